@@ -165,6 +165,32 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+
+/* Zero-heap build. Every thread, queue, semaphore and timer is statically allocated by its
+   module, so the FreeRTOS heap can be removed. The ZeroHeap build configuration defines this
+   as 1 and leaves heap_4.c out. Any remaining dynamic allocation then fails to link or
+   returns NULL at startup. */
+#ifndef RTOS_ZERO_HEAP
+#define RTOS_ZERO_HEAP 0
+#endif
+
+#if RTOS_ZERO_HEAP
+#undef configSUPPORT_DYNAMIC_ALLOCATION
+#define configSUPPORT_DYNAMIC_ALLOCATION 0
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE 0
+#endif
+
+/* Timer service task stack (words). The PID, element and Modbus timers run in this task, and
+   every structured telemetry line formats into a LOG_LINE_SIZE buffer with float vsnprintf on
+   top of the control step: about 1.8 KB at -O0 for the deepest path. Check the high-water mark
+   of "Tmr Svc" with "boot stack" after changing the control step or the log module. */
+#undef configTIMER_TASK_STACK_DEPTH
+#define configTIMER_TASK_STACK_DEPTH 768
+
+/* Tickless idle. The idle task sleeps on LPTIM1 until the next thread timeout or timer
+   expiry with the kernel tick stopped; vPortSuppressTicksAndSleep() is in power.c. */
+#define configUSE_TICKLESS_IDLE 1
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -16,14 +16,26 @@
  * D2       SCV fault: Reads 1 when thermocouple is shorted to V_CC, else 0
  * D1       SCG fault: Reads 1 when thermocouple is shorted to gnd, else 0
  * D0       OC  fault: Reads 1 when thermocouple is open-circuit, else 0
+ *
+ * Several MAX31855K can share one SPI bus, each with its own chip-select line. Devices are
+ * addressed by index (0 to MAX31855K_MAX_DEVICES - 1), assigned in MAX31855K_Init().
+ *
+ * Blocking reads from several threads are serialized by a bus mutex. To read a device and
+ * then its temperature without another thread reading it in between, hold the bus lock
+ * around both calls.
  */
 
 #ifndef _MAX31855K_H_
 #define _MAX31855K_H_
 
+#include <stdbool.h>
+
 #include "stm32l4xx_hal.h"
 #include "stm32l476xx.h"
 
+/* Configuration parameters */
+#define MAX31855K_MAX_DEVICES 5 // Maximum number of thermocouple ICs.
+
 // MAX31855K thermocouple device error definitions.
 typedef enum
 {
@@ -33,6 +45,7 @@ typedef enum
     MAX_OPEN,         // Thermocouple connection is open.
     MAX_ZEROS,        // SPI read only 0s.
     MAX_SPI_DMA_FAIL, // Error during SPI DMA RX transfer.
+    MAX_FAULT,        // Fault bit set without exactly one fault source.
 
     MAX_NUM_ERRORS
 } MAX31855K_err_t;
@@ -46,62 +59,97 @@ typedef struct
 } MAX31855K_cfg_t;
 
 /**
- * @brief Initialize MAX31885K driver.
+ * @brief Initialize MAX31885K driver instance.
  * 
+ * @param dev Device index, less than MAX31855K_MAX_DEVICES.
  * @param max_cfg Configuration parameters.
  */
-void MAX31855K_Init(MAX31855K_cfg_t const *const max_cfg);
+void MAX31855K_Init(uint8_t dev, MAX31855K_cfg_t const *const max_cfg);
 
 /**
  * @brief Read data from MAX31855K in blocking mode and check for errors.
  * 
+ * @param dev Device index.
+ *
  * @return MAX31855K_err_t Error value.
  * 
  * SPI instance must be initialized prior to function call.
  */
-MAX31855K_err_t MAX31855K_RxBlocking();
+MAX31855K_err_t MAX31855K_RxBlocking(uint8_t dev);
 
 /**
  * @brief Read data from MAX31855K in non-blocking mode through DMA controller.
+ *
+ * @param dev Device index. Only one device of a bus may be read at a time.
+ *
+ * @note The bus lock is not taken, since the transfer completes in an interrupt.
  */
-void MAX31855K_RxDMA();
+void MAX31855K_RxDMA(uint8_t dev);
 
 /**
  * @brief Format data received and check for errors after DMA transfer.
  * 
- * @param max Pointer to MAX321885K_t structure containing configuration parameters and data.
+ * @param dev Device index passed to MAX31855K_RxDMA().
  * 
  * Function should be called from within a SPI_RX_Cplt callback function.
  */
-void MAX31885K_RxDMA_Complete();
+void MAX31885K_RxDMA_Complete(uint8_t dev);
 
 /**
  * @brief Parse HJ temperature from raw data.
  * 
- * @pre Check that max's error value equals MAX_OK.
+ * @pre Check that the device's error value equals MAX_OK.
  *
- * @param max Pointer to MAX321885K_t structure containing configuration parameters and data.
+ * @param dev Device index.
  *
  * @return float Hot junction temperature.
  */
-float MAX31855K_Get_HJ();
+float MAX31855K_Get_HJ(uint8_t dev);
 
 /**
  * @brief Parse CJ temperature from raw data.
  * 
- * @pre Check that max's error value equals MAX_OK.
+ * @pre Check that the device's error value equals MAX_OK.
  *
- * @param max Pointer to MAX321885K_t structure containing configuration parameters and data.
+ * @param dev Device index.
  *
  * @return float Cold junction temperature.
  */
-float MAX31855K_Get_CJ();
+float MAX31855K_Get_CJ(uint8_t dev);
 
 /**
  * @brief Get current error value as a character string.
  *
+ * @param dev Device index.
+ *
  * @return Error value formatted as character string.
  */
-const char *MAX31855K_Err_Str();
+const char *MAX31855K_Err_Str(uint8_t dev);
+
+/**
+ * @brief Get name of an error value, e.g. one saved from an earlier reading.
+ *
+ * @param err Error value.
+ *
+ * @return Error value formatted as character string.
+ */
+const char *MAX31855K_Err_Name(MAX31855K_err_t err);
+
+/**
+ * @brief Take the SPI bus for a sequence of reads and temperature conversions.
+ *
+ * Waits until no other thread uses the bus. Before the scheduler runs, the bus is not
+ * locked. Must not be called from interrupts or with the kernel locked.
+ *
+ * @return true if locked, pass to MAX31855K_Bus_Unlock().
+ */
+bool MAX31855K_Bus_Lock(void);
+
+/**
+ * @brief Release the SPI bus.
+ *
+ * @param locked Return value of MAX31855K_Bus_Lock().
+ */
+void MAX31855K_Bus_Unlock(bool locked);
 
 #endif
@@ -10,8 +10,10 @@
 #define _ACTIVE_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "common.h"
 #include "cmsis_os.h"
+#include "timers.h"
 
 /**
  * @brief Generic signal type definition.
@@ -56,6 +58,33 @@ typedef struct
     uint32_t reload;  // Reload value for periodic time events, 0 means one-shot.
 } TimeEvent;
 
+/**
+ * @brief Define statically allocated thread and event queue of an active object.
+ *
+ * Defines <ao_name>_thread_attr and <ao_name>_queue_attr to pass to Active_start(), so the
+ * active object does not allocate from the RTOS heap. Use at file scope.
+ *
+ * @param ao_name Active object name, also used as thread name.
+ * @param stack_bytes Thread stack size in bytes.
+ * @param num_msgs Maximum number of messages/events in queue.
+ */
+#define ACTIVE_STATIC_DEF(ao_name, stack_bytes, num_msgs)                       \
+    static StaticTask_t ao_name##_thread_cb;                                    \
+    static uint32_t ao_name##_thread_stack[(stack_bytes) / sizeof(uint32_t)];   \
+    static StaticQueue_t ao_name##_queue_cb;                                    \
+    static Event const *ao_name##_queue_mem[(num_msgs)];                        \
+    static const osThreadAttr_t ao_name##_thread_attr = {                       \
+        .name = #ao_name,                                                       \
+        .cb_mem = &ao_name##_thread_cb,                                         \
+        .cb_size = sizeof(ao_name##_thread_cb),                                 \
+        .stack_mem = ao_name##_thread_stack,                                    \
+        .stack_size = sizeof(ao_name##_thread_stack)};                          \
+    static const osMessageQueueAttr_t ao_name##_queue_attr = {                  \
+        .cb_mem = &ao_name##_queue_cb,                                          \
+        .cb_size = sizeof(ao_name##_queue_cb),                                  \
+        .mq_mem = ao_name##_queue_mem,                                          \
+        .mq_size = sizeof(ao_name##_queue_mem)}
+
 /* Event handler function pointer typedef. */
 typedef void (*EventHandler)(Active *const ao, Event const *const evt);
 
@@ -72,6 +101,10 @@ struct Active
 
     /* Virtual functions */
     EventHandler evt_handler; // Event handler function.
+
+    /* Instrumentation */
+    uint32_t dispatch_us;     // Run-to-completion time of most recent event (us).
+    uint32_t dispatch_max_us; // Longest run-to-completion time (us).
 };
 
 /**
@@ -91,6 +124,9 @@ mod_err_t Active_ctor(Active *const ao, EventHandler evt_handler);
  * @param[in] thread_attr Thread attributes (NULL for default).
  * @param[in] msg_count Maximum number of messages/events in queue.
  * @param[in] queue_attr Queue attributes (NULL for default).
+ *
+ * Pass the attributes of ACTIVE_STATIC_DEF() for static allocation; NULL attributes
+ * allocate from the RTOS heap, which zero-heap builds do not have.
  * 
  * @return MOD_OK if successful, a "MOD_ERR" value otherwise.
  * 
@@ -113,6 +149,21 @@ mod_err_t Active_start(Active *const ao,
  */
 mod_err_t Active_post(Active *const ao, Event const *const evt);
 
+/**
+ * @brief Create periodic software timer in statically allocated memory.
+ *
+ * osTimerNew() allocates its callback record from the RTOS heap even when given a control
+ * block, so timers are created with the FreeRTOS API. The returned ID works with
+ * osTimerStart() and osTimerStop(), which also set the period.
+ *
+ * @param[in] name Timer name.
+ * @param[in] cb Timer callback, runs in the timer service task.
+ * @param[in] cb_mem Timer control block.
+ *
+ * @return Timer ID, NULL if arguments are invalid.
+ */
+osTimerId_t Active_timer_new(const char *name, TimerCallbackFunction_t cb, StaticTimer_t *cb_mem);
+
 /**
  * @brief Time event constructor.
  * 
@@ -140,4 +191,23 @@ void TimeEvent_arm(TimeEvent *const time_evt, uint32_t timeout, uint32_t reload)
  */
 void TimeEvent_disarm(TimeEvent *const time_evt);
 
+/**
+ * @brief Select clock driving all time events.
+ * 
+ * @param[in] enable true to count down time events only through TimeEvent_advance(),
+ *                   false to count down on the 1 s timer.
+ * 
+ * A virtual clock makes timeouts follow the pace of the caller, e.g. replayed samples.
+ */
+void TimeEvent_use_virtual_clock(bool enable);
+
+/**
+ * @brief Advance virtual clock.
+ * 
+ * @param[in] ms Elapsed virtual time (ms). Time events count down once per full second.
+ * 
+ * Has no effect unless the virtual clock is selected.
+ */
+void TimeEvent_advance(uint32_t ms);
+
 #endif
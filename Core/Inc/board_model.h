@@ -0,0 +1,96 @@
+/**
+ * @file board_model.h
+ * @author Timothy Nguyen
+ * @brief PCB temperature observer
+ * @version 0.1
+ * @date 2021-08-18
+ *
+ *      The thermocouple measures oven air, but the solder joints follow the board. The board is
+ *      modelled as one thermal mass heated by the air through a first-order lag:
+ *
+ *          tau dTb/dt = Ta - Tb,  tau = m c / (h A)
+ *
+ *      tau grows with the board's heat capacity m c and shrinks with the convective coupling h A,
+ *      so heavy boards and copper pours lag more. With the air temperature held over each sample
+ *      period Ts, the exact discrete form is
+ *
+ *          Tb[k] = Tb[k-1] + alpha (Ta[k] - Tb[k-1]),  alpha = 1 - exp(-Ts / tau)
+ *
+ *      The lag of a board is fitted from a run with a thermocouple probe taped to it, by least
+ *      squares on the same recurrence: dTb = alpha e, e = Ta[k] - Tb[k-1]. Probe noise in Tb[k-1]
+ *      appears in both dTb and e and would shorten the fitted lag, so e is instrumented with
+ *      z = Ta[k] - Tb[k-2]: alpha = sum(dTb z) / sum(e z).
+ */
+
+#ifndef _BOARD_MODEL_H_
+#define _BOARD_MODEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Board temperature observer structure */
+typedef struct
+{
+    float tau;      // Board thermal time constant (s).
+    float Ts;       // Sample time (s).
+    float alpha;    // Smoothing factor, 1 - exp(-Ts / tau).
+    float estimate; // Estimated board temperature.
+} Board_t;
+
+/* Least-squares fit of the board lag from air and probe temperatures */
+typedef struct
+{
+    double sum_ez;     // Sum of air-to-board difference times instrument.
+    double sum_dz;     // Sum of board temperature change times instrument.
+    float prev_probe;  // Previous probe temperature.
+    float prev2_probe; // Probe temperature before previous.
+    uint32_t samples;  // Number of accumulated samples.
+} Board_fit_t;
+
+/**
+ * @brief Set board lag and sample time, and reset the estimate to ambient.
+ *
+ * @param[in/out] board Observer instance to initialize.
+ * @param tau Board thermal time constant (s), greater than 0.
+ * @param Ts Sample time (s), greater than 0.
+ * @param temp Initial board temperature.
+ */
+void Board_Init(Board_t *const board, float tau, float Ts, float temp);
+
+/**
+ * @brief Advance the board estimate by one sample.
+ *
+ * @param board Observer instance.
+ * @param air_temp Oven air temperature of the current sample.
+ * @return float Estimated board temperature.
+ */
+float Board_Update(Board_t *const board, float air_temp);
+
+/**
+ * @brief Clear fit sums.
+ *
+ * @param fit Fit instance.
+ * @param probe_temp Probe temperature at the start of the run.
+ */
+void Board_Fit_Reset(Board_fit_t *const fit, float probe_temp);
+
+/**
+ * @brief Add one sample to the fit.
+ *
+ * @param fit Fit instance.
+ * @param air_temp Oven air temperature of the current sample.
+ * @param probe_temp Board probe temperature of the current sample.
+ */
+void Board_Fit_Add(Board_fit_t *const fit, float air_temp, float probe_temp);
+
+/**
+ * @brief Compute board lag of the accumulated samples.
+ *
+ * @param fit Fit instance.
+ * @param Ts Sample time of the accumulated samples (s).
+ * @param[out] tau Fitted board thermal time constant (s).
+ * @return true if the run heated the board enough for a fit, otherwise false.
+ */
+bool Board_Fit_Tau(Board_fit_t const *const fit, float Ts, float *const tau);
+
+#endif
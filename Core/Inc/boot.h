@@ -0,0 +1,87 @@
+/**
+ * @file boot.h
+ * @author Timothy Nguyen
+ * @brief Boot-time profiler and deferred initialization.
+ * @version 0.1
+ * @date 2021-08-15
+ *
+ * Boot phases are timestamped in microseconds from the reset vector (see timestamp.h) and kept
+ * in a record in SRAM2, which the startup code does not initialize, so the record of the previous
+ * boot survives a reset. The full profile is logged on the first boot after power-up; warm resets
+ * log a one-line summary. Enter "boot status" for both records at any time, and "boot stack" for
+ * the unused stack of every thread.
+ *
+ * Only the control path is initialized before the reflow active object starts. Non-critical setup
+ * (command registration for diagnostics, console, Modbus thread) is queued with boot_defer() and
+ * run by boot_run_deferred() at below-normal priority, so it never delays the first control tick.
+ */
+
+#ifndef _BOOT_H_
+#define _BOOT_H_
+
+#include <stdint.h>
+
+#include "common.h"
+
+/* Configuration parameters */
+#define BOOT_MAX_DEFERRED 12 // Maximum number of deferred initialization functions.
+#define BOOT_MAX_THREADS 12  // Maximum number of threads listed by "boot stack", including idle and timer tasks.
+
+/* Boot phases, in boot order */
+typedef enum
+{
+    BOOT_PHASE_RESET,    // Reset vector, cycle counter started.
+    BOOT_PHASE_MAIN,     // main() entered, .data and .bss initialized.
+    BOOT_PHASE_CLOCK,    // System clock switched to PLL.
+    BOOT_PHASE_PERIPH,   // HAL peripherals and UARTs initialized.
+    BOOT_PHASE_KERNEL,   // Scheduler started, default task running.
+    BOOT_PHASE_CONTROL,  // First safe control tick: reflow active object in RESET, heater off.
+    BOOT_PHASE_PROMPT,   // Console prompt printed.
+    BOOT_PHASE_DEFERRED, // Deferred initialization done.
+
+    NUM_BOOT_PHASES
+} boot_phase_t;
+
+/* Deferred initialization function */
+typedef mod_err_t (*boot_init_fn_t)(void);
+
+/**
+ * @brief Start boot record of this boot and keep the previous one.
+ *
+ * Call at the start of main(), after timestamp_init().
+ */
+void boot_init(void);
+
+/**
+ * @brief Register boot commands.
+ *
+ * @return MOD_OK if successful, otherwise a "MOD_ERR" value.
+ */
+mod_err_t boot_start(void);
+
+/**
+ * @brief Timestamp a boot phase. Only the first mark of each phase is kept.
+ *
+ * Safe to call from threads and interrupts.
+ */
+void boot_mark(boot_phase_t phase);
+
+/**
+ * @brief Queue an initialization function to run after the control path is live.
+ *
+ * @param name Name shown by "boot status".
+ * @param fn Initialization function.
+ *
+ * @return MOD_OK if successful, MOD_ERR_RESOURCE if the queue is full.
+ */
+mod_err_t boot_defer(const char *name, boot_init_fn_t fn);
+
+/**
+ * @brief Run deferred initialization functions in order, then report the boot profile.
+ *
+ * Lowers the priority of the calling thread below normal first, so threads started on the
+ * control path run before any deferred work.
+ */
+void boot_run_deferred(void);
+
+#endif
@@ -22,6 +22,9 @@
 
 #define PROMPT "> "
 
+/* Raw character handler, bypasses command line editing. */
+typedef void (*console_raw_handler_t)(char c);
+
 /**
  * @brief Initialize console module instance.
  *
@@ -47,4 +50,13 @@ mod_err_t console_start(void);
  */
 mod_err_t console_post(char c);
 
+/**
+ * @brief Route received characters to a raw handler instead of the command line editor.
+ *
+ * @param handler Raw character handler, or NULL to resume command line editing.
+ *
+ * Handler is called from the console thread.
+ */
+void console_set_raw_handler(console_raw_handler_t handler);
+
 #endif
@@ -14,19 +14,41 @@
  * Then use one of logging macros to produce output, e.g: 
  * 
  * LOGW(TAG, "Baud rate error %.1f%%. Requested: %d baud, actual: %d baud", error * 100, baud_req, baud_real);
+ *
+ * Messages that start with a "key=" field are structured, e.g:
+ *
+ * LOGI(TAG, "s=%s sp=%.2f pv=%.2f", state_name, setpoint, temperature);
+ *
+ * The output format is selected at runtime with "log format <text|kv|json>":
+ * - text: "I (12.345678) REFLOW: PREHEAT 150.00 25.00" (colour codes, keys are stripped).
+ * - kv:   "s=PREHEAT sp=150.00 pv=25.00"
+ * - json: {"s":"PREHEAT","sp":150.00,"pv":25.00}
+ * Structured info messages are records: kv and json print only their fields, so records must carry
+ * their own sequence number or time. Keep keys short, they are sent with every kv and json record.
+ * Other messages start with "t=12.345678 lvl=W tag=REFLOW" (kv) or "t", "lvl" and "tag" members
+ * (json). Timestamps are seconds since boot with microsecond resolution (see timestamp.h).
+ * Unstructured messages become a "msg" field in kv and json formats. Field values must not
+ * contain spaces.
+ *
+ * Structured messages are formatted into a LOG_LINE_SIZE buffer on the caller's stack. Longer
+ * messages lose their last, cut-off field and are marked: " ~" (text), "trunc=1" (kv) or
+ * "trunc":1 (json). Split long telemetry over several messages instead.
  */
 
 #ifndef _LOG_H_
 #define _LOG_H_
 
 #include <stdbool.h>
+#include <inttypes.h>
 
 #include "stm32l4xx_hal.h"
 #include "common.h"
 #include "printf.h"
+#include "timestamp.h"
 
 /* Configuration parameters */
 #define LOG_TOGGLE_CHAR '\t' // Press LOG_TOGGLE_CHAR to toggle logging on and off.
+#define LOG_LINE_SIZE 128    // Maximum length of a formatted structured message, on the caller's stack.
 
 /**
  * @brief Logging levels.
@@ -43,6 +65,18 @@ typedef enum
     LOG_DEFAULT = LOG_INFO // Default log level.
 } log_level_t;
 
+/**
+ * @brief Log output formats.
+ */
+typedef enum
+{
+    LOG_FORMAT_TEXT, // Human-readable text with colour codes.
+    LOG_FORMAT_KV,   // key=value fields without colour codes.
+    LOG_FORMAT_JSON, // One JSON object per line.
+
+    NUM_LOG_FORMATS
+} log_format_t;
+
 /* Logging text colours */
 #define LOG_COLOUR_BLACK "30"
 #define LOG_COLOUR_RED "31"
@@ -61,17 +95,7 @@ typedef enum
 #define LOG_COLOUR_D LOG_COLOUR(LOG_COLOUR_BLUE)
 #define LOG_COLOUR_V LOG_COLOUR(LOG_COLOUR_CYAN)
 
-/**
- * @brief Runtime macro to format string with additional information.
- * 
- * @param level First letter of log level.
- * @param format Format string before additional information is prepended.
- * 
- * Additional information prepended from left-to-right: Colour, Log level, Time (ms), Tag. 
- */
-#define LOG_FORMAT(letter, format) "\r" LOG_COLOUR_##letter #letter " (%lu.%03lu) %s: " format "\r\n"
-
-#define ASSERTION_FORMAT LOG_COLOUR_E "E (%lu.%03lu) Assertion failed at %s, line %d" \
+#define ASSERTION_FORMAT LOG_COLOUR_E "E (%" PRIu32 ".%06" PRIu32 ") Assertion failed at %s, line %d" \
                                       "\r\n"
 
 /**
@@ -97,22 +121,33 @@ bool log_toggle(void);
  */
 bool log_is_active(void);
 
+/**
+ * @brief Set log output format.
+ *
+ * @param format New output format.
+ *
+ * @return MOD_OK if successful, MOD_ERR_ARG if format is invalid.
+ */
+mod_err_t log_format_set(log_format_t format);
+
 /** 
  * @brief Base "printf" style function for logging.
  *
  * @param tag Unique module tag.
  * @param level Message's log level.
+ * @param us Timestamp of message (us).
  * @param fmt Format string.
  * @param ... Variable arguments.
  *
  * This function is not intended to be used directly. Instead, use one of 
  * LOGE, LOGW, LOGI, LOGD, LOGV macros below.
  */
-void log_printf(const char *tag, log_level_t level, const char *fmt, ...);
+void log_printf(const char *tag, log_level_t level, uint64_t us, const char *fmt, ...) __attribute__((format(__printf__, 4, 5)));
 
 /* Private variables for logging macros. Do not modify. */
 extern bool _log_active;          // Is data logging active or inactive?
 extern int32_t _global_log_level; // Only print messages at or below the global log level.
+extern log_format_t _log_format;  // Output format of log messages.
 
 /**
  * @brief Runtime macros to output a log message at a specified level.
@@ -123,54 +158,49 @@ extern int32_t _global_log_level; // Only print messages at or below the global
  * 
  * @note tag should have static storage duration.
  */
-#define LOGE(tag, fmt, ...)                                                                           \
-    do                                                                                                \
-    {                                                                                                 \
-        if (_log_active)                                                                              \
-        {                                                                                             \
-            uint32_t ms = HAL_GetTick();                                                              \
-            log_printf(tag, LOG_ERROR, LOG_FORMAT(E, fmt), ms / 1000, ms % 1000, tag, ##__VA_ARGS__); \
-        }                                                                                             \
+#define LOGE(tag, fmt, ...)                                                 \
+    do                                                                      \
+    {                                                                       \
+        if (_log_active)                                                    \
+        {                                                                   \
+            log_printf(tag, LOG_ERROR, timestamp_us(), fmt, ##__VA_ARGS__); \
+        }                                                                   \
     } while (0)
 
-#define LOGW(tag, fmt, ...)                                                                             \
-    do                                                                                                  \
-    {                                                                                                   \
-        if (_log_active)                                                                                \
-        {                                                                                               \
-            uint32_t ms = HAL_GetTick();                                                                \
-            log_printf(tag, LOG_WARNING, LOG_FORMAT(W, fmt), ms / 1000, ms % 1000, tag, ##__VA_ARGS__); \
-        }                                                                                               \
+#define LOGW(tag, fmt, ...)                                                   \
+    do                                                                        \
+    {                                                                         \
+        if (_log_active)                                                      \
+        {                                                                     \
+            log_printf(tag, LOG_WARNING, timestamp_us(), fmt, ##__VA_ARGS__); \
+        }                                                                     \
     } while (0)
 
-#define LOGI(tag, fmt, ...)                                                                          \
-    do                                                                                               \
-    {                                                                                                \
-        if (_log_active)                                                                             \
-        {                                                                                            \
-            uint32_t ms = HAL_GetTick();                                                             \
-            log_printf(tag, LOG_INFO, LOG_FORMAT(I, fmt), ms / 1000, ms % 1000, tag, ##__VA_ARGS__); \
-        }                                                                                            \
+#define LOGI(tag, fmt, ...)                                                \
+    do                                                                     \
+    {                                                                      \
+        if (_log_active)                                                   \
+        {                                                                  \
+            log_printf(tag, LOG_INFO, timestamp_us(), fmt, ##__VA_ARGS__); \
+        }                                                                  \
     } while (0)
 
-#define LOGD(tag, fmt, ...)                                                                           \
-    do                                                                                                \
-    {                                                                                                 \
-        if (_log_active)                                                                              \
-        {                                                                                             \
-            uint32_t ms = HAL_GetTick();                                                              \
-            log_printf(tag, LOG_DEBUG, LOG_FORMAT(D, fmt), ms / 1000, ms % 1000, tag, ##__VA_ARGS__); \
-        }                                                                                             \
+#define LOGD(tag, fmt, ...)                                                 \
+    do                                                                      \
+    {                                                                       \
+        if (_log_active)                                                    \
+        {                                                                   \
+            log_printf(tag, LOG_DEBUG, timestamp_us(), fmt, ##__VA_ARGS__); \
+        }                                                                   \
     } while (0)
 
-#define LOGV(tag, fmt, ...)                                                                             \
-    do                                                                                                  \
-    {                                                                                                   \
-        if (_log_active)                                                                                \
-        {                                                                                               \
-            uint32_t ms = HAL_GetTick();                                                                \
-            log_printf(tag, LOG_VERBOSE, LOG_FORMAT(V, fmt), ms / 1000, ms % 1000, tag, ##__VA_ARGS__); \
-        }                                                                                               \
+#define LOGV(tag, fmt, ...)                                                   \
+    do                                                                        \
+    {                                                                         \
+        if (_log_active)                                                      \
+        {                                                                     \
+            log_printf(tag, LOG_VERBOSE, timestamp_us(), fmt, ##__VA_ARGS__); \
+        }                                                                     \
     } while (0)
 
 /**
@@ -180,25 +210,26 @@ extern int32_t _global_log_level; // Only print messages at or below the global
  * @param ... Variable arguments.
  *
  * In essence, this macro bypasses log level checks and extra formatting.
+ * Colour codes are only sent in text format.
  */
-#define LOG(format, ...) printf(LOG_RESET_COLOUR format, ##__VA_ARGS__)
+#define LOG(format, ...) printf("%s" format, _log_format == LOG_FORMAT_TEXT ? LOG_RESET_COLOUR : "", ##__VA_ARGS__)
 
 /**
  * @brief Assertion macro.
  *
  * If assertion fails, program enters forever loop.
  */
-#define ASSERT(check)                                                           \
-    do                                                                          \
-    {                                                                           \
-        if (!(check))                                                           \
-        {                                                                       \
-            uint32_t ms = HAL_GetTick();                                        \
-            printf(ASSERTION_FORMAT, ms / 1000, ms % 1000, __FILE__, __LINE__); \
-            while (1)                                                           \
-            {                                                                   \
-            }                                                                   \
-        }                                                                       \
+#define ASSERT(check)                                                                                         \
+    do                                                                                                        \
+    {                                                                                                         \
+        if (!(check))                                                                                         \
+        {                                                                                                     \
+            uint64_t us = timestamp_us();                                                                     \
+            printf(ASSERTION_FORMAT, (uint32_t)(us / 1000000), (uint32_t)(us % 1000000), __FILE__, __LINE__); \
+            while (1)                                                                                         \
+            {                                                                                                 \
+            }                                                                                                 \
+        }                                                                                                     \
     } while (0)
 
 #endif // _LOG_H_
@@ -89,6 +89,14 @@ void Error_Handler(void);
 #define SWO_Pin GPIO_PIN_3
 #define SWO_GPIO_Port GPIOB
 /* USER CODE BEGIN Private defines */
+#define MAX_ELEMENT_CS_Pin GPIO_PIN_5 // Chip select of heater element thermocouple, shares SPI2 with MAX_CS.
+#define MAX_ELEMENT_CS_GPIO_Port GPIOC
+#define MAX_PROBE_CS_Pin GPIO_PIN_6 // Chip select of board probe thermocouple (calibration), shares SPI2 with MAX_CS.
+#define MAX_PROBE_CS_GPIO_Port GPIOC
+#define MAX_OVEN_B_CS_Pin GPIO_PIN_8 // Chip selects of redundant oven thermocouples, share SPI2 with MAX_CS.
+#define MAX_OVEN_B_CS_GPIO_Port GPIOC
+#define MAX_OVEN_C_CS_Pin GPIO_PIN_9
+#define MAX_OVEN_C_CS_GPIO_Port GPIOC
 
 /* USER CODE END Private defines */
 
@@ -0,0 +1,118 @@
+/**
+ * @file modbus.h
+ * @author Timothy Nguyen
+ * @brief Modbus RTU slave for PLC/SCADA integration.
+ * @version 0.1
+ * @date 2021-08-12
+ *
+ * Runs on its own UART instance, separate from the console. Frames are delimited by the
+ * UART's receiver timeout (3.5 character times), so the receive ISR only stores bytes.
+ * Requests are answered by the Modbus thread from shadow register blocks, which the
+ * register owner refreshes with modbus_update_input_regs() and modbus_update_holding_regs().
+ *
+ * Supported function codes:
+ * - 0x03 Read Holding Registers
+ * - 0x04 Read Input Registers
+ * - 0x06 Write Single Register
+ * - 0x10 Write Multiple Registers
+ *
+ * Writes to holding registers are passed to the write callback, which validates and applies
+ * them and refreshes the holding register shadow. Broadcast requests (address 0) are executed without a response.
+ */
+
+#ifndef _MODBUS_H_
+#define _MODBUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "common.h"
+#include "stm32l4xx_ll_usart.h"
+
+/* Configuration parameters */
+#define MODBUS_NUM_INPUT_REGS 16       // Number of input registers (read-only telemetry).
+#define MODBUS_NUM_HOLDING_REGS 16     // Number of holding registers (parameters and commands).
+#define MODBUS_MAX_FRAME_SIZE 256      // Maximum RTU frame size, including address and CRC.
+#define MODBUS_THREAD_STACK_SIZE 512   // Stack size for Modbus thread.
+#define MODBUS_T35_FAST_US 1750        // Fixed inter-frame gap above 19200 baud (us).
+
+/* Exception codes */
+enum modbus_exception
+{
+    MODBUS_EX_NONE = 0x00,
+    MODBUS_EX_ILLEGAL_FUNCTION = 0x01,
+    MODBUS_EX_ILLEGAL_DATA_ADDRESS = 0x02,
+    MODBUS_EX_ILLEGAL_DATA_VALUE = 0x03,
+    MODBUS_EX_DEVICE_FAILURE = 0x04,
+    MODBUS_EX_DEVICE_BUSY = 0x06,
+};
+
+/* Configuration structure */
+typedef struct
+{
+    USART_TypeDef *uart_reg_base; // Address of UARTn peripheral's base register (initialized and enabled).
+    IRQn_Type irq_num;            // Interrupt request number (IRQn) of UARTn peripheral.
+    uint32_t baud_rate;           // Baud rate the UART was initialized with, used for frame timing.
+    uint8_t slave_addr;           // Slave address (1-247).
+} modbus_cfg_t;
+
+/**
+ * @brief Callback validating and applying a write to holding registers.
+ *
+ * Called from the Modbus thread, once per write request. The thread stack (MODBUS_THREAD_STACK_SIZE)
+ * has no room for logging, post an event to log or run longer actions.
+ *
+ * @param addr Address of the first register.
+ * @param count Number of registers.
+ * @param values New register values.
+ *
+ * @return MODBUS_EX_NONE if the write was applied, otherwise the exception code to answer with.
+ */
+typedef uint8_t (*modbus_write_cb_t)(uint16_t addr, uint16_t count, const uint16_t *values);
+
+/**
+ * @brief Initialize Modbus slave.
+ *
+ * @param cfg Configuration structure.
+ *
+ * @return MOD_OK if successful, otherwise a "MOD_ERR" value.
+ */
+mod_err_t modbus_init(modbus_cfg_t const *const cfg);
+
+/**
+ * @brief Start Modbus thread and enable UART interrupts.
+ *
+ * @return MOD_OK if successful, otherwise a "MOD_ERR" value.
+ */
+mod_err_t modbus_start(void);
+
+/**
+ * @brief Register callback for writes to holding registers.
+ *
+ * @param cb Write callback, NULL to reject all writes.
+ */
+void modbus_set_write_cb(modbus_write_cb_t cb);
+
+/**
+ * @brief Copy values into the input register shadow.
+ *
+ * @param addr Address of the first register.
+ * @param count Number of registers.
+ * @param values Register values.
+ *
+ * @return MOD_OK if successful, MOD_ERR_ARG if the range is out of bounds.
+ */
+mod_err_t modbus_update_input_regs(uint16_t addr, uint16_t count, const uint16_t *values);
+
+/**
+ * @brief Copy values into the holding register shadow.
+ *
+ * @param addr Address of the first register.
+ * @param count Number of registers.
+ * @param values Register values.
+ *
+ * @return MOD_OK if successful, MOD_ERR_ARG if the range is out of bounds.
+ */
+mod_err_t modbus_update_holding_regs(uint16_t addr, uint16_t count, const uint16_t *values);
+
+#endif
@@ -9,11 +9,22 @@
  * 
  *      Integrator anti-windup method based on Bryan Douglas' PID video: https://www.youtube.com/watch?v=NVLXCwc8HzM
  * 
+ *      Two-degree-of-freedom form with setpoint weights b and c, and back-calculation anti-windup,
+ *      from Astrom and Hagglund, Advanced PID Control, chapter 3:
+ *
+ *          P = Kp (b r - y),  D = Kd s / (tau s + 1) (c r - y),  I = Ki / s (r - y)
+ *
+ *      b < 1 softens the proportional kick of a setpoint step without slowing disturbance
+ *      rejection; c = 0 takes the derivative on measurement only. b = 1, c = 0 and Tt = 0 give the
+ *      classic controller with conditional integration.
+ * 
  */
 
 #ifndef _PID_H_
 #define _PID_H_
 
+#include "common.h"
+
 /* PID controller structure */
 typedef struct
 {
@@ -24,6 +35,10 @@ typedef struct
     float tau; // Derivative low-pass filter time constant
     float Ts;  // Sample time (s).
 
+    float b;  // Setpoint weight of proportional term.
+    float c;  // Setpoint weight of derivative term.
+    float Tt; // Back-calculation tracking time constant (s), 0 for conditional integration.
+
     float out_lim_max; // Output maximum saturation limit.
     float out_lim_min; // Output minimum saturation limit.
 
@@ -32,6 +47,7 @@ typedef struct
     float derivative;       // Derivative term.
     float prev_error;       // Previous error, required for integrator.
     float prev_measurement; // Previous measurement, required for differentiator.
+    float prev_setpoint;    // Previous setpoint, required for differentiator.
 
     /* Solely for data logging */
     float proportional;
@@ -50,6 +66,11 @@ typedef struct
     float tau;
     float Ts;
 
+    /* Setpoint weights and anti-windup tracking time constant */
+    float b;
+    float c;
+    float Tt;
+
     float out_max;
     float out_min;
 } PID_cfg_t;
@@ -80,4 +101,11 @@ float PID_Calculate(PID_t *const pid, float setpoint, float measurement);
  */
 void PID_Reset(PID_t *const pid);
 
+/**
+ * @brief Register PID commands ("pid bench").
+ *
+ * @return MOD_OK if successful, otherwise a "MOD_ERR" value.
+ */
+mod_err_t PID_Start(void);
+
 #endif
@@ -0,0 +1,425 @@
+/**
+ * @file pid.hpp
+ * @author Timothy Nguyen
+ * @brief Header-only C++17 control library: PID controller, filters and discretisation.
+ * @version 0.1
+ * @date 2021-08-17
+ *
+ * Templates over the sample type T (float, double or ctl::Fixed), with features selected by
+ * policy types at compile time, so a PI controller carries no derivative state and no
+ * derivative arithmetic.
+ *
+ * Continuous gains are discretised by constexpr functions into the coefficients the update
+ * equations use, so gains known at compile time cost nothing at run time, and no update
+ * divides. ctl::Pid<float> computes the same output as PID_Calculate() in pid.c.
+ *
+ * C code uses the controller through pid_cxx.h.
+ *
+ * No exceptions, RTTI, heap or library calls: the firmware is linked without libstdc++.
+ */
+
+#ifndef _PID_HPP_
+#define _PID_HPP_
+
+#include <cstdint>
+#include <limits>
+
+namespace ctl
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Fixed-point sample type
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Signed fixed-point number with Frac fractional bits in a 32-bit integer.
+ *
+ * Multiplication rounds towards minus infinity. Addition, subtraction and multiplication
+ * saturate instead of wrapping, like the controller output does.
+ */
+template <int Frac>
+class Fixed
+{
+    static_assert(Frac > 0 && Frac < 31, "Fixed needs integer and fractional bits");
+
+public:
+    using raw_type = int32_t;
+
+    constexpr Fixed() = default;
+
+    constexpr explicit Fixed(double value)
+        : raw_(saturate(static_cast<int64_t>(value * one + (value < 0 ? -0.5 : 0.5))))
+    {
+    }
+
+    static constexpr Fixed from_raw(raw_type raw)
+    {
+        Fixed f;
+        f.raw_ = raw;
+        return f;
+    }
+
+    constexpr raw_type raw() const { return raw_; }
+
+    constexpr explicit operator float() const { return static_cast<float>(raw_) / one; }
+    constexpr explicit operator double() const { return static_cast<double>(raw_) / one; }
+
+    friend constexpr Fixed operator+(Fixed a, Fixed b) { return from_raw(saturate(int64_t{a.raw_} + b.raw_)); }
+    friend constexpr Fixed operator-(Fixed a, Fixed b) { return from_raw(saturate(int64_t{a.raw_} - b.raw_)); }
+    friend constexpr Fixed operator*(Fixed a, Fixed b) { return from_raw(saturate((int64_t{a.raw_} * b.raw_) >> Frac)); }
+    friend constexpr Fixed operator-(Fixed a) { return from_raw(saturate(-int64_t{a.raw_})); }
+
+    friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw_ == b.raw_; }
+    friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw_ != b.raw_; }
+    friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw_ < b.raw_; }
+    friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw_ > b.raw_; }
+    friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw_ <= b.raw_; }
+    friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw_ >= b.raw_; }
+
+private:
+    static constexpr double one = static_cast<double>(int64_t{1} << Frac);
+
+    static constexpr raw_type saturate(int64_t v)
+    {
+        return v > std::numeric_limits<raw_type>::max()   ? std::numeric_limits<raw_type>::max()
+               : v < std::numeric_limits<raw_type>::min() ? std::numeric_limits<raw_type>::min()
+                                                          : static_cast<raw_type>(v);
+    }
+
+    raw_type raw_ = 0;
+};
+
+/* Range +-524288 with 0.00024 resolution: temperatures, PWM counts and the gains of reflow.h. */
+using q20_12 = Fixed<12>;
+
+////////////////////////////////////////////////////////////////////////////////
+// Discretisation
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Discrete PID coefficients.
+ */
+template <typename T>
+struct PidGains
+{
+    T kp;         // Proportional gain.
+    T ki_half_ts; // Trapezoidal integrator gain, Ki * Ts / 2.
+    T kd_diff;    // Derivative gain of the filtered differentiator, 2 Kd / (2 tau + Ts).
+    T d_pole;     // Filter pole of the differentiator, (2 tau - Ts) / (2 tau + Ts).
+    T out_min;    // Output minimum saturation limit.
+    T out_max;    // Output maximum saturation limit.
+    T b;          // Setpoint weight of the proportional term.
+    T c;          // Setpoint weight of the derivative term.
+    T kt;         // Back-calculation gain, Ts / Tt.
+};
+
+/**
+ * @brief Discretise continuous PID gains with the bilinear (Tustin) transform.
+ *
+ * @param Kp Proportional gain.
+ * @param Ki Integral gain (1/s).
+ * @param Kd Derivative gain (s).
+ * @param tau Derivative low-pass filter time constant (s).
+ * @param Ts Sample time (s).
+ * @param out_min Output minimum saturation limit.
+ * @param out_max Output maximum saturation limit.
+ * @param b Setpoint weight of the proportional term.
+ * @param c Setpoint weight of the derivative term, 0 for derivative on measurement.
+ * @param Tt Back-calculation tracking time constant (s), only used by BackCalculationAntiWindup.
+ */
+template <typename T>
+constexpr PidGains<T> discretise(double Kp, double Ki, double Kd, double tau, double Ts, double out_min, double out_max,
+                                 double b = 1.0, double c = 0.0, double Tt = 0.0)
+{
+    return PidGains<T>{T(Kp),
+                       T(0.5 * Ki * Ts),
+                       T(2.0 * Kd / (2.0 * tau + Ts)),
+                       T((2.0 * tau - Ts) / (2.0 * tau + Ts)),
+                       T(out_min),
+                       T(out_max),
+                       T(b),
+                       T(c),
+                       T(Tt > 0.0 ? Ts / Tt : 0.0)};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Policies
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Integrate unconditionally.
+ */
+struct NoAntiWindup
+{
+    static constexpr bool tracking = false;
+
+    template <typename T>
+    static constexpr bool hold(T, T, T, T) { return false; }
+};
+
+/**
+ * @brief Conditional integration: hold the integral while the output is saturated and the
+ * error would drive it further into saturation, as PID_Calculate() does.
+ */
+struct ClampAntiWindup
+{
+    static constexpr bool tracking = false;
+
+    template <typename T>
+    static constexpr bool hold(T out, T out_min, T out_max, T error)
+    {
+        return (out == out_max || out == out_min) && ((out <= T(0)) == (error <= T(0)));
+    }
+};
+
+/**
+ * @brief Back-calculation: integrate unconditionally and feed the saturation error back into the
+ * integral with gain Ts / Tt, as PID_Calculate() does when Tt > 0.
+ */
+struct BackCalculationAntiWindup
+{
+    static constexpr bool tracking = true;
+
+    template <typename T>
+    static constexpr bool hold(T, T, T, T) { return false; }
+};
+
+/**
+ * @brief No derivative term (PI controller). No state, no arithmetic.
+ */
+struct NoDerivative
+{
+    template <typename T>
+    struct State
+    {
+        constexpr T update(const PidGains<T> &, T, T) { return T(0); }
+        constexpr T value() const { return T(0); }
+        constexpr void reset() {}
+    };
+};
+
+/**
+ * @brief Derivative of c r - y through a first-order low-pass filter, with the same recurrence
+ * as PID_Calculate().
+ */
+struct FilteredDerivative
+{
+    template <typename T>
+    struct State
+    {
+        constexpr T update(const PidGains<T> &g, T setpoint, T measurement)
+        {
+            T weighted = measurement - g.c * setpoint;
+            d = -(g.kd_diff * (weighted - prev_weighted) + g.d_pole * d);
+            prev_weighted = weighted;
+            return d;
+        }
+        constexpr T value() const { return d; }
+        constexpr void reset() { d = prev_weighted = T(0); }
+
+        T d{};
+        T prev_weighted{}; // Previous measurement - c setpoint.
+    };
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// PID controller
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Discrete PID controller with output saturation.
+ *
+ * @tparam T Sample type.
+ * @tparam AntiWindup NoAntiWindup, ClampAntiWindup or BackCalculationAntiWindup.
+ * @tparam DerivFilter NoDerivative or FilteredDerivative.
+ *
+ * The derivative state is a private base, so NoDerivative adds no storage (empty base).
+ */
+template <typename T, typename AntiWindup = ClampAntiWindup, typename DerivFilter = FilteredDerivative>
+class Pid : private DerivFilter::template State<T>
+{
+    using Deriv = typename DerivFilter::template State<T>;
+
+public:
+    constexpr explicit Pid(const PidGains<T> &gains) : gains_(gains) {}
+
+    /**
+     * @brief Set gains and erase controller memory, like PID_Init().
+     */
+    constexpr void set_gains(const PidGains<T> &gains)
+    {
+        gains_ = gains;
+        reset();
+    }
+
+    constexpr const PidGains<T> &gains() const { return gains_; }
+
+    /**
+     * @brief Erase controller memory but keep gains, like PID_Reset().
+     */
+    constexpr void reset()
+    {
+        proportional_ = integral_ = prev_error_ = out_ = T(0);
+        Deriv::reset();
+    }
+
+    /**
+     * @brief Perform one controller iteration.
+     *
+     * @note Setpoint and measurement must have the same units.
+     * @return Saturated controller output.
+     */
+    constexpr T update(T setpoint, T measurement)
+    {
+        T error = setpoint - measurement;
+        proportional_ = gains_.kp * (gains_.b * setpoint - measurement);
+
+        if (!AntiWindup::hold(out_, gains_.out_min, gains_.out_max, error))
+        {
+            integral_ = integral_ + gains_.ki_half_ts * (error + prev_error_);
+        }
+
+        T out = proportional_ + integral_ + Deriv::update(gains_, setpoint, measurement);
+        out_ = out > gains_.out_max ? gains_.out_max : (out < gains_.out_min ? gains_.out_min : out);
+        if constexpr (AntiWindup::tracking)
+        {
+            integral_ = integral_ + gains_.kt * (out_ - out);
+        }
+        prev_error_ = error;
+        return out_;
+    }
+
+    /* Terms of the last iteration, for data logging */
+    constexpr T proportional() const { return proportional_; }
+    constexpr T integral() const { return integral_; }
+    constexpr T derivative() const { return Deriv::value(); }
+    constexpr T output() const { return out_; }
+
+private:
+    PidGains<T> gains_;
+    T proportional_{};
+    T integral_{};
+    T prev_error_{};
+    T out_{};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Filters
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief First-order low-pass filter coefficients, y[n] = b (x[n] + x[n-1]) + a y[n-1].
+ */
+template <typename T>
+struct FirstOrderCoeffs
+{
+    T b;
+    T a;
+};
+
+/**
+ * @brief Discretise 1 / (tau s + 1) with the bilinear transform.
+ *
+ * @param tau Time constant (s).
+ * @param Ts Sample time (s).
+ */
+template <typename T>
+constexpr FirstOrderCoeffs<T> first_order_lowpass(double tau, double Ts)
+{
+    return FirstOrderCoeffs<T>{T(Ts / (2.0 * tau + Ts)), T((2.0 * tau - Ts) / (2.0 * tau + Ts))};
+}
+
+/**
+ * @brief First-order IIR filter.
+ */
+template <typename T>
+class FirstOrder
+{
+public:
+    constexpr explicit FirstOrder(const FirstOrderCoeffs<T> &c) : c_(c) {}
+
+    constexpr T update(T x)
+    {
+        y_ = c_.b * (x + x_prev_) + c_.a * y_;
+        x_prev_ = x;
+        return y_;
+    }
+
+    /**
+     * @brief Start from steady state at value, e.g. the first measurement.
+     */
+    constexpr void reset(T value = T(0)) { x_prev_ = y_ = value; }
+
+    constexpr T value() const { return y_; }
+
+private:
+    FirstOrderCoeffs<T> c_;
+    T x_prev_{};
+    T y_{};
+};
+
+/**
+ * @brief Biquad coefficients, normalized so that a0 = 1.
+ */
+template <typename T>
+struct BiquadCoeffs
+{
+    T b0, b1, b2;
+    T a1, a2;
+};
+
+/**
+ * @brief Discretise the second-order low-pass w0^2 / (s^2 + (w0 / Q) s + w0^2) with the
+ * bilinear transform.
+ *
+ * The cutoff is not prewarped (tan() is not constexpr), which is accurate for cutoffs well
+ * below the Nyquist frequency, as for thermal loops.
+ *
+ * @param f0 Cutoff frequency (Hz).
+ * @param q Quality factor, 0.7071 for a Butterworth response.
+ * @param Ts Sample time (s).
+ */
+template <typename T>
+constexpr BiquadCoeffs<T> biquad_lowpass(double f0, double q, double Ts)
+{
+    const double w0 = 2.0 * 3.14159265358979323846 * f0;
+    const double c = 2.0 / Ts;
+    const double a0 = c * c + w0 * c / q + w0 * w0;
+    return BiquadCoeffs<T>{T(w0 * w0 / a0),
+                           T(2.0 * w0 * w0 / a0),
+                           T(w0 * w0 / a0),
+                           T((2.0 * w0 * w0 - 2.0 * c * c) / a0),
+                           T((c * c - w0 * c / q + w0 * w0) / a0)};
+}
+
+/**
+ * @brief Biquad IIR filter, transposed direct form II.
+ */
+template <typename T>
+class Biquad
+{
+public:
+    constexpr explicit Biquad(const BiquadCoeffs<T> &c) : c_(c) {}
+
+    constexpr T update(T x)
+    {
+        T y = c_.b0 * x + s1_;
+        s1_ = c_.b1 * x - c_.a1 * y + s2_;
+        s2_ = c_.b2 * x - c_.a2 * y;
+        return y;
+    }
+
+    constexpr void reset()
+    {
+        s1_ = s2_ = T(0);
+    }
+
+private:
+    BiquadCoeffs<T> c_;
+    T s1_{};
+    T s2_{};
+};
+
+} // namespace ctl
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file pid_cxx.h
+ * @author Timothy Nguyen
+ * @brief C interface to the C++ PID controller of pid.hpp.
+ * @version 0.1
+ * @date 2021-08-17
+ *
+ * Same configuration and calls as pid.h, so a module switches controller by changing
+ * PID_t to PIDX_t and the PID_ prefix to PIDX_. The controller is ctl::Pid<float> with
+ * conditional integration and the filtered derivative, so outputs match PID_Calculate() for any
+ * setpoint weights b and c; the tracking time constant Tt is ignored (back-calculation is
+ * ctl::BackCalculationAntiWindup). Gains are discretised once in PIDX_Init() instead of in every
+ * iteration.
+ */
+
+#ifndef _PID_CXX_H_
+#define _PID_CXX_H_
+
+#include <stdint.h>
+
+#include "pid.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Storage size of the C++ controller (32-bit words), checked in pid_cxx.cpp */
+#define PIDX_STATE_WORDS 16
+
+/* Opaque C++ PID controller */
+typedef struct
+{
+    uint32_t state[PIDX_STATE_WORDS];
+} PIDX_t;
+
+/**
+ * @brief Set/update PID controller parameters and erase controller memory.
+ *
+ * @param[in/out] pid PID instance to initialize.
+ * @param[in] pid_cfg PID configuration parameters.
+ */
+void PIDX_Init(PIDX_t *const pid, PID_cfg_t const *const pid_cfg);
+
+/**
+ * @brief Perform PID iteration.
+ *
+ * @note  Setpoint and measurement arguments must have the same units.
+ * @param pid PID instance.
+ * @param setpoint Setpoint value for current iteration.
+ * @param measurement Measured value for current iteration.
+ * @return float Output of PID calculation.
+ */
+float PIDX_Calculate(PIDX_t *const pid, float setpoint, float measurement);
+
+/**
+ * @brief Clear PID memory but retain controller parameters.
+ *
+ * @param pid PID instance.
+ */
+void PIDX_Reset(PIDX_t *const pid);
+
+/**
+ * @brief Get terms of the last iteration, for data logging.
+ *
+ * @param pid PID instance.
+ * @param[out] proportional Proportional term.
+ * @param[out] integral Integral term.
+ * @param[out] derivative Derivative term.
+ */
+void PIDX_Terms(PIDX_t const *const pid, float *proportional, float *integral, float *derivative);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file power.h
+ * @author Timothy Nguyen
+ * @brief Tickless idle on LPTIM1 and wake-up accounting.
+ * @version 0.1
+ * @date 2021-08-16
+ *
+ * When no thread is ready, the FreeRTOS idle task calls vPortSuppressTicksAndSleep() with the
+ * number of ticks until the next kernel deadline: the earliest thread timeout or software timer
+ * expiry (PID and Modbus timers, the 1 s time event timer while a time event is armed). The
+ * kernel (SysTick) and HAL (TIM7) ticks are stopped and the core sleeps until LPTIM1 reaches
+ * the deadline or an interrupt arrives. The tick count is then stepped by the time LPTIM1
+ * measured, so thread timing is unaffected.
+ *
+ * The core uses SLEEP, not STOP mode: the heater PWM (TIM3), console and Modbus UARTs must
+ * keep running. LPTIM1 counts PCLK1 / 128, the same clock as the kernel tick, so no drift is
+ * added; its 16-bit counter limits one sleep to about 100 ms at 80 MHz.
+ *
+ * Every wake-up is counted by reason. Enter "power status" for totals, averages and the
+ * counts of the last complete second, and "power tickless off" to compare with plain WFI
+ * idle, where the 1 kHz kernel and HAL ticks wake the core.
+ */
+
+#ifndef _POWER_H_
+#define _POWER_H_
+
+#include <stdint.h>
+
+#include "common.h"
+
+/* Reasons for waking from idle sleep */
+typedef enum
+{
+    POWER_WAKE_DEADLINE, // LPTIM1 reached the kernel deadline.
+    POWER_WAKE_LIMIT,    // LPTIM1 reached its maximum count before the deadline.
+    POWER_WAKE_TICK,     // Kernel or HAL tick (tickless idle off).
+    POWER_WAKE_CONSOLE,  // Console UART (USART2).
+    POWER_WAKE_MODBUS,   // Modbus UART (UART4).
+    POWER_WAKE_OTHER,    // Any other interrupt.
+
+    NUM_POWER_WAKES
+} power_wake_t;
+
+/**
+ * @brief Configure LPTIM1 for tickless idle.
+ *
+ * Call after SystemClock_Config(). Idle sleep starts with power_start().
+ *
+ * @return MOD_OK if successful, MOD_ERR_PERIPH if the clock tree does not give a whole number
+ *         of LPTIM1 counts per kernel tick.
+ */
+mod_err_t power_init(void);
+
+/**
+ * @brief Register power commands and let the idle task sleep.
+ *
+ * @return MOD_OK if successful, otherwise a "MOD_ERR" value.
+ */
+mod_err_t power_start(void);
+
+#endif
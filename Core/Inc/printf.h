@@ -58,7 +58,7 @@ void _putchar(char character);
  * \return The number of characters that are written into the array, not counting the terminating null character
  */
 #define printf printf_
-int printf_(const char* format, ...);
+int printf_(const char* format, ...) __attribute__((format(__printf__, 1, 2)));
 
 
 /**
@@ -69,7 +69,7 @@ int printf_(const char* format, ...);
  * \return The number of characters that are WRITTEN into the buffer, not counting the terminating null character
  */
 #define sprintf sprintf_
-int sprintf_(char* buffer, const char* format, ...);
+int sprintf_(char* buffer, const char* format, ...) __attribute__((format(__printf__, 2, 3)));
 
 
 /**
@@ -84,7 +84,7 @@ int sprintf_(char* buffer, const char* format, ...);
  */
 #define snprintf  snprintf_
 #define vsnprintf vsnprintf_
-int  snprintf_(char* buffer, size_t count, const char* format, ...);
+int  snprintf_(char* buffer, size_t count, const char* format, ...) __attribute__((format(__printf__, 3, 4)));
 int vsnprintf_(char* buffer, size_t count, const char* format, va_list va);
 
 
@@ -106,7 +106,7 @@ int vprintf_(const char* format, va_list va);
  * \param format A string that specifies the format of the output
  * \return The number of characters that are sent to the output function, not counting the terminating null character
  */
-int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...);
+int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...) __attribute__((format(__printf__, 3, 4)));
 
 
 #ifdef __cplusplus
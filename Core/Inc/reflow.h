@@ -16,33 +16,110 @@
 #include "MAX31855K.h"
 
 /* Configuration parameters */
-#define REFLOW_THREAD_STACK_SZ 1024 * 2
+#define REFLOW_THREAD_STACK_SZ (1024 * 2)
+#define REFLOW_EVENT_MSG_COUNT 5 // Maximum number of events in reflow event queue.
 
 #define KP_INIT 10.0f        // Kp gain.
 #define KI_INIT 0.0f         // Ki gain.
 #define KD_INIT 0.0f         // Kd gain.
 #define TAU_INIT 1.0f        // Low-pass filter time constant.
 #define TS_INIT 0.5f         // Sampling period (s).
+#define B_INIT 1.0f          // Setpoint weight of proportional term.
+#define C_INIT 0.0f          // Setpoint weight of derivative term.
+#define TT_INIT 0.0f         // Anti-windup tracking time constant (s), 0 for conditional integration.
 #define OUT_MAX_INIT 4095.0f // Maximum output saturation limit.
 #define OUT_MIN_INIT 0.0f    // Minimum output saturation limit.
 
-/* Reflow controller signals. */
+/* Inner (heater element) loop of cascade control, see "reflow cascade". */
+#define ELEMENT_KP_INIT 20.0f         // Kp gain.
+#define ELEMENT_KI_INIT 2.0f          // Ki gain.
+#define ELEMENT_KD_INIT 0.0f          // Kd gain.
+#define ELEMENT_TAU_INIT 0.2f         // Low-pass filter time constant.
+#define ELEMENT_TS_INIT 0.1f          // Sampling period (s), at most TS_INIT.
+#define ELEMENT_TEMP_MAX_INIT 450.0f  // Maximum element setpoint (deg C).
+
+/* Redundant oven thermocouples, see "reflow fusion". */
+#define FUSION_SENSORS_INIT 1       // Number of oven thermocouples voted on (1-3).
+#define FUSION_THRESHOLD_INIT 10.0f // Largest difference between agreeing oven readings (deg C).
+
+#define REFLOW_MODBUS_PERIOD_MS 500 // Refresh period of Modbus register shadow (ms).
+
+/* Reflow controller signals, declared in reflow_sm.def. */
 enum ReflowSignal
 {
-    START_REFLOW_SIG = USER_SIG, // Start reflow process.
-    REACH_TIME_SIG,              // Timeout event.
-    REACH_TEMP_SIG,              // Reached specific temperature.
-    STOP_REFLOW_SIG,             // Stop reflow process.
+    REFLOW_SIG_BASE = USER_SIG - 1, // First signal in reflow_sm.def is USER_SIG.
+#define REFLOW_SIGNAL(id) id##_SIG,
+#include "reflow_sm.def"
 
     NUM_REFLOW_SIGS
 };
 
+/**
+ * Modbus input registers (function code 0x04), refreshed every REFLOW_MODBUS_PERIOD_MS.
+ * Temperatures are in 0.1 deg C, 32-bit values are split into high and low word.
+ */
+enum ReflowInputReg
+{
+    REFLOW_IR_STATE,        // Reflow state, same order as "reflow status" (0 = RESET).
+    REFLOW_IR_SETPOINT,     // Setpoint temperature.
+    REFLOW_IR_TEMPERATURE,  // Oven temperature.
+    REFLOW_IR_OUTPUT,       // PWM output (0-4095).
+    REFLOW_IR_ALARMS,       // REFLOW_ALARM_* bits, cleared when a run starts.
+    REFLOW_IR_TC_ERROR,     // MAX31855K error code of last thermocouple read.
+    REFLOW_IR_PROFILE,      // Index of active reflow profile.
+    REFLOW_IR_SAMPLE_SEQ_H, // Sequence number of latest control sample.
+    REFLOW_IR_SAMPLE_SEQ_L,
+    REFLOW_IR_TICK_H, // Device tick of latest control sample (ms).
+    REFLOW_IR_TICK_L,
+    REFLOW_IR_TC_CONFIDENCE, // Confidence in oven temperature (tc_confidence_t, 0 = HIGH).
+
+    NUM_REFLOW_INPUT_REGS
+};
+
+/* Modbus holding registers (function codes 0x03, 0x06, 0x10). Gains, weights and Tt are scaled by 100. */
+enum ReflowHoldingReg
+{
+    REFLOW_HR_COMMAND, // Write REFLOW_CMD_* to start or stop a run, reads 0.
+    REFLOW_HR_PROFILE, // Index of active reflow profile, only writable in RESET state.
+    REFLOW_HR_KP,
+    REFLOW_HR_KI,
+    REFLOW_HR_KD,
+    REFLOW_HR_TAU,
+    REFLOW_HR_B,  // Setpoint weight of proportional term (0-100).
+    REFLOW_HR_C,  // Setpoint weight of derivative term (0-100).
+    REFLOW_HR_TT, // Anti-windup tracking time constant, 0 for conditional integration.
+
+    NUM_REFLOW_HOLDING_REGS
+};
+
+/* Values of REFLOW_HR_COMMAND register */
+#define REFLOW_CMD_START 1
+#define REFLOW_CMD_STOP 2
+
+/* Bits of REFLOW_IR_ALARMS register */
+#define REFLOW_ALARM_TC_FAULT (1 << 0) // Thermocouple could not be read.
+#define REFLOW_ALARM_ABORTED (1 << 1)  // Run was aborted by the controller.
+#define REFLOW_ALARM_TC_VOTE (1 << 2)  // An oven thermocouple failed or was outvoted, run continued.
+
+/* Thermocouples, MAX31855K device indices on the shared SPI bus */
+enum
+{
+    REFLOW_TC_OVEN,    // Oven air, the controlled temperature.
+    REFLOW_TC_ELEMENT, // Heater element, inner loop of cascade control.
+    REFLOW_TC_PROBE,   // Probe taped to a test board, board lag calibration.
+    REFLOW_TC_OVEN_B,  // Second oven thermocouple, voted on with REFLOW_TC_OVEN.
+    REFLOW_TC_OVEN_C,  // Third oven thermocouple.
+
+    NUM_REFLOW_TCS
+};
+_Static_assert(NUM_REFLOW_TCS <= MAX31855K_MAX_DEVICES, "Not enough MAX31855K device slots");
+
 /* Reflow oven controller configuration structure */
 typedef struct
 {
-    TIM_HandleTypeDef *pwm_timer_handle; // PWM Timer handle.
-    uint32_t pwm_channel;                // PWM Timer channel.
-    MAX31855K_cfg_t max_cfg;             // MAX31855K Thermocouple IC configuration structure.
+    TIM_HandleTypeDef *pwm_timer_handle;     // PWM Timer handle.
+    uint32_t pwm_channel;                    // PWM Timer channel.
+    MAX31855K_cfg_t max_cfg[NUM_REFLOW_TCS]; // MAX31855K Thermocouple IC configuration structures.
 } Reflow_cfg_t;
 
 /**
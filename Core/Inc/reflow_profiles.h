@@ -0,0 +1,70 @@
+/**
+ * @file reflow_profiles.h
+ * @author Timothy Nguyen
+ * @brief Compiled-in library of solder paste reflow profiles.
+ * @version 0.1
+ * @date 2021-08-02
+ *
+ * Profiles are declared in reflow_profiles.def and stored in flash.
+ * Selecting a profile only swaps a pointer.
+ */
+
+#ifndef _REFLOW_PROFILES_H_
+#define _REFLOW_PROFILES_H_
+
+#include <stdint.h>
+
+/* Number of phases in a reflow profile (pre-heat, soak, ramp-up, peak, cool-down). */
+#define NUM_PROFILE_PHASES 5
+
+/* Maximum peak temperature allowed by J-STD-020 (deg C). */
+#define REFLOW_PROFILE_MAX_PEAK_TEMP 260
+
+/* Maximum soak ramp rate allowed by J-STD-020 (deg C/s). */
+#define REFLOW_PROFILE_MAX_RAMP_RATE 3
+
+/* Reflow profile phase characteristic. */
+typedef struct
+{
+    enum
+    {
+        REACHTEMP,      // Attain a specific temperature with maximum gradient.
+        REACHTIME,      // Run profile element for specified time.
+    } const phase_type; // REACHTEMP or REACHTIME
+
+    uint32_t reach_temp;
+    uint32_t reach_time;
+} Reflow_Phase;
+
+/* Reflow profile. */
+typedef struct
+{
+    const char *name;                        // Profile name.
+    Reflow_Phase phases[NUM_PROFILE_PHASES]; // Reflow phase characteristics.
+    uint32_t board_tau;                      // Board thermal lag behind oven air (s).
+} Reflow_Profile;
+
+/* Profile identifiers, one per entry in reflow_profiles.def. */
+typedef enum
+{
+#define REFLOW_PROFILE(id, name, preheat_temp, soak_temp, soak_time, peak_temp, peak_time, cooldown_temp, board_tau) \
+    REFLOW_PROFILE_##id,
+#include "reflow_profiles.def"
+#undef REFLOW_PROFILE
+
+    NUM_REFLOW_PROFILES
+} Reflow_Profile_Id;
+
+/* Flash-resident profile table. */
+extern const Reflow_Profile reflow_profiles[NUM_REFLOW_PROFILES];
+
+/**
+ * @brief Find profile by name.
+ *
+ * @param name Profile name (case-insensitive).
+ *
+ * @return Pointer to profile in flash, NULL if not found.
+ */
+const Reflow_Profile *reflow_profile_find(const char *name);
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file stream.h
+ * @author Timothy Nguyen
+ * @brief Binary setpoint streaming between a host and the reflow oven controller.
+ * @version 0.1
+ * @date 2021-08-04
+ *
+ * While streaming, the console hands every received byte to this module instead of the
+ * command line editor. Frames are little-endian and protected by a CRC-8 (poly 0x07):
+ *
+ * Setpoint frame (host -> device, STREAM_SETPOINT_FRAME):
+ * | 0xA5 | 0x5A | type | seq (u16) | flags (u8) | setpoint (f32) | feedforward (f32) | crc8 |
+ *
+ * Replay frame (host -> device, STREAM_REPLAY_FRAME):
+ * | 0xA5 | 0x5A | type | seq (u16) | flags (u8) | temperature (f32) | reserved (f32) | crc8 |
+ *
+ * Sample frame (device -> host, STREAM_SAMPLE_FRAME):
+ * | 0xA5 | 0x5A | type | seq (u16) | state (u8) | sample seq (u32) | tick (u32) | setpoint (f32) | temperature (f32) | output (f32) | crc8 |
+ *
+ * The CRC covers every byte between the sync bytes and the CRC itself.
+ */
+
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include <stdint.h>
+
+#include "common.h"
+
+/* Configuration parameters */
+#define STREAM_WATCHDOG_MS 1000 // Fall back to a safe state if no frame is received within this time.
+
+/* Frame sync bytes */
+#define STREAM_SYNC_0 0xA5
+#define STREAM_SYNC_1 0x5A
+
+/* Frame types */
+enum stream_frame_type
+{
+    STREAM_SETPOINT_FRAME = 0x01, // Host -> device setpoint.
+    STREAM_REPLAY_FRAME = 0x02,   // Host -> device recorded temperature sample.
+    STREAM_SAMPLE_FRAME = 0x81,   // Device -> host control sample.
+};
+
+/* Setpoint frame flags */
+#define STREAM_FLAG_FEEDFORWARD 0x01 // Feedforward duty is valid.
+#define STREAM_FLAG_STOP 0x02        // Leave streaming mode.
+#define STREAM_FLAG_FAULT 0x04       // Recorded sample was a thermocouple read error (replay frames).
+
+/* Setpoint received from host. */
+typedef struct
+{
+    uint16_t seq;      // Host sequence number.
+    uint8_t flags;     // STREAM_FLAG_* bits.
+    float setpoint;    // Setpoint temperature (deg C).
+    float feedforward; // Feedforward duty added to PID output (PWM counts).
+} stream_setpoint_t;
+
+/* Recorded temperature sample received from host. */
+typedef struct
+{
+    uint16_t seq;      // Host sequence number.
+    uint8_t flags;     // STREAM_FLAG_* bits.
+    float temperature; // Recorded temperature (deg C).
+} stream_replay_t;
+
+/* Control sample reported to host. */
+typedef struct
+{
+    uint16_t seq;        // Sequence number of the host frame being answered.
+    uint8_t state;       // Reflow state.
+    uint32_t sample_seq; // Sequence number of the control sample, increments every sampling period.
+    uint32_t tick;       // Device tick (ms) of the control sample.
+    float setpoint;      // Setpoint temperature (deg C).
+    float temperature;   // Measured temperature (deg C).
+    float output;        // Controller output (PWM counts).
+} stream_sample_t;
+
+/* Callback invoked from the console thread for every valid setpoint frame. */
+typedef void (*stream_setpoint_cb_t)(const stream_setpoint_t *sp);
+
+/* Callback invoked from the console thread for every valid replay frame. */
+typedef void (*stream_replay_cb_t)(const stream_replay_t *rp);
+
+/**
+ * @brief Initialize stream module.
+ *
+ * @return MOD_OK if successful, otherwise a "MOD_ERR" value.
+ */
+mod_err_t stream_init(void);
+
+/**
+ * @brief Switch console input to binary frame decoding.
+ *
+ * @param setpoint_cb Callback invoked for every valid setpoint frame, NULL to reject setpoint frames.
+ * @param replay_cb Callback invoked for every valid replay frame, NULL to reject replay frames.
+ *
+ * @return MOD_OK if successful, MOD_ERR_ARG if both callbacks are NULL.
+ */
+mod_err_t stream_open(stream_setpoint_cb_t setpoint_cb, stream_replay_cb_t replay_cb);
+
+/**
+ * @brief Return console input to the command line editor.
+ */
+void stream_close(void);
+
+/**
+ * @brief Transmit control sample to host (non-blocking).
+ *
+ * @param sample Control sample.
+ *
+ * @return MOD_OK if successful, MOD_ERR_BUF_OVERRUN if UART transmit buffer is full.
+ */
+mod_err_t stream_send_sample(const stream_sample_t *sample);
+
+#endif
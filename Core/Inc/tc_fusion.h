@@ -0,0 +1,68 @@
+/**
+ * @file tc_fusion.h
+ * @author Timothy Nguyen
+ * @brief Plausibility voting over redundant thermocouples
+ * @version 0.1
+ * @date 2021-08-19
+ *
+ *      Two or three thermocouples measure the same oven temperature. Readings that the
+ *      MAX31855K reports as faulty are dropped, the rest are cross-checked:
+ *
+ *      3 readings: readings further than the threshold from the median are outvoted, the others
+ *                  are averaged.
+ *      2 readings: averaged if they agree. Otherwise there is no majority and the higher reading
+ *                  is used, so that the heater errs towards doing less.
+ *      1 reading:  used as is.
+ *
+ *      The confidence flag tells how much of the redundancy is left.
+ */
+
+#ifndef _TC_FUSION_H_
+#define _TC_FUSION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Maximum number of redundant thermocouples. */
+#define TC_FUSION_MAX_SENSORS 3
+
+/* Confidence in validated temperature, from best to worst. */
+typedef enum
+{
+    TC_CONF_HIGH,     // All sensors read and agree.
+    TC_CONF_DEGRADED, // A sensor failed or was outvoted, at least two remaining sensors agree.
+    TC_CONF_LOW,      // One sensor left, or two that disagree.
+    TC_CONF_NONE,     // No sensor could be read.
+
+    NUM_TC_CONFS
+} tc_confidence_t;
+
+/* Names of confidence values, same order as tc_confidence_t. */
+#define TC_CONF_NAMES_CSV "HIGH", "DEGRADED", "LOW", "NONE"
+
+/* Result of a vote */
+typedef struct
+{
+    float temp;                 // Validated temperature, unchanged if confidence is TC_CONF_NONE.
+    tc_confidence_t confidence; // Confidence in temp.
+    uint8_t used;               // Bit i set if sensor i contributed to temp.
+    uint8_t outvoted;           // Bit i set if sensor i was read but disagreed with the vote.
+} tc_fusion_t;
+
+/**
+ * @brief Vote on one set of readings.
+ *
+ * With a single sensor configured, a valid reading has TC_CONF_HIGH: there is nothing to
+ * cross-check it against.
+ *
+ * @param temps Temperature of each sensor.
+ * @param valid True for each sensor read without fault.
+ * @param num Number of sensors (1 to TC_FUSION_MAX_SENSORS).
+ * @param threshold Largest difference between agreeing readings.
+ * @param[out] result Validated temperature, confidence and sensors used.
+ * @return tc_confidence_t Confidence in validated temperature.
+ */
+tc_confidence_t TC_Fusion_Vote(const float *temps, const bool *valid, uint8_t num, float threshold,
+                               tc_fusion_t *const result);
+
+#endif
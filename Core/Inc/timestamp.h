@@ -0,0 +1,88 @@
+/**
+ * @file timestamp.h
+ * @author Timothy Nguyen
+ * @brief Monotonic 64-bit microsecond clock.
+ * @version 0.1
+ * @date 2021-08-14
+ *
+ * Counts CPU cycles with the DWT cycle counter (CYCCNT). The 32-bit counter wraps every
+ * 2^32 / SystemCoreClock seconds (53.7 s at 80 MHz), so every read extends it to 64 bits by
+ * tracking overflows. timestamp_refresh() must be called at least once per wrap period; the
+ * HAL timebase interrupt does so once per second.
+ *
+ * Unlike HAL_GetTick(), which advances in the 1 kHz timebase interrupt, timestamps have
+ * sub-microsecond resolution and do not depend on interrupt latency.
+ *
+ * The counter is started by the reset handler, so timestamps count from the reset vector.
+ * The core runs from the 4 MHz MSI until SystemClock_Config() switches to the PLL;
+ * timestamp_clock_update() keeps microseconds continuous across the switch.
+ *
+ * The counter stops while the core sleeps; the idle sleep code adds the time asleep with
+ * timestamp_add_cycles() (see power.h).
+ */
+
+#ifndef _TIMESTAMP_H_
+#define _TIMESTAMP_H_
+
+#include <stdint.h>
+
+#include "common.h"
+
+/**
+ * @brief Start DWT cycle counter from zero.
+ *
+ * Called by Reset_Handler before SystemInit(), so it must not use RAM variables.
+ */
+void timestamp_start(void);
+
+/**
+ * @brief Initialize clock state from SystemCoreClock.
+ *
+ * Call once at the start of main(), before the first timestamp is taken. Starts the
+ * cycle counter if the reset handler did not.
+ *
+ * @return MOD_OK if successful, MOD_ERR_PERIPH if the core has no cycle counter.
+ */
+mod_err_t timestamp_init(void);
+
+/**
+ * @brief Continue microsecond count at the new SystemCoreClock after a clock change.
+ */
+void timestamp_clock_update(void);
+
+/**
+ * @brief Get number of CPU cycles since reset.
+ *
+ * Safe to call from threads and interrupts.
+ */
+uint64_t timestamp_cycles(void);
+
+/**
+ * @brief Get microseconds since reset.
+ */
+uint64_t timestamp_us(void);
+
+/**
+ * @brief Get milliseconds since reset, wrapping like HAL_GetTick().
+ */
+uint32_t timestamp_ms(void);
+
+/**
+ * @brief Convert a difference of two cycle counts to microseconds.
+ */
+uint32_t timestamp_cycles_to_us(uint64_t cycles);
+
+/**
+ * @brief Add cycles the cycle counter missed while the core clock was gated.
+ *
+ * Advances timestamp_us() and timestamp_ms(); timestamp_cycles() keeps counting executed
+ * cycles only. Call with interrupts disabled.
+ */
+void timestamp_add_cycles(uint32_t cycles);
+
+/**
+ * @brief Keep track of cycle counter overflows while no timestamps are taken.
+ */
+void timestamp_refresh(void);
+
+#endif
@@ -8,17 +8,24 @@
  * Notes:
  * - A UART peripheral must be initialized prior to using this module.
  * - Do not enable UART interrupts within CubeMX.
+ * - Threads share the transmit buffer. Hold uart_tx_lock() around a whole message (log line,
+ *   binary frame) so that messages of different threads are never interleaved.
  */
 
 #ifndef _UART_H_
 #define _UART_H_
 
+#include <stdbool.h>
+
 #include "common.h"
 #include "stm32l4xx_ll_usart.h"
 
 /* Configuration parameters */
 #define UART_TX_BUF_SIZE 1024 // Maximum number of bytes in UART's transmit circular buffer.
 
+/* Interrupt service routine of a UART instance. */
+typedef void (*uart_isr_t)(void);
+
 /* Configuration structure */
 typedef struct
 {
@@ -36,12 +43,21 @@ typedef struct
 mod_err_t uart_init(uart_config_t *uart_cfg);
 
 /**
- * @brief Start reception and transmision of characters over UART by enabling interrupts.
+ * @brief Start transmision of characters over UART by enabling interrupts.
  * 
  * @return MOD_OK for success, else a "MOD_ERR" value.
  */
 mod_err_t uart_start(void);
 
+/**
+ * @brief Start reception of characters over UART by enabling the RXNE interrupt.
+ *
+ * @return MOD_OK for success, else a "MOD_ERR" value.
+ *
+ * @note Received characters are posted to the console, call after its queue is created.
+ */
+mod_err_t uart_start_rx(void);
+
 /** 
  * @brief Put a character for transmission in transmit buffer (non-blocking).
  *
@@ -53,4 +69,48 @@ mod_err_t uart_start(void);
  */
 mod_err_t uart_putc(char c);
 
+/**
+ * @brief Put a block of bytes in transmit buffer, either all of them or none (non-blocking).
+ *
+ * Unlike printf(), null bytes are transmitted, so binary frames are sent with this function.
+ *
+ * @param data Bytes to transmit.
+ * @param len Number of bytes.
+ *
+ * @return MOD_OK for success, MOD_ERR_BUF_OVERRUN if the block does not fit in the transmit buffer.
+ *
+ * @note Call with uart_tx_lock() held if other threads may transmit.
+ */
+mod_err_t uart_write(const void *data, uint16_t len);
+
+/**
+ * @brief Take exclusive use of the transmit buffer.
+ *
+ * The lock is recursive. It is not taken before the scheduler starts or in interrupts, and only
+ * if free while the scheduler is suspended, since these callers can not wait.
+ *
+ * @return true if the lock was taken and must be released with uart_tx_unlock().
+ */
+bool uart_tx_lock(void);
+
+/**
+ * @brief Release transmit buffer taken by uart_tx_lock().
+ *
+ * @param locked Return value of matching uart_tx_lock().
+ */
+void uart_tx_unlock(bool locked);
+
+/**
+ * @brief Route interrupts of a UART instance to a service routine.
+ *
+ * The console UART is registered by uart_init(). Other modules driving their own
+ * UART instance (e.g. Modbus) register their ISR here.
+ *
+ * @param irq_num Interrupt request number (IRQn) of UARTn peripheral.
+ * @param isr Interrupt service routine, NULL to ignore interrupts of this instance.
+ *
+ * @return MOD_OK for success, MOD_ERR_ARG if irq_num is not a UART interrupt.
+ */
+mod_err_t uart_register_isr(IRQn_Type irq_num, uart_isr_t isr);
+
 #endif
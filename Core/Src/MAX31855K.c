@@ -18,15 +18,25 @@
  * D0       OC  fault: Reads 1 when thermocouple is open-circuit, else 0
  */
 
+#include <stdbool.h>
+
 #include "MAX31855K.h"
 #include "string.h"
 #include "log.h"
+#include "cmd.h"
+#include "cmsis_os.h"
 
 // Temperature resolutions:
 #define HJ_RES 0.25   // Hot junction temperature resolution in degrees Celsius.
 #define CJ_RES 0.0625 // Cold junction temperature resolution in degrees Celsius.
 
-#define MAX_ERR_NAMES_CSV "MAX_OK", "MAX_SHORT_VCC", "MAX_SHORT_GND", "MAX_OPEN", "MAX_ZEROS", "MAX_SPI_DMA_FAIL"
+// Fault bits:
+#define FAULT_BIT ((uint32_t)1 << 16) // D16, set when any of D0-D2 is set.
+#define SCV_BIT 0x4                   // D2, short to VCC.
+#define SCG_BIT 0x2                   // D1, short to GND.
+#define OC_BIT 0x1                    // D0, open circuit.
+
+#define MAX_ERR_NAMES_CSV "MAX_OK", "MAX_SHORT_VCC", "MAX_SHORT_GND", "MAX_OPEN", "MAX_ZEROS", "MAX_SPI_DMA_FAIL", "MAX_FAULT"
 
 // MAX31885K thermocouple device structure definition.
 typedef struct
@@ -47,66 +57,163 @@ typedef struct
 } MAX31855K_t;
 
 /* Static function prototypes */
-static void MAX31855K_error_check(); // Check data for device faults or SPI read error.
+static void MAX31855K_error_check(MAX31855K_t *const max); // Check data for device faults or SPI read error.
+static float MAX31855K_decode_HJ(uint32_t data);           // Parse HJ temperature from raw reading.
+static float MAX31855K_decode_CJ(uint32_t data);           // Parse CJ temperature from raw reading.
+static uint32_t max_status_cmd(uint32_t argc, const char **argv); // Display most recent reading.
+
+/* MAX31855K_t instances, one per chip-select line on the shared SPI bus. */
+static MAX31855K_t max_devs[MAX31855K_MAX_DEVICES];
 
-/* MAX31855K_t instance. */
-static MAX31855K_t max;
+/* Number of initialized instances (highest device index + 1). */
+static uint8_t num_devs;
+
+/* Shared SPI bus, held during each transaction and by MAX31855K_Bus_Lock() callers. */
+static osMutexId_t bus_mutex;
+static StaticSemaphore_t bus_mutex_cb;
 
 static const char *max_err_names[MAX_NUM_ERRORS] = {MAX_ERR_NAMES_CSV};
 
-void MAX31855K_Init(MAX31855K_cfg_t const *const max_cfg)
+/* Information about thermocouple commands. */
+static const cmd_cmd_info max_cmd_infos[] = {
+    {.cmd_name = "status",
+     .cb = &max_status_cmd,
+     .help = "Display most recent reading of each thermocouple."},
+};
+
+/* Client information for command module */
+static cmd_client_info max_client_info = {.client_name = "max",
+                                          .num_cmds = ARRAY_SIZE(max_cmd_infos),
+                                          .cmds = max_cmd_infos,
+                                          .num_u16_pms = 0,
+                                          .u16_pms = NULL,
+                                          .u16_pm_names = NULL};
+
+void MAX31855K_Init(uint8_t dev, MAX31855K_cfg_t const *const max_cfg)
 {
-    max.spi_handle = max_cfg->hspi;
-    max.cs_port = max_cfg->max_cs_port;
-    max.cs_pin = max_cfg->max_cs_pin;
-    memset(max.tx_buf, 0, sizeof(max.tx_buf));
-    memset(max.rx_buf, 0, sizeof(max.rx_buf));
-    max.data32 = 0;
-    max.err = MAX_OK;
+    ASSERT(dev < MAX31855K_MAX_DEVICES);
+    MAX31855K_t *max = &max_devs[dev];
+
+    max->spi_handle = max_cfg->hspi;
+    max->cs_port = max_cfg->max_cs_port;
+    max->cs_pin = max_cfg->max_cs_pin;
+    memset(max->tx_buf, 0, sizeof(max->tx_buf));
+    memset(max->rx_buf, 0, sizeof(max->rx_buf));
+    max->data32 = 0;
+    max->err = MAX_OK;
+
+    /* Deassert CS so that the device releases MISO while others on the bus are read. */
+    HAL_GPIO_WritePin(max->cs_port, max->cs_pin, GPIO_PIN_SET);
+    if (num_devs == 0)
+    {
+        static const osMutexAttr_t mutex_attr = {.name = "max_spi",
+                                                 .attr_bits = osMutexRecursive | osMutexPrioInherit,
+                                                 .cb_mem = &bus_mutex_cb,
+                                                 .cb_size = sizeof(bus_mutex_cb)};
+        bus_mutex = osMutexNew(&mutex_attr);
+        ASSERT(bus_mutex != NULL);
+        cmd_register(&max_client_info);
+    }
+    if (dev >= num_devs)
+    {
+        num_devs = dev + 1;
+    }
 }
 
-MAX31855K_err_t MAX31855K_RxBlocking()
+MAX31855K_err_t MAX31855K_RxBlocking(uint8_t dev)
 {
+    ASSERT(dev < num_devs);
+    MAX31855K_t *max = &max_devs[dev];
+    bool locked = MAX31855K_Bus_Lock();
+
     /* Acquire data from MAX31855K */
-    HAL_GPIO_WritePin(max.cs_port, max.cs_pin, GPIO_PIN_RESET); // Assert CS line to start transaction.
-    HAL_SPI_Receive(max.spi_handle,                             // Sample 4 bytes off MISO line.
-                    max.rx_buf,
-                    sizeof(max.rx_buf),
+    HAL_GPIO_WritePin(max->cs_port, max->cs_pin, GPIO_PIN_RESET); // Assert CS line to start transaction.
+    HAL_SPI_Receive(max->spi_handle,                              // Sample 4 bytes off MISO line.
+                    max->rx_buf,
+                    sizeof(max->rx_buf),
                     HAL_MAX_DELAY);
-    HAL_GPIO_WritePin(max.cs_port, max.cs_pin, GPIO_PIN_SET); // Deassert CS line to end transaction.
-    max.data32 = max.rx_buf[0] << 24 | (max.rx_buf[1] << 16) | (max.rx_buf[2] << 8) | max.rx_buf[3];
+    HAL_GPIO_WritePin(max->cs_port, max->cs_pin, GPIO_PIN_SET); // Deassert CS line to end transaction.
+    max->data32 = max->rx_buf[0] << 24 | (max->rx_buf[1] << 16) | (max->rx_buf[2] << 8) | max->rx_buf[3];
 
     /* Check for faults. */
-    MAX31855K_error_check();
+    MAX31855K_error_check(max);
+    MAX31855K_err_t err = max->err;
 
-    return max.err;
+    MAX31855K_Bus_Unlock(locked);
+    return err;
 }
 
-void MAX31855K_RxDMA()
+void MAX31855K_RxDMA(uint8_t dev)
 {
+    ASSERT(dev < num_devs);
+    MAX31855K_t *max = &max_devs[dev];
+
     /* Pull CS line low */
-    HAL_GPIO_WritePin(max.cs_port, max.cs_pin, GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(max->cs_port, max->cs_pin, GPIO_PIN_RESET);
 
     /* Execute DMA transfer */
-    HAL_StatusTypeDef err = HAL_SPI_TransmitReceive_DMA(max.spi_handle, max.tx_buf, max.rx_buf, sizeof(max.rx_buf));
+    HAL_StatusTypeDef err = HAL_SPI_TransmitReceive_DMA(max->spi_handle, max->tx_buf, max->rx_buf, sizeof(max->rx_buf));
     if (err != HAL_OK)
     {
-        HAL_GPIO_WritePin(max.cs_port, max.cs_pin, GPIO_PIN_SET);
-        max.err = MAX_SPI_DMA_FAIL;
+        HAL_GPIO_WritePin(max->cs_port, max->cs_pin, GPIO_PIN_SET);
+        max->err = MAX_SPI_DMA_FAIL;
+    }
+}
+
+void MAX31885K_RxDMA_Complete(uint8_t dev)
+{
+    ASSERT(dev < num_devs);
+    MAX31855K_t *max = &max_devs[dev];
+
+    HAL_GPIO_WritePin(max->cs_port, max->cs_pin, GPIO_PIN_SET);
+    max->data32 = max->rx_buf[0] << 24 | (max->rx_buf[1] << 16) | (max->rx_buf[2] << 8) | max->rx_buf[3];
+    MAX31855K_error_check(max);
+}
+
+float MAX31855K_Get_HJ(uint8_t dev)
+{
+    ASSERT(dev < num_devs);
+    return MAX31855K_decode_HJ(max_devs[dev].data32);
+}
+
+float MAX31855K_Get_CJ(uint8_t dev)
+{
+    ASSERT(dev < num_devs);
+    return MAX31855K_decode_CJ(max_devs[dev].data32);
+}
+
+const char *MAX31855K_Err_Str(uint8_t dev)
+{
+    ASSERT(dev < num_devs && max_devs[dev].err < MAX_NUM_ERRORS);
+    return max_err_names[max_devs[dev].err];
+}
+
+const char *MAX31855K_Err_Name(MAX31855K_err_t err)
+{
+    ASSERT(err < MAX_NUM_ERRORS);
+    return max_err_names[err];
+}
+
+bool MAX31855K_Bus_Lock(void)
+{
+    if (bus_mutex == NULL || osKernelGetState() != osKernelRunning)
+    {
+        return false;
     }
+    return osMutexAcquire(bus_mutex, osWaitForever) == osOK;
 }
 
-void MAX31885K_RxDMA_Complete()
+void MAX31855K_Bus_Unlock(bool locked)
 {
-    HAL_GPIO_WritePin(max.cs_port, max.cs_pin, GPIO_PIN_SET);
-    max.data32 = max.rx_buf[0] << 24 | (max.rx_buf[1] << 16) | (max.rx_buf[2] << 8) | max.rx_buf[3];
-    MAX31855K_error_check();
+    if (locked)
+    {
+        osMutexRelease(bus_mutex);
+    }
 }
 
-float MAX31855K_Get_HJ()
+static float MAX31855K_decode_HJ(uint32_t data)
 {
     /* Extract HJ temperature. */
-    uint32_t data = max.data32;     // Capture latest data reading.
     int16_t val = 0;                // Value prior to temperature conversion.
     if (data & ((uint32_t)1 << 31)) // Perform sign-extension.
     {
@@ -119,10 +226,9 @@ float MAX31855K_Get_HJ()
     return val * HJ_RES;
 }
 
-float MAX31855K_Get_CJ()
+static float MAX31855K_decode_CJ(uint32_t data)
 {
     /* Extract CJ temperature. */
-    uint32_t data = max.data32;     // Capture latest data reading.
     int16_t val = 0;                // Value prior to temperature conversion.
     if (data & ((uint32_t)1 << 15)) // Perform sign-extension.
     {
@@ -135,39 +241,53 @@ float MAX31855K_Get_CJ()
     return val * CJ_RES;
 }
 
-const char *MAX31855K_Err_Str()
-{
-    ASSERT(max.err < MAX_NUM_ERRORS);
-    return max_err_names[max.err];
-}
-
-static void MAX31855K_error_check()
+static void MAX31855K_error_check(MAX31855K_t *const max)
 {
-    if (max.data32 == 0)
+    if (max->data32 == 0)
     {
-        max.err = MAX_ZEROS;
+        max->err = MAX_ZEROS;
     }
-    else if (max.data32 & ((uint32_t)1 << 16))
+    else if (max->data32 & FAULT_BIT)
     {
-        uint8_t fault = max.data32 & 0x7;
+        uint8_t fault = max->data32 & (SCV_BIT | SCG_BIT | OC_BIT);
         switch (fault)
         {
-        case 0x4:
-            max.err = MAX_SHORT_VCC;
+        case SCV_BIT:
+            max->err = MAX_SHORT_VCC;
             break;
-        case 0x2:
-            max.err = MAX_SHORT_GND;
+        case SCG_BIT:
+            max->err = MAX_SHORT_GND;
             break;
-        case 0x1:
-            max.err = MAX_OPEN;
+        case OC_BIT:
+            max->err = MAX_OPEN;
             break;
         default:
-            ASSERT(0); // Should never reach this point.
+            max->err = MAX_FAULT; // Corrupted reading or several faults at once.
             break;
         }
     }
     else
     {
-        max.err = MAX_OK;
+        max->err = MAX_OK;
+    }
+}
+
+static uint32_t max_status_cmd(uint32_t argc, const char **argv)
+{
+    for (uint8_t dev = 0; dev < num_devs; dev++)
+    {
+        if (max_devs[dev].spi_handle == NULL)
+        {
+            continue; // Index not in use.
+        }
+
+        /* Copy reading, so the bus is not held while printing. */
+        bool locked = MAX31855K_Bus_Lock();
+        MAX31855K_t max = max_devs[dev];
+        MAX31855K_Bus_Unlock(locked);
+        LOG("%u: Raw data: 0x%08" PRIx32 "\tHJ: %.2f\tCJ: %.4f\tError: %s\r\n",
+            dev, max.data32, MAX31855K_decode_HJ(max.data32), MAX31855K_decode_CJ(max.data32),
+            MAX31855K_Err_Name(max.err));
     }
+    return 0;
 }
@@ -10,6 +10,7 @@
 
 #include "active.h"
 #include "log.h"
+#include "timestamp.h"
 #include "cmsis_os.h"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -18,7 +19,13 @@
 
 static void Active_event_loop(void *argument); // Common event loop thread function.
 
-static void TimeEvent_tick(void *argument); // Simulate a timer tick.
+static void TimeEvent_tick(TimerHandle_t timer); // Simulate a timer tick.
+
+static void TimeEvent_count_down(void); // Count down armed time events by 1 s.
+
+static mod_err_t TimeEvent_timer_update(void); // Run 1 s timer only while a time event is armed.
+
+static void TimeEvent_timer_check(mod_err_t err); // Report a timer command that could not be queued.
 
 ////////////////////////////////////////////////////////////////////////////////
 // Private (static) variables
@@ -36,8 +43,20 @@ static uint8_t num_time_events;
 /* Software timer instance */
 osTimerId_t ms_timer_inst;
 
-/* Condition so that 1 ms timer is started once */
-static bool first_arm = false;
+/* Software timer control block */
+static StaticTimer_t ms_timer_cb;
+
+/* 1 s timer is running (or its start command is queued) */
+static bool timer_running = false;
+
+/* Timer commands that could not be queued */
+static uint16_t timer_cmd_errors;
+
+/* Time events count down on virtual clock instead of 1 s timer */
+static bool virtual_clock = false;
+
+/* Virtual time elapsed since last count down (ms) */
+static uint32_t virtual_ms;
 
 ////////////////////////////////////////////////////////////////////////////////
 // Public (global) functions
@@ -59,8 +78,9 @@ mod_err_t Active_start(Active *const ao,
                        uint32_t msg_count,
                        const osMessageQueueAttr_t *const queue_attr)
 {
-    ao->thread_id = osThreadNew(Active_event_loop, (void *)ao, thread_attr);
+    /* Queue first, the thread may run before osThreadNew() returns. */
     ao->queue_id = osMessageQueueNew(msg_count, sizeof(Event *), queue_attr);
+    ao->thread_id = osThreadNew(Active_event_loop, (void *)ao, thread_attr);
 
     ASSERT(ao->thread_id != NULL && ao->queue_id != NULL);
 
@@ -79,6 +99,17 @@ mod_err_t Active_post(Active *const ao, Event const *const evt)
     return MOD_OK;
 }
 
+osTimerId_t Active_timer_new(const char *name, TimerCallbackFunction_t cb, StaticTimer_t *cb_mem)
+{
+    if (cb == NULL || cb_mem == NULL)
+    {
+        return NULL;
+    }
+
+    /* Period is set when the timer is started. */
+    return (osTimerId_t)xTimerCreateStatic(name, 1, pdTRUE, NULL, cb, cb_mem);
+}
+
 void TimeEvent_ctor(TimeEvent *const time_evt, Signal sig, Active *ao)
 {
     /* No critical section because it is presumed that all Time_Events
@@ -95,22 +126,21 @@ void TimeEvent_ctor(TimeEvent *const time_evt, Signal sig, Active *ao)
 
 void TimeEvent_arm(TimeEvent *const time_evt, uint32_t timeout, uint32_t reload)
 {
-    LOGI(TAG, "Arming time event for %lu seconds (%s)", timeout, reload == 0 ? "One-shot" : "Periodic");
-    osKernelLock(); // Data shared between threads and timer ISR
-    time_evt->timeout = timeout;
-    time_evt->reload = reload;
-    osKernelUnlock();
+    LOGI(TAG, "Arming time event for %" PRIu32 " seconds (%s)", timeout, reload == 0 ? "One-shot" : "Periodic");
 
-    /* Start 1 s timer if first arming of timer. */
-    if (first_arm == false)
+    /* Create 1 s timer on first arming of a time event. */
+    if (ms_timer_inst == NULL)
     {
-        ms_timer_inst = osTimerNew(TimeEvent_tick, osTimerPeriodic, NULL, NULL);
+        ms_timer_inst = Active_timer_new("time_evt", TimeEvent_tick, &ms_timer_cb);
         ASSERT(ms_timer_inst != NULL);
-        LOGI(TAG, "Starting 1 s periodic timer.");
-        osStatus_t err = osTimerStart(ms_timer_inst, 1000);
-        ASSERT(err == osOK);
-        first_arm = true;
     }
+
+    osKernelLock(); // Data shared between threads and timer ISR
+    time_evt->timeout = timeout;
+    time_evt->reload = reload;
+    mod_err_t err = TimeEvent_timer_update();
+    osKernelUnlock();
+    TimeEvent_timer_check(err);
 }
 
 void TimeEvent_disarm(TimeEvent *const time_evt)
@@ -118,7 +148,37 @@ void TimeEvent_disarm(TimeEvent *const time_evt)
     LOGI(TAG, "Disarming time event.");
     osKernelLock(); // Data shared between threads and timer ISR.
     time_evt->timeout = 0U;
+    mod_err_t err = TimeEvent_timer_update();
+    osKernelUnlock();
+    TimeEvent_timer_check(err);
+}
+
+void TimeEvent_use_virtual_clock(bool enable)
+{
+    LOGI(TAG, "Time events on %s clock.", enable ? "virtual" : "1 s timer");
+    osKernelLock(); // Data shared between threads and timer ISR.
+    virtual_clock = enable;
+    virtual_ms = 0;
+    mod_err_t err = TimeEvent_timer_update();
+    osKernelUnlock();
+    TimeEvent_timer_check(err);
+}
+
+void TimeEvent_advance(uint32_t ms)
+{
+    osKernelLock(); // Data shared between threads and timer ISR.
+    if (virtual_clock)
+    {
+        virtual_ms += ms;
+        while (virtual_ms >= 1000)
+        {
+            virtual_ms -= 1000;
+            TimeEvent_count_down();
+        }
+    }
+    mod_err_t err = TimeEvent_timer_update();
     osKernelUnlock();
+    TimeEvent_timer_check(err);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -152,7 +212,13 @@ static void Active_event_loop(void *argument)
         }
 
         /* Dispatch event to active object's event handler and run to completion. */
+        uint64_t start = timestamp_cycles();
         ao->evt_handler(ao, evt);
+        ao->dispatch_us = timestamp_cycles_to_us(timestamp_cycles() - start);
+        if (ao->dispatch_us > ao->dispatch_max_us)
+        {
+            ao->dispatch_max_us = ao->dispatch_us;
+        }
     }
 }
 
@@ -165,7 +231,22 @@ static void Active_event_loop(void *argument)
  * @note This function should be called from within a 1 s timer ISR
  *       or using a 1 s OS-specific software timer.
  */
-static void TimeEvent_tick(void *argument)
+static void TimeEvent_tick(TimerHandle_t timer)
+{
+    osKernelLock(); // Data shared between threads and timer ISR.
+    if (!virtual_clock)
+    {
+        TimeEvent_count_down();
+    }
+    mod_err_t err = TimeEvent_timer_update();
+    osKernelUnlock();
+    TimeEvent_timer_check(err);
+}
+
+/**
+ * @brief Count down armed time events by 1 s.
+ */
+static void TimeEvent_count_down(void)
 {
     for (uint8_t i = 0U; i < num_time_events; ++i)
     {
@@ -183,3 +264,65 @@ static void TimeEvent_tick(void *argument)
         }
     }
 }
+
+/**
+ * @brief Run the 1 s timer only while a time event is armed.
+ *
+ * A stopped timer keeps the core asleep in idle (see power.h). It restarts on the next
+ * arming, so a time event armed while no other is pending expires exactly timeout seconds
+ * later. Called with the kernel locked, so timer commands are queued in the order the
+ * decisions are made.
+ *
+ * @return MOD_OK if the timer runs as required or its command is queued, MOD_ERR_TIMEOUT if
+ *         the timer command queue is full. The timer then keeps its previous state, and the
+ *         command is sent again on the next arming, disarming or tick.
+ */
+static mod_err_t TimeEvent_timer_update(void)
+{
+    if (ms_timer_inst == NULL)
+    {
+        return MOD_OK;
+    }
+
+    bool armed = false;
+    for (uint8_t i = 0U; i < num_time_events; ++i)
+    {
+        armed = armed || time_events[i]->timeout > 0U;
+    }
+
+    bool run = armed && !virtual_clock;
+    bool queued = true;
+    if (run && !timer_running)
+    {
+        queued = osTimerStart(ms_timer_inst, 1000) == osOK;
+    }
+    else if (!run && timer_running)
+    {
+        /* Not osTimerStop(), which fails while the start command is still queued. */
+        queued = xTimerStop((TimerHandle_t)ms_timer_inst, 0) == pdPASS;
+    }
+
+    if (!queued)
+    {
+        INC_SAT_U16(timer_cmd_errors);
+        return MOD_ERR_TIMEOUT;
+    }
+    timer_running = run;
+    return MOD_OK;
+}
+
+/**
+ * @brief Report a timer command that could not be queued.
+ *
+ * @param err Result of TimeEvent_timer_update().
+ *
+ * Called after the kernel is unlocked, so the message does not hold off other threads.
+ */
+static void TimeEvent_timer_check(mod_err_t err)
+{
+    if (err != MOD_OK)
+    {
+        LOGW(TAG, "Timer command queue full, 1 s timer %s on next update (%u times).",
+             timer_running ? "stops" : "starts", timer_cmd_errors);
+    }
+}
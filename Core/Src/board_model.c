@@ -0,0 +1,71 @@
+/**
+ * @file board_model.c
+ * @author Timothy Nguyen
+ * @brief PCB temperature observer
+ * @version 0.1
+ * @date 2021-08-18
+ */
+
+#include <math.h>
+
+#include "board_model.h"
+#include "log.h"
+
+#define BOARD_FIT_MIN_SAMPLES 60 // Samples needed for a fit.
+#define BOARD_FIT_MIN_LAG 1.0f   // Minimum mean of air-to-board difference times instrument (deg C^2).
+
+void Board_Init(Board_t *const board, float tau, float Ts, float temp)
+{
+    ASSERT(tau > 0.0f && Ts > 0.0f);
+
+    board->tau = tau;
+    board->Ts = Ts;
+    board->alpha = 1.0f - expf(-Ts / tau);
+    board->estimate = temp;
+}
+
+float Board_Update(Board_t *const board, float air_temp)
+{
+    board->estimate += board->alpha * (air_temp - board->estimate);
+    return board->estimate;
+}
+
+void Board_Fit_Reset(Board_fit_t *const fit, float probe_temp)
+{
+    fit->sum_ez = 0;
+    fit->sum_dz = 0;
+    fit->prev_probe = probe_temp;
+    fit->prev2_probe = probe_temp;
+    fit->samples = 0;
+}
+
+void Board_Fit_Add(Board_fit_t *const fit, float air_temp, float probe_temp)
+{
+    float e = air_temp - fit->prev_probe;
+    float z = air_temp - fit->prev2_probe; // Instrument, free of the noise of prev_probe.
+    float d = probe_temp - fit->prev_probe;
+
+    fit->sum_ez += (double)e * z;
+    fit->sum_dz += (double)d * z;
+    fit->prev2_probe = fit->prev_probe;
+    fit->prev_probe = probe_temp;
+    fit->samples++;
+}
+
+bool Board_Fit_Tau(Board_fit_t const *const fit, float Ts, float *const tau)
+{
+    /* A board already at air temperature carries no information about its lag. */
+    if (fit->samples < BOARD_FIT_MIN_SAMPLES || fit->sum_ez < BOARD_FIT_MIN_LAG * fit->samples)
+    {
+        return false;
+    }
+
+    double alpha = fit->sum_dz / fit->sum_ez;
+    if (alpha <= 0.0 || alpha >= 1.0)
+    {
+        return false;
+    }
+
+    *tau = (float)(-Ts / log(1.0 - alpha));
+    return true;
+}
@@ -0,0 +1,337 @@
+/**
+ * @file boot.c
+ * @author Timothy Nguyen
+ * @brief Boot-time profiler and deferred initialization.
+ * @version 0.1
+ * @date 2021-08-15
+ */
+
+#include <string.h>
+#include <stdbool.h>
+
+#include "boot.h"
+#include "timestamp.h"
+#include "cmd.h"
+#include "log.h"
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32l4xx.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+/* Marks a valid boot record ("BOOT"). */
+#define BOOT_RECORD_MAGIC 0x544F4F42U
+
+/* Reset cause flags in RCC_CSR. */
+#define RESET_FLAGS_MASK (RCC_CSR_LPWRRSTF | RCC_CSR_WWDGRSTF | RCC_CSR_IWDGRSTF | RCC_CSR_SFTRSTF | \
+                          RCC_CSR_BORRSTF | RCC_CSR_PINRSTF | RCC_CSR_OBLRSTF | RCC_CSR_FWRSTF)
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/* Boot record, retained across resets */
+typedef struct
+{
+    uint32_t magic;                     // BOOT_RECORD_MAGIC if the record is valid.
+    uint32_t boot_count;                // Boots since power-up, starting at 1.
+    uint32_t reset_flags;               // Reset cause flags (RCC_CSR).
+    uint32_t marked;                    // Bit mask of timestamped phases.
+    uint32_t phase_us[NUM_BOOT_PHASES]; // Time of each phase since reset vector (us).
+} Boot_record_t;
+
+/* Deferred initialization function and its result */
+typedef struct
+{
+    const char *name;
+    boot_init_fn_t fn;
+    mod_err_t err;    // Return value of fn.
+    uint32_t time_us; // Execution time of fn (us).
+} Boot_deferred_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t boot_status_cmd(uint32_t argc, const char **argv); // Display boot profile.
+static uint32_t boot_stack_cmd(uint32_t argc, const char **argv);  // Display stack high-water marks.
+
+static void boot_report(bool full);                  // Log boot profile.
+static const char *reset_cause(uint32_t reset_flags); // Name of reset cause.
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+/* Records of this boot [0] and the previous boot [1], not initialized by startup code. */
+static Boot_record_t boot_records[2] __attribute__((section(".noinit")));
+
+/* Deferred initialization queue */
+static Boot_deferred_t deferred[BOOT_MAX_DEFERRED];
+
+/* Number of queued deferred initialization functions */
+static uint8_t num_deferred;
+
+/* Thread states for "boot stack", static since osThreadEnumerate() allocates from the RTOS heap. */
+static TaskStatus_t thread_states[BOOT_MAX_THREADS];
+
+/* Boot phase names */
+static const char *phase_names[NUM_BOOT_PHASES] = {
+    "RESET",
+    "MAIN",
+    "CLOCK",
+    "PERIPH",
+    "KERNEL",
+    "CONTROL",
+    "PROMPT",
+    "DEFERRED"};
+
+/* Reset causes in order of precedence (the pin flag is set by every reset). */
+static const struct
+{
+    uint32_t flag;
+    const char *name;
+} reset_causes[] = {
+    {RCC_CSR_LPWRRSTF, "LOW POWER"},
+    {RCC_CSR_WWDGRSTF, "WWDG"},
+    {RCC_CSR_IWDGRSTF, "IWDG"},
+    {RCC_CSR_SFTRSTF, "SOFTWARE"},
+    {RCC_CSR_BORRSTF, "POWER ON"},
+    {RCC_CSR_OBLRSTF, "OPTION BYTES"},
+    {RCC_CSR_FWRSTF, "FIREWALL"},
+    {RCC_CSR_PINRSTF, "PIN"}};
+
+/* Information about boot commands. */
+static const cmd_cmd_info boot_cmd_infos[] = {
+    {.cmd_name = "status",
+     .cb = &boot_status_cmd,
+     .help = "Display boot phase timestamps of this and the previous boot, and deferred initialization."},
+    {.cmd_name = "stack",
+     .cb = &boot_stack_cmd,
+     .help = "Display least unused stack since boot of each thread (high-water mark)."}};
+
+/* Boot module client info */
+static cmd_client_info boot_client_info =
+    {
+        .client_name = "boot",
+        .num_cmds = ARRAY_SIZE(boot_cmd_infos),
+        .cmds = boot_cmd_infos,
+        .num_u16_pms = 0,
+        .u16_pms = NULL,
+        .u16_pm_names = NULL};
+
+/* Unique tag for logging module */
+static const char *TAG = "BOOT";
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+void boot_init(void)
+{
+    Boot_record_t *rec = &boot_records[0];
+    uint32_t reset_flags = RCC->CSR & RESET_FLAGS_MASK;
+    SET_BIT(RCC->CSR, RCC_CSR_RMVF);
+
+    /* SRAM2 content is random after power-up. */
+    bool warm = rec->magic == BOOT_RECORD_MAGIC && !(reset_flags & RCC_CSR_BORRSTF);
+    if (warm)
+    {
+        boot_records[1] = *rec;
+    }
+    else
+    {
+        memset(&boot_records[1], 0, sizeof(boot_records[1]));
+    }
+
+    uint32_t boot_count = warm ? rec->boot_count + 1 : 1;
+    memset(rec, 0, sizeof(*rec));
+    rec->magic = BOOT_RECORD_MAGIC;
+    rec->boot_count = boot_count;
+    rec->reset_flags = reset_flags;
+
+    /* Reset vector is time zero, see timestamp_start(). */
+    rec->marked = 1U << BOOT_PHASE_RESET;
+    boot_mark(BOOT_PHASE_MAIN);
+}
+
+mod_err_t boot_start(void)
+{
+    return cmd_register(&boot_client_info);
+}
+
+void boot_mark(boot_phase_t phase)
+{
+    if (phase >= NUM_BOOT_PHASES)
+    {
+        return;
+    }
+
+    uint32_t us = (uint32_t)timestamp_us();
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!(boot_records[0].marked & (1U << phase)))
+    {
+        boot_records[0].phase_us[phase] = us;
+        boot_records[0].marked |= 1U << phase;
+    }
+    __set_PRIMASK(primask);
+}
+
+mod_err_t boot_defer(const char *name, boot_init_fn_t fn)
+{
+    if (name == NULL || fn == NULL)
+    {
+        return MOD_ERR_ARG;
+    }
+    if (num_deferred >= BOOT_MAX_DEFERRED)
+    {
+        return MOD_ERR_RESOURCE;
+    }
+
+    deferred[num_deferred].name = name;
+    deferred[num_deferred].fn = fn;
+    num_deferred++;
+    return MOD_OK;
+}
+
+void boot_run_deferred(void)
+{
+    /* Let the control path threads run first. */
+    osThreadSetPriority(osThreadGetId(), osPriorityBelowNormal);
+
+    for (uint8_t i = 0; i < num_deferred; i++)
+    {
+        uint64_t start = timestamp_cycles();
+        deferred[i].err = deferred[i].fn();
+        deferred[i].time_us = timestamp_cycles_to_us(timestamp_cycles() - start);
+        if (deferred[i].err != MOD_OK)
+        {
+            LOGE(TAG, "Deferred initialization of %s failed (%d).", deferred[i].name, deferred[i].err);
+        }
+    }
+    boot_mark(BOOT_PHASE_DEFERRED);
+
+    boot_report(boot_records[0].boot_count == 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Log boot profile.
+ *
+ * @param full Log every phase, otherwise only a summary line.
+ */
+static void boot_report(bool full)
+{
+    const Boot_record_t *rec = &boot_records[0];
+
+    if (full)
+    {
+        uint32_t prev_us = 0;
+        for (uint8_t i = 0; i < NUM_BOOT_PHASES; i++)
+        {
+            if (rec->marked & (1U << i))
+            {
+                LOGI(TAG, "phase=%s us=%" PRIu32 " delta=%" PRIu32, phase_names[i], rec->phase_us[i], rec->phase_us[i] - prev_us);
+                prev_us = rec->phase_us[i];
+            }
+        }
+    }
+
+    LOGI(TAG, "boot=%" PRIu32 " reset=%s control=%" PRIu32 " prompt=%" PRIu32 " deferred=%" PRIu32,
+         rec->boot_count,
+         reset_cause(rec->reset_flags),
+         rec->phase_us[BOOT_PHASE_CONTROL],
+         rec->phase_us[BOOT_PHASE_PROMPT],
+         rec->phase_us[BOOT_PHASE_DEFERRED]);
+}
+
+/**
+ * @brief Get name of the reset cause with the highest precedence.
+ */
+static const char *reset_cause(uint32_t reset_flags)
+{
+    for (uint8_t i = 0; i < ARRAY_SIZE(reset_causes); i++)
+    {
+        if (reset_flags & reset_causes[i].flag)
+        {
+            return reset_causes[i].name;
+        }
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * @brief Display boot phase timestamps and deferred initialization results.
+ */
+static uint32_t boot_status_cmd(uint32_t argc, const char **argv)
+{
+    const Boot_record_t *rec = &boot_records[0];
+    const Boot_record_t *prev = &boot_records[1];
+    bool have_prev = prev->magic == BOOT_RECORD_MAGIC;
+
+    LOG("Boot %" PRIu32 ", reset cause: %s\r\n", rec->boot_count, reset_cause(rec->reset_flags));
+    if (have_prev)
+    {
+        LOG("Previous boot %" PRIu32 ", reset cause: %s\r\n", prev->boot_count, reset_cause(prev->reset_flags));
+    }
+
+    LOG("%-10s %12s %12s %12s\r\n", "Phase", "Time (us)", "Delta (us)", "Previous");
+    uint32_t prev_us = 0;
+    for (uint8_t i = 0; i < NUM_BOOT_PHASES; i++)
+    {
+        LOG("%-10s ", phase_names[i]);
+        if (rec->marked & (1U << i))
+        {
+            LOG("%12" PRIu32 " %12" PRIu32 " ", rec->phase_us[i], rec->phase_us[i] - prev_us);
+            prev_us = rec->phase_us[i];
+        }
+        else
+        {
+            LOG("%12s %12s ", "-", "-");
+        }
+        if (have_prev && (prev->marked & (1U << i)))
+        {
+            LOG("%12" PRIu32 "\r\n", prev->phase_us[i]);
+        }
+        else
+        {
+            LOG("%12s\r\n", "-");
+        }
+    }
+
+    LOG("Deferred initialization:\r\n");
+    for (uint8_t i = 0; i < num_deferred; i++)
+    {
+        LOG("  %-14s %8" PRIu32 " us\t%s\r\n", deferred[i].name, deferred[i].time_us, deferred[i].err == MOD_OK ? "OK" : "FAILED");
+    }
+    return 0;
+}
+
+/**
+ * @brief Display least unused stack of each thread since boot.
+ *
+ * A thread with little margin left needs a larger stack before its worst-case path overflows it.
+ */
+static uint32_t boot_stack_cmd(uint32_t argc, const char **argv)
+{
+    UBaseType_t num = uxTaskGetSystemState(thread_states, BOOT_MAX_THREADS, NULL);
+    if (num == 0)
+    {
+        LOG("More than %u threads\r\n", BOOT_MAX_THREADS);
+        return -1;
+    }
+
+    LOG("%-16s %14s\r\n", "Thread", "Unused (words)");
+    for (UBaseType_t i = 0; i < num; i++)
+    {
+        LOG("%-16s %14" PRIu32 "\r\n", thread_states[i].pcTaskName, (uint32_t)thread_states[i].usStackHighWaterMark);
+    }
+    return 0;
+}
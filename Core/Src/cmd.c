@@ -53,6 +53,9 @@ static void Cmd_Event_Handler(Cmd_Active *const ao, Cmd_Event const *const evt);
 /* Hold information about each client */
 static const cmd_client_info *client_infos[CMD_MAX_CLIENTS];
 
+/* Thread and event queue of command active object. */
+ACTIVE_STATIC_DEF(cmd, CMD_THREAD_SIZE, CMD_EVENT_MSG_COUNT);
+
 /* Unique tag for logging module */
 static const char *TAG = "CMD";
 
@@ -85,8 +88,7 @@ mod_err_t cmd_init(void)
 
 mod_err_t cmd_start()
 {
-    static const osThreadAttr_t thread_attr = {.stack_size = CMD_THREAD_SIZE};
-    return Active_start((Active *)&cmd_ao, &thread_attr, CMD_EVENT_MSG_COUNT, NULL);
+    return Active_start((Active *)&cmd_ao, &cmd_thread_attr, CMD_EVENT_MSG_COUNT, &cmd_queue_attr);
 }
 
 mod_err_t cmd_register(const cmd_client_info *_client_info)
@@ -130,7 +132,7 @@ int32_t cmd_parse_args(int32_t argc, const char **argv, const char *fmt, cmd_arg
                 return arg_cnt;
             }
             printf("Insufficient arguments\r\n");
-            return MOD_ERR_BAD_CMD;
+            return -MOD_ERR_BAD_CMD;
         }
 
         // These error conditions should not occur, but we check them for
@@ -138,7 +140,7 @@ int32_t cmd_parse_args(int32_t argc, const char **argv, const char *fmt, cmd_arg
         if (*argv == NULL || **argv == '\0')
         {
             printf("Invalid empty arguments\r\n");
-            return MOD_ERR_BAD_CMD;
+            return -MOD_ERR_BAD_CMD;
         }
 
         switch (*fmt)
@@ -148,7 +150,7 @@ int32_t cmd_parse_args(int32_t argc, const char **argv, const char *fmt, cmd_arg
             if (*endptr)
             {
                 printf("Argument '%s' not a valid integer\r\n", *argv);
-                return MOD_ERR_ARG;
+                return -MOD_ERR_ARG;
             }
             break;
         case 'u':
@@ -156,7 +158,7 @@ int32_t cmd_parse_args(int32_t argc, const char **argv, const char *fmt, cmd_arg
             if (*endptr)
             {
                 printf("Argument '%s' not a valid unsigned integer\r\n", *argv);
-                return MOD_ERR_ARG;
+                return -MOD_ERR_ARG;
             }
             break;
         case 'p':
@@ -164,7 +166,7 @@ int32_t cmd_parse_args(int32_t argc, const char **argv, const char *fmt, cmd_arg
             if (*endptr)
             {
                 printf("Argument '%s' not a valid pointer\r\n", *argv);
-                return MOD_ERR_ARG;
+                return -MOD_ERR_ARG;
             }
             break;
         case 's':
@@ -172,7 +174,7 @@ int32_t cmd_parse_args(int32_t argc, const char **argv, const char *fmt, cmd_arg
             break;
         default:
             printf("Bad argument format '%c'\n", *fmt);
-            return MOD_ERR_ARG;
+            return -MOD_ERR_ARG;
         }
         arg_vals->type = *fmt;
         arg_vals++;
@@ -184,7 +186,7 @@ int32_t cmd_parse_args(int32_t argc, const char **argv, const char *fmt, cmd_arg
     if (arg_cnt < argc)
     {
         printf("Too many arguments \r\n");
-        return MOD_ERR_BAD_CMD;
+        return -MOD_ERR_BAD_CMD;
     }
     return arg_cnt;
 }
@@ -312,7 +314,7 @@ static inline mod_err_t help_handler(const char **tokens)
     if (strcasecmp("help", tokens[0]) == 0 || strcasecmp("?", tokens[0]) == 0)
     {
         /* Iterate through commands of each client. */
-        for (uint8_t i = 0; client_infos[i] != NULL && i < CMD_MAX_CLIENTS; i++)
+        for (uint8_t i = 0; i < CMD_MAX_CLIENTS && client_infos[i] != NULL; i++)
         {
             const cmd_client_info *ci = client_infos[i];
 
@@ -362,7 +364,7 @@ static inline mod_err_t help_handler(const char **tokens)
  */
 static inline mod_err_t client_command_handler(const char **tokens, uint32_t num_tokens)
 {
-    for (uint8_t i = 0; client_infos[i] != NULL && i < CMD_MAX_CLIENTS; i++)
+    for (uint8_t i = 0; i < CMD_MAX_CLIENTS && client_infos[i] != NULL; i++)
     {
         const cmd_client_info *ci = client_infos[i];
 
@@ -474,7 +476,8 @@ static void Cmd_Event_Handler(Cmd_Active *const ao, Cmd_Event const *const evt)
         break;
     case CMD_RX_SIG:
         /* Copy command line to avoid race conditions. */
-        strncpy(cmd_ao.cmd_buf, evt->cmd_line, CONSOLE_CMD_BUF_SIZE);
+        strncpy(cmd_ao.cmd_buf, evt->cmd_line, CONSOLE_CMD_BUF_SIZE - 1);
+        cmd_ao.cmd_buf[CONSOLE_CMD_BUF_SIZE - 1] = '\0';
         cmd_execute(cmd_ao.cmd_buf);
         break;
     default:
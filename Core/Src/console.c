@@ -19,6 +19,7 @@
 #include "log.h"
 #include "printf.h"
 #include "active.h"
+#include "boot.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Common macros
@@ -41,6 +42,7 @@ typedef struct
     char cmd_buf[CONSOLE_CMD_BUF_SIZE]; // Hold command characters as they are entered by user over serial.
     uint16_t num_cmd_buf_chars;         // Holds number of characters currently in command buffer.
     bool first_run_done;                // First run, print PROMPT before checking for command characters
+    console_raw_handler_t raw_handler;  // Raw character handler, NULL when editing command lines.
 } Console_t;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,6 +62,12 @@ static inline mod_err_t console_process(char c); // Process received character f
 /* Console_t object */
 static Console_t console;
 
+/* Console thread and character queue memory */
+static StaticTask_t console_thread_cb;
+static uint32_t console_thread_stack[CONSOLE_THREAD_STACK_SIZE / sizeof(uint32_t)];
+static StaticQueue_t console_queue_cb;
+static char console_queue_mem[CONSOLE_MSG_QUEUE_SIZE];
+
 /* Unique tag for logging module */
 static const char *TAG = "CONSOLE";
 
@@ -89,13 +97,21 @@ mod_err_t console_init(void)
 mod_err_t console_start(void)
 {
     /* Create active object. */
-    static const osThreadAttr_t thread_attr = {.stack_size = CONSOLE_THREAD_STACK_SIZE};
+    static const osThreadAttr_t thread_attr = {.name = "console",
+                                               .cb_mem = &console_thread_cb,
+                                               .cb_size = sizeof(console_thread_cb),
+                                               .stack_mem = console_thread_stack,
+                                               .stack_size = sizeof(console_thread_stack)};
+    static const osMessageQueueAttr_t queue_attr = {.cb_mem = &console_queue_cb,
+                                                    .cb_size = sizeof(console_queue_cb),
+                                                    .mq_mem = console_queue_mem,
+                                                    .mq_size = sizeof(console_queue_mem)};
+    console.console_queue_id = osMessageQueueNew(CONSOLE_MSG_QUEUE_SIZE, sizeof(char), &queue_attr);
     console.console_thread_id = osThreadNew(Console_thread, NULL, &thread_attr);
-    console.console_queue_id = osMessageQueueNew(CONSOLE_MSG_QUEUE_SIZE, sizeof(char), NULL);
 
     ASSERT(console.console_queue_id != NULL && console.console_thread_id != NULL);
 
-    uart_start();
+    uart_start_rx();
 
     return MOD_OK;
 }
@@ -111,6 +127,12 @@ mod_err_t console_post(char c)
     return MOD_OK;
 }
 
+void console_set_raw_handler(console_raw_handler_t handler)
+{
+    console.num_cmd_buf_chars = 0; // Discard partially entered command line.
+    console.raw_handler = handler;
+}
+
 void console_signal(void)
 {
     osSemaphoreRelease(console.console_sem_id);
@@ -126,6 +148,7 @@ void console_signal(void)
 static void Console_thread(void *argument)
 {
     LOG(PROMPT);
+    boot_mark(BOOT_PHASE_PROMPT);
     while (1)
     {
         /* Read character from message queue, then process character */
@@ -136,6 +159,10 @@ static void Console_thread(void *argument)
         {
             LOGE(TAG, "Could not read character from queue.");
         }
+        else if (console.raw_handler != NULL)
+        {
+            console.raw_handler(char_to_process);
+        }
         else
         {
             console_process(char_to_process);
@@ -180,7 +207,7 @@ static mod_err_t console_process(char c)
         return MOD_OK;
     }
     /* Echo the character back. */
-    if (isprint(c))
+    if (isprint((unsigned char)c))
     {
         if (console.num_cmd_buf_chars < (CONSOLE_CMD_BUF_SIZE - 1))
         {
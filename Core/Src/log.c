@@ -10,13 +10,13 @@
 #include <stdarg.h>
 #include <string.h>
 #include <sys/queue.h>
-#include <stdlib.h>
 
 #include "log.h"
 #include "common.h"
 #include "stm32l4xx_hal.h"
 #include "printf.h"
 #include "cmd.h"
+#include "uart.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Common macros
@@ -25,10 +25,15 @@
 /* Logging names */
 #define LOG_LEVEL_NAMES "OFF, ERROR, WARNING, INFO, DEBUG, VERBOSE"
 #define LOG_LEVEL_NAMES_CSV "OFF", "ERROR", "WARNING", "INFO", "DEBUG", "VERBOSE"
+#define LOG_FORMAT_NAMES "text, kv, json"
+#define LOG_FORMAT_NAMES_CSV "text", "kv", "json"
 
 /* Number of tags to be cached. Must be 2**n - 1, n >= 2. */
 #define TAG_CACHE_SIZE 31
 
+/* Maximum number of tags with their own log level. */
+#define LOG_MAX_ENTRIES 16
+
 ////////////////////////////////////////////////////////////////////////////////
 // Type definitions
 ////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +87,7 @@ SLIST_HEAD(Log_head_t, Log_entry);
 /* Command callback functions */
 static uint32_t cmd_log_status(uint32_t argc, const char **argv); // Get log levels callback.
 static uint32_t cmd_log_set(uint32_t argc, const char **argv);    // Set log level callback.
+static uint32_t cmd_log_format(uint32_t argc, const char **argv); // Set log format callback.
 
 static inline void log_level_set(const char *tag, log_level_t level); // Set tag's log level.
 
@@ -97,6 +103,14 @@ static inline void log_add_cache(const char *tag, log_level_t log_level); // Add
 static inline void heap_bubble_down(int index);       // Heapify min-heap.
 static inline void heap_swap(uint32_t i, uint32_t j); // Swap heap array elements.
 
+static inline bool is_structured(const char *fmt);                   // Check if format string starts with a "key=" field.
+static char *next_field(char **p, char **key);                       // Split next field off structured message.
+static void log_print_text(char *line);                              // Print fields of structured message without keys.
+static void log_print_kv(const char *line, bool structured);         // Print message as key=value fields.
+static void log_print_json(char *line, bool structured, bool comma); // Print message as JSON members.
+static void log_print_json_str(const char *str);                     // Print escaped JSON string.
+static bool is_number(const char *str);                              // Check if field value is a JSON number.
+
 ////////////////////////////////////////////////////////////////////////////////
 // Private (static) variables
 ////////////////////////////////////////////////////////////////////////////////
@@ -105,6 +119,15 @@ static inline void heap_swap(uint32_t i, uint32_t j); // Swap heap array element
 static const char *log_level_names[] = {
     LOG_LEVEL_NAMES_CSV};
 
+/* First letter and text colour of each log level */
+static const char log_level_letters[] = "-EWIDV";
+static const char *log_level_colours[] = {
+    "", LOG_COLOUR_E, LOG_COLOUR_W, LOG_COLOUR_I, LOG_COLOUR_D, LOG_COLOUR_V};
+
+/* Log format names */
+static const char *log_format_names[NUM_LOG_FORMATS] = {
+    LOG_FORMAT_NAMES_CSV};
+
 /* Log command information. */
 static cmd_cmd_info log_cmds[] = {
     {.cmd_name = "status",
@@ -112,13 +135,16 @@ static cmd_cmd_info log_cmds[] = {
      .help = "Display log levels.\r\nPossible log levels: " LOG_LEVEL_NAMES},
     {.cmd_name = "set",
      .cb = cmd_log_set,
-     .help = "Set tag's log level, usage: log set <tag> <level>.\r\nPossible log levels: " LOG_LEVEL_NAMES}};
+     .help = "Set tag's log level, usage: log set <tag> <level>.\r\nPossible log levels: " LOG_LEVEL_NAMES},
+    {.cmd_name = "format",
+     .cb = cmd_log_format,
+     .help = "Set output format, usage: log format <format>.\r\nPossible formats: " LOG_FORMAT_NAMES}};
 
 /* Log module client info */
 static cmd_client_info log_client_info =
     {
         .client_name = "log",
-        .num_cmds = 2,
+        .num_cmds = ARRAY_SIZE(log_cmds),
         .cmds = log_cmds,
         .num_u16_pms = 0,
         .u16_pms = NULL,
@@ -130,6 +156,10 @@ static const char *TAG = "LOG";
 /* Declare a Log_head_t object containing a pointer to first log_tag_entry node. */
 static struct Log_head_t log_head;
 
+/* Statically allocated tag entries, unused ones are kept in a free list. */
+static Log_entry log_entry_pool[LOG_MAX_ENTRIES];
+static struct Log_head_t log_free_head;
+
 /* Cache of tags and their log levels */
 static Log_cache_state_t cache_state;
 
@@ -148,6 +178,9 @@ bool _log_active = true;
  */
 int32_t _global_log_level = LOG_DEFAULT;
 
+/* Output format of log messages */
+log_format_t _log_format = LOG_FORMAT_TEXT;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Public (global) functions
 ////////////////////////////////////////////////////////////////////////////////
@@ -155,6 +188,11 @@ int32_t _global_log_level = LOG_DEFAULT;
 mod_err_t log_init(void)
 {
     SLIST_INIT(&log_head); // Initialize linked list by setting head pointer to NULL.
+    SLIST_INIT(&log_free_head);
+    for (uint32_t i = 0; i < LOG_MAX_ENTRIES; i++)
+    {
+        SLIST_INSERT_HEAD(&log_free_head, &log_entry_pool[i], entries);
+    }
     LOGI(TAG, "Initialized log module");
     return cmd_register(&log_client_info);
 }
@@ -170,17 +208,98 @@ bool log_is_active(void)
     return _log_active;
 }
 
-void log_printf(const char *tag, log_level_t level, const char *fmt, ...)
+mod_err_t log_format_set(log_format_t format)
+{
+    if (format >= NUM_LOG_FORMATS)
+    {
+        return MOD_ERR_ARG;
+    }
+    _log_format = format;
+    return MOD_OK;
+}
+
+void log_printf(const char *tag, log_level_t level, uint64_t us, const char *fmt, ...)
 {
     log_level_t tag_level = get_log_level(tag);
     if (level > tag_level)
     {
         return;
     }
+
+    uint32_t secs = (uint32_t)(us / 1000000);
+    uint32_t frac = (uint32_t)(us % 1000000);
+
     va_list args;
     va_start(args, fmt);
-    vprintf(fmt, args);
+    bool structured = is_structured(fmt);
+    log_format_t format = _log_format;
+    if (format == LOG_FORMAT_TEXT && !structured)
+    {
+        /* Plain messages are printed without intermediate buffer. */
+        bool locked = uart_tx_lock();
+        printf("\r%s%c (%" PRIu32 ".%06" PRIu32 ") %s: ", log_level_colours[level], log_level_letters[level], secs, frac, tag);
+        vprintf(fmt, args);
+        printf("\r\n");
+        uart_tx_unlock(locked);
+        va_end(args);
+        return;
+    }
+
+    char line[LOG_LINE_SIZE];
+    int len = vsnprintf(line, sizeof(line), fmt, args);
     va_end(args);
+
+    /* A cut-off value would read as a wrong one, so the partial field is dropped. */
+    bool truncated = len >= (int)sizeof(line);
+    if (truncated && structured)
+    {
+        char *last_space = strrchr(line, ' ');
+        if (last_space != NULL)
+        {
+            *last_space = '\0';
+        }
+    }
+
+    /* Structured info messages are records (telemetry, boot phases) that carry their own sequence
+     * number or time, so kv and json print their fields only. Level and tag only take bytes. */
+    bool record = structured && level == LOG_INFO;
+
+    /* Keep the line together, other threads log and stream frames on the same UART. */
+    bool locked = uart_tx_lock();
+    switch (format)
+    {
+    case LOG_FORMAT_TEXT:
+        printf("\r%s%c (%" PRIu32 ".%06" PRIu32 ") %s: ", log_level_colours[level], log_level_letters[level], secs, frac, tag);
+        log_print_text(line);
+        printf(truncated ? " ~\r\n" : "\r\n");
+        break;
+    case LOG_FORMAT_KV:
+        if (record)
+        {
+            _putchar('\r');
+        }
+        else
+        {
+            printf("\rt=%" PRIu32 ".%06" PRIu32 " lvl=%c tag=%s ", secs, frac, log_level_letters[level], tag);
+        }
+        log_print_kv(line, structured);
+        printf(truncated ? " trunc=1\r\n" : "\r\n");
+        break;
+    default:
+        if (record)
+        {
+            printf("\r{");
+        }
+        else
+        {
+            printf("\r{\"t\":%" PRIu32 ".%06" PRIu32 ",\"lvl\":\"%c\",\"tag\":", secs, frac, log_level_letters[level]);
+            log_print_json_str(tag);
+        }
+        log_print_json(line, structured, !record);
+        printf(truncated ? ",\"trunc\":1}\r\n" : "}\r\n");
+        break;
+    }
+    uart_tx_unlock(locked);
 }
 
 /**
@@ -281,6 +400,40 @@ static uint32_t cmd_log_set(uint32_t argc, const char **argv)
     }
 }
 
+/**
+ * @brief Log format command.
+ *
+ * @param argc Number of arguments.
+ * @param argv Argument values.
+ *
+ * @return 0 if successful, 1 otherwise.
+ *
+ * TTYS command format: > log format <format>.
+ */
+static uint32_t cmd_log_format(uint32_t argc, const char **argv)
+{
+    if (argc == 0)
+    {
+        LOG("Log format: (%s)\r\n", log_format_names[_log_format]);
+        return 0;
+    }
+    else if (argc == 1)
+    {
+        for (uint8_t format = 0; format < NUM_LOG_FORMATS; format++)
+        {
+            if (strcasecmp(argv[0], log_format_names[format]) == 0)
+            {
+                log_format_set(format);
+                LOG("Log format set to (%s)\r\n", log_format_names[format]);
+                return 0;
+            }
+        }
+    }
+
+    LOGW(TAG, "Log format not recognized, possible formats: %s", LOG_FORMAT_NAMES);
+    return 1;
+}
+
 /**
  * @brief Set log level.
  * 
@@ -303,7 +456,7 @@ static inline void log_level_set(const char *tag, log_level_t level)
         {
             p = SLIST_FIRST(&log_head);
             SLIST_REMOVE_HEAD(&log_head, entries);
-            free(p);
+            SLIST_INSERT_HEAD(&log_free_head, p, entries);
         }
 
         cache_state.entry_count = 0;
@@ -327,14 +480,16 @@ static inline void log_level_set(const char *tag, log_level_t level)
     /* Tag not found in linked list, add new entry. */
     if (p == NULL)
     {
-        Log_entry *new_entry = (Log_entry *)malloc(sizeof(Log_entry));
+        Log_entry *new_entry = SLIST_FIRST(&log_free_head);
         if (new_entry == NULL)
         {
-            LOGW(TAG, "Insufficient heap memory for new list entry.");
+            LOGW(TAG, "No free list entry, at most %d tags can have their own level.", LOG_MAX_ENTRIES);
             return;
         }
+        SLIST_REMOVE_HEAD(&log_free_head, entries);
         new_entry->level = level;
-        strncpy(new_entry->tag, tag, sizeof(new_entry->tag));
+        strncpy(new_entry->tag, tag, sizeof(new_entry->tag) - 1);
+        new_entry->tag[sizeof(new_entry->tag) - 1] = '\0';
         SLIST_INSERT_HEAD(&log_head, new_entry, entries);
         LOG("Added tag (%s) to list with level (%s)\r\n", new_entry->tag, log_level_str(new_entry->level));
     }
@@ -493,3 +648,180 @@ static inline void heap_swap(uint32_t i, uint32_t j)
     cache_state.cache[i] = cache_state.cache[j];
     cache_state.cache[j] = tmp;
 }
+
+/**
+ * @brief Check if format string starts with a "key=" field.
+ */
+static inline bool is_structured(const char *fmt)
+{
+    const char *p = fmt;
+    while ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') || *p == '_')
+    {
+        p++;
+    }
+    return p != fmt && *p == '=';
+}
+
+/**
+ * @brief Get next space-separated field of structured message.
+ *
+ * @param[in/out] p Position in message, moved past the field.
+ * @param[out] key Field key, NULL if field has no key.
+ *
+ * @return Field value, NULL at end of message.
+ */
+static char *next_field(char **p, char **key)
+{
+    while (**p == ' ')
+    {
+        (*p)++;
+    }
+    if (**p == '\0')
+    {
+        return NULL;
+    }
+
+    char *field = *p;
+    while (**p != ' ' && **p != '\0')
+    {
+        (*p)++;
+    }
+    if (**p == ' ')
+    {
+        *(*p)++ = '\0';
+    }
+
+    char *value = strchr(field, '=');
+    if (value == NULL)
+    {
+        *key = NULL;
+        return field;
+    }
+    *value = '\0';
+    *key = field;
+    return value + 1;
+}
+
+/**
+ * @brief Print fields of structured message without their keys.
+ *
+ * @param line Formatted message, modified in place.
+ */
+static void log_print_text(char *line)
+{
+    char *key;
+    char *value;
+    const char *sep = "";
+    while ((value = next_field(&line, &key)) != NULL)
+    {
+        printf("%s%s", sep, value);
+        sep = " ";
+    }
+}
+
+/**
+ * @brief Print message as key=value fields.
+ *
+ * @param line Formatted message.
+ * @param structured Message consists of key=value fields.
+ */
+static void log_print_kv(const char *line, bool structured)
+{
+    if (structured)
+    {
+        printf("%s", line);
+        return;
+    }
+
+    /* Free text is quoted so that spaces do not split it into fields. */
+    printf("msg=\"");
+    for (const char *p = line; *p != '\0'; p++)
+    {
+        _putchar(*p == '"' ? '\'' : *p);
+    }
+    _putchar('"');
+}
+
+/**
+ * @brief Print message as JSON object members.
+ *
+ * @param line Formatted message, modified in place.
+ * @param structured Message consists of key=value fields.
+ * @param comma Members follow others, print a comma before the first one.
+ */
+static void log_print_json(char *line, bool structured, bool comma)
+{
+    if (!structured)
+    {
+        printf(",\"msg\":");
+        log_print_json_str(line);
+        return;
+    }
+
+    char *key;
+    char *value;
+    while ((value = next_field(&line, &key)) != NULL)
+    {
+        if (key == NULL)
+        {
+            continue;
+        }
+        if (comma)
+        {
+            _putchar(',');
+        }
+        comma = true;
+        log_print_json_str(key);
+        _putchar(':');
+        if (is_number(value))
+        {
+            printf("%s", value);
+        }
+        else
+        {
+            log_print_json_str(value);
+        }
+    }
+}
+
+/**
+ * @brief Print string as JSON string, replacing control characters with spaces.
+ */
+static void log_print_json_str(const char *str)
+{
+    _putchar('"');
+    for (const char *p = str; *p != '\0'; p++)
+    {
+        if (*p == '"' || *p == '\\')
+        {
+            _putchar('\\');
+        }
+        _putchar((unsigned char)*p < ' ' ? ' ' : *p);
+    }
+    _putchar('"');
+}
+
+/**
+ * @brief Check if field value is a valid JSON number (nan and inf are not).
+ */
+static bool is_number(const char *str)
+{
+    const char *p = str;
+    bool digits = false;
+    if (*p == '-')
+    {
+        p++;
+    }
+    for (; *p != '\0'; p++)
+    {
+        if (*p >= '0' && *p <= '9')
+        {
+            digits = true;
+        }
+        else if (*p != '.' && *p != 'e' && *p != 'E' && *p != '+' && *p != '-')
+        {
+            return false;
+        }
+    }
+    return digits;
+}
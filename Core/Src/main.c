@@ -30,15 +30,24 @@
 #include "cmd.h"
 #include "log.h"
 #include "reflow.h"
+#include "pid.h"
+#include "stream.h"
+#include "modbus.h"
+#include "timestamp.h"
+#include "boot.h"
+#include "power.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
+typedef StaticTask_t osStaticThreadDef_t;
 /* USER CODE BEGIN PTD */
 
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+#define MODBUS_BAUD_RATE 19200 // Modbus RTU baud rate (8N1).
+#define MODBUS_SLAVE_ADDR 1    // Modbus slave address.
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -53,9 +62,14 @@ TIM_HandleTypeDef htim3;
 
 /* Definitions for defaultTask */
 osThreadId_t defaultTaskHandle;
+uint32_t defaultTaskBuffer[512];
+osStaticThreadDef_t defaultTaskControlBlock;
 const osThreadAttr_t defaultTask_attributes = {
     .name = "defaultTask",
-    .stack_size = 512 * 4,
+    .cb_mem = &defaultTaskControlBlock,
+    .cb_size = sizeof(defaultTaskControlBlock),
+    .stack_mem = &defaultTaskBuffer[0],
+    .stack_size = sizeof(defaultTaskBuffer),
     .priority = (osPriority_t)osPriorityNormal,
 };
 /* USER CODE BEGIN PV */
@@ -64,10 +78,30 @@ static const Reflow_cfg_t reflow_cfg =
     {
         .pwm_timer_handle = &htim3,   // PWM Timer handle.
         .pwm_channel = TIM_CHANNEL_1, // PWM Timer channel.
-        .max_cfg = {                  // MAX31855K Thermocouple IC configuration structure.
-                    .hspi = &hspi2,
-                    .max_cs_port = MAX_CS_GPIO_Port,
-                    .max_cs_pin = MAX_CS_Pin}};
+        .max_cfg = {                  // MAX31855K Thermocouple IC configuration structures.
+                    [REFLOW_TC_OVEN] = {.hspi = &hspi2,
+                                        .max_cs_port = MAX_CS_GPIO_Port,
+                                        .max_cs_pin = MAX_CS_Pin},
+                    [REFLOW_TC_ELEMENT] = {.hspi = &hspi2,
+                                           .max_cs_port = MAX_ELEMENT_CS_GPIO_Port,
+                                           .max_cs_pin = MAX_ELEMENT_CS_Pin},
+                    [REFLOW_TC_PROBE] = {.hspi = &hspi2,
+                                         .max_cs_port = MAX_PROBE_CS_GPIO_Port,
+                                         .max_cs_pin = MAX_PROBE_CS_Pin},
+                    [REFLOW_TC_OVEN_B] = {.hspi = &hspi2,
+                                          .max_cs_port = MAX_OVEN_B_CS_GPIO_Port,
+                                          .max_cs_pin = MAX_OVEN_B_CS_Pin},
+                    [REFLOW_TC_OVEN_C] = {.hspi = &hspi2,
+                                          .max_cs_port = MAX_OVEN_C_CS_GPIO_Port,
+                                          .max_cs_pin = MAX_OVEN_C_CS_Pin}}};
+
+static const modbus_cfg_t modbus_cfg =
+    {
+        .uart_reg_base = UART4,         // Modbus runs on its own UART, separate from the console.
+        .irq_num = UART4_IRQn,          // UART4 interrupt request number.
+        .baud_rate = MODBUS_BAUD_RATE,  // Baud rate, used for inter-frame timing.
+        .slave_addr = MODBUS_SLAVE_ADDR // Slave address.
+};
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -79,6 +113,8 @@ static void MX_SPI2_Init(void);
 void StartDefaultTask(void *argument);
 
 /* USER CODE BEGIN PFP */
+static void MX_UART4_Init(void);
+static void MX_MAX_CS_Init(void);
 
 /* USER CODE END PFP */
 
@@ -94,7 +130,8 @@ void StartDefaultTask(void *argument);
 int main(void)
 {
     /* USER CODE BEGIN 1 */
-
+    timestamp_init();
+    boot_init();
     /* USER CODE END 1 */
 
     /* MCU Configuration--------------------------------------------------------*/
@@ -110,7 +147,8 @@ int main(void)
     SystemClock_Config();
 
     /* USER CODE BEGIN SysInit */
-
+    timestamp_clock_update();
+    boot_mark(BOOT_PHASE_CLOCK);
     /* USER CODE END SysInit */
 
     /* Initialize all configured peripherals */
@@ -122,7 +160,10 @@ int main(void)
     uart_config_t uart_cfg = {.uart_reg_base = USART2, .irq_num = USART2_IRQn};
     uart_init(&uart_cfg);
     uart_start();
+    MX_UART4_Init();
+    MX_MAX_CS_Init();
     HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_SET);
+    boot_mark(BOOT_PHASE_PERIPH);
     /* USER CODE END 2 */
 
     /* Init scheduler */
@@ -415,6 +456,72 @@ static void MX_GPIO_Init(void)
 
 /* USER CODE BEGIN 4 */
 
+/**
+  * @brief UART4 Initialization Function (Modbus RTU)
+  * @param None
+  * @retval None
+  */
+static void MX_UART4_Init(void)
+{
+    LL_USART_InitTypeDef USART_InitStruct = {0};
+
+    LL_GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    /* Peripheral clock enable */
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_UART4);
+
+    LL_AHB2_GRP1_EnableClock(LL_AHB2_GRP1_PERIPH_GPIOA);
+    /**UART4 GPIO Configuration
+  PA0   ------> UART4_TX
+  PA1   ------> UART4_RX
+  PA15  ------> UART4_DE (RS-485 transceiver driver enable)
+  */
+    GPIO_InitStruct.Pin = LL_GPIO_PIN_0 | LL_GPIO_PIN_1 | LL_GPIO_PIN_15;
+    GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
+    GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_VERY_HIGH;
+    GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+    GPIO_InitStruct.Pull = LL_GPIO_PULL_NO;
+    GPIO_InitStruct.Alternate = LL_GPIO_AF_8;
+    LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    USART_InitStruct.BaudRate = MODBUS_BAUD_RATE;
+    USART_InitStruct.DataWidth = LL_USART_DATAWIDTH_8B;
+    USART_InitStruct.StopBits = LL_USART_STOPBITS_1;
+    USART_InitStruct.Parity = LL_USART_PARITY_NONE;
+    USART_InitStruct.TransferDirection = LL_USART_DIRECTION_TX_RX;
+    USART_InitStruct.HardwareFlowControl = LL_USART_HWCONTROL_NONE;
+    USART_InitStruct.OverSampling = LL_USART_OVERSAMPLING_16;
+    LL_USART_Init(UART4, &USART_InitStruct);
+    LL_USART_ConfigAsyncMode(UART4);
+
+    /* Hardware drives the transceiver's DE pin around each transmitted frame. */
+    LL_USART_EnableDEMode(UART4);
+    LL_USART_SetDESignalPolarity(UART4, LL_USART_DE_POLARITY_HIGH);
+    LL_USART_SetDEAssertionTime(UART4, 8);
+    LL_USART_SetDEDeassertionTime(UART4, 8);
+
+    LL_USART_Enable(UART4);
+}
+
+/**
+  * @brief Element, probe and redundant oven thermocouple chip select Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_MAX_CS_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    /* Idle high so that these MAX31855Ks leave MISO to the oven MAX31855K. */
+    HAL_GPIO_WritePin(GPIOC, MAX_ELEMENT_CS_Pin | MAX_PROBE_CS_Pin | MAX_OVEN_B_CS_Pin | MAX_OVEN_C_CS_Pin, GPIO_PIN_SET);
+
+    GPIO_InitStruct.Pin = MAX_ELEMENT_CS_Pin | MAX_PROBE_CS_Pin | MAX_OVEN_B_CS_Pin | MAX_OVEN_C_CS_Pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_Init(GPIOC, &GPIO_InitStruct); // All on GPIOC.
+}
+
 /* USER CODE END 4 */
 
 /* USER CODE BEGIN Header_StartDefaultTask */
@@ -427,17 +534,27 @@ static void MX_GPIO_Init(void)
 void StartDefaultTask(void *argument)
 {
     /* USER CODE BEGIN 5 */
+    boot_mark(BOOT_PHASE_KERNEL);
 
-    console_init();
-    cmd_init();
-    log_init();
-
+    /* Control path first. Modbus is initialized before the reflow module registers its write callback. */
+    modbus_init(&modbus_cfg);
     reflow_init(&reflow_cfg);
-
-    console_start();
-    cmd_start();
     reflow_start();
 
+    /* Everything else runs once the reflow active object has turned the heater off. */
+    boot_defer("log", log_init);
+    boot_defer("stream", stream_init);
+    boot_defer("boot", boot_start);
+    boot_defer("pid", PID_Start);
+    boot_defer("cmd", cmd_init);
+    boot_defer("cmd start", cmd_start);
+    boot_defer("modbus start", modbus_start);
+    boot_defer("console", console_init);
+    boot_defer("console start", console_start);
+    boot_defer("power", power_init);
+    boot_defer("power start", power_start);
+    boot_run_deferred();
+
     osThreadTerminate(defaultTaskHandle);
     /* Infinite loop */
     for (;;)
@@ -465,7 +582,11 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
         HAL_IncTick();
     }
     /* USER CODE BEGIN Callback 1 */
-
+    if (htim->Instance == TIM7 && HAL_GetTick() % 1000 == 0)
+    {
+        /* Track cycle counter overflows even if no timestamps are taken. */
+        timestamp_refresh();
+    }
     /* USER CODE END Callback 1 */
 }
 
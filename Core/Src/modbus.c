@@ -0,0 +1,505 @@
+/**
+ * @file modbus.c
+ * @author Timothy Nguyen
+ * @brief Modbus RTU slave for PLC/SCADA integration.
+ * @version 0.1
+ * @date 2021-08-12
+ */
+
+#include <string.h>
+
+#include "modbus.h"
+#include "uart.h"
+#include "cmd.h"
+#include "log.h"
+#include "cmsis_os.h"
+#include "stm32l4xx_ll_usart.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+/* Inter-frame gap in bits at or below 19200 baud: 3.5 characters of 11 bits. */
+#define MODBUS_T35_BITS 39
+
+/* Register count limits of a single request. */
+#define MODBUS_MAX_READ_REGS 125
+#define MODBUS_MAX_WRITE_REGS 123
+
+/* Function codes */
+#define FC_READ_HOLDING_REGS 0x03
+#define FC_READ_INPUT_REGS 0x04
+#define FC_WRITE_SINGLE_REG 0x06
+#define FC_WRITE_MULTIPLE_REGS 0x10
+
+/* Read big-endian u16 from frame. */
+#define GET_U16(p) ((uint16_t)(((p)[0] << 8) | (p)[1]))
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/* Modbus slave structure */
+typedef struct
+{
+    /* Configuration parameters */
+    USART_TypeDef *uart_reg_base; // Pointer to UART's base register address.
+    IRQn_Type irq_num;            // Interrupt request number.
+    uint32_t baud_rate;           // Baud rate.
+    uint8_t slave_addr;           // Slave address.
+
+    /* OS objects */
+    osThreadId_t thread_id;     // Modbus thread ID.
+    osSemaphoreId_t frame_sem;  // Released by ISR when a frame is complete.
+
+    /* Receive buffer, owned by the ISR until frame_ready is set. */
+    uint8_t rx_buf[MODBUS_MAX_FRAME_SIZE];
+    volatile uint16_t rx_len;
+    volatile bool rx_err;      // Frame had a UART error or did not fit into rx_buf.
+    volatile bool frame_ready; // Frame is being processed, incoming bytes are dropped.
+
+    /* Transmit buffer, owned by the ISR while TXE interrupt is enabled. */
+    uint8_t tx_buf[MODBUS_MAX_FRAME_SIZE];
+    uint16_t tx_len;
+    volatile uint16_t tx_idx;
+
+    /* Shadow registers, updated by the register owner. */
+    uint16_t input_regs[MODBUS_NUM_INPUT_REGS];
+    uint16_t holding_regs[MODBUS_NUM_HOLDING_REGS];
+    modbus_write_cb_t write_cb;
+} Modbus_t;
+
+/**
+ * @brief List of Modbus performance measurements.
+ */
+typedef enum
+{
+    CNT_RX_FRAMES,    // Frames addressed to this slave.
+    CNT_RX_CRC_ERR,   // Frames dropped due to CRC mismatch.
+    CNT_RX_UART_ERR,  // Frames dropped due to UART errors or oversize.
+    CNT_RX_BUSY,      // Bytes dropped while previous frame was processed.
+    CNT_TX_FRAMES,    // Responses transmitted.
+    CNT_TX_EXCEPTION, // Exception responses transmitted.
+
+    NUM_U16_PMS // Number of performance measurements
+} Modbus_pms_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t modbus_status_cmd(uint32_t argc, const char **argv); // Display Modbus configuration.
+
+static void Modbus_thread(void *argument);                            // Modbus thread function.
+static void modbus_isr(void);                                         // UART interrupt service routine.
+static uint16_t modbus_process(const uint8_t *req, uint16_t len);     // Build response to request.
+static uint16_t modbus_read_regs(const uint8_t *req, uint16_t len,
+                                 const uint16_t *regs, uint16_t num_regs); // Build read response.
+static uint16_t modbus_write_regs(const uint8_t *req, uint16_t len); // Apply write, build response.
+static uint16_t modbus_exception(uint8_t fc, uint8_t ex);            // Build exception response.
+static void modbus_send(uint16_t len);                               // Append CRC and start transmission.
+static uint16_t crc16(const uint8_t *data, uint16_t len);            // Compute Modbus CRC-16.
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+/* Modbus_t instance */
+static Modbus_t modbus;
+
+/* Modbus thread and frame semaphore memory */
+static StaticTask_t modbus_thread_cb;
+static uint32_t modbus_thread_stack[MODBUS_THREAD_STACK_SIZE / sizeof(uint32_t)];
+static StaticSemaphore_t frame_sem_cb;
+
+/* Performance measurement counters */
+static uint16_t modbus_pms[NUM_U16_PMS];
+
+/* Performance measurement names */
+static const char *pm_names[] = {
+    "RX FRAMES",
+    "RX CRC ERR",
+    "RX UART ERR",
+    "RX BUSY",
+    "TX FRAMES",
+    "TX EXCEPTION"};
+
+/* Information about Modbus commands. */
+static const cmd_cmd_info modbus_cmd_infos[] = {
+    {.cmd_name = "status",
+     .cb = &modbus_status_cmd,
+     .help = "Display Modbus slave address and baud rate."}};
+
+/* Modbus module client info */
+static cmd_client_info modbus_client_info =
+    {
+        .client_name = "modbus",
+        .num_cmds = ARRAY_SIZE(modbus_cmd_infos),
+        .cmds = modbus_cmd_infos,
+        .num_u16_pms = NUM_U16_PMS,
+        .u16_pms = modbus_pms,
+        .u16_pm_names = pm_names};
+
+/* Unique tag for logging module */
+static const char *TAG = "MODBUS";
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+mod_err_t modbus_init(modbus_cfg_t const *const cfg)
+{
+    if (cfg->uart_reg_base == NULL || cfg->slave_addr == 0 || cfg->slave_addr > 247 || cfg->baud_rate == 0)
+    {
+        return MOD_ERR_ARG;
+    }
+    else if (!LL_USART_IsEnabled(cfg->uart_reg_base))
+    {
+        return MOD_ERR_PERIPH;
+    }
+
+    memset(&modbus, 0, sizeof(modbus));
+    modbus.uart_reg_base = cfg->uart_reg_base;
+    modbus.irq_num = cfg->irq_num;
+    modbus.baud_rate = cfg->baud_rate;
+    modbus.slave_addr = cfg->slave_addr;
+
+    mod_err_t err = uart_register_isr(cfg->irq_num, modbus_isr);
+    if (err != MOD_OK)
+    {
+        return err;
+    }
+
+    /* End of frame is detected by hardware after 3.5 idle character times. */
+    uint32_t t35_bits = MODBUS_T35_BITS;
+    if (cfg->baud_rate > 19200)
+    {
+        t35_bits = (uint32_t)(((uint64_t)MODBUS_T35_FAST_US * cfg->baud_rate + 999999) / 1000000);
+    }
+    LL_USART_SetRxTimeout(modbus.uart_reg_base, t35_bits);
+    LL_USART_EnableRxTimeout(modbus.uart_reg_base);
+
+    LOGI(TAG, "Initialized Modbus slave %u at %" PRIu32 " baud.", modbus.slave_addr, modbus.baud_rate);
+    return cmd_register(&modbus_client_info);
+}
+
+mod_err_t modbus_start(void)
+{
+    if (modbus.uart_reg_base == NULL)
+    {
+        LOGE(TAG, "Modbus not initialized");
+        return MOD_ERR_NOT_INIT;
+    }
+
+    static const osThreadAttr_t thread_attr = {.name = "modbus",
+                                               .cb_mem = &modbus_thread_cb,
+                                               .cb_size = sizeof(modbus_thread_cb),
+                                               .stack_mem = modbus_thread_stack,
+                                               .stack_size = sizeof(modbus_thread_stack)};
+    static const osSemaphoreAttr_t sem_attr = {.cb_mem = &frame_sem_cb, .cb_size = sizeof(frame_sem_cb)};
+    modbus.frame_sem = osSemaphoreNew(1, 0, &sem_attr);
+    modbus.thread_id = osThreadNew(Modbus_thread, NULL, &thread_attr);
+    ASSERT(modbus.frame_sem != NULL && modbus.thread_id != NULL);
+
+    LL_USART_EnableIT_RXNE(modbus.uart_reg_base);
+    LL_USART_EnableIT_RTO(modbus.uart_reg_base);
+
+    /* ISR uses FreeRTOS API, see uart_start(). */
+    __NVIC_SetPriority(modbus.irq_num, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
+    __NVIC_EnableIRQ(modbus.irq_num);
+
+    return MOD_OK;
+}
+
+void modbus_set_write_cb(modbus_write_cb_t cb)
+{
+    modbus.write_cb = cb;
+}
+
+mod_err_t modbus_update_input_regs(uint16_t addr, uint16_t count, const uint16_t *values)
+{
+    if ((uint32_t)addr + count > MODBUS_NUM_INPUT_REGS)
+    {
+        return MOD_ERR_ARG;
+    }
+
+    osKernelLock();
+    memcpy(&modbus.input_regs[addr], values, count * sizeof(uint16_t));
+    osKernelUnlock();
+    return MOD_OK;
+}
+
+mod_err_t modbus_update_holding_regs(uint16_t addr, uint16_t count, const uint16_t *values)
+{
+    if ((uint32_t)addr + count > MODBUS_NUM_HOLDING_REGS)
+    {
+        return MOD_ERR_ARG;
+    }
+
+    osKernelLock();
+    memcpy(&modbus.holding_regs[addr], values, count * sizeof(uint16_t));
+    osKernelUnlock();
+    return MOD_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) functions
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t modbus_status_cmd(uint32_t argc, const char **argv)
+{
+    LOG("Slave address: %u\tBaud rate: %" PRIu32 "\r\n", modbus.slave_addr, modbus.baud_rate);
+    return 0;
+}
+
+/**
+ * @brief Modbus thread, answers one request per complete frame.
+ */
+static void Modbus_thread(void *argument)
+{
+    while (1)
+    {
+        osSemaphoreAcquire(modbus.frame_sem, osWaitForever);
+
+        uint16_t len = modbus.rx_len;
+        const uint8_t *req = modbus.rx_buf;
+        uint8_t addr = req[0];
+
+        if (modbus.rx_err || len < 4)
+        {
+            INC_SAT_U16(modbus_pms[CNT_RX_UART_ERR]);
+        }
+        else if (addr != modbus.slave_addr && addr != 0)
+        {
+            /* Frame for another slave on the bus. */
+        }
+        else if (crc16(req, len - 2) != (uint16_t)(req[len - 2] | (req[len - 1] << 8)))
+        {
+            INC_SAT_U16(modbus_pms[CNT_RX_CRC_ERR]);
+        }
+        else if (LL_USART_IsEnabledIT_TXE(modbus.uart_reg_base))
+        {
+            /* Master did not wait for the previous response. */
+            INC_SAT_U16(modbus_pms[CNT_RX_BUSY]);
+        }
+        else
+        {
+            INC_SAT_U16(modbus_pms[CNT_RX_FRAMES]);
+            uint16_t tx_len = modbus_process(req, len - 2);
+            if (addr != 0)
+            {
+                modbus_send(tx_len);
+            }
+        }
+
+        /* Hand receive buffer back to the ISR. */
+        modbus.rx_len = 0;
+        modbus.rx_err = false;
+        modbus.frame_ready = false;
+    }
+}
+
+/**
+ * @brief Build response to a request with valid address and CRC.
+ *
+ * @param req Request frame without CRC.
+ * @param len Request length without CRC.
+ *
+ * @return Response length without CRC, response is placed in tx_buf.
+ */
+static uint16_t modbus_process(const uint8_t *req, uint16_t len)
+{
+    modbus.tx_buf[0] = modbus.slave_addr;
+    switch (req[1])
+    {
+    case FC_READ_HOLDING_REGS:
+        return modbus_read_regs(req, len, modbus.holding_regs, MODBUS_NUM_HOLDING_REGS);
+    case FC_READ_INPUT_REGS:
+        return modbus_read_regs(req, len, modbus.input_regs, MODBUS_NUM_INPUT_REGS);
+    case FC_WRITE_SINGLE_REG:
+    case FC_WRITE_MULTIPLE_REGS:
+        return modbus_write_regs(req, len);
+    default:
+        return modbus_exception(req[1], MODBUS_EX_ILLEGAL_FUNCTION);
+    }
+}
+
+static uint16_t modbus_read_regs(const uint8_t *req, uint16_t len, const uint16_t *regs, uint16_t num_regs)
+{
+    if (len != 6)
+    {
+        return modbus_exception(req[1], MODBUS_EX_ILLEGAL_DATA_VALUE);
+    }
+
+    uint16_t addr = GET_U16(&req[2]);
+    uint16_t count = GET_U16(&req[4]);
+    if (count == 0 || count > MODBUS_MAX_READ_REGS)
+    {
+        return modbus_exception(req[1], MODBUS_EX_ILLEGAL_DATA_VALUE);
+    }
+    else if ((uint32_t)addr + count > num_regs)
+    {
+        return modbus_exception(req[1], MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+    }
+
+    modbus.tx_buf[1] = req[1];
+    modbus.tx_buf[2] = count * 2;
+    uint8_t *p = &modbus.tx_buf[3];
+
+    /* Registers are answered from the shadow copy only. */
+    osKernelLock();
+    for (uint16_t i = 0; i < count; i++)
+    {
+        *p++ = regs[addr + i] >> 8;
+        *p++ = regs[addr + i] & 0xFF;
+    }
+    osKernelUnlock();
+
+    return 3 + count * 2;
+}
+
+static uint16_t modbus_write_regs(const uint8_t *req, uint16_t len)
+{
+    uint16_t addr = GET_U16(&req[2]);
+    uint16_t count = 1;
+    const uint8_t *data = &req[4];
+
+    if (req[1] == FC_WRITE_MULTIPLE_REGS)
+    {
+        count = GET_U16(&req[4]);
+        data = &req[7];
+        if (len < 7 || count == 0 || count > MODBUS_MAX_WRITE_REGS || req[6] != count * 2 || len != 7 + count * 2)
+        {
+            return modbus_exception(req[1], MODBUS_EX_ILLEGAL_DATA_VALUE);
+        }
+    }
+    else if (len != 6)
+    {
+        return modbus_exception(req[1], MODBUS_EX_ILLEGAL_DATA_VALUE);
+    }
+
+    if ((uint32_t)addr + count > MODBUS_NUM_HOLDING_REGS)
+    {
+        return modbus_exception(req[1], MODBUS_EX_ILLEGAL_DATA_ADDRESS);
+    }
+    else if (modbus.write_cb == NULL)
+    {
+        return modbus_exception(req[1], MODBUS_EX_DEVICE_FAILURE);
+    }
+
+    uint16_t values[MODBUS_NUM_HOLDING_REGS];
+    for (uint16_t i = 0; i < count; i++)
+    {
+        values[i] = GET_U16(&data[i * 2]);
+    }
+
+    uint8_t ex = modbus.write_cb(addr, count, values);
+    if (ex != MODBUS_EX_NONE)
+    {
+        return modbus_exception(req[1], ex);
+    }
+
+    /* Both write responses echo the first 6 bytes of the request. */
+    memcpy(&modbus.tx_buf[1], &req[1], 5);
+    return 6;
+}
+
+static uint16_t modbus_exception(uint8_t fc, uint8_t ex)
+{
+    INC_SAT_U16(modbus_pms[CNT_TX_EXCEPTION]);
+    modbus.tx_buf[1] = fc | 0x80;
+    modbus.tx_buf[2] = ex;
+    return 3;
+}
+
+static void modbus_send(uint16_t len)
+{
+    uint16_t crc = crc16(modbus.tx_buf, len);
+    modbus.tx_buf[len++] = crc & 0xFF;
+    modbus.tx_buf[len++] = crc >> 8;
+
+    modbus.tx_len = len;
+    modbus.tx_idx = 0;
+    INC_SAT_U16(modbus_pms[CNT_TX_FRAMES]);
+    LL_USART_EnableIT_TXE(modbus.uart_reg_base);
+}
+
+/**
+ * @brief UART interrupt service routine.
+ *
+ * Only moves bytes between the data registers and the frame buffers.
+ */
+static void modbus_isr(void)
+{
+    uint32_t status_reg = modbus.uart_reg_base->ISR;
+
+    if (status_reg & USART_ISR_RXNE_Msk)
+    {
+        uint8_t byte = modbus.uart_reg_base->RDR & 0xFFU; // Clears RXNE flag.
+        if (modbus.frame_ready)
+        {
+            INC_SAT_U16(modbus_pms[CNT_RX_BUSY]);
+        }
+        else if (modbus.rx_len < MODBUS_MAX_FRAME_SIZE)
+        {
+            modbus.rx_buf[modbus.rx_len++] = byte;
+        }
+        else
+        {
+            modbus.rx_err = true;
+        }
+    }
+
+    if (status_reg & USART_ISR_RTOF_Msk)
+    {
+        /* 3.5 character times of silence: frame is complete. */
+        LL_USART_ClearFlag_RTO(modbus.uart_reg_base);
+        if (!modbus.frame_ready && modbus.rx_len > 0)
+        {
+            modbus.frame_ready = true;
+            osSemaphoreRelease(modbus.frame_sem);
+        }
+    }
+
+    if ((status_reg & USART_ISR_TXE_Msk) && LL_USART_IsEnabledIT_TXE(modbus.uart_reg_base))
+    {
+        if (modbus.tx_idx < modbus.tx_len)
+        {
+            modbus.uart_reg_base->TDR = modbus.tx_buf[modbus.tx_idx++]; // Clears TXE flag.
+        }
+        else
+        {
+            LL_USART_DisableIT_TXE(modbus.uart_reg_base);
+        }
+    }
+
+    if (status_reg & (USART_ISR_ORE | USART_ISR_NE | USART_ISR_FE | USART_ISR_PE))
+    {
+        /* Discard frame, the master will retry. */
+        if (!modbus.frame_ready)
+        {
+            modbus.rx_err = true;
+        }
+        LL_USART_ClearFlag_ORE(modbus.uart_reg_base);
+        LL_USART_ClearFlag_NE(modbus.uart_reg_base);
+        LL_USART_ClearFlag_FE(modbus.uart_reg_base);
+        LL_USART_ClearFlag_PE(modbus.uart_reg_base);
+    }
+}
+
+/**
+ * @brief Compute Modbus CRC-16 (poly 0xA001 reflected, initial value 0xFFFF).
+ */
+static uint16_t crc16(const uint8_t *data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return crc;
+}
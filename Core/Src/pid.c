@@ -11,11 +11,56 @@
  * 
  */
 
-#include "PID.h"
+#include <math.h>
+
+#include "pid.h"
+#include "pid_cxx.h"
+#include "cmd.h"
 #include "log.h"
+#include "timestamp.h"
+#include "cmsis_os.h"
 
 #define SAMESIGN(X, Y) ((X) <= 0) == ((Y) <= 0)
 
+#define PID_BENCH_ITERATIONS 1000 // Default iterations of "pid bench".
+#define PID_BENCH_RUNS 3          // Timed runs, the fastest is reported.
+
+static uint32_t pid_bench_cmd(uint32_t argc, const char **argv); // Compare PID_Calculate() and PIDX_Calculate().
+
+/* Information about PID commands. */
+static const cmd_cmd_info pid_cmd_infos[] = {
+    {.cmd_name = "bench",
+     .cb = &pid_bench_cmd,
+     .help = "Compare cycles per iteration of the C and C++ PID controllers, usage: pid bench [iterations]."}};
+
+/* PID module client info */
+static cmd_client_info pid_client_info =
+    {
+        .client_name = "pid",
+        .num_cmds = ARRAY_SIZE(pid_cmd_infos),
+        .cmds = pid_cmd_infos,
+        .num_u16_pms = 0,
+        .u16_pms = NULL,
+        .u16_pm_names = NULL};
+
+/* Benchmark configuration: gains of a tuned oven with the derivative term enabled. */
+static const PID_cfg_t bench_cfg = {.Kp = 225.0f,
+                                    .Ki = 0.5f,
+                                    .Kd = 10.0f,
+                                    .tau = 1.0f,
+                                    .Ts = 0.5f,
+                                    .b = 1.0f,
+                                    .c = 0.0f,
+                                    .Tt = 0.0f,
+                                    .out_max = 4095.0f,
+                                    .out_min = 0.0f};
+
+/* Keeps benchmark results alive. */
+static volatile float bench_sink;
+
+/* Unique tag for logging module */
+static const char *TAG = "PID";
+
 void PID_Init(PID_t *const pid, PID_cfg_t const *const pid_cfg)
 {
 
@@ -28,6 +73,9 @@ void PID_Init(PID_t *const pid, PID_cfg_t const *const pid_cfg)
     pid->Kd = pid_cfg->Kd;
     pid->tau = pid_cfg->tau;
     pid->Ts = pid_cfg->Ts;
+    pid->b = pid_cfg->b;
+    pid->c = pid_cfg->c;
+    pid->Tt = pid_cfg->Tt;
     pid->out_lim_max = pid_cfg->out_max;
     pid->out_lim_min = pid_cfg->out_min;
 }
@@ -37,11 +85,11 @@ float PID_Calculate(PID_t *const pid, float setpoint, float measurement)
     /* Compute error */
     float error = setpoint - measurement;
 
-    /* Compute proportional term */
-    pid->proportional = pid->Kp * error;
+    /* Compute proportional term on weighted setpoint */
+    pid->proportional = pid->Kp * (pid->b * setpoint - measurement);
 
     /* Compute integral term */
-    if ((pid->out == pid->out_lim_max || pid->out == pid->out_lim_min) && SAMESIGN(pid->out, error))
+    if (pid->Tt <= 0.0f && (pid->out == pid->out_lim_max || pid->out == pid->out_lim_min) && SAMESIGN(pid->out, error))
     {
         pid->integral = pid->integral; /* Clamp integral term to avoid wind-up. */
     }
@@ -50,26 +98,38 @@ float PID_Calculate(PID_t *const pid, float setpoint, float measurement)
         pid->integral = pid->integral + 0.5f * pid->Ki * pid->Ts * (error + pid->prev_error);
     }
 
-    /* Compute filtered derivative term. 
-     * Note: Taking derivative on measurement only. */
-    pid->derivative = -(2.0f * pid->Kd * (measurement - pid->prev_measurement) + (2.0f * pid->tau - pid->Ts) * pid->derivative) / (2.0f * pid->tau + pid->Ts);
+    /* Compute filtered derivative term on weighted setpoint.
+     * Note: c = 0 takes derivative on measurement only. */
+    float d_measurement = (measurement - pid->c * setpoint) - (pid->prev_measurement - pid->c * pid->prev_setpoint);
+    pid->derivative = -(2.0f * pid->Kd * d_measurement + (2.0f * pid->tau - pid->Ts) * pid->derivative) / (2.0f * pid->tau + pid->Ts);
 
     /* Compute output */
-    pid->out = pid->proportional + pid->integral + pid->derivative;
+    float out = pid->proportional + pid->integral + pid->derivative;
 
     /* Floor output */
-    if (pid->out > pid->out_lim_max)
+    if (out > pid->out_lim_max)
     {
         pid->out = pid->out_lim_max;
     }
-    else if (pid->out < pid->out_lim_min)
+    else if (out < pid->out_lim_min)
     {
         pid->out = pid->out_lim_min;
     }
+    else
+    {
+        pid->out = out;
+    }
+
+    /* Back-calculation: bleed the integral towards the value that just saturates the output. */
+    if (pid->Tt > 0.0f)
+    {
+        pid->integral += pid->Ts / pid->Tt * (pid->out - out);
+    }
 
     /* Store error and measurement for next PID calculation. */
     pid->prev_error = error;
     pid->prev_measurement = measurement;
+    pid->prev_setpoint = setpoint;
 
     /* Return controller output */
     return pid->out;
@@ -81,6 +141,105 @@ void PID_Reset(PID_t *const pid)
     pid->prev_error = 0.0f;
     pid->derivative = 0.0f;
     pid->prev_measurement = 0.0f;
+    pid->prev_setpoint = 0.0f;
     pid->out = 0.0f;
     pid->proportional = 0.0f;
 }
+
+mod_err_t PID_Start(void)
+{
+    return cmd_register(&pid_client_info);
+}
+
+/**
+ * @brief Benchmark setpoint: a step from 150 to 40 deg C halfway.
+ */
+static inline float bench_setpoint(uint32_t i, uint32_t n)
+{
+    return i < n / 2 ? 150.0f : 40.0f;
+}
+
+/**
+ * @brief Benchmark measurement: a 25 to 125 deg C sawtooth, so the output saturates both ways.
+ */
+static inline float bench_measurement(uint32_t i)
+{
+    return 25.0f + (float)(i % 200) * 0.5f;
+}
+
+/**
+ * @brief Compare PID_Calculate() and PIDX_Calculate() on the same inputs.
+ *
+ * Reports the fastest of PID_BENCH_RUNS runs of each controller, with the scheduler locked,
+ * and the largest output difference.
+ *
+ * TTYS command format: > pid bench [iterations].
+ */
+static uint32_t pid_bench_cmd(uint32_t argc, const char **argv)
+{
+    cmd_arg_val arg_vals[1];
+    uint32_t n = PID_BENCH_ITERATIONS;
+    int32_t num_args = cmd_parse_args(argc, argv, "[u]", arg_vals);
+    if (num_args < 0)
+    {
+        return 1;
+    }
+    if (num_args == 1)
+    {
+        n = arg_vals[0].val.u;
+    }
+    if (n == 0)
+    {
+        LOGW(TAG, "Number of iterations must be positive");
+        return 1;
+    }
+
+    PID_t c_pid;
+    PIDX_t cxx_pid;
+    uint64_t c_cycles = UINT64_MAX;
+    uint64_t cxx_cycles = UINT64_MAX;
+    float sum = 0.0f;
+
+    osKernelLock();
+    for (uint32_t run = 0; run < PID_BENCH_RUNS; run++)
+    {
+        PID_Init(&c_pid, &bench_cfg);
+        uint64_t start = timestamp_cycles();
+        for (uint32_t i = 0; i < n; i++)
+        {
+            sum += PID_Calculate(&c_pid, bench_setpoint(i, n), bench_measurement(i));
+        }
+        uint64_t cycles = timestamp_cycles() - start;
+        c_cycles = cycles < c_cycles ? cycles : c_cycles;
+
+        PIDX_Init(&cxx_pid, &bench_cfg);
+        start = timestamp_cycles();
+        for (uint32_t i = 0; i < n; i++)
+        {
+            sum += PIDX_Calculate(&cxx_pid, bench_setpoint(i, n), bench_measurement(i));
+        }
+        cycles = timestamp_cycles() - start;
+        cxx_cycles = cycles < cxx_cycles ? cycles : cxx_cycles;
+    }
+    osKernelUnlock();
+    bench_sink = sum;
+
+    /* Equivalence, untimed. */
+    float max_diff = 0.0f;
+    PID_Init(&c_pid, &bench_cfg);
+    PIDX_Init(&cxx_pid, &bench_cfg);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        float diff = fabsf(PID_Calculate(&c_pid, bench_setpoint(i, n), bench_measurement(i)) -
+                           PIDX_Calculate(&cxx_pid, bench_setpoint(i, n), bench_measurement(i)));
+        max_diff = diff > max_diff ? diff : max_diff;
+    }
+
+    LOG("Iterations: %" PRIu32 ", best of %d runs\r\n", n, PID_BENCH_RUNS);
+    LOG("PID_Calculate():  %" PRIu32 " cycles/iteration (%" PRIu32 " us total)\r\n",
+        (uint32_t)(c_cycles / n), timestamp_cycles_to_us(c_cycles));
+    LOG("PIDX_Calculate(): %" PRIu32 " cycles/iteration (%" PRIu32 " us total)\r\n",
+        (uint32_t)(cxx_cycles / n), timestamp_cycles_to_us(cxx_cycles));
+    LOG("Largest output difference: %g\r\n", max_diff);
+    return 0;
+}
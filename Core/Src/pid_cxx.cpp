@@ -0,0 +1,78 @@
+/**
+ * @file pid_cxx.cpp
+ * @author Timothy Nguyen
+ * @brief C interface to the C++ PID controller of pid.hpp.
+ * @version 0.1
+ * @date 2021-08-17
+ */
+
+#include <new>
+
+#include "pid_cxx.h"
+#include "pid.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/* Controller behind PIDX_t, equivalent to PID_Calculate() with Tt = 0 */
+using Controller = ctl::Pid<float, ctl::ClampAntiWindup, ctl::FilteredDerivative>;
+
+static_assert(sizeof(Controller) <= sizeof(PIDX_t), "PIDX_STATE_WORDS too small");
+static_assert(alignof(Controller) <= alignof(PIDX_t), "PIDX_t alignment too small");
+
+/* Discretisation is constexpr, so constant gains are folded at compile time. */
+static_assert(ctl::discretise<float>(1.0, 2.0, 0.0, 1.0, 0.5, 0.0, 1.0).ki_half_ts == 0.5f, "Tustin integrator");
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Get controller stored in PIDX_t.
+ */
+static inline Controller *controller(PIDX_t *pid)
+{
+    return std::launder(reinterpret_cast<Controller *>(pid->state));
+}
+
+static inline const Controller *controller(const PIDX_t *pid)
+{
+    return std::launder(reinterpret_cast<const Controller *>(pid->state));
+}
+
+/**
+ * @brief Discretise PID configuration.
+ */
+static inline ctl::PidGains<float> gains(PID_cfg_t const *cfg)
+{
+    return ctl::discretise<float>(cfg->Kp, cfg->Ki, cfg->Kd, cfg->tau, cfg->Ts, cfg->out_min, cfg->out_max,
+                                  cfg->b, cfg->c, cfg->Tt);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+extern "C" void PIDX_Init(PIDX_t *const pid, PID_cfg_t const *const pid_cfg)
+{
+    new (pid->state) Controller(gains(pid_cfg));
+}
+
+extern "C" float PIDX_Calculate(PIDX_t *const pid, float setpoint, float measurement)
+{
+    return controller(pid)->update(setpoint, measurement);
+}
+
+extern "C" void PIDX_Reset(PIDX_t *const pid)
+{
+    controller(pid)->reset();
+}
+
+extern "C" void PIDX_Terms(PIDX_t const *const pid, float *proportional, float *integral, float *derivative)
+{
+    const Controller *c = controller(pid);
+    *proportional = c->proportional();
+    *integral = c->integral();
+    *derivative = c->derivative();
+}
@@ -0,0 +1,462 @@
+/**
+ * @file power.c
+ * @author Timothy Nguyen
+ * @brief Tickless idle on LPTIM1 and wake-up accounting.
+ * @version 0.1
+ * @date 2021-08-16
+ */
+
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+
+#include "power.h"
+#include "timestamp.h"
+#include "cmd.h"
+#include "log.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32l4xx_hal.h"
+#include "stm32l4xx_ll_bus.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define LPTIM_PRESCALER 128U   // LPTIM1 counter clock is PCLK1 / 128.
+#define LPTIM_MAX_COUNT 0xFFFFU // 16-bit counter.
+
+#define US_PER_SECOND 1000000U
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Power module structure.
+ */
+typedef struct
+{
+    /* Configuration parameters */
+    uint32_t lp_per_tick;        // LPTIM1 counts per kernel tick.
+    uint32_t core_per_lp;        // Core clock cycles per LPTIM1 count.
+    uint32_t core_per_tick;      // Core clock cycles per kernel tick.
+    TickType_t max_sleep_ticks;  // Longest sleep LPTIM1 can measure.
+    volatile bool sleep_enabled; // Idle task may sleep.
+    volatile bool tickless;      // Stop kernel tick while sleeping.
+
+    /* Data */
+    uint32_t wakes[NUM_POWER_WAKES];             // Wake-ups since reset.
+    uint32_t window_wakes[NUM_POWER_WAKES];      // Wake-ups in the current second.
+    uint32_t last_second_wakes[NUM_POWER_WAKES]; // Wake-ups in the last complete second.
+    uint64_t window_start_us;                    // Start of the current second.
+    uint64_t sleep_us;                           // Time asleep since reset.
+    uint32_t aborted;                            // Sleeps abandoned because a thread became ready.
+} Power_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t power_status_cmd(uint32_t argc, const char **argv);   // Display wake-up statistics.
+static uint32_t power_tickless_cmd(uint32_t argc, const char **argv); // Enable or disable tickless idle.
+
+static void sleep_tickless(TickType_t expected_idle); // Sleep on LPTIM1 with kernel and HAL ticks stopped.
+static void sleep_until_tick(void);                   // Sleep until the next interrupt.
+static power_wake_t wake_reason(void);                // Classify pending interrupt.
+static void count_wake(power_wake_t reason, uint32_t slept_cycles, uint32_t counted_cycles);
+
+static void lptim_start(uint32_t count); // Start LPTIM1 in one-shot mode.
+static uint32_t lptim_count(void);       // Read LPTIM1 counter.
+static void lptim_stop(void);            // Stop LPTIM1 and clear its interrupt.
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+/* Power module instance */
+static Power_t power = {.tickless = true};
+
+/* Wake-up reason names */
+static const char *wake_names[NUM_POWER_WAKES] = {
+    "DEADLINE",
+    "LIMIT",
+    "TICK",
+    "CONSOLE",
+    "MODBUS",
+    "OTHER"};
+
+/* Information about power commands. */
+static const cmd_cmd_info power_cmd_infos[] = {
+    {.cmd_name = "status",
+     .cb = &power_status_cmd,
+     .help = "Display time asleep and wake-ups by reason: total, average and last second."},
+    {.cmd_name = "tickless",
+     .cb = &power_tickless_cmd,
+     .help = "Stop kernel tick in idle sleep, usage: power tickless <on|off>."}};
+
+/* Power module client info */
+static cmd_client_info power_client_info =
+    {
+        .client_name = "power",
+        .num_cmds = ARRAY_SIZE(power_cmd_infos),
+        .cmds = power_cmd_infos,
+        .num_u16_pms = 0,
+        .u16_pms = NULL,
+        .u16_pm_names = NULL};
+
+/* Unique tag for logging module */
+static const char *TAG = "POWER";
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+mod_err_t power_init(void)
+{
+    uint32_t lp_hz = HAL_RCC_GetPCLK1Freq() / LPTIM_PRESCALER;
+    if (lp_hz % configTICK_RATE_HZ != 0 || SystemCoreClock % lp_hz != 0)
+    {
+        return MOD_ERR_PERIPH;
+    }
+    power.lp_per_tick = lp_hz / configTICK_RATE_HZ;
+    power.core_per_lp = SystemCoreClock / lp_hz;
+    power.core_per_tick = SystemCoreClock / configTICK_RATE_HZ;
+    power.max_sleep_ticks = LPTIM_MAX_COUNT / power.lp_per_tick - 1;
+
+    /* PCLK1 kernel clock, /128 prescaler. CFGR and IER are written while disabled. */
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_LPTIM1);
+    MODIFY_REG(RCC->CCIPR, RCC_CCIPR_LPTIM1SEL, 0U);
+    LPTIM1->CR = 0U;
+    LPTIM1->CFGR = LPTIM_CFGR_PRESC;
+    LPTIM1->IER = LPTIM_IER_ARRMIE;
+
+    /* Only wakes the core, so the lowest priority. */
+    NVIC_SetPriority(LPTIM1_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), configLIBRARY_LOWEST_INTERRUPT_PRIORITY, 0));
+    NVIC_EnableIRQ(LPTIM1_IRQn);
+
+    power.window_start_us = timestamp_us();
+    return MOD_OK;
+}
+
+mod_err_t power_start(void)
+{
+    if (power.lp_per_tick == 0)
+    {
+        return MOD_ERR_NOT_INIT;
+    }
+
+    mod_err_t err = cmd_register(&power_client_info);
+    if (err != MOD_OK)
+    {
+        return err;
+    }
+
+    power.sleep_enabled = true;
+    LOGI(TAG, "Idle sleep enabled, tickless up to %" PRIu32 " ms.", (uint32_t)power.max_sleep_ticks * 1000U / configTICK_RATE_HZ);
+    return MOD_OK;
+}
+
+/**
+ * @brief Sleep until the next kernel deadline or interrupt.
+ *
+ * Called by the idle task with the scheduler suspended, replaces the SysTick implementation
+ * of the port (configUSE_TICKLESS_IDLE is 1).
+ *
+ * @param expected_idle Ticks until the next thread timeout or timer expiry.
+ */
+void vPortSuppressTicksAndSleep(TickType_t expected_idle)
+{
+    if (!power.sleep_enabled)
+    {
+        return;
+    }
+
+    /* Interrupts stay masked until the accounting is done, but still end WFI. */
+    __disable_irq();
+    __DSB();
+    __ISB();
+
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+    {
+        power.aborted++;
+    }
+    else if (power.tickless)
+    {
+        sleep_tickless(expected_idle);
+    }
+    else
+    {
+        sleep_until_tick();
+    }
+
+    __enable_irq();
+}
+
+/**
+ * @brief LPTIM1 interrupt handler. The interrupt only ends WFI; sleep_tickless() normally
+ * clears it before it is taken.
+ */
+void LPTIM1_IRQHandler(void)
+{
+    LPTIM1->ICR = LPTIM_ICR_ARRMCF;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Sleep on LPTIM1 with the kernel and HAL ticks stopped.
+ *
+ * The rest of the current tick period is rounded up to whole LPTIM1 counts, so a sleep that
+ * reaches the deadline ends just after the deadline's tick boundary. The ticks that passed
+ * are stepped, except the last one, which is counted by pending the SysTick interrupt so the
+ * kernel unblocks the waiting thread as usual.
+ *
+ * @param expected_idle Ticks until the next kernel deadline.
+ */
+static void sleep_tickless(TickType_t expected_idle)
+{
+    bool limited = expected_idle > power.max_sleep_ticks;
+    if (limited)
+    {
+        expected_idle = power.max_sleep_ticks;
+    }
+
+    /* Stop the kernel tick. VAL counts down to the end of the current tick period. */
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    uint32_t tick_left = SysTick->VAL;
+    if (tick_left == 0U)
+    {
+        tick_left = 1U;
+    }
+
+    /* TIM7 keeps counting with its update interrupt disabled. */
+    HAL_SuspendTick();
+    uint32_t hal_cnt = TIM7->CNT;
+
+    uint32_t sleep_lp = (tick_left + power.core_per_lp - 1U) / power.core_per_lp + power.lp_per_tick * (expected_idle - 1U);
+    lptim_start(sleep_lp);
+
+    uint32_t cyccnt = DWT->CYCCNT;
+    __DSB();
+    __WFI();
+    __ISB();
+    uint32_t counted = DWT->CYCCNT - cyccnt;
+
+    bool timeout = LPTIM1->ISR & LPTIM_ISR_ARRM;
+    uint32_t slept_lp = timeout ? sleep_lp : lptim_count();
+    power_wake_t reason = wake_reason();
+    if (reason == POWER_WAKE_OTHER && timeout)
+    {
+        reason = limited ? POWER_WAKE_LIMIT : POWER_WAKE_DEADLINE;
+    }
+    lptim_stop();
+    uint32_t slept = slept_lp * power.core_per_lp;
+
+    /* Kernel tick: step the whole ticks that passed and restart SysTick for the rest of the period. */
+    uint32_t remaining;
+    if (slept < tick_left)
+    {
+        remaining = tick_left - slept;
+    }
+    else
+    {
+        uint32_t after = slept - tick_left;
+        vTaskStepTick(after / power.core_per_tick);
+        SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+        remaining = power.core_per_tick - after % power.core_per_tick;
+    }
+    SysTick->LOAD = remaining - 1U;
+    SysTick->VAL = 0U;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = power.core_per_tick - 1U;
+
+    /* HAL tick: the pending update interrupt counts one of the TIM7 periods that passed. */
+    uint32_t period_us = TIM7->ARR + 1U;
+    int32_t hal_us = (int32_t)(slept / (SystemCoreClock / 1000000U) + hal_cnt) - (int32_t)TIM7->CNT;
+    int32_t periods = (hal_us + (int32_t)period_us / 2) / (int32_t)period_us;
+    if (periods > 1)
+    {
+        uwTick += (uint32_t)(periods - 1) * uwTickFreq;
+    }
+    HAL_ResumeTick();
+
+    count_wake(reason, slept, counted);
+}
+
+/**
+ * @brief Sleep until the next interrupt, usually the kernel or HAL tick.
+ *
+ * SysTick measures the time asleep; WFI returns at its next reload at the latest.
+ */
+static void sleep_until_tick(void)
+{
+    uint32_t load = SysTick->LOAD + 1U;
+    (void)SysTick->CTRL; // Clear COUNTFLAG.
+    uint32_t val = SysTick->VAL;
+
+    uint32_t cyccnt = DWT->CYCCNT;
+    __DSB();
+    __WFI();
+    __ISB();
+    uint32_t counted = DWT->CYCCNT - cyccnt;
+
+    uint32_t val_now = SysTick->VAL;
+    uint32_t slept = (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) ? val + load - val_now : val - val_now;
+
+    count_wake(wake_reason(), slept, counted);
+}
+
+/**
+ * @brief Classify the interrupt that ended WFI from the pending interrupts.
+ *
+ * @return Wake-up reason, POWER_WAKE_OTHER if none of the known interrupts is pending.
+ */
+static power_wake_t wake_reason(void)
+{
+    if (NVIC_GetPendingIRQ(USART2_IRQn))
+    {
+        return POWER_WAKE_CONSOLE;
+    }
+    if (NVIC_GetPendingIRQ(UART4_IRQn))
+    {
+        return POWER_WAKE_MODBUS;
+    }
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) || NVIC_GetPendingIRQ(TIM7_IRQn))
+    {
+        return POWER_WAKE_TICK;
+    }
+    return POWER_WAKE_OTHER;
+}
+
+/**
+ * @brief Count a wake-up and correct timestamps for the time asleep.
+ *
+ * @param reason Wake-up reason.
+ * @param slept_cycles Time asleep in core clock cycles.
+ * @param counted_cycles Cycles counted by the DWT cycle counter over the same time.
+ */
+static void count_wake(power_wake_t reason, uint32_t slept_cycles, uint32_t counted_cycles)
+{
+    /* The cycle counter stops while the core clock is gated. Small differences are
+     * measurement error, not a stopped counter. */
+    if (counted_cycles < slept_cycles / 2U)
+    {
+        timestamp_add_cycles(slept_cycles - counted_cycles);
+    }
+    timestamp_refresh();
+
+    uint64_t now = timestamp_us();
+    uint64_t elapsed = now - power.window_start_us;
+    if (elapsed >= US_PER_SECOND)
+    {
+        if (elapsed < 2U * US_PER_SECOND)
+        {
+            memcpy(power.last_second_wakes, power.window_wakes, sizeof(power.window_wakes));
+        }
+        else
+        {
+            memset(power.last_second_wakes, 0, sizeof(power.last_second_wakes));
+        }
+        memset(power.window_wakes, 0, sizeof(power.window_wakes));
+        power.window_start_us += elapsed - elapsed % US_PER_SECOND;
+    }
+
+    power.wakes[reason]++;
+    power.window_wakes[reason]++;
+    power.sleep_us += timestamp_cycles_to_us(slept_cycles);
+}
+
+/**
+ * @brief Start LPTIM1 in one-shot mode, counting from 0 to count.
+ */
+static void lptim_start(uint32_t count)
+{
+    LPTIM1->CR = LPTIM_CR_ENABLE;
+    LPTIM1->ARR = count;
+    while (!(LPTIM1->ISR & LPTIM_ISR_ARROK))
+    {
+    }
+    LPTIM1->ICR = LPTIM_ICR_ARROKCF;
+    LPTIM1->CR = LPTIM_CR_ENABLE | LPTIM_CR_SNGSTRT;
+}
+
+/**
+ * @brief Read LPTIM1 counter. Two equal consecutive reads are needed while it runs.
+ */
+static uint32_t lptim_count(void)
+{
+    uint32_t cnt;
+    do
+    {
+        cnt = LPTIM1->CNT;
+    } while (cnt != LPTIM1->CNT);
+    return cnt;
+}
+
+/**
+ * @brief Stop and reset LPTIM1 and clear its pending interrupt.
+ */
+static void lptim_stop(void)
+{
+    LPTIM1->ICR = LPTIM_ICR_ARRMCF;
+    LPTIM1->CR = 0U;
+    NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+}
+
+/**
+ * @brief Display time asleep and wake-ups by reason.
+ */
+static uint32_t power_status_cmd(uint32_t argc, const char **argv)
+{
+    /* Copy the counters updated by the idle task. */
+    uint32_t wakes[NUM_POWER_WAKES];
+    uint32_t last_second[NUM_POWER_WAKES];
+    taskENTER_CRITICAL();
+    memcpy(wakes, power.wakes, sizeof(wakes));
+    memcpy(last_second, power.last_second_wakes, sizeof(last_second));
+    uint64_t sleep_us = power.sleep_us;
+    uint32_t aborted = power.aborted;
+    taskEXIT_CRITICAL();
+
+    uint32_t uptime_ms = timestamp_ms();
+    float uptime_s = uptime_ms / 1000.0f;
+    LOG("Idle sleep: %s, tickless: %s (max %" PRIu32 " ms)\r\n",
+        power.sleep_enabled ? "on" : "off",
+        power.tickless ? "on" : "off",
+        (uint32_t)power.max_sleep_ticks * 1000U / configTICK_RATE_HZ);
+    LOG("Asleep: %.1f %% of %" PRIu32 " ms, aborted sleeps: %" PRIu32 "\r\n",
+        uptime_ms ? 100.0f * (float)(sleep_us / 1000U) / uptime_ms : 0.0f, uptime_ms, aborted);
+
+    LOG("%-10s %10s %10s %10s\r\n", "Reason", "Total", "Per s", "Last s");
+    uint32_t total = 0;
+    uint32_t total_last = 0;
+    for (uint8_t i = 0; i < NUM_POWER_WAKES; i++)
+    {
+        LOG("%-10s %10" PRIu32 " %10.1f %10" PRIu32 "\r\n", wake_names[i], wakes[i], wakes[i] / uptime_s, last_second[i]);
+        total += wakes[i];
+        total_last += last_second[i];
+    }
+    LOG("%-10s %10" PRIu32 " %10.1f %10" PRIu32 "\r\n", "ALL", total, total / uptime_s, total_last);
+    return 0;
+}
+
+/**
+ * @brief Enable or disable tickless idle.
+ *
+ * TTYS command format: > power tickless <on|off>.
+ */
+static uint32_t power_tickless_cmd(uint32_t argc, const char **argv)
+{
+    if (argc != 1 || (strcasecmp(argv[0], "on") != 0 && strcasecmp(argv[0], "off") != 0))
+    {
+        LOGW(TAG, "Usage: power tickless <on|off>");
+        return 1;
+    }
+
+    power.tickless = strcasecmp(argv[0], "on") == 0;
+    LOG("Tickless idle %s\r\n", power.tickless ? "on" : "off");
+    return 0;
+}
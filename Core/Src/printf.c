@@ -146,6 +146,13 @@ static inline void _out_null(char character, void* buffer, size_t idx, size_t ma
 }
 
 
+// output a character, used by the log module to print without formatting
+void _putchar(char character)
+{
+  uart_putc(character);
+}
+
+
 // internal _putchar wrapper
 static inline void _out_char(char character, void* buffer, size_t idx, size_t maxlen)
 {
@@ -864,8 +871,7 @@ int printf_(const char* format, ...)
 {
   va_list va;
   va_start(va, format);
-  char buffer[1];
-  const int ret = _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+  const int ret = vprintf_(format, va);
   va_end(va);
   return ret;
 }
@@ -894,7 +900,11 @@ int snprintf_(char* buffer, size_t count, const char* format, ...)
 int vprintf_(const char* format, va_list va)
 {
   char buffer[1];
-  return _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+  // keep output of one call together, see uart_tx_lock()
+  const bool locked = uart_tx_lock();
+  const int ret = _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+  uart_tx_unlock(locked);
+  return ret;
 }
 
 
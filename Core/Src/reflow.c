@@ -18,25 +18,25 @@
 #include "cmsis_os.h"
 #include "stm32l4xx.h"
 #include "MAX31855K.h"
-
-#define REFLOW_PROFILE_PHASES_CSV "RESET", "PREHEAT", "SOAK", "RAMPUP", "PEAK", "COOLDOWN"
-
-/* Reflow oven states. */
+#include "reflow_profiles.h"
+#include "stream.h"
+#include "modbus.h"
+#include "timestamp.h"
+#include "boot.h"
+#include "board_model.h"
+#include "tc_fusion.h"
+
+/* Reflow oven states, declared in reflow_sm.def. */
 typedef enum
 {
-    RESET_STATE,
+#define REFLOW_STATE(id, entry) id##_STATE,
+#include "reflow_sm.def"
 
-    /* Reflow profile phases. */
-    PREHEAT_STATE,
-    SOAK_STATE,
-    RAMPUP_STATE,
-    PEAK_STATE,
-    COOLDOWN_STATE,
-
-    NUM_REFLOW_STATES,
-    NUM_PROFILE_PHASES = NUM_REFLOW_STATES - 1
+    NUM_REFLOW_STATES
 } Reflow_State;
 
+_Static_assert(COOLDOWN_STATE == NUM_PROFILE_PHASES, "Each profile phase needs a reflow state");
+
 /* Status code when returning from event handler. */
 typedef enum
 {
@@ -46,18 +46,14 @@ typedef enum
     INIT_STATUS,    // Initial state transition was taken.
 } Reflow_Status;
 
-/* Reflow profile phase characteristic. */
+/* Oven thermocouple readings and their vote */
 typedef struct
 {
-    enum
-    {
-        REACHTEMP,      // Attain a specific temperature with maximum gradient.
-        REACHTIME,      // Run profile element for specified time.
-    } const phase_type; // REACHTEMP or REACHTIME
-
-    uint32_t reach_temp;
-    uint32_t reach_time;
-} Reflow_Phase;
+    float temps[TC_FUSION_MAX_SENSORS]; // Readings, 0 if faulty.
+    bool valid[TC_FUSION_MAX_SENSORS];  // Readings without fault.
+    MAX31855K_err_t err;                // Error of first faulty thermocouple.
+    tc_fusion_t fusion;                 // Vote.
+} Reflow_TC_Read;
 
 /* Reflow controller active object */
 typedef struct
@@ -71,18 +67,61 @@ typedef struct
     /* Timer instances */
     TimeEvent reflow_time_evt; // Time event for REACHTIME reflow phases.
     osTimerId_t pid_timer_id;  // 1/Ts Hz timer for PID calculations.
+    osTimerId_t modbus_timer_id; // Timer refreshing Modbus register shadow.
+    osTimerId_t element_timer_id; // Timer of inner loop of cascade control.
 
     /* Other variables */
-    Reflow_State state;                                   // State variable for state machine.
-    PID_t pid_params;                                     // PID parameters.
-    float step_size;                                      // Temperature step size for REACHTIME phases (deg C / sample).
-    float setpoint;                                       // Setpoint temperature.
-    const Reflow_Phase reflow_phases[NUM_PROFILE_PHASES]; // Reflow phase characteristics.
+    Reflow_State state;            // State variable for state machine.
+    PID_t pid_params;              // PID parameters.
+    float step_size;               // Temperature step size for REACHTIME phases (deg C / sample).
+    float setpoint;                // Setpoint temperature.
+    const Reflow_Profile *profile; // Active reflow profile (flash-resident).
+    uint32_t sample_seq;           // Sequence number of next control sample.
+    uint32_t step_us;              // Execution time of most recent control step (us).
+    uint32_t step_max_us;          // Longest control step execution time (us).
+    uint16_t alarms;               // REFLOW_ALARM_* bits, reported over Modbus.
+    float output;                  // Most recent PWM output.
+    uint16_t modbus_profile;       // Profile index written over Modbus, applied by the active object.
+
+    /* Cascade control: the outer loop sets the element temperature, the inner loop the PWM output. */
+    bool cascade;           // Use cascade control in the next run.
+    bool cascade_active;    // Current run uses cascade control.
+    PID_t element_pid;      // Inner loop controller, runs every element_pid.Ts.
+    float element_max;      // Maximum element temperature setpoint (deg C).
+    float element_setpoint; // Element temperature setpoint, output of the outer loop.
+    float element_temp;     // Most recent element temperature.
+
+    /* Board temperature observer */
+    Board_t board;          // Board temperature estimate, updated every control step.
+    float board_tau;        // Board lag set by command or calibration (s), 0 to use the profile's.
+    bool board_control;     // Regulate and change phases on the board estimate instead of air.
+    bool board_cal;         // Fit the board lag from the probe thermocouple in the next run.
+    bool board_cal_active;  // Current run fits the board lag.
+    Board_fit_t board_fit;  // Board lag fit of the current run.
+    float probe_temp;       // Most recent probe temperature.
+
+    /* Redundant oven thermocouples */
+    uint8_t fusion_sensors;                          // Number of oven thermocouples voted on.
+    float fusion_threshold;                          // Largest difference between agreeing readings (deg C).
+    Reflow_TC_Read tc;                               // Oven readings published by the timer service task.
+    tc_confidence_t run_confidence;                  // Confidence last reported by the control step.
+    uint32_t tc_faults[TC_FUSION_MAX_SENSORS];       // Control steps with sensor fault.
+    uint32_t tc_outvoted[TC_FUSION_MAX_SENSORS];     // Control steps with sensor outvoted.
+
+    /* Host setpoint streaming */
+    float feedforward;           // Feedforward duty added to PID output (PWM counts).
+    uint32_t stream_rx_tick;     // Tick of most recent setpoint frame, used as watchdog.
+    stream_setpoint_t stream_sp; // Most recent setpoint frame, shared with console thread.
+    stream_sample_t sample;      // Most recent control sample, shared with PID timer.
+
+    /* Replay of recorded temperature traces */
+    bool replay;                   // Temperatures come from host instead of thermocouple, relay stays off.
+    bool replay_started;           // Replayed run has left RESET state.
+    stream_replay_t replay_rx;     // Most recent replay frame, shared with console thread.
+    stream_replay_t replay_sample; // Replay frame used by current control iteration.
+    uint32_t replay_tick;          // Virtual time of replayed run (ms).
 } Reflow_Active;
 
-/* Callback function prototype for event handler. */
-typedef Reflow_Status (*ReflowAction)(Reflow_Active *const ao, Event const *const evt);
-
 static void reflow_evt_handler(Reflow_Active *const ao, Event const *const evt); // Event handler.
 static inline void displayPIDParams();                                           // Display PID parameters.
 static inline void displayProfileParams();                                       // Display reflow profile phase parameters.
@@ -91,23 +130,55 @@ static uint32_t reflow_status_cmd(uint32_t argc, const char **argv);
 static uint32_t reflow_start_cmd(uint32_t argc, const char **argv);              // Start reflow process command handler.
 static uint32_t reflow_stop_cmd(uint32_t argc, const char **argv);               // Stop reflow process command handler.
 static uint32_t reflow_set_cmd(uint32_t argc, const char **argv);                // Set PID parameters.
-static void reflow_pid_iteration(void *argument);                                // Discrete PID controller iteration.
-static inline bool readTemperature(float *const temp);                           // Read thermocouple temperature.
+static uint32_t reflow_profile_cmd(uint32_t argc, const char **argv);            // List or select reflow profiles.
+static uint32_t reflow_stream_cmd(uint32_t argc, const char **argv);             // Enter host-streamed setpoint mode.
+static uint32_t reflow_replay_cmd(uint32_t argc, const char **argv);             // Enter replay mode.
+static uint32_t reflow_cascade_cmd(uint32_t argc, const char **argv);            // Configure cascade control.
+static uint32_t reflow_board_cmd(uint32_t argc, const char **argv);              // Configure board temperature observer.
+static uint32_t reflow_fusion_cmd(uint32_t argc, const char **argv);             // Configure redundant oven thermocouples.
+static void reflow_stream_setpoint(const stream_setpoint_t *sp);                 // Setpoint frame callback.
+static void reflow_replay_temperature(const stream_replay_t *rp);                // Replay frame callback.
+static void reflow_send_sample(Reflow_Active *const ao, uint16_t seq);           // Answer host frame with latest control sample.
+static void reflow_replay_close(Reflow_Active *const ao);                        // Leave replay mode.
+static void reflow_pid_iteration(TimerHandle_t timer);                           // PID timer callback.
+static void reflow_control_step(void);                                           // Discrete PID controller iteration.
+static void reflow_element_iteration(TimerHandle_t timer);                       // Inner loop timer callback.
+static void reflow_element_step(void);                                           // Inner loop iteration of cascade control.
+static void reflow_loops_start(Reflow_Active *const ao);                         // Select control structure and start loop timers.
+static void reflow_fusion_account(void);                                         // Count oven thermocouple faults and votes.
+static bool reflow_board_start(Reflow_Active *const ao, float air_temp);         // Start board estimate and calibration.
+static void reflow_board_fit(Reflow_Active *const ao);                           // Finish board lag calibration.
+static void reflow_modbus_publish(TimerHandle_t timer);                          // Refresh Modbus register shadow.
+static void reflow_modbus_publish_params(void);                                  // Refresh Modbus holding registers.
+static uint8_t reflow_modbus_write(uint16_t addr, uint16_t count, const uint16_t *values); // Apply Modbus register writes.
+static bool readOvenThermocouples(Reflow_TC_Read *const read);                   // Read oven thermocouples and vote.
+static inline bool readTemperature(float *const temp, bool publish);             // Read validated oven temperature.
+static inline bool readThermocouple(uint8_t tc, float *const temp);              // Read one thermocouple.
 
 /* Reflow active object. */
 static Reflow_Active reflow_ao = {
-    .reflow_phases = {{.phase_type = REACHTEMP, .reach_temp = 100},                    // Pre-heat
-                      {.phase_type = REACHTIME, .reach_temp = 150, .reach_time = 120}, // Soak
-                      {.phase_type = REACHTEMP, .reach_temp = 215},                    // Ramp-up
-                      {.phase_type = REACHTIME, .reach_temp = 215, .reach_time = 5},   // Peak
-                      {.phase_type = REACHTEMP, .reach_temp = 35}}                     // Cool-down
-};
+    .profile = &reflow_profiles[REFLOW_PROFILE_DEFAULT],
+    .fusion_sensors = FUSION_SENSORS_INIT,
+    .fusion_threshold = FUSION_THRESHOLD_INIT};
+
+/* Oven thermocouples in voting order. */
+static const uint8_t oven_tcs[TC_FUSION_MAX_SENSORS] = {REFLOW_TC_OVEN, REFLOW_TC_OVEN_B, REFLOW_TC_OVEN_C};
+_Static_assert(FUSION_SENSORS_INIT >= 1 && FUSION_SENSORS_INIT <= TC_FUSION_MAX_SENSORS, "1 to 3 oven thermocouples");
+
+/* Names of confidence values. */
+static const char *tc_conf_names[NUM_TC_CONFS] = {TC_CONF_NAMES_CSV};
+
+/* Thread and event queue of reflow active object. */
+ACTIVE_STATIC_DEF(reflow, REFLOW_THREAD_STACK_SZ, REFLOW_EVENT_MSG_COUNT);
 
 /* Unique module tag for logging information */
 static const char *TAG = "REFLOW";
 
-/* Names of reflow profile phases as null-terminated string constants. */
-static const char *reflow_names[NUM_REFLOW_STATES] = {REFLOW_PROFILE_PHASES_CSV};
+/* Names of reflow states as null-terminated string constants. */
+static const char *reflow_names[NUM_REFLOW_STATES] = {
+#define REFLOW_STATE(id, entry) [id##_STATE] = #id,
+#include "reflow_sm.def"
+};
 
 /* Information about reflow commands. */
 static const cmd_cmd_info reflow_cmd_infos[] = {
@@ -122,11 +193,29 @@ static const cmd_cmd_info reflow_cmd_infos[] = {
      .help = "Stop reflow process."},
     {.cmd_name = "set",
      .cb = &reflow_set_cmd,
-     .help = "Set pid parameters (Kp, Ki, Kd, Tau)\r\nUsage: reflow set <param> <value> [<param2> <value2> ...] "}};
+     .help = "Set pid parameters (Kp, Ki, Kd, Tau, B, C, Tt)\r\nUsage: reflow set <param> <value> [<param2> <value2> ...] "},
+    {.cmd_name = "profile",
+     .cb = &reflow_profile_cmd,
+     .help = "List or select solder paste profiles\r\nUsage: reflow profile [list | use <name>]"},
+    {.cmd_name = "stream",
+     .cb = &reflow_stream_cmd,
+     .help = "Track setpoints streamed from host in binary frames (see stream.h)."},
+    {.cmd_name = "replay",
+     .cb = &reflow_replay_cmd,
+     .help = "Run reflow profile on temperatures replayed from host (see stream.h). Relay stays off."},
+    {.cmd_name = "cascade",
+     .cb = &reflow_cascade_cmd,
+     .help = "Cascade control with element thermocouple\r\nUsage: reflow cascade [on | off | set <Kp | Ki | Kd | Tau | Ts | Max> <value> ...]"},
+    {.cmd_name = "board",
+     .cb = &reflow_board_cmd,
+     .help = "PCB temperature observer\r\nUsage: reflow board [on | off | tau <s> | cal [off]]"},
+    {.cmd_name = "fusion",
+     .cb = &reflow_fusion_cmd,
+     .help = "Vote on redundant oven thermocouples\r\nUsage: reflow fusion [sensors <1-3> | threshold <deg C>]"}};
 
 /* Client information for command module */
 static cmd_client_info reflow_client_info = {.client_name = "reflow", // Client name (first command line token)
-                                             .num_cmds = 4,
+                                             .num_cmds = ARRAY_SIZE(reflow_cmd_infos),
                                              .cmds = reflow_cmd_infos,
                                              .num_u16_pms = 0,
                                              .u16_pms = NULL,
@@ -135,6 +224,9 @@ static cmd_client_info reflow_client_info = {.client_name = "reflow", // Client
 /* Stop reflow process event signal */
 static const Event stop_evt = {.sig = STOP_REFLOW_SIG};
 
+/* Replay frame received event signal */
+static const Event replay_frame_evt = {.sig = REPLAY_FRAME_SIG};
+
 /*---------------------------------------------------------------------------*/
 /* State machine facilities... */
 
@@ -154,11 +246,23 @@ static Reflow_Status Reflow_reset_ENTRY(Reflow_Active *const ao, Event const *co
 
     /* Clear PID memory */
     PID_Reset(&ao->pid_params);
+    PID_Reset(&ao->element_pid);
+    ao->feedforward = 0;
+    ao->output = 0;
+    ao->cascade_active = false;
+
+    /* Finish board lag calibration of the run. */
+    if (ao->board_cal_active)
+    {
+        reflow_board_fit(ao);
+    }
 
     /* Disarm timers */
     osTimerStop(ao->pid_timer_id);
+    osTimerStop(ao->element_timer_id);
     TimeEvent_disarm(&ao->reflow_time_evt);
 
+    boot_mark(BOOT_PHASE_CONTROL);
     LOGI(TAG, "Reflow oven controller initialized.");
     LOGI(TAG, "Enter command \"reflow start\" to start reflow process.");
     return HANDLED_STATUS;
@@ -166,36 +270,46 @@ static Reflow_Status Reflow_reset_ENTRY(Reflow_Active *const ao, Event const *co
 
 static Reflow_Status Reflow_preheat_ENTRY(Reflow_Active *const ao, Event const *const evt)
 {
-    ao->setpoint = (float)ao->reflow_phases[PREHEAT_STATE - 1].reach_temp;
-    osTimerStart(ao->pid_timer_id, (uint32_t)(ao->pid_params.Ts * 1000));
+    ao->setpoint = (float)ao->profile->phases[PREHEAT_STATE - 1].reach_temp;
+    reflow_loops_start(ao);
     return HANDLED_STATUS;
 }
 
 static Reflow_Status Reflow_soak_ENTRY(Reflow_Active *const ao, Event const *const evt)
 {
     /* Set step size for slowest temperature rise. */
-    ao->step_size = (float)(ao->reflow_phases[SOAK_STATE - 1].reach_temp - ao->reflow_phases[PREHEAT_STATE - 1].reach_temp) /
-                    (ao->reflow_phases[SOAK_STATE - 1].reach_time * (1 / ao->pid_params.Ts));
-    TimeEvent_arm(&ao->reflow_time_evt, ao->reflow_phases[SOAK_STATE - 1].reach_time, 0);
+    ao->step_size = (float)(ao->profile->phases[SOAK_STATE - 1].reach_temp - ao->profile->phases[PREHEAT_STATE - 1].reach_temp) /
+                    (ao->profile->phases[SOAK_STATE - 1].reach_time * (1 / ao->pid_params.Ts));
+    TimeEvent_arm(&ao->reflow_time_evt, ao->profile->phases[SOAK_STATE - 1].reach_time, 0);
     return HANDLED_STATUS;
 }
 
 static Reflow_Status Reflow_rampup_ENTRY(Reflow_Active *const ao, Event const *const evt)
 {
-    ao->setpoint = (float)ao->reflow_phases[RAMPUP_STATE - 1].reach_temp;
+    ao->setpoint = (float)ao->profile->phases[RAMPUP_STATE - 1].reach_temp;
     return HANDLED_STATUS;
 }
 
 static Reflow_Status Reflow_peak_ENTRY(Reflow_Active *const ao, Event const *const evt)
 {
     ao->step_size = 0;
-    TimeEvent_arm(&ao->reflow_time_evt, ao->reflow_phases[PEAK_STATE - 1].reach_time, 0);
+    TimeEvent_arm(&ao->reflow_time_evt, ao->profile->phases[PEAK_STATE - 1].reach_time, 0);
     return HANDLED_STATUS;
 }
 
 static Reflow_Status Reflow_cooldown_ENTRY(Reflow_Active *const ao, Event const *const evt)
 {
-    ao->setpoint = (float)ao->reflow_phases[COOLDOWN_STATE - 1].reach_temp;
+    ao->setpoint = (float)ao->profile->phases[COOLDOWN_STATE - 1].reach_temp;
+    return HANDLED_STATUS;
+}
+
+static Reflow_Status Reflow_stream_ENTRY(Reflow_Active *const ao, Event const *const evt)
+{
+    /* Hold output at zero until the first setpoint frame arrives. */
+    ao->setpoint = 0;
+    ao->feedforward = 0;
+    ao->stream_rx_tick = HAL_GetTick();
+    reflow_loops_start(ao);
     return HANDLED_STATUS;
 }
 
@@ -203,27 +317,120 @@ static Reflow_Status Reflow_reset_START(Reflow_Active *const ao, Event const *co
 {
     /* Check that oven temperature has cooled down. */
     float current_temp = 0;
-    if (readTemperature(&current_temp) != true)
+    if (readTemperature(&current_temp, false) != true)
     {
         LOGW(TAG, "MAX31855K Read Error, unable to start reflow process.");
         return HANDLED_STATUS;
     }
-    else if ((uint32_t)current_temp > ao->reflow_phases[COOLDOWN_STATE - 1].reach_temp) // Subtract 1 due to RESET_STATE.)
+    else if ((uint32_t)current_temp > ao->profile->phases[COOLDOWN_STATE - 1].reach_temp) // Subtract 1 due to RESET_STATE.)
+    {
+        LOGW(TAG, "Oven temperature must cool to below %" PRIu32 " before starting another run.",
+             ao->profile->phases[COOLDOWN_STATE - 1].reach_temp);
+        return HANDLED_STATUS;
+    }
+    else if (ao->cascade && !ao->replay && !readThermocouple(REFLOW_TC_ELEMENT, &ao->element_temp))
+    {
+        LOGW(TAG, "Element thermocouple read error, unable to start cascade control.");
+        return HANDLED_STATUS;
+    }
+    else if (!reflow_board_start(ao, current_temp))
     {
-        LOGW(TAG, "Oven temperature must cool to below %lu before starting another run.",
-             ao->reflow_phases[COOLDOWN_STATE - 1].reach_temp);
         return HANDLED_STATUS;
     }
     else
     {
         LOG("Starting reflow process\r\n");
-        HAL_TIM_PWM_Start(ao->pwm_timer_handle, ao->pwm_channel);
+        ao->alarms = 0;
+        if (!ao->replay)
+        {
+            HAL_TIM_PWM_Start(ao->pwm_timer_handle, ao->pwm_channel);
+        }
         LOGI(TAG, "Entering pre-heat phase.");
         ao->state = PREHEAT_STATE;
         return TRAN_STATUS;
     }
 }
 
+static Reflow_Status Reflow_reset_STREAM(Reflow_Active *const ao, Event const *const evt)
+{
+    float current_temp = 0;
+    if (readTemperature(&current_temp, false) != true)
+    {
+        LOGW(TAG, "MAX31855K Read Error, unable to stream setpoints.");
+        return HANDLED_STATUS;
+    }
+    if (ao->cascade && !readThermocouple(REFLOW_TC_ELEMENT, &ao->element_temp))
+    {
+        LOGW(TAG, "Element thermocouple read error, unable to start cascade control.");
+        return HANDLED_STATUS;
+    }
+    if (!reflow_board_start(ao, current_temp))
+    {
+        return HANDLED_STATUS;
+    }
+
+    LOG("Streaming setpoints from host\r\n");
+    stream_open(reflow_stream_setpoint, NULL);
+    HAL_TIM_PWM_Start(ao->pwm_timer_handle, ao->pwm_channel);
+    ao->state = STREAM_STATE;
+    return TRAN_STATUS;
+}
+
+static Reflow_Status Reflow_reset_REPLAY(Reflow_Active *const ao, Event const *const evt)
+{
+    if (ao->replay)
+    {
+        return HANDLED_STATUS;
+    }
+
+    LOG("Replaying recorded temperatures from host\r\n");
+    ao->replay = true;
+    ao->replay_started = false;
+    ao->replay_tick = 0;
+    TimeEvent_use_virtual_clock(true);
+    stream_open(NULL, reflow_replay_temperature);
+    return HANDLED_STATUS;
+}
+
+/* Selected in the active object rather than the Modbus thread, whose stack has no room for logging. */
+static Reflow_Status Reflow_reset_SETPROFILE(Reflow_Active *const ao, Event const *const evt)
+{
+    ao->profile = &reflow_profiles[ao->modbus_profile];
+    LOGI(TAG, "Using profile %s", ao->profile->name);
+    reflow_modbus_publish_params();
+    return HANDLED_STATUS;
+}
+
+/* The first replay frame starts the run like "reflow start", frames after the run has ended or stopped are only answered. */
+static Reflow_Status Reflow_reset_REPLAYFRAME(Reflow_Active *const ao, Event const *const evt)
+{
+    if (!ao->replay)
+    {
+        return IGNORE_STATUS;
+    }
+
+    osKernelLock();
+    ao->replay_sample = ao->replay_rx;
+    osKernelUnlock();
+
+    if (ao->replay_sample.flags & STREAM_FLAG_STOP)
+    {
+        reflow_replay_close(ao);
+        return HANDLED_STATUS;
+    }
+
+    if (!ao->replay_started && Reflow_reset_START(ao, evt) == TRAN_STATUS)
+    {
+        /* Frame also carries the first control sample, handle it again once pre-heat is entered. */
+        ao->replay_started = true;
+        Active_post(&ao->reflow_base, &replay_frame_evt);
+        return TRAN_STATUS;
+    }
+
+    reflow_send_sample(ao, ao->replay_sample.seq);
+    return HANDLED_STATUS;
+}
+
 static Reflow_Status Reflow_preheat_REACHTEMP(Reflow_Active *const ao, Event const *const evt)
 {
     LOGI(TAG, "Entering soak phase.");
@@ -267,20 +474,81 @@ static Reflow_Status Reflow_STOP(Reflow_Active *const ao, Event const *const evt
     return TRAN_STATUS;
 }
 
-static Reflow_Status Reflow_ignore(Reflow_Active *const ao, Event const *const evt)
+static Reflow_Status Reflow_stream_STOP(Reflow_Active *const ao, Event const *const evt)
+{
+    stream_close();
+    return Reflow_STOP(ao, evt);
+}
+
+static Reflow_Status Reflow_stream_FRAME(Reflow_Active *const ao, Event const *const evt)
 {
-    return IGNORE_STATUS;
+    /* Take a consistent copy of data shared with other threads. */
+    osKernelLock();
+    stream_setpoint_t sp = ao->stream_sp;
+    osKernelUnlock();
+
+    if (sp.flags & STREAM_FLAG_STOP)
+    {
+        return Reflow_stream_STOP(ao, evt);
+    }
+
+    ao->setpoint = sp.setpoint;
+    ao->feedforward = (sp.flags & STREAM_FLAG_FEEDFORWARD) ? sp.feedforward : 0;
+    ao->stream_rx_tick = HAL_GetTick();
+
+    /* Answer every frame with the latest control sample. */
+    reflow_send_sample(ao, sp.seq);
+    return HANDLED_STATUS;
+}
+
+static Reflow_Status Reflow_replay_FRAME(Reflow_Active *const ao, Event const *const evt)
+{
+    if (!ao->replay)
+    {
+        return IGNORE_STATUS;
+    }
+
+    osKernelLock();
+    ao->replay_sample = ao->replay_rx;
+    osKernelUnlock();
+
+    if (ao->replay_sample.flags & STREAM_FLAG_STOP)
+    {
+        reflow_replay_close(ao);
+        return Reflow_STOP(ao, evt);
+    }
+
+    /* Run control iteration on recorded sample in lockstep with host. */
+    reflow_control_step();
+    reflow_send_sample(ao, ao->replay_sample.seq);
+    return HANDLED_STATUS;
 }
 
-/* State machine table */
-static const ReflowAction Reflow_state_table[NUM_REFLOW_STATES][NUM_REFLOW_SIGS] = {
-    /*              INIT_SIG,    ENTRY_SIG,    START_REFLOW_SIG,    REACH_TIME_SIG,    REACH_TEMP_SIG,    STOP_REFLOW_SIG */
-    /* RESET  	*/ {Reflow_reset_INIT, Reflow_reset_ENTRY, Reflow_reset_START, Reflow_ignore, Reflow_ignore, Reflow_ignore},
-    /* PREHEAT 	*/ {Reflow_ignore, Reflow_preheat_ENTRY, Reflow_ignore, Reflow_ignore, Reflow_preheat_REACHTEMP, Reflow_STOP},
-    /* SOAK 	*/ {Reflow_ignore, Reflow_soak_ENTRY, Reflow_ignore, Reflow_soak_REACHTIME, Reflow_ignore, Reflow_STOP},
-    /* RAMPUP 	*/ {Reflow_ignore, Reflow_rampup_ENTRY, Reflow_ignore, Reflow_ignore, Reflow_rampup_REACHTEMP, Reflow_STOP},
-    /* PEAK 	*/ {Reflow_ignore, Reflow_peak_ENTRY, Reflow_ignore, Reflow_peak_REACHTIME, Reflow_ignore, Reflow_STOP},
-    /* COOLDOWN */ {Reflow_ignore, Reflow_cooldown_ENTRY, Reflow_ignore, Reflow_ignore, Reflow_cooldown_REACHTEMP, Reflow_STOP}};
+/* Index of the (state, signal) pair in the dispatch switch. */
+#define REFLOW_SM_CASE(state, sig) ((state)*NUM_REFLOW_SIGS + (sig))
+
+/**
+ * @brief Dispatch event to the action of the current state, generated from reflow_sm.def.
+ *
+ * The case values are dense, so the switch compiles to a single byte-wide branch table and the
+ * actions, each called from one place, can be inlined. Unlisted pairs are ignored.
+ */
+static Reflow_Status reflow_dispatch(Reflow_Active *const ao, Event const *const evt)
+{
+    switch (REFLOW_SM_CASE(ao->state, evt->sig))
+    {
+#define REFLOW_STATE(id, entry)                    \
+    case REFLOW_SM_CASE(id##_STATE, ENTRY_SIG):    \
+        return entry(ao, evt);
+#define REFLOW_TRANSITION(state, sig, action)      \
+    case REFLOW_SM_CASE(state##_STATE, sig##_SIG): \
+        return action(ao, evt);
+#include "reflow_sm.def"
+
+    default:
+        return IGNORE_STATUS;
+    }
+}
 
 void reflow_init(Reflow_cfg_t const *const reflow_cfg)
 {
@@ -298,51 +566,132 @@ void reflow_init(Reflow_cfg_t const *const reflow_cfg)
                                              .Kd = KD_INIT,
                                              .tau = TAU_INIT,
                                              .Ts = TS_INIT,
+                                             .b = B_INIT,
+                                             .c = C_INIT,
+                                             .Tt = TT_INIT,
                                              .out_max = OUT_MAX_INIT,
                                              .out_min = OUT_MIN_INIT};
     PID_Init(&reflow_ao.pid_params, &reflow_pid_cfg);
 
+    /* Inner loop of cascade control, off until enabled with "reflow cascade on". */
+    static const PID_cfg_t element_pid_cfg = {.Kp = ELEMENT_KP_INIT,
+                                              .Ki = ELEMENT_KI_INIT,
+                                              .Kd = ELEMENT_KD_INIT,
+                                              .tau = ELEMENT_TAU_INIT,
+                                              .Ts = ELEMENT_TS_INIT,
+                                              .b = B_INIT,
+                                              .c = C_INIT,
+                                              .Tt = TT_INIT,
+                                              .out_max = OUT_MAX_INIT,
+                                              .out_min = OUT_MIN_INIT};
+    PID_Init(&reflow_ao.element_pid, &element_pid_cfg);
+    reflow_ao.element_max = ELEMENT_TEMP_MAX_INIT;
+
     /* Initialize timer instances. */
     TimeEvent_ctor(&reflow_ao.reflow_time_evt, REACH_TIME_SIG, (Active *)&reflow_ao);
-    reflow_ao.pid_timer_id = osTimerNew(reflow_pid_iteration, osTimerPeriodic, NULL, NULL);
+    static StaticTimer_t pid_timer_cb, modbus_timer_cb, element_timer_cb;
+    reflow_ao.pid_timer_id = Active_timer_new("pid", reflow_pid_iteration, &pid_timer_cb);
+    reflow_ao.modbus_timer_id = Active_timer_new("reflow_modbus", reflow_modbus_publish, &modbus_timer_cb);
+    reflow_ao.element_timer_id = Active_timer_new("element", reflow_element_iteration, &element_timer_cb);
+    ASSERT(reflow_ao.pid_timer_id != NULL && reflow_ao.modbus_timer_id != NULL && reflow_ao.element_timer_id != NULL);
+
+    /* Accept parameter and command writes from Modbus master. */
+    modbus_set_write_cb(reflow_modbus_write);
 
     /* Register reflow commands */
     cmd_register(&reflow_client_info);
 
-    /* Initialize thermocouple IC */
-    MAX31855K_Init(&reflow_cfg->max_cfg);
+    /* Initialize thermocouple ICs */
+    for (uint8_t tc = 0; tc < NUM_REFLOW_TCS; tc++)
+    {
+        MAX31855K_Init(tc, &reflow_cfg->max_cfg[tc]);
+    }
 
     LOGI(TAG, "Initialized reflow module.");
 }
 
 void reflow_start()
 {
-    osThreadAttr_t reflow_thread_attr = {.stack_size = REFLOW_THREAD_STACK_SZ};
-    Active_start((Active *)&reflow_ao, &reflow_thread_attr, 5, NULL);
+    Active_start((Active *)&reflow_ao, &reflow_thread_attr, REFLOW_EVENT_MSG_COUNT, &reflow_queue_attr);
+    osTimerStart(reflow_ao.modbus_timer_id, REFLOW_MODBUS_PERIOD_MS);
+}
+
+/**
+ * @brief PID timer callback.
+ */
+static void reflow_pid_iteration(TimerHandle_t timer)
+{
+    reflow_control_step();
 }
 
 /**
  * @brief Perform PID iteration.
+ *
+ * Runs from the PID timer, or from the reflow active object for every replay frame.
  */
-static void reflow_pid_iteration(void *argument)
+static void reflow_control_step(void)
 {
+    /* Stamp sample so the host can detect lost samples and rebuild exact timing. */
+    uint64_t start = timestamp_cycles();
+    uint32_t tick = reflow_ao.replay ? reflow_ao.replay_tick : timestamp_ms();
+    uint32_t seq = reflow_ao.sample_seq++;
+
     /* Read temperature */
     float temp_reading = 0;
-    bool status = readTemperature(&temp_reading);
+    bool status = readTemperature(&temp_reading, true);
     if (status == false)
     {
         LOGE(TAG, "Could not read temperature, aborting reflow process.");
+        reflow_ao.alarms |= REFLOW_ALARM_TC_FAULT | REFLOW_ALARM_ABORTED;
         Active_post(&reflow_ao.reflow_base, &stop_evt);
     }
+    else if (!reflow_ao.replay)
+    {
+        reflow_fusion_account();
+    }
 
+    /* Estimate board temperature, which replaces air temperature as process value if selected. */
+    float board_temp = Board_Update(&reflow_ao.board, temp_reading);
+    float pv = reflow_ao.board_control ? board_temp : temp_reading;
+    if (reflow_ao.board_cal_active)
+    {
+        if (readThermocouple(REFLOW_TC_PROBE, &reflow_ao.probe_temp))
+        {
+            Board_Fit_Add(&reflow_ao.board_fit, temp_reading, reflow_ao.probe_temp);
+        }
+        else
+        {
+            LOGW(TAG, "Could not read probe temperature, board lag calibration stopped.");
+            reflow_ao.board_cal_active = false;
+            reflow_ao.board_cal = false;
+        }
+    }
+
+    /* Without a temperature, or if the run stopped while this step waited for the bus or was
+     * preempted by the reflow thread, phases and control law are skipped and the heater is off. */
+    bool control = status && reflow_ao.state != RESET_STATE;
+    if (!control)
+    {
+        /* Heater is turned off below. */
+    }
+    else if (reflow_ao.state == STREAM_STATE)
+    {
+        /* Fall back to safe state if host stopped streaming setpoints. */
+        if (HAL_GetTick() - reflow_ao.stream_rx_tick > STREAM_WATCHDOG_MS)
+        {
+            LOGE(TAG, "Setpoint stream stalled, aborting reflow process.");
+            reflow_ao.alarms |= REFLOW_ALARM_ABORTED;
+            Active_post(&reflow_ao.reflow_base, &stop_evt);
+        }
+    }
     /* Check if temperature reached intended temperature of REACHTEMP phases.
 	 * If so, send REACHTEMP signal to reflow active object.
 	 */
-    if (reflow_ao.reflow_phases[reflow_ao.state - 1].phase_type == REACHTEMP)
+    else if (reflow_ao.profile->phases[reflow_ao.state - 1].phase_type == REACHTEMP)
     {
-        uint32_t reach_temp = reflow_ao.reflow_phases[reflow_ao.state - 1].reach_temp;
+        uint32_t reach_temp = reflow_ao.profile->phases[reflow_ao.state - 1].reach_temp;
         /* Give some leeway. */
-        if (reach_temp > (uint32_t)temp_reading - 2U && reach_temp < (uint32_t)temp_reading + 2U)
+        if (reach_temp > (uint32_t)pv - 2U && reach_temp < (uint32_t)pv + 2U)
         {
             static const Event reachtemp_evt = {.sig = REACH_TEMP_SIG};
             Active_post(&reflow_ao.reflow_base, &reachtemp_evt);
@@ -356,20 +705,398 @@ static void reflow_pid_iteration(void *argument)
         reflow_ao.setpoint += reflow_ao.step_size;
     }
 
-    /* Acquire new PWM output signal through feedback control. */
-    float pwm_value = PID_Calculate(&reflow_ao.pid_params, reflow_ao.setpoint, temp_reading);
+    if (reflow_ao.replay)
+    {
+        /* Each replayed sample advances virtual time by one sampling period. */
+        uint32_t ts_ms = (uint32_t)(reflow_ao.pid_params.Ts * 1000);
+        reflow_ao.replay_tick += ts_ms;
+        TimeEvent_advance(ts_ms);
+    }
 
-    /* Set PWM signal */
-    __HAL_TIM_SET_COMPARE(reflow_ao.pwm_timer_handle, reflow_ao.pwm_channel, (uint16_t)pwm_value);
+    float pwm_value;
+    if (!control)
+    {
+        pwm_value = 0;
+        reflow_ao.output = 0;
+        if (!reflow_ao.replay)
+        {
+            __HAL_TIM_SET_COMPARE(reflow_ao.pwm_timer_handle, reflow_ao.pwm_channel, 0);
+        }
+    }
+    else if (reflow_ao.cascade_active)
+    {
+        /* Outer loop: element setpoint for the inner loop, which sets the PWM signal. */
+        reflow_ao.element_setpoint = PID_Calculate(&reflow_ao.pid_params, reflow_ao.setpoint, pv);
+        pwm_value = reflow_ao.output;
+    }
+    else
+    {
+        /* Acquire new PWM output signal through feedback control and optional feedforward. */
+        pwm_value = PID_Calculate(&reflow_ao.pid_params, reflow_ao.setpoint, pv) + reflow_ao.feedforward;
+        pwm_value = CLAMP(pwm_value, reflow_ao.pid_params.out_lim_min, reflow_ao.pid_params.out_lim_max);
+        reflow_ao.output = pwm_value;
 
-    LOGI(TAG, "%s %.2f %.2f %.2f %.2f %.2f %.2f",
+        /* Set PWM signal */
+        if (!reflow_ao.replay)
+        {
+            __HAL_TIM_SET_COMPARE(reflow_ao.pwm_timer_handle, reflow_ao.pwm_channel, (uint16_t)pwm_value);
+        }
+    }
+
+    /* Record sample for host streaming. */
+    osKernelLock();
+    reflow_ao.sample.state = reflow_ao.state;
+    reflow_ao.sample.sample_seq = seq;
+    reflow_ao.sample.tick = tick;
+    reflow_ao.sample.setpoint = reflow_ao.setpoint;
+    reflow_ao.sample.temperature = temp_reading;
+    reflow_ao.sample.output = pwm_value;
+    osKernelUnlock();
+
+    /* Thermocouple read, control law and PWM update, excluding the telemetry line. */
+    reflow_ao.step_us = timestamp_cycles_to_us(timestamp_cycles() - start);
+    if (reflow_ao.step_us > reflow_ao.step_max_us)
+    {
+        reflow_ao.step_max_us = reflow_ao.step_us;
+    }
+
+    /* Short keys keep kv telemetry small. PID terms are in whole PWM counts, o is the compare value applied. */
+    LOGI(TAG, "s=%s sp=%.2f pv=%.2f p=%.0f i=%.0f d=%.0f o=%u n=%" PRIu32 " k=%" PRIu32 " x=%" PRIu32,
          reflow_names[reflow_ao.state],
          reflow_ao.setpoint,
          temp_reading,
          reflow_ao.pid_params.proportional,
          reflow_ao.pid_params.integral,
          reflow_ao.pid_params.derivative,
-         pwm_value);
+         (uint16_t)pwm_value,
+         seq,
+         tick,
+         reflow_ao.step_us);
+    if (reflow_ao.cascade_active)
+    {
+        LOGI(TAG, "esp=%.2f epv=%.2f ep=%.0f ei=%.0f ed=%.0f n=%" PRIu32,
+             reflow_ao.element_setpoint,
+             reflow_ao.element_temp,
+             reflow_ao.element_pid.proportional,
+             reflow_ao.element_pid.integral,
+             reflow_ao.element_pid.derivative,
+             seq);
+    }
+    if (reflow_ao.fusion_sensors == 3 && !reflow_ao.replay)
+    {
+        LOGI(TAG, "t0=%.2f t1=%.2f t2=%.2f c=%s n=%" PRIu32,
+             reflow_ao.tc.temps[0], reflow_ao.tc.temps[1], reflow_ao.tc.temps[2],
+             tc_conf_names[reflow_ao.tc.fusion.confidence], seq);
+    }
+    else if (reflow_ao.fusion_sensors == 2 && !reflow_ao.replay)
+    {
+        LOGI(TAG, "t0=%.2f t1=%.2f c=%s n=%" PRIu32,
+             reflow_ao.tc.temps[0], reflow_ao.tc.temps[1], tc_conf_names[reflow_ao.tc.fusion.confidence], seq);
+    }
+    if (reflow_ao.board_cal_active)
+    {
+        LOGI(TAG, "pcb=%.2f probe=%.2f n=%" PRIu32, board_temp, reflow_ao.probe_temp, seq);
+    }
+    else if (reflow_ao.board_control)
+    {
+        LOGI(TAG, "pcb=%.2f n=%" PRIu32, board_temp, seq);
+    }
+}
+
+/**
+ * @brief Inner loop timer callback.
+ */
+static void reflow_element_iteration(TimerHandle_t timer)
+{
+    reflow_element_step();
+}
+
+/**
+ * @brief Perform inner loop iteration of cascade control.
+ *
+ * Runs from its own timer every element_pid.Ts, in the same timer thread as the outer loop,
+ * so the element's thermal lag is corrected several times per outer sample.
+ */
+static void reflow_element_step(void)
+{
+    float element_temp = 0;
+    if (!readThermocouple(REFLOW_TC_ELEMENT, &element_temp))
+    {
+        /* Element temperature unknown, turn heater off until the run is stopped. */
+        __HAL_TIM_SET_COMPARE(reflow_ao.pwm_timer_handle, reflow_ao.pwm_channel, 0);
+        reflow_ao.output = 0;
+        if (!(reflow_ao.alarms & REFLOW_ALARM_TC_FAULT))
+        {
+            LOGE(TAG, "Could not read element temperature, aborting reflow process.");
+            reflow_ao.alarms |= REFLOW_ALARM_TC_FAULT | REFLOW_ALARM_ABORTED;
+            Active_post(&reflow_ao.reflow_base, &stop_evt);
+        }
+        return;
+    }
+
+    float pwm_value = PID_Calculate(&reflow_ao.element_pid, reflow_ao.element_setpoint, element_temp) + reflow_ao.feedforward;
+    pwm_value = CLAMP(pwm_value, reflow_ao.element_pid.out_lim_min, reflow_ao.element_pid.out_lim_max);
+    __HAL_TIM_SET_COMPARE(reflow_ao.pwm_timer_handle, reflow_ao.pwm_channel, (uint16_t)pwm_value);
+
+    reflow_ao.element_temp = element_temp;
+    reflow_ao.output = pwm_value;
+}
+
+/**
+ * @brief Count sensor faults and outvoted sensors of the last oven read, and report changes in confidence.
+ *
+ * A run continues as long as one oven thermocouple can be read; losing redundancy raises
+ * REFLOW_ALARM_TC_VOTE instead.
+ */
+static void reflow_fusion_account(void)
+{
+    for (uint8_t i = 0; i < reflow_ao.fusion_sensors; i++)
+    {
+        if (!reflow_ao.tc.valid[i])
+        {
+            reflow_ao.tc_faults[i]++;
+        }
+        else if (reflow_ao.tc.fusion.outvoted & (1 << i))
+        {
+            reflow_ao.tc_outvoted[i]++;
+        }
+    }
+
+    tc_confidence_t conf = reflow_ao.tc.fusion.confidence;
+    if (conf != reflow_ao.run_confidence)
+    {
+        if (conf > reflow_ao.run_confidence)
+        {
+            LOGW(TAG, "Oven temperature confidence dropped to %s (used 0x%x, outvoted 0x%x).",
+                 tc_conf_names[conf], reflow_ao.tc.fusion.used, reflow_ao.tc.fusion.outvoted);
+            reflow_ao.alarms |= REFLOW_ALARM_TC_VOTE;
+        }
+        else
+        {
+            LOGI(TAG, "Oven temperature confidence back to %s.", tc_conf_names[conf]);
+        }
+        reflow_ao.run_confidence = conf;
+    }
+}
+
+/**
+ * @brief Start board temperature estimate at oven temperature and arm board lag calibration.
+ *
+ * The board is assumed to have settled at oven temperature before a run. Replayed runs have no
+ * probe temperature and are never calibrated.
+ *
+ * @return false if calibration is armed but the probe thermocouple cannot be read.
+ */
+static bool reflow_board_start(Reflow_Active *const ao, float air_temp)
+{
+    float tau = ao->board_tau > 0.0f ? ao->board_tau : (float)ao->profile->board_tau;
+    Board_Init(&ao->board, tau, ao->pid_params.Ts, air_temp);
+
+    ao->board_cal_active = ao->board_cal && !ao->replay;
+    if (ao->board_cal_active)
+    {
+        if (!readThermocouple(REFLOW_TC_PROBE, &ao->probe_temp))
+        {
+            LOGW(TAG, "Probe thermocouple read error, unable to calibrate board lag.");
+            ao->board_cal_active = false;
+            return false;
+        }
+        Board_Fit_Reset(&ao->board_fit, ao->probe_temp);
+    }
+    return true;
+}
+
+/**
+ * @brief Fit board lag from the run just finished and use it for the following runs.
+ */
+static void reflow_board_fit(Reflow_Active *const ao)
+{
+    ao->board_cal_active = false;
+    ao->board_cal = false;
+
+    float tau = 0;
+    if (Board_Fit_Tau(&ao->board_fit, ao->pid_params.Ts, &tau))
+    {
+        ao->board_tau = tau;
+        LOGI(TAG, "Board lag fitted: %.1f s from %" PRIu32 " samples.", tau, ao->board_fit.samples);
+    }
+    else
+    {
+        LOGW(TAG, "Board lag fit failed, the run did not heat the test board enough.");
+    }
+}
+
+/**
+ * @brief Select direct or cascade control for a run and start the loop timers.
+ *
+ * Replayed runs have no element temperature and always use direct control.
+ */
+static void reflow_loops_start(Reflow_Active *const ao)
+{
+    ao->cascade_active = ao->cascade && !ao->replay;
+    ao->run_confidence = TC_CONF_HIGH;
+
+    /* The outer loop outputs an element temperature in cascade, a PWM value otherwise. */
+    ao->pid_params.out_lim_min = ao->cascade_active ? 0.0f : OUT_MIN_INIT;
+    ao->pid_params.out_lim_max = ao->cascade_active ? ao->element_max : OUT_MAX_INIT;
+
+    if (ao->replay)
+    {
+        return;
+    }
+    osTimerStart(ao->pid_timer_id, (uint32_t)(ao->pid_params.Ts * 1000));
+    if (ao->cascade_active)
+    {
+        ao->element_setpoint = 0;
+        osTimerStart(ao->element_timer_id, (uint32_t)(ao->element_pid.Ts * 1000));
+    }
+}
+
+/**
+ * @brief Refresh Modbus register shadow from the latest control sample.
+ *
+ * Runs from a timer so that Modbus requests never touch the control loop.
+ */
+static void reflow_modbus_publish(TimerHandle_t timer)
+{
+    /* No control samples are taken in RESET state, keep published readings current. */
+    bool idle = reflow_ao.state == RESET_STATE && !reflow_ao.replay;
+    float temp = 0;
+    bool temp_valid = idle && readTemperature(&temp, true);
+
+    osKernelLock();
+    stream_sample_t sample = reflow_ao.sample;
+    Reflow_TC_Read tc = reflow_ao.tc;
+    osKernelUnlock();
+
+    if (idle)
+    {
+        if (temp_valid)
+        {
+            sample.temperature = temp;
+        }
+        sample.setpoint = 0;
+        sample.output = 0;
+    }
+
+    uint16_t input_regs[NUM_REFLOW_INPUT_REGS] = {
+        [REFLOW_IR_STATE] = reflow_ao.state,
+        [REFLOW_IR_SETPOINT] = (uint16_t)(int16_t)(sample.setpoint * 10),
+        [REFLOW_IR_TEMPERATURE] = (uint16_t)(int16_t)(sample.temperature * 10),
+        [REFLOW_IR_OUTPUT] = (uint16_t)sample.output,
+        [REFLOW_IR_ALARMS] = reflow_ao.alarms,
+        [REFLOW_IR_TC_ERROR] = tc.err,
+        [REFLOW_IR_PROFILE] = reflow_ao.profile - reflow_profiles,
+        [REFLOW_IR_SAMPLE_SEQ_H] = sample.sample_seq >> 16,
+        [REFLOW_IR_SAMPLE_SEQ_L] = sample.sample_seq & 0xFFFF,
+        [REFLOW_IR_TICK_H] = sample.tick >> 16,
+        [REFLOW_IR_TICK_L] = sample.tick & 0xFFFF,
+        [REFLOW_IR_TC_CONFIDENCE] = reflow_ao.replay ? TC_CONF_HIGH : tc.fusion.confidence};
+    modbus_update_input_regs(0, NUM_REFLOW_INPUT_REGS, input_regs);
+
+    /* Parameters may also have been changed from the console. */
+    reflow_modbus_publish_params();
+}
+
+static void reflow_modbus_publish_params(void)
+{
+    uint16_t holding_regs[NUM_REFLOW_HOLDING_REGS] = {
+        [REFLOW_HR_COMMAND] = 0,
+        [REFLOW_HR_PROFILE] = reflow_ao.profile - reflow_profiles,
+        [REFLOW_HR_KP] = (uint16_t)(reflow_ao.pid_params.Kp * 100),
+        [REFLOW_HR_KI] = (uint16_t)(reflow_ao.pid_params.Ki * 100),
+        [REFLOW_HR_KD] = (uint16_t)(reflow_ao.pid_params.Kd * 100),
+        [REFLOW_HR_TAU] = (uint16_t)(reflow_ao.pid_params.tau * 100),
+        [REFLOW_HR_B] = (uint16_t)(reflow_ao.pid_params.b * 100),
+        [REFLOW_HR_C] = (uint16_t)(reflow_ao.pid_params.c * 100),
+        [REFLOW_HR_TT] = (uint16_t)(reflow_ao.pid_params.Tt * 100)};
+    modbus_update_holding_regs(0, NUM_REFLOW_HOLDING_REGS, holding_regs);
+}
+
+/**
+ * @brief Validate and apply writes to Modbus holding registers.
+ *
+ * Called from the Modbus thread. Either all registers of a request are applied or none. Nothing is
+ * logged here, the profile is selected and logged by the active object.
+ */
+static uint8_t reflow_modbus_write(uint16_t addr, uint16_t count, const uint16_t *values)
+{
+    if ((uint32_t)addr + count > NUM_REFLOW_HOLDING_REGS)
+    {
+        return MODBUS_EX_ILLEGAL_DATA_ADDRESS;
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint16_t reg = addr + i;
+        if (reg == REFLOW_HR_COMMAND && values[i] != REFLOW_CMD_START && values[i] != REFLOW_CMD_STOP)
+        {
+            return MODBUS_EX_ILLEGAL_DATA_VALUE;
+        }
+        else if (reg == REFLOW_HR_PROFILE && values[i] >= NUM_REFLOW_PROFILES)
+        {
+            return MODBUS_EX_ILLEGAL_DATA_VALUE;
+        }
+        else if (reg == REFLOW_HR_PROFILE && reflow_ao.state != RESET_STATE)
+        {
+            return MODBUS_EX_DEVICE_BUSY;
+        }
+        else if ((reg == REFLOW_HR_B || reg == REFLOW_HR_C) && values[i] > 100)
+        {
+            return MODBUS_EX_ILLEGAL_DATA_VALUE;
+        }
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        float val = values[i] / 100.0f;
+        switch (addr + i)
+        {
+        case REFLOW_HR_COMMAND:
+            if (values[i] == REFLOW_CMD_START)
+            {
+                static const Event start_evt = {.sig = START_REFLOW_SIG};
+                Active_post(&reflow_ao.reflow_base, &start_evt);
+            }
+            else
+            {
+                Active_post(&reflow_ao.reflow_base, &stop_evt);
+            }
+            break;
+        case REFLOW_HR_PROFILE:
+        {
+            static const Event profile_evt = {.sig = SET_PROFILE_SIG};
+            reflow_ao.modbus_profile = values[i];
+            Active_post(&reflow_ao.reflow_base, &profile_evt);
+            break;
+        }
+        case REFLOW_HR_KP:
+            reflow_ao.pid_params.Kp = val;
+            break;
+        case REFLOW_HR_KI:
+            reflow_ao.pid_params.Ki = val;
+            break;
+        case REFLOW_HR_KD:
+            reflow_ao.pid_params.Kd = val;
+            break;
+        case REFLOW_HR_TAU:
+            reflow_ao.pid_params.tau = val;
+            break;
+        case REFLOW_HR_B:
+            reflow_ao.pid_params.b = val;
+            break;
+        case REFLOW_HR_C:
+            reflow_ao.pid_params.c = val;
+            break;
+        case REFLOW_HR_TT:
+            reflow_ao.pid_params.Tt = val;
+            break;
+        }
+    }
+
+    /* Answer reads with the new values right away. */
+    reflow_modbus_publish_params();
+    return MODBUS_EX_NONE;
 }
 
 /**
@@ -380,14 +1107,35 @@ static uint32_t reflow_status_cmd(uint32_t argc, const char **argv)
     displayPIDParams();
     displayProfileParams();
     displayState();
-    float oven_temp = 0;
-    if (readTemperature(&oven_temp))
+
+    /* Show the last published vote. Only the control step and the Modbus timer read the oven thermocouples. */
+    osKernelLock();
+    Reflow_TC_Read tc = reflow_ao.tc;
+    float sample_temp = reflow_ao.sample.temperature;
+    osKernelUnlock();
+    if (reflow_ao.replay)
+    {
+        LOG("Oven temperature: %.2f\tReplayed\r\n", sample_temp);
+    }
+    else if (tc.fusion.confidence != TC_CONF_NONE)
     {
-        LOG("Oven temperature: %.2f\r\n", oven_temp);
+        LOG("Oven temperature: %.2f\tConfidence: %s\r\n", tc.fusion.temp, tc_conf_names[tc.fusion.confidence]);
     }
     else
     {
-        LOG("Oven temperature read error: %s\r\n", MAX31855K_Err_Str());
+        LOG("Oven temperature read error: %s\r\n", MAX31855K_Err_Name(tc.err));
+    }
+    if (reflow_ao.cascade)
+    {
+        float element_temp = 0;
+        if (readThermocouple(REFLOW_TC_ELEMENT, &element_temp))
+        {
+            LOG("Element temperature: %.2f\r\n", element_temp);
+        }
+        else
+        {
+            LOG("Element temperature read error: %s\r\n", MAX31855K_Err_Str(REFLOW_TC_ELEMENT));
+        }
     }
     return 0;
 }
@@ -407,6 +1155,73 @@ static uint32_t reflow_stop_cmd(uint32_t argc, const char **argv)
     return 0;
 }
 
+static uint32_t reflow_stream_cmd(uint32_t argc, const char **argv)
+{
+    static const Event stream_evt = {.sig = STREAM_REFLOW_SIG};
+    Active_post(&reflow_ao.reflow_base, &stream_evt);
+    LOG("Posted STREAM signal to reflow active object.\r\n");
+    return 0;
+}
+
+static uint32_t reflow_replay_cmd(uint32_t argc, const char **argv)
+{
+    static const Event replay_evt = {.sig = REPLAY_REFLOW_SIG};
+    Active_post(&reflow_ao.reflow_base, &replay_evt);
+    LOG("Posted REPLAY signal to reflow active object.\r\n");
+    return 0;
+}
+
+/**
+ * @brief Store setpoint frame received from host and notify reflow active object.
+ *
+ * Called from the console thread.
+ */
+static void reflow_stream_setpoint(const stream_setpoint_t *sp)
+{
+    static const Event frame_evt = {.sig = STREAM_FRAME_SIG};
+    osKernelLock();
+    reflow_ao.stream_sp = *sp;
+    osKernelUnlock();
+    Active_post(&reflow_ao.reflow_base, &frame_evt);
+}
+
+/**
+ * @brief Store replay frame received from host and notify reflow active object.
+ *
+ * Called from the console thread.
+ */
+static void reflow_replay_temperature(const stream_replay_t *rp)
+{
+    osKernelLock();
+    reflow_ao.replay_rx = *rp;
+    osKernelUnlock();
+    Active_post(&reflow_ao.reflow_base, &replay_frame_evt);
+}
+
+/**
+ * @brief Answer host frame with latest control sample.
+ *
+ * @param seq Sequence number of the frame being answered.
+ */
+static void reflow_send_sample(Reflow_Active *const ao, uint16_t seq)
+{
+    osKernelLock();
+    stream_sample_t sample = ao->sample;
+    osKernelUnlock();
+
+    sample.seq = seq;
+    sample.state = ao->state;
+    stream_send_sample(&sample);
+}
+
+static void reflow_replay_close(Reflow_Active *const ao)
+{
+    stream_close();
+    TimeEvent_use_virtual_clock(false);
+    ao->replay = false;
+    LOG("Replay finished\r\n");
+}
+
 static uint32_t reflow_set_cmd(uint32_t argc, const char **argv)
 {
     if (argc % 2 != 0 || argc == 0)
@@ -419,31 +1234,61 @@ static uint32_t reflow_set_cmd(uint32_t argc, const char **argv)
     for (uint8_t i = 0; i < argc; i += 2)
     {
         const char *param = argv[i];
-        char **end_ptr;
-        uint32_t val = strtoul(argv[i + 1], end_ptr, 0);
-        if (strcasecmp(param, "Kp") == 0)
+        char *end_ptr;
+        float val = strtof(argv[i + 1], &end_ptr);
+        if (end_ptr == argv[i + 1] || *end_ptr != '\0')
+        {
+            LOG("Invalid value for %s: %s\r\n", param, argv[i + 1]);
+            return -1;
+        }
+        else if (strcasecmp(param, "Kp") == 0)
         {
 
-            reflow_ao.pid_params.Kp = (float)val;
+            reflow_ao.pid_params.Kp = val;
             LOG("Updated Kp to %.2f\r\n", reflow_ao.pid_params.Kp);
         }
         else if (strcasecmp(param, "Kd") == 0)
         {
 
-            reflow_ao.pid_params.Kd = (float)val;
+            reflow_ao.pid_params.Kd = val;
             LOG("Updated Kd to %.2f\r\n", reflow_ao.pid_params.Kd);
         }
         else if (strcasecmp(param, "Ki") == 0)
         {
 
-            reflow_ao.pid_params.Ki = (float)val;
+            reflow_ao.pid_params.Ki = val;
             LOG("Updated Ki to %.2f\r\n", reflow_ao.pid_params.Ki);
         }
         else if (strcasecmp(param, "Tau") == 0)
         {
-            reflow_ao.pid_params.tau = (float)val;
+            reflow_ao.pid_params.tau = val;
             LOG("Updated tau to %.2f\r\n", reflow_ao.pid_params.tau);
         }
+        else if ((strcasecmp(param, "B") == 0 || strcasecmp(param, "C") == 0) && (val < 0.0f || val > 1.0f))
+        {
+            LOG("Setpoint weight %s must be between 0 and 1\r\n", param);
+            return -1;
+        }
+        else if (strcasecmp(param, "B") == 0)
+        {
+            reflow_ao.pid_params.b = val;
+            LOG("Updated b to %.2f\r\n", reflow_ao.pid_params.b);
+        }
+        else if (strcasecmp(param, "C") == 0)
+        {
+            reflow_ao.pid_params.c = val;
+            LOG("Updated c to %.2f\r\n", reflow_ao.pid_params.c);
+        }
+        else if (strcasecmp(param, "Tt") == 0)
+        {
+            if (val < 0.0f)
+            {
+                LOG("Tt must not be negative\r\n");
+                return -1;
+            }
+            reflow_ao.pid_params.Tt = val;
+            LOG("Updated Tt to %.2f\r\n", reflow_ao.pid_params.Tt);
+        }
         else
         {
             LOG("Unrecognizable PID parameter: %s\r\n", param);
@@ -454,70 +1299,414 @@ static uint32_t reflow_set_cmd(uint32_t argc, const char **argv)
     return 0;
 }
 
+/**
+ * @brief Display or configure cascade control.
+ *
+ * Cascade control can only be switched on or off and its sampling period changed in RESET state.
+ * The outer loop gains ("reflow set") then act on element temperature instead of PWM counts.
+ *
+ * TTYS command format: > reflow cascade [on | off | set <param> <value> [<param2> <value2> ...]].
+ */
+static uint32_t reflow_cascade_cmd(uint32_t argc, const char **argv)
+{
+    if (argc == 0)
+    {
+        PID_t *pid = &reflow_ao.element_pid;
+        LOG("Cascade control: %s%s\r\n", reflow_ao.cascade ? "on" : "off", reflow_ao.cascade_active ? " (running)" : "");
+        LOG("Element Kp: %.2f\tKi: %.2f\tKd: %.2f\tTau: %.2f\tSampling Period: %.2f s\tMax Temperature: %.2f\r\n",
+            pid->Kp, pid->Ki, pid->Kd, pid->tau, pid->Ts, reflow_ao.element_max);
+        return 0;
+    }
+
+    if (argc == 1 && (strcasecmp(argv[0], "on") == 0 || strcasecmp(argv[0], "off") == 0))
+    {
+        if (reflow_ao.state != RESET_STATE)
+        {
+            LOG("Stop reflow process before switching cascade control.\r\n");
+            return -1;
+        }
+        reflow_ao.cascade = strcasecmp(argv[0], "on") == 0;
+        LOG("Cascade control %s\r\n", reflow_ao.cascade ? "on" : "off");
+        return 0;
+    }
+
+    if (argc < 3 || argc % 2 == 0 || strcasecmp(argv[0], "set") != 0)
+    {
+        LOG("Usage: reflow cascade [on | off | set <Kp | Ki | Kd | Tau | Ts | Max> <value> ...]\r\n");
+        return -1;
+    }
+
+    /* Iterate through <param>,<value> pairs */
+    for (uint8_t i = 1; i < argc; i += 2)
+    {
+        const char *param = argv[i];
+        char *end_ptr;
+        float val = strtof(argv[i + 1], &end_ptr);
+        if (end_ptr == argv[i + 1] || *end_ptr != '\0' || val < 0.0f)
+        {
+            LOG("Invalid value for %s: %s\r\n", param, argv[i + 1]);
+            return -1;
+        }
+        else if (strcasecmp(param, "Kp") == 0)
+        {
+            reflow_ao.element_pid.Kp = val;
+        }
+        else if (strcasecmp(param, "Ki") == 0)
+        {
+            reflow_ao.element_pid.Ki = val;
+        }
+        else if (strcasecmp(param, "Kd") == 0)
+        {
+            reflow_ao.element_pid.Kd = val;
+        }
+        else if (strcasecmp(param, "Tau") == 0)
+        {
+            reflow_ao.element_pid.tau = val;
+        }
+        else if (strcasecmp(param, "Ts") == 0)
+        {
+            if (reflow_ao.state != RESET_STATE)
+            {
+                LOG("Stop reflow process before changing the sampling period.\r\n");
+                return -1;
+            }
+            if (val < 0.01f || val > reflow_ao.pid_params.Ts)
+            {
+                LOG("Element sampling period must be between 0.01 and %.2f s\r\n", reflow_ao.pid_params.Ts);
+                return -1;
+            }
+            reflow_ao.element_pid.Ts = val;
+        }
+        else if (strcasecmp(param, "Max") == 0)
+        {
+            reflow_ao.element_max = val;
+            if (reflow_ao.cascade_active)
+            {
+                reflow_ao.pid_params.out_lim_max = val;
+            }
+        }
+        else
+        {
+            LOG("Unrecognizable cascade parameter: %s\r\n", param);
+            return -1;
+        }
+        LOG("Updated element %s to %.2f\r\n", param, val);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Display or configure the board temperature observer.
+ *
+ * The board lag comes from the active profile unless set with "tau" or fitted by a calibration
+ * run. Settings can only be changed in RESET state.
+ *
+ * TTYS command format: > reflow board [on | off | tau <s> | cal [off]].
+ */
+static uint32_t reflow_board_cmd(uint32_t argc, const char **argv)
+{
+    if (argc == 0)
+    {
+        LOG("Board control: %s\tTau: %.1f s (%s)\tEstimate: %.2f\r\n",
+            reflow_ao.board_control ? "on" : "off",
+            reflow_ao.board_tau > 0.0f ? reflow_ao.board_tau : (float)reflow_ao.profile->board_tau,
+            reflow_ao.board_tau > 0.0f ? "set" : "profile",
+            reflow_ao.board.estimate);
+        LOG("Calibration: %s\r\n", reflow_ao.board_cal_active ? "running" : (reflow_ao.board_cal ? "armed" : "off"));
+        return 0;
+    }
+
+    if (reflow_ao.state != RESET_STATE)
+    {
+        LOG("Stop reflow process before changing the board model.\r\n");
+        return -1;
+    }
+
+    if (argc == 1 && (strcasecmp(argv[0], "on") == 0 || strcasecmp(argv[0], "off") == 0))
+    {
+        reflow_ao.board_control = strcasecmp(argv[0], "on") == 0;
+        LOG("Board control %s\r\n", reflow_ao.board_control ? "on" : "off");
+        return 0;
+    }
+    else if (argc == 2 && strcasecmp(argv[0], "tau") == 0)
+    {
+        char *end_ptr;
+        float val = strtof(argv[1], &end_ptr);
+        if (end_ptr == argv[1] || *end_ptr != '\0' || val < 0.0f)
+        {
+            LOG("Invalid value for tau: %s\r\n", argv[1]);
+            return -1;
+        }
+        reflow_ao.board_tau = val;
+        LOG("Board tau %s\r\n", val > 0.0f ? "set" : "taken from profile");
+        return 0;
+    }
+    else if (argc == 1 && strcasecmp(argv[0], "cal") == 0)
+    {
+        float probe_temp = 0;
+        if (!readThermocouple(REFLOW_TC_PROBE, &probe_temp))
+        {
+            LOG("Probe thermocouple read error: %s\r\n", MAX31855K_Err_Str(REFLOW_TC_PROBE));
+            return -1;
+        }
+        reflow_ao.board_cal = true;
+        LOG("Board lag calibration armed for next run\r\n");
+        return 0;
+    }
+    else if (argc == 2 && strcasecmp(argv[0], "cal") == 0 && strcasecmp(argv[1], "off") == 0)
+    {
+        reflow_ao.board_cal = false;
+        LOG("Board lag calibration off\r\n");
+        return 0;
+    }
+
+    LOG("Usage: reflow board [on | off | tau <s> | cal [off]]\r\n");
+    return -1;
+}
+
+/**
+ * @brief Display or configure voting on redundant oven thermocouples.
+ *
+ * The number of sensors can only be changed in RESET state.
+ *
+ * TTYS command format: > reflow fusion [sensors <1-3> | threshold <deg C>].
+ */
+static uint32_t reflow_fusion_cmd(uint32_t argc, const char **argv)
+{
+    if (argc == 0)
+    {
+        osKernelLock(); // Published by the timer service task.
+        Reflow_TC_Read tc = reflow_ao.tc;
+        osKernelUnlock();
+        LOG("Oven thermocouples: %u\tThreshold: %.2f\tConfidence: %s\r\n",
+            reflow_ao.fusion_sensors, reflow_ao.fusion_threshold, tc_conf_names[tc.fusion.confidence]);
+        for (uint8_t i = 0; i < reflow_ao.fusion_sensors; i++)
+        {
+            const char *vote = !tc.valid[i] ? "fault" : ((tc.fusion.outvoted & (1 << i)) ? "outvoted" : "used");
+            LOG("t%u (max %u): %.2f\t%s\tFaults: %" PRIu32 "\tOutvoted: %" PRIu32 "\r\n",
+                i, oven_tcs[i], tc.temps[i], vote, reflow_ao.tc_faults[i], reflow_ao.tc_outvoted[i]);
+        }
+        return 0;
+    }
+
+    char *end_ptr = NULL;
+    float val = argc == 2 ? strtof(argv[1], &end_ptr) : 0.0f;
+    if (argc != 2 || end_ptr == argv[1] || *end_ptr != '\0')
+    {
+        LOG("Usage: reflow fusion [sensors <1-3> | threshold <deg C>]\r\n");
+        return -1;
+    }
+    else if (strcasecmp(argv[0], "sensors") == 0)
+    {
+        if (reflow_ao.state != RESET_STATE)
+        {
+            LOG("Stop reflow process before changing the number of oven thermocouples.\r\n");
+            return -1;
+        }
+        if (val != 1.0f && val != 2.0f && val != 3.0f)
+        {
+            LOG("Number of oven thermocouples must be 1, 2 or 3\r\n");
+            return -1;
+        }
+        reflow_ao.fusion_sensors = (uint8_t)val;
+        memset(reflow_ao.tc_faults, 0, sizeof(reflow_ao.tc_faults));
+        memset(reflow_ao.tc_outvoted, 0, sizeof(reflow_ao.tc_outvoted));
+    }
+    else if (strcasecmp(argv[0], "threshold") == 0)
+    {
+        if (val <= 0.0f)
+        {
+            LOG("Threshold must be positive\r\n");
+            return -1;
+        }
+        reflow_ao.fusion_threshold = val;
+    }
+    else
+    {
+        LOG("Unrecognizable fusion parameter: %s\r\n", argv[0]);
+        return -1;
+    }
+
+    LOG("Updated %s to %.2f\r\n", argv[0], val);
+    return 0;
+}
+
+/**
+ * @brief List available reflow profiles or select one by name.
+ *
+ * Selecting a profile only updates a pointer into the flash-resident profile table.
+ */
+static uint32_t reflow_profile_cmd(uint32_t argc, const char **argv)
+{
+    if (argc == 0 || (argc == 1 && strcasecmp(argv[0], "list") == 0))
+    {
+        for (uint8_t i = 0; i < NUM_REFLOW_PROFILES; i++)
+        {
+            const Reflow_Profile *profile = &reflow_profiles[i];
+            LOG("%c %s\tPre-heat: %" PRIu32 "\tSoak: %" PRIu32 " (%" PRIu32 " s)\tPeak: %" PRIu32 " (%" PRIu32 " s)\tCool-down: %" PRIu32 "\tBoard lag: %" PRIu32 " s\r\n",
+                profile == reflow_ao.profile ? '*' : ' ',
+                profile->name,
+                profile->phases[PREHEAT_STATE - 1].reach_temp,
+                profile->phases[SOAK_STATE - 1].reach_temp,
+                profile->phases[SOAK_STATE - 1].reach_time,
+                profile->phases[PEAK_STATE - 1].reach_temp,
+                profile->phases[PEAK_STATE - 1].reach_time,
+                profile->phases[COOLDOWN_STATE - 1].reach_temp,
+                profile->board_tau);
+        }
+        return 0;
+    }
+
+    if (argc != 2 || strcasecmp(argv[0], "use") != 0)
+    {
+        LOG("Usage: reflow profile [list | use <name>]\r\n");
+        return -1;
+    }
+
+    const Reflow_Profile *profile = reflow_profile_find(argv[1]);
+    if (profile == NULL)
+    {
+        LOG("Unknown profile: %s\r\n", argv[1]);
+        return -1;
+    }
+    else if (reflow_ao.state != RESET_STATE)
+    {
+        LOG("Stop reflow process before changing profile.\r\n");
+        return -1;
+    }
+
+    reflow_ao.profile = profile;
+    LOG("Using profile %s\r\n", profile->name);
+    return 0;
+}
+
 static void reflow_evt_handler(Reflow_Active *const ao, Event const *const evt)
 {
-    /* Use state table to handle events */
+    static const Event entry_evt = {.sig = ENTRY_SIG};
+
     ASSERT((ao->state < NUM_REFLOW_STATES) && (evt->sig < NUM_REFLOW_SIGS));
-    Reflow_Status stat = Reflow_state_table[ao->state][evt->sig](ao, evt);
+    Reflow_Status stat = reflow_dispatch(ao, evt);
 
     /**
 	 * Execute entry action of current state if
-	 * state transition was taken.
+	 * state transition was taken, or of the initial state.
 	 */
-    if (stat == TRAN_STATUS)
+    if (stat == TRAN_STATUS || stat == INIT_STATUS)
     {
         ASSERT(ao->state < NUM_REFLOW_STATES);
-        Reflow_state_table[ao->state][ENTRY_SIG](ao, (Event *)0);
-    }
-    else if (stat == INIT_STATUS)
-    {
-        /* Execute entry action of initial state. */
-        Reflow_state_table[ao->state][ENTRY_SIG](ao, (Event *)0);
+        reflow_dispatch(ao, &entry_evt);
     }
 }
 
 static inline void displayPIDParams()
 {
     LOG("Kp: %.2f\tKi: %.2f\tKd: %.2f\tTau: %.2f\r\n"
-        "Sampling Period: %.2f s\tMax Limit: %.2f\tMin Limit: %.2f\r\n",
+        "Sampling Period: %.2f s\tMax Limit: %.2f\tMin Limit: %.2f\r\n"
+        "Setpoint Weights b: %.2f c: %.2f\tTracking Tt: %.2f s\r\n",
         reflow_ao.pid_params.Kp, reflow_ao.pid_params.Ki, reflow_ao.pid_params.Kd,
         reflow_ao.pid_params.tau, reflow_ao.pid_params.Ts,
-        reflow_ao.pid_params.out_lim_max, reflow_ao.pid_params.out_lim_min);
+        reflow_ao.pid_params.out_lim_max, reflow_ao.pid_params.out_lim_min,
+        reflow_ao.pid_params.b, reflow_ao.pid_params.c, reflow_ao.pid_params.Tt);
 }
 
 static inline void displayProfileParams()
 {
+    LOG("Profile: %s\r\n", reflow_ao.profile->name);
     for (uint8_t i = 0; i < NUM_PROFILE_PHASES; i++)
     {
-        LOG("Phase: %s\tType: %s\tReach Temp: %lu deg C\tReach Time: %lu s\r\n",
-            reflow_names[i + 1], reflow_ao.reflow_phases[i].phase_type == REACHTEMP ? "REACHTEMP" : "REACHTIME",
-            reflow_ao.reflow_phases[i].reach_temp,
-            reflow_ao.reflow_phases[i].reach_time);
+        LOG("Phase: %s\tType: %s\tReach Temp: %" PRIu32 " deg C\tReach Time: %" PRIu32 " s\r\n",
+            reflow_names[i + 1], reflow_ao.profile->phases[i].phase_type == REACHTEMP ? "REACHTEMP" : "REACHTIME",
+            reflow_ao.profile->phases[i].reach_temp,
+            reflow_ao.profile->phases[i].reach_time);
     }
 }
 
 static inline void displayState()
 {
     LOG("Current state: %s\r\n", reflow_names[reflow_ao.state]);
+    LOG("Control step: %" PRIu32 " us (max %" PRIu32 " us)\tEvent dispatch: %" PRIu32 " us (max %" PRIu32 " us)\r\n",
+        reflow_ao.step_us, reflow_ao.step_max_us,
+        reflow_ao.reflow_base.dispatch_us, reflow_ao.reflow_base.dispatch_max_us);
 }
 
 /**
- * @brief Read thermocouple temperature.
+ * @brief Read oven thermocouples and vote on the oven temperature.
  *
- * @param[in/out] temp Temperature reading if return value is true, unmodified otherwise.
+ * @param[out] read Readings, error of the first faulty thermocouple and vote.
  *
- * @return true if successful read, false otherwise.
+ * @return true if at least one oven thermocouple was read, false otherwise.
  */
-static inline bool readTemperature(float *const temp)
+static bool readOvenThermocouples(Reflow_TC_Read *const read)
 {
-    MAX31855K_err_t err = MAX31855K_RxBlocking();
-    if (err)
+    memset(read, 0, sizeof(*read));
+    uint8_t num = reflow_ao.fusion_sensors; // May be changed from the console in RESET state.
+
+    bool locked = MAX31855K_Bus_Lock();
+    for (uint8_t i = 0; i < num; i++)
     {
-        return false;
+        MAX31855K_err_t err = MAX31855K_RxBlocking(oven_tcs[i]);
+        read->valid[i] = err == MAX_OK;
+        read->temps[i] = err == MAX_OK ? MAX31855K_Get_HJ(oven_tcs[i]) : 0.0f;
+        if (err != MAX_OK && read->err == MAX_OK)
+        {
+            read->err = err;
+        }
     }
-    else
+    MAX31855K_Bus_Unlock(locked);
+
+    return TC_Fusion_Vote(read->temps, read->valid, num, reflow_ao.fusion_threshold, &read->fusion) != TC_CONF_NONE;
+}
+
+/**
+ * @brief Read validated oven temperature, or take it from the replayed sample.
+ *
+ * @param[in/out] temp Validated temperature if return value is true, unmodified otherwise.
+ * @param[in] publish true to keep readings and vote in reflow_ao.tc for telemetry, Modbus and
+ *                    the status commands. Only the timer service task publishes, so the fault
+ *                    counts of the control step always match the published vote.
+ *
+ * @return true if at least one oven thermocouple was read, false otherwise.
+ */
+static inline bool readTemperature(float *const temp, bool publish)
+{
+    if (reflow_ao.replay)
     {
-        *temp = MAX31855K_Get_HJ();
+        /* Recorded sample from host replaces thermocouple reading. */
+        if (reflow_ao.replay_sample.flags & STREAM_FLAG_FAULT)
+        {
+            return false;
+        }
+        *temp = reflow_ao.replay_sample.temperature;
         return true;
     }
+
+    Reflow_TC_Read read;
+    bool valid = readOvenThermocouples(&read);
+    if (publish)
+    {
+        osKernelLock(); // Shared with console thread.
+        reflow_ao.tc = read;
+        osKernelUnlock();
+    }
+
+    if (!valid)
+    {
+        return false;
+    }
+    *temp = read.fusion.temp;
+    return true;
+}
+
+static inline bool readThermocouple(uint8_t tc, float *const temp)
+{
+    /* No other thread may read the device before its temperature is taken. */
+    bool locked = MAX31855K_Bus_Lock();
+    bool valid = MAX31855K_RxBlocking(tc) == MAX_OK;
+    if (valid)
+    {
+        *temp = MAX31855K_Get_HJ(tc);
+    }
+    MAX31855K_Bus_Unlock(locked);
+    return valid;
 }
@@ -0,0 +1,54 @@
+/**
+ * @file reflow_profiles.c
+ * @author Timothy Nguyen
+ * @brief Compiled-in library of solder paste reflow profiles.
+ * @version 0.1
+ * @date 2021-08-02
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "reflow_profiles.h"
+#include "common.h"
+
+/* Validate every profile at compile time. */
+#define REFLOW_PROFILE(id, name, preheat_temp, soak_temp, soak_time, peak_temp, peak_time, cooldown_temp, board_tau) \
+    _Static_assert((soak_temp) > (preheat_temp), #id ": soak temperature must exceed pre-heat temperature"); \
+    _Static_assert((peak_temp) > (soak_temp), #id ": peak temperature must exceed soak temperature");       \
+    _Static_assert((peak_temp) <= REFLOW_PROFILE_MAX_PEAK_TEMP, #id ": peak temperature too high");        \
+    _Static_assert((cooldown_temp) < (preheat_temp), #id ": cool-down must end below pre-heat");            \
+    _Static_assert((soak_time) > 0 && (peak_time) > 0, #id ": REACHTIME phases need a non-zero duration");   \
+    _Static_assert((soak_temp) - (preheat_temp) <= REFLOW_PROFILE_MAX_RAMP_RATE * (soak_time),             \
+                   #id ": soak ramp rate too steep");                                                        \
+    _Static_assert((board_tau) > 0, #id ": board lag must be positive");
+#include "reflow_profiles.def"
+#undef REFLOW_PROFILE
+
+/* Profile table, placed in flash. */
+const Reflow_Profile reflow_profiles[NUM_REFLOW_PROFILES] = {
+#define REFLOW_PROFILE(id, _name, preheat_temp, soak_temp, soak_time, peak_temp, peak_time, cooldown_temp, _board_tau) \
+    [REFLOW_PROFILE_##id] = {                                                                               \
+        .name = _name,                                                                                      \
+        .phases = {{.phase_type = REACHTEMP, .reach_temp = (preheat_temp)},                          /* Pre-heat */  \
+                   {.phase_type = REACHTIME, .reach_temp = (soak_temp), .reach_time = (soak_time)},  /* Soak */      \
+                   {.phase_type = REACHTEMP, .reach_temp = (peak_temp)},                             /* Ramp-up */   \
+                   {.phase_type = REACHTIME, .reach_temp = (peak_temp), .reach_time = (peak_time)},  /* Peak */      \
+                   {.phase_type = REACHTEMP, .reach_temp = (cooldown_temp)}},                        /* Cool-down */ \
+        .board_tau = (_board_tau)},
+#include "reflow_profiles.def"
+#undef REFLOW_PROFILE
+};
+
+const Reflow_Profile *reflow_profile_find(const char *name)
+{
+    for (uint8_t i = 0; i < ARRAY_SIZE(reflow_profiles); i++)
+    {
+        if (strcasecmp(reflow_profiles[i].name, name) == 0)
+        {
+            return &reflow_profiles[i];
+        }
+    }
+
+    return NULL;
+}
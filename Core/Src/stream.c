@@ -0,0 +1,284 @@
+/**
+ * @file stream.c
+ * @author Timothy Nguyen
+ * @brief Binary setpoint streaming between a host and the reflow oven controller.
+ * @version 0.1
+ * @date 2021-08-04
+ */
+
+#include <string.h>
+
+#include "stream.h"
+#include "console.h"
+#include "uart.h"
+#include "cmd.h"
+#include "log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+/* Size of host frames following the sync bytes: type, seq, flags, two f32 values, crc. */
+#define HOST_FRAME_SIZE (1 + 2 + 1 + 4 + 4 + 1)
+
+/* Size of sample frame following the sync bytes: type, seq, state, sample seq, tick, setpoint, temperature, output, crc. */
+#define SAMPLE_FRAME_SIZE (1 + 2 + 1 + 4 + 4 + 4 + 4 + 4 + 1)
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/* Frame decoder states. */
+typedef enum
+{
+    WAIT_SYNC_0,
+    WAIT_SYNC_1,
+    READ_FRAME,
+} Stream_Rx_State;
+
+/* Stream decoder structure. */
+typedef struct
+{
+    stream_setpoint_cb_t setpoint_cb; // Callback for valid setpoint frames.
+    stream_replay_cb_t replay_cb;     // Callback for valid replay frames.
+    Stream_Rx_State rx_state;         // Frame decoder state.
+    uint8_t rx_buf[HOST_FRAME_SIZE];  // Frame bytes following the sync bytes.
+    uint8_t rx_len;                   // Number of bytes in rx_buf.
+} Stream_t;
+
+/**
+ * @brief List of stream performance measurements.
+ */
+typedef enum
+{
+    CNT_RX_FRAMES,   // Valid setpoint frames received.
+    CNT_RX_CRC_ERR,  // Frames dropped due to CRC mismatch.
+    CNT_RX_TYPE_ERR, // Frames dropped due to unknown or unexpected type.
+    CNT_TX_FRAMES,   // Sample frames transmitted.
+    CNT_TX_BUF_ERR,  // Sample frames dropped due to full transmit buffer.
+
+    NUM_U16_PMS // Number of performance measurements
+} Stream_pms_t;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+static void stream_rx_byte(char c);                     // Decode byte received over console.
+static void stream_rx_frame(void);                      // Handle complete frame.
+static uint8_t crc8(const uint8_t *data, uint32_t len); // Compute CRC-8 (poly 0x07).
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+/* Stream_t instance */
+static Stream_t stream;
+
+/* Performance measurement counters */
+static uint16_t stream_pms[NUM_U16_PMS];
+
+/* Performance measurement names */
+static const char *pm_names[] = {
+    "RX FRAMES",
+    "RX CRC ERR",
+    "RX TYPE ERR",
+    "TX FRAMES",
+    "TX BUF ERR"};
+
+/* Stream module client info */
+static cmd_client_info stream_client_info =
+    {
+        .client_name = "stream",
+        .num_cmds = 0,
+        .cmds = NULL,
+        .num_u16_pms = NUM_U16_PMS,
+        .u16_pms = stream_pms,
+        .u16_pm_names = pm_names};
+
+/* Unique tag for logging module */
+static const char *TAG = "STREAM";
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+mod_err_t stream_init(void)
+{
+    memset(&stream, 0, sizeof(stream));
+    LOGI(TAG, "Initialized stream.");
+    return cmd_register(&stream_client_info);
+}
+
+mod_err_t stream_open(stream_setpoint_cb_t setpoint_cb, stream_replay_cb_t replay_cb)
+{
+    if (setpoint_cb == NULL && replay_cb == NULL)
+    {
+        return MOD_ERR_ARG;
+    }
+
+    stream.setpoint_cb = setpoint_cb;
+    stream.replay_cb = replay_cb;
+    stream.rx_state = WAIT_SYNC_0;
+    stream.rx_len = 0;
+    console_set_raw_handler(stream_rx_byte);
+    LOGI(TAG, "Streaming %s.", setpoint_cb != NULL ? "setpoints" : "recorded temperatures");
+    return MOD_OK;
+}
+
+void stream_close(void)
+{
+    console_set_raw_handler(NULL);
+    stream.setpoint_cb = NULL;
+    stream.replay_cb = NULL;
+    LOGI(TAG, "Stopped streaming.");
+}
+
+mod_err_t stream_send_sample(const stream_sample_t *sample)
+{
+    uint8_t frame[2 + SAMPLE_FRAME_SIZE] = {STREAM_SYNC_0, STREAM_SYNC_1, STREAM_SAMPLE_FRAME};
+    uint8_t *p = &frame[3];
+
+    /* Cortex-M4 is little-endian, so fields are copied as is. */
+    memcpy(p, &sample->seq, sizeof(sample->seq));
+    p += sizeof(sample->seq);
+    *p++ = sample->state;
+    memcpy(p, &sample->sample_seq, sizeof(sample->sample_seq));
+    p += sizeof(sample->sample_seq);
+    memcpy(p, &sample->tick, sizeof(sample->tick));
+    p += sizeof(sample->tick);
+    memcpy(p, &sample->setpoint, sizeof(sample->setpoint));
+    p += sizeof(sample->setpoint);
+    memcpy(p, &sample->temperature, sizeof(sample->temperature));
+    p += sizeof(sample->temperature);
+    memcpy(p, &sample->output, sizeof(sample->output));
+    p += sizeof(sample->output);
+    *p = crc8(&frame[2], SAMPLE_FRAME_SIZE - 1);
+
+    /* Bypass printf, which drops null characters. The frame is written whole or not at all,
+     * and never between the characters of a log line. */
+    bool locked = uart_tx_lock();
+    mod_err_t err = uart_write(frame, sizeof(frame));
+    uart_tx_unlock(locked);
+    if (err != MOD_OK)
+    {
+        INC_SAT_U16(stream_pms[CNT_TX_BUF_ERR]);
+        return err;
+    }
+
+    INC_SAT_U16(stream_pms[CNT_TX_FRAMES]);
+    return MOD_OK;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) functions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Decode byte received over console.
+ *
+ * @param c Received byte.
+ *
+ * Runs in the console thread. Bytes outside of a frame are discarded,
+ * so the decoder resynchronizes on the next pair of sync bytes.
+ */
+static void stream_rx_byte(char c)
+{
+    uint8_t byte = (uint8_t)c;
+
+    switch (stream.rx_state)
+    {
+    case WAIT_SYNC_0:
+        if (byte == STREAM_SYNC_0)
+        {
+            stream.rx_state = WAIT_SYNC_1;
+        }
+        break;
+    case WAIT_SYNC_1:
+        if (byte == STREAM_SYNC_1)
+        {
+            stream.rx_len = 0;
+            stream.rx_state = READ_FRAME;
+        }
+        else if (byte != STREAM_SYNC_0)
+        {
+            stream.rx_state = WAIT_SYNC_0;
+        }
+        break;
+    case READ_FRAME:
+        stream.rx_buf[stream.rx_len++] = byte;
+        if (stream.rx_len == HOST_FRAME_SIZE)
+        {
+            stream_rx_frame();
+            stream.rx_state = WAIT_SYNC_0;
+        }
+        break;
+    default:
+        stream.rx_state = WAIT_SYNC_0;
+        break;
+    }
+}
+
+/**
+ * @brief Validate complete host frame and pass it to the callback registered for its type.
+ */
+static void stream_rx_frame(void)
+{
+    if (crc8(stream.rx_buf, HOST_FRAME_SIZE - 1) != stream.rx_buf[HOST_FRAME_SIZE - 1])
+    {
+        INC_SAT_U16(stream_pms[CNT_RX_CRC_ERR]);
+        return;
+    }
+
+    const uint8_t *p = &stream.rx_buf[1];
+    if (stream.rx_buf[0] == STREAM_SETPOINT_FRAME && stream.setpoint_cb != NULL)
+    {
+        stream_setpoint_t sp;
+        memcpy(&sp.seq, p, sizeof(sp.seq));
+        p += sizeof(sp.seq);
+        sp.flags = *p++;
+        memcpy(&sp.setpoint, p, sizeof(sp.setpoint));
+        p += sizeof(sp.setpoint);
+        memcpy(&sp.feedforward, p, sizeof(sp.feedforward));
+
+        INC_SAT_U16(stream_pms[CNT_RX_FRAMES]);
+        stream.setpoint_cb(&sp);
+    }
+    else if (stream.rx_buf[0] == STREAM_REPLAY_FRAME && stream.replay_cb != NULL)
+    {
+        stream_replay_t rp;
+        memcpy(&rp.seq, p, sizeof(rp.seq));
+        p += sizeof(rp.seq);
+        rp.flags = *p++;
+        memcpy(&rp.temperature, p, sizeof(rp.temperature));
+
+        INC_SAT_U16(stream_pms[CNT_RX_FRAMES]);
+        stream.replay_cb(&rp);
+    }
+    else
+    {
+        INC_SAT_U16(stream_pms[CNT_RX_TYPE_ERR]);
+    }
+}
+
+/**
+ * @brief Compute CRC-8 (polynomial 0x07, initial value 0x00).
+ *
+ * @param data Data to checksum.
+ * @param len Number of bytes.
+ *
+ * @return CRC-8 value.
+ */
+static uint8_t crc8(const uint8_t *data, uint32_t len)
+{
+    uint8_t crc = 0;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file tc_fusion.c
+ * @author Timothy Nguyen
+ * @brief Plausibility voting over redundant thermocouples
+ * @version 0.1
+ * @date 2021-08-19
+ */
+
+#include <math.h>
+
+#include "tc_fusion.h"
+#include "log.h"
+
+tc_confidence_t TC_Fusion_Vote(const float *temps, const bool *valid, uint8_t num, float threshold,
+                               tc_fusion_t *const result)
+{
+    ASSERT(num > 0 && num <= TC_FUSION_MAX_SENSORS);
+
+    /* Collect sensors read without fault. */
+    uint8_t idx[TC_FUSION_MAX_SENSORS];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < num; i++)
+    {
+        if (valid[i])
+        {
+            idx[count++] = i;
+        }
+    }
+
+    result->used = 0;
+    result->outvoted = 0;
+
+    if (count == 0)
+    {
+        result->confidence = TC_CONF_NONE;
+    }
+    else if (count == 1)
+    {
+        result->temp = temps[idx[0]];
+        result->used = 1 << idx[0];
+        result->confidence = num == 1 ? TC_CONF_HIGH : TC_CONF_LOW;
+    }
+    else if (count == 2)
+    {
+        float a = temps[idx[0]];
+        float b = temps[idx[1]];
+        if (fabsf(a - b) <= threshold)
+        {
+            result->temp = 0.5f * (a + b);
+            result->used = (1 << idx[0]) | (1 << idx[1]);
+            result->confidence = num == 2 ? TC_CONF_HIGH : TC_CONF_DEGRADED;
+        }
+        else
+        {
+            /* No majority, the higher reading keeps the heater from overshooting. */
+            uint8_t hi = a >= b ? idx[0] : idx[1];
+            uint8_t lo = a >= b ? idx[1] : idx[0];
+            result->temp = temps[hi];
+            result->used = 1 << hi;
+            result->outvoted = 1 << lo;
+            result->confidence = TC_CONF_LOW;
+        }
+    }
+    else
+    {
+        /* Median of three. */
+        float a = temps[0];
+        float b = temps[1];
+        float c = temps[2];
+        float median = fmaxf(fminf(a, b), fminf(fmaxf(a, b), c));
+
+        float sum = 0;
+        uint8_t agree = 0;
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            if (fabsf(temps[i] - median) <= threshold)
+            {
+                sum += temps[i];
+                agree++;
+                result->used |= 1 << i;
+            }
+            else
+            {
+                result->outvoted |= 1 << i;
+            }
+        }
+        result->temp = sum / agree; // The median always agrees with itself.
+        result->confidence = agree == 3 ? TC_CONF_HIGH : (agree == 2 ? TC_CONF_DEGRADED : TC_CONF_LOW);
+    }
+
+    return result->confidence;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file timestamp.c
+ * @author Timothy Nguyen
+ * @brief Monotonic 64-bit microsecond clock.
+ * @version 0.1
+ * @date 2021-08-14
+ */
+
+#include "timestamp.h"
+#include "stm32l4xx.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+/* Cycle counter value of the most recent read. */
+static uint32_t last_cyccnt;
+
+/* Upper 32 bits of the 64-bit cycle count. */
+static uint32_t cyccnt_high;
+
+/* CPU cycles per microsecond. */
+static uint32_t cycles_per_us = 1;
+
+/* Cycle count and microseconds at the most recent clock change. */
+static uint64_t base_cycles;
+static uint64_t base_us;
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+void timestamp_start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+mod_err_t timestamp_init(void)
+{
+    if (DWT->CTRL & DWT_CTRL_NOCYCCNT_Msk)
+    {
+        return MOD_ERR_PERIPH;
+    }
+
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    {
+        timestamp_start();
+    }
+    cycles_per_us = SystemCoreClock / 1000000U;
+    last_cyccnt = DWT->CYCCNT;
+    cyccnt_high = 0;
+    base_cycles = 0;
+    base_us = 0;
+    return MOD_OK;
+}
+
+void timestamp_clock_update(void)
+{
+    uint64_t cycles = timestamp_cycles();
+    base_us += (cycles - base_cycles) / cycles_per_us;
+    base_cycles = cycles;
+    cycles_per_us = SystemCoreClock / 1000000U;
+}
+
+uint64_t timestamp_cycles(void)
+{
+    /* Read and overflow update must not be interrupted by another reader. */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t cyccnt = DWT->CYCCNT;
+    if (cyccnt < last_cyccnt)
+    {
+        cyccnt_high++;
+    }
+    last_cyccnt = cyccnt;
+    uint64_t cycles = ((uint64_t)cyccnt_high << 32) | cyccnt;
+    __set_PRIMASK(primask);
+    return cycles;
+}
+
+uint64_t timestamp_us(void)
+{
+    return base_us + (timestamp_cycles() - base_cycles) / cycles_per_us;
+}
+
+uint32_t timestamp_ms(void)
+{
+    return (uint32_t)(timestamp_us() / 1000U);
+}
+
+uint32_t timestamp_cycles_to_us(uint64_t cycles)
+{
+    return (uint32_t)(cycles / cycles_per_us);
+}
+
+void timestamp_add_cycles(uint32_t cycles)
+{
+    /* Modular arithmetic: base_cycles may wrap below zero. */
+    base_cycles -= cycles;
+}
+
+void timestamp_refresh(void)
+{
+    timestamp_cycles();
+}
@@ -17,6 +17,7 @@
 #include "string.h"
 #include "log.h"
 #include "console.h"
+#include "cmsis_os.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Common macros
@@ -34,6 +35,7 @@ typedef struct
     /* Configuration parameters */
     USART_TypeDef *uart_reg_base; // Pointer to UART's base register address.
     IRQn_Type irq_num;
+    osMutexId_t tx_mutex; // Serializes messages of threads sharing the transmit buffer.
 
     /* Data */
     uint16_t tx_buf_get_idx;       // Transmit buffer get index.
@@ -41,6 +43,20 @@ typedef struct
     char tx_buf[UART_TX_BUF_SIZE]; // Transmit circular buffer.
 } UART_t;
 
+/**
+ * @brief UART instances with an interrupt handler.
+ */
+typedef enum
+{
+    UART_IDX_USART1,
+    UART_IDX_USART2,
+    UART_IDX_USART3,
+    UART_IDX_UART4,
+    UART_IDX_UART5,
+
+    NUM_UART_INSTANCES
+} UART_idx_t;
+
 /**
  * @brief List of UART performance measurements.
  */
@@ -63,6 +79,12 @@ typedef enum
 /* UART_t Instance */
 static UART_t uart;
 
+/* Transmit mutex memory */
+static StaticSemaphore_t tx_mutex_cb;
+
+/* Interrupt service routines of UART instances. */
+static uart_isr_t uart_isrs[NUM_UART_INSTANCES];
+
 /* Performance measurement counters */
 static uint16_t uart_pms[NUM_U16_PMS];
 
@@ -101,6 +123,12 @@ static inline void read_rdr(void);
 /* Write byte to transmit data register. */
 static inline void write_tdr(void);
 
+/* Get UART instance index from its interrupt number. */
+static int32_t uart_idx(IRQn_Type irq_num);
+
+/* Call interrupt service routine of a UART instance. */
+static inline void uart_dispatch(UART_idx_t idx);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Public (global) functions
 ////////////////////////////////////////////////////////////////////////////////
@@ -117,22 +145,23 @@ mod_err_t uart_init(uart_config_t *uart_cfg)
     }
     else
     {
-        switch (uart_cfg->irq_num)
+        if (uart_register_isr(uart_cfg->irq_num, UART_ISR) != MOD_OK)
         {
-        case USART1_IRQn:
-        case USART2_IRQn:
-        case USART3_IRQn:
-        case UART4_IRQn:
-        case UART5_IRQn:
-            memset(&uart, 0, sizeof(uart));
-            uart.irq_num = uart_cfg->irq_num;
-            uart.uart_reg_base = uart_cfg->uart_reg_base;
-            mod_err_t err = cmd_register(&uart_client_info);
-            LOGI(TAG, "Initialized UART");
-            return err;
-        default:
             return MOD_ERR_ARG;
         }
+        memset(&uart, 0, sizeof(uart));
+        uart.irq_num = uart_cfg->irq_num;
+        uart.uart_reg_base = uart_cfg->uart_reg_base;
+
+        static const osMutexAttr_t mutex_attr = {.name = "uart_tx",
+                                                 .attr_bits = osMutexRecursive | osMutexPrioInherit,
+                                                 .cb_mem = &tx_mutex_cb,
+                                                 .cb_size = sizeof(tx_mutex_cb)};
+        uart.tx_mutex = osMutexNew(&mutex_attr);
+        ASSERT(uart.tx_mutex != NULL);
+        mod_err_t err = cmd_register(&uart_client_info);
+        LOGI(TAG, "Initialized UART");
+        return err;
     }
 }
 
@@ -144,8 +173,7 @@ mod_err_t uart_start(void)
         return MOD_ERR_NOT_INIT;
     }
 
-    LL_USART_EnableIT_TXE(uart.uart_reg_base);  // Generate interrupt whenever TXE flag is set.
-    LL_USART_EnableIT_RXNE(uart.uart_reg_base); // Generate interrupt whenever RXNE flag is set.
+    LL_USART_EnableIT_TXE(uart.uart_reg_base); // Generate interrupt whenever TXE flag is set.
 
     /* Numerical interrupt priority must be set greater than or
      * equal to configMAX_SYSCALL_INTERRUPT_PRIORITY
@@ -158,6 +186,19 @@ mod_err_t uart_start(void)
     return MOD_OK;
 }
 
+mod_err_t uart_start_rx(void)
+{
+    if (uart.uart_reg_base == NULL)
+    {
+        LOGE(TAG, "UART not initialized");
+        return MOD_ERR_NOT_INIT;
+    }
+
+    LL_USART_EnableIT_RXNE(uart.uart_reg_base); // Generate interrupt whenever RXNE flag is set.
+
+    return MOD_OK;
+}
+
 mod_err_t uart_putc(char c)
 {
 
@@ -185,47 +226,130 @@ mod_err_t uart_putc(char c)
     return MOD_OK;
 }
 
+mod_err_t uart_write(const void *data, uint16_t len)
+{
+    /* The ISR only frees space, so the block still fits after this check. */
+    uint16_t used = (uart.tx_buf_put_idx + UART_TX_BUF_SIZE - uart.tx_buf_get_idx) % UART_TX_BUF_SIZE;
+    if (len > UART_TX_BUF_SIZE - 1 - used)
+    {
+        INC_SAT_U16(uart_pms[CNT_TX_BUF_OVERRUN]);
+        return MOD_ERR_BUF_OVERRUN;
+    }
+
+    const char *p = data;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        uart_putc(p[i]);
+    }
+    return MOD_OK;
+}
+
+bool uart_tx_lock(void)
+{
+    if (uart.tx_mutex == NULL || __get_IPSR() != 0)
+    {
+        return false;
+    }
+
+    switch (osKernelGetState())
+    {
+    case osKernelRunning:
+        return osMutexAcquire(uart.tx_mutex, osWaitForever) == osOK;
+    case osKernelLocked:
+        return osMutexAcquire(uart.tx_mutex, 0) == osOK;
+    default:
+        return false;
+    }
+}
+
+void uart_tx_unlock(bool locked)
+{
+    if (locked)
+    {
+        osMutexRelease(uart.tx_mutex);
+    }
+}
+
+mod_err_t uart_register_isr(IRQn_Type irq_num, uart_isr_t isr)
+{
+    int32_t idx = uart_idx(irq_num);
+    if (idx < 0)
+    {
+        return MOD_ERR_ARG;
+    }
+
+    uart_isrs[idx] = isr;
+    return MOD_OK;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Interrupt handlers
 ////////////////////////////////////////////////////////////////////////////////
 
 void USART1_IRQHandler(void)
 {
-    UART_ISR();
+    uart_dispatch(UART_IDX_USART1);
 }
 
 void USART2_IRQHandler(void)
 {
-    UART_ISR();
+    uart_dispatch(UART_IDX_USART2);
 }
 
 void USART3_IRQHandler(void)
 {
-    UART_ISR();
+    uart_dispatch(UART_IDX_USART3);
 }
 
 void UART4_IRQHandler(void)
 {
-    UART_ISR();
+    uart_dispatch(UART_IDX_UART4);
 }
 
 void UART5_IRQHandler(void)
 {
-    UART_ISR();
+    uart_dispatch(UART_IDX_UART5);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Private (static) function definitions
 ////////////////////////////////////////////////////////////////////////////////
 
+static int32_t uart_idx(IRQn_Type irq_num)
+{
+    switch (irq_num)
+    {
+    case USART1_IRQn:
+        return UART_IDX_USART1;
+    case USART2_IRQn:
+        return UART_IDX_USART2;
+    case USART3_IRQn:
+        return UART_IDX_USART3;
+    case UART4_IRQn:
+        return UART_IDX_UART4;
+    case UART5_IRQn:
+        return UART_IDX_UART5;
+    default:
+        return -1;
+    }
+}
+
+static inline void uart_dispatch(UART_idx_t idx)
+{
+    if (uart_isrs[idx] != NULL)
+    {
+        uart_isrs[idx]();
+    }
+}
+
 static void UART_ISR(void)
 {
     /* Read interrupt status register. */
     uint32_t status_reg = uart.uart_reg_base->ISR;
 
     /* Service interrupt flags. */
-    if (status_reg & USART_ISR_RXNE_Msk)
-    {
+    if ((status_reg & USART_ISR_RXNE_Msk) && LL_USART_IsEnabledIT_RXNE(uart.uart_reg_base))
+    { // Characters received before uart_start_rx() stay in RDR, the console queue may not exist yet.
         read_rdr();
     }
     if (status_reg & USART_ISR_TXE_Msk)
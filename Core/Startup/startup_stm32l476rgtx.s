@@ -63,6 +63,9 @@ Reset_Handler:
 
   ldr   sp, =_estack    /* Set stack pointer */
 
+/* Start the cycle counter, boot phases are timed from here.*/
+    bl  timestamp_start
+
 /* Call the clock system initialization function.*/
     bl  SystemInit
 
@@ -7,6 +7,7 @@ ELF_SRCS :=
 OBJ_SRCS := 
 S_SRCS := 
 C_SRCS := 
+CPP_SRCS := 
 S_UPPER_SRCS := 
 O_SRCS := 
 SIZE_OUTPUT := 
@@ -16,6 +17,7 @@ OBJS :=
 S_DEPS := 
 S_UPPER_DEPS := 
 C_DEPS := 
+CPP_DEPS := 
 OBJCOPY_BIN := 
 
 # Every subdirectory with source files must be described here
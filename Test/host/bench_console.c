@@ -0,0 +1,78 @@
+/**
+ * @file bench_console.c
+ * @author Timothy Nguyen
+ * @brief Throughput of the console path: command lines per second from received bytes to handler.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      A script of typical command lines is fed through the console repeatedly. Output is only
+ *      counted, so the result includes formatting but not the UART.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_console.h"
+
+#define DEFAULT_ROUNDS 20000 // Times the script is fed.
+
+/* Typical console traffic, including edits, errors and help output. */
+static const char script[] = "fuzz args 1 -2 0x30\r"
+                             "fuzz addr 42 20000000\r"
+                             "fuzz opt\r"
+                             "fuzz opt 017\r"
+                             "fuzz str profile\b\b\b\b\b\b\bpeak 245\r"
+                             "fuzz args 1 2 3 4\r"
+                             "fuzz args one\r"
+                             "fuzz pm\r"
+                             "fuzz\r"
+                             "reflow set Kp 12.5 Ki 0.05\r"
+                             "reflow profile use Sn63Pb37\r"
+                             "reflow fusion threshold 7.5\r"
+                             "reflow status\r"
+                             "max status\r"
+                             "log status\r"
+                             "log format kv\r"
+                             "log format text\r"
+                             "no such command\r"
+                             "\r";
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    long rounds = argc > 1 ? strtol(argv[1], NULL, 0) : DEFAULT_ROUNDS;
+    if (rounds <= 0)
+    {
+        fprintf(stderr, "usage: %s [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    host_console_init();
+    host_console_reset();
+
+    uint64_t lines = 0;
+    uint64_t out_start = host_uart_bytes();
+    double start = now_s();
+    for (long i = 0; i < rounds; i++)
+    {
+        lines += host_console_feed((const uint8_t *)script, strlen(script));
+    }
+    double elapsed = now_s() - start;
+    uint64_t out_bytes = host_uart_bytes() - out_start;
+
+    printf("%llu lines in %.3f s: %.0f lines/s, %.1f MB/s in, %.1f MB/s out\n",
+           (unsigned long long)lines,
+           elapsed,
+           lines / elapsed,
+           rounds * (sizeof(script) - 1) / elapsed / 1e6,
+           out_bytes / elapsed / 1e6);
+    return 0;
+}
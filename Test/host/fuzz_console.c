@@ -0,0 +1,24 @@
+/**
+ * @file fuzz_console.c
+ * @author Timothy Nguyen
+ * @brief Fuzz target for console line editing, tokenizing, argument parsing and command dispatch.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Entry point for libFuzzer. AFL and plain runs link fuzz_main.c, which calls the same
+ *      function once per input file.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "host_console.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    host_console_init();
+    host_console_reset();
+    host_console_feed(data, size);
+    host_console_feed((const uint8_t *)"\r", 1); // Execute an unterminated last line too.
+    return 0;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file fuzz_main.c
+ * @author Timothy Nguyen
+ * @brief Driver running the console fuzz target without libFuzzer.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Each file argument is one input; without arguments one input is read from stdin, as
+ *      afl-fuzz provides it. Used for AFL and to replay the corpus with sanitizers under gcc.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MAX_INPUT_SIZE (64 * 1024) // Longer inputs are cut off.
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint8_t input[MAX_INPUT_SIZE];
+
+static int run_file(FILE *f)
+{
+    size_t size = fread(input, 1, sizeof(input), f);
+    if (ferror(f))
+    {
+        return 1;
+    }
+    LLVMFuzzerTestOneInput(input, size);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        return run_file(stdin);
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        FILE *f = fopen(argv[i], "rb");
+        if (f == NULL || run_file(f) != 0)
+        {
+            fprintf(stderr, "Could not read %s\n", argv[i]);
+            return 1;
+        }
+        fclose(f);
+    }
+    fprintf(stderr, "Ran %d inputs\n", argc - 1);
+    return 0;
+}
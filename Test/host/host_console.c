@@ -0,0 +1,214 @@
+/**
+ * @file host_console.c
+ * @author Timothy Nguyen
+ * @brief Host build of the console and command path for fuzzing and benchmarking.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      console.c is included so the static console_process() and console state can be driven
+ *      directly, without the console thread and its character queue.
+ *
+ *      The reflow, thermocouple and stream modules are initialized with host register blocks
+ *      so their commands are reached too. The PID client is not registered: "pid bench" runs
+ *      for as many iterations as it is given.
+ */
+
+#include "../../Core/Src/console.c"
+
+#include "host_console.h"
+#include "reflow.h"
+#include "stream.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t fuzz_args_cmd(uint32_t argc, const char **argv); // Parse up to three integers.
+static uint32_t fuzz_addr_cmd(uint32_t argc, const char **argv); // Parse unsigned value and pointer.
+static uint32_t fuzz_opt_cmd(uint32_t argc, const char **argv);  // Parse optional unsigned value.
+static uint32_t fuzz_str_cmd(uint32_t argc, const char **argv);  // Parse one or two strings.
+
+static void print_args(const cmd_arg_val *arg_vals, int32_t num_args); // Print parsed arguments.
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+/* Test commands, one per cmd_parse_args() format class used by the firmware. */
+static const cmd_cmd_info fuzz_cmds[] = {
+    {
+        .cmd_name = "args",
+        .cb = fuzz_args_cmd,
+        .help = "Parse one to three integers, args: <i> [<i> [<i>]]",
+    },
+    {
+        .cmd_name = "addr",
+        .cb = fuzz_addr_cmd,
+        .help = "Parse an unsigned value and a pointer, args: <u> <p>",
+    },
+    {
+        .cmd_name = "opt",
+        .cb = fuzz_opt_cmd,
+        .help = "Parse an optional unsigned value, args: [<u>]",
+    },
+    {
+        .cmd_name = "str",
+        .cb = fuzz_str_cmd,
+        .help = "Parse one or two strings, args: <s> [<s>]",
+    },
+};
+
+/* Performance measurements, to reach the "pm" handler. */
+static uint16_t fuzz_pms[1];
+static const char *const fuzz_pm_names[] = {"lines"};
+
+static const cmd_client_info fuzz_client_info = {
+    .client_name = "fuzz",
+    .num_cmds = ARRAY_SIZE(fuzz_cmds),
+    .cmds = fuzz_cmds,
+    .num_u16_pms = ARRAY_SIZE(fuzz_pms),
+    .u16_pms = fuzz_pms,
+    .u16_pm_names = fuzz_pm_names,
+};
+
+/* Peripherals passed to the reflow module, as in main.c. */
+static TIM_TypeDef tim3;
+static TIM_HandleTypeDef htim3 = {.Instance = &tim3};
+static SPI_TypeDef spi2;
+static SPI_HandleTypeDef hspi2 = {.Instance = &spi2};
+static GPIO_TypeDef gpiob;
+
+static const Reflow_cfg_t reflow_cfg = {
+    .pwm_timer_handle = &htim3,
+    .pwm_channel = TIM_CHANNEL_1,
+    .max_cfg = {[REFLOW_TC_OVEN] = {.hspi = &hspi2, .max_cs_port = &gpiob, .max_cs_pin = GPIO_PIN_6},
+                [REFLOW_TC_ELEMENT] = {.hspi = &hspi2, .max_cs_port = &gpiob, .max_cs_pin = GPIO_PIN_5},
+                [REFLOW_TC_PROBE] = {.hspi = &hspi2, .max_cs_port = &gpiob, .max_cs_pin = GPIO_PIN_4},
+                [REFLOW_TC_OVEN_B] = {.hspi = &hspi2, .max_cs_port = &gpiob, .max_cs_pin = GPIO_PIN_3},
+                [REFLOW_TC_OVEN_C] = {.hspi = &hspi2, .max_cs_port = &gpiob, .max_cs_pin = GPIO_PIN_2}}};
+
+static bool host_initialized; // Modules initialized?
+static uint32_t lines_done;   // Completed command lines.
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+void host_console_init(void)
+{
+    if (host_initialized)
+    {
+        return;
+    }
+    host_initialized = true;
+
+    cmd_init();
+    log_init();
+    console_init();
+    stream_init();
+    reflow_init(&reflow_cfg);
+    reflow_start();
+    cmd_register(&fuzz_client_info);
+}
+
+void host_console_reset(void)
+{
+    console.num_cmd_buf_chars = 0;
+    console.raw_handler = NULL;
+    _log_active = true;
+    log_format_set(LOG_FORMAT_TEXT);
+
+    /* Leave any reflow run or stream started by the previous input. */
+    static const char stop[] = "\rreflow stop\r";
+    for (const char *c = stop; *c != '\0'; c++)
+    {
+        console_process(*c);
+    }
+    console.num_cmd_buf_chars = 0;
+}
+
+uint32_t host_console_feed(const uint8_t *data, size_t size)
+{
+    uint32_t lines = lines_done;
+    for (size_t i = 0; i < size; i++)
+    {
+        char c = (char)data[i];
+        if (console.raw_handler != NULL)
+        {
+            console.raw_handler(c); // Stream frames, as in the console thread.
+            continue;
+        }
+        console_process(c);
+        if (c == '\n' || c == '\r')
+        {
+            lines_done++;
+            INC_SAT_U16(fuzz_pms[0]);
+        }
+
+        /* Line editing must never run past the command buffer. */
+        if (console.num_cmd_buf_chars >= CONSOLE_CMD_BUF_SIZE)
+        {
+            __builtin_trap();
+        }
+    }
+    return lines_done - lines;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) functions
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t fuzz_args_cmd(uint32_t argc, const char **argv)
+{
+    cmd_arg_val arg_vals[3];
+    int32_t num_args = cmd_parse_args(argc, argv, "i[i[i", arg_vals);
+    print_args(arg_vals, num_args);
+    return num_args < 0;
+}
+
+static uint32_t fuzz_addr_cmd(uint32_t argc, const char **argv)
+{
+    cmd_arg_val arg_vals[2];
+    int32_t num_args = cmd_parse_args(argc, argv, "up", arg_vals);
+    print_args(arg_vals, num_args);
+    return num_args < 0;
+}
+
+static uint32_t fuzz_opt_cmd(uint32_t argc, const char **argv)
+{
+    cmd_arg_val arg_vals[1];
+    int32_t num_args = cmd_parse_args(argc, argv, "[u]", arg_vals);
+    print_args(arg_vals, num_args);
+    return num_args < 0;
+}
+
+static uint32_t fuzz_str_cmd(uint32_t argc, const char **argv)
+{
+    cmd_arg_val arg_vals[2];
+    int32_t num_args = cmd_parse_args(argc, argv, "s[s]", arg_vals);
+    print_args(arg_vals, num_args);
+    return num_args < 0;
+}
+
+static void print_args(const cmd_arg_val *arg_vals, int32_t num_args)
+{
+    for (int32_t i = 0; i < num_args; i++)
+    {
+        switch (arg_vals[i].type)
+        {
+        case 'i':
+            LOG("%ld ", (long)arg_vals[i].val.i);
+            break;
+        case 'u':
+            LOG("%lu ", (unsigned long)arg_vals[i].val.u);
+            break;
+        case 'p':
+            LOG("%p ", arg_vals[i].val.p);
+            break;
+        case 's':
+            LOG("%s ", arg_vals[i].val.s);
+            break;
+        }
+    }
+    LOG("\r\n");
+}
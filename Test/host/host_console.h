@@ -0,0 +1,54 @@
+/**
+ * @file host_console.h
+ * @author Timothy Nguyen
+ * @brief Host build of the console and command path for fuzzing and benchmarking.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Bytes are fed through console_process(), and every completed line is tokenized, parsed and
+ *      dispatched by the command module in the calling thread. The log module and a "fuzz" test
+ *      client (see host_console.c) are registered as command clients.
+ */
+
+#ifndef _HOST_CONSOLE_H_
+#define _HOST_CONSOLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Initialize log, command and console modules once.
+ */
+void host_console_init(void);
+
+/**
+ * @brief Return console, log output and log format to their state after initialization.
+ *
+ * Log levels set through "log set" are kept.
+ */
+void host_console_reset(void);
+
+/**
+ * @brief Feed bytes to the console as if received over the UART.
+ *
+ * @param data Received bytes.
+ * @param size Number of bytes.
+ *
+ * @return Number of completed command lines.
+ */
+uint32_t host_console_feed(const uint8_t *data, size_t size);
+
+/**
+ * @brief Get number of bytes written to the UART since start.
+ */
+uint64_t host_uart_bytes(void);
+
+/**
+ * @brief Echo UART output to stdout.
+ *
+ * @param enable true to echo, false to only count bytes (default).
+ */
+void host_uart_echo(bool enable);
+
+#endif
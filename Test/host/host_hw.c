@@ -0,0 +1,747 @@
+/**
+ * @file host_hw.c
+ * @author Timothy Nguyen
+ * @brief Virtual clock, NVIC and peripheral models of the virtual-time host build.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      A USART model cannot observe register accesses, so it resynchronizes with the registers
+ *      after every interrupt handler and every LL call that changes control bits or clears flags
+ *      (host_usart_changed()): a written TDR (initialized to TDR_EMPTY) is moved to the shift
+ *      register, and RXNE is cleared once a handler ran with RXNEIE set, as both drivers read
+ *      RDR there. TIM7, the HAL time base, counts microseconds; with its update interrupt
+ *      enabled, uwTick follows the clock and timestamp_refresh() runs every second as in
+ *      HAL_TIM_PeriodElapsedCallback(). After HAL_SuspendTick() updates only set UIF, and
+ *      HAL_ResumeTick() raises the one interrupt the chip would take for them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_hw.h"
+#include "host_rtos.h"
+#include "stm32l4xx_ll_usart.h"
+#include "timestamp.h"
+#include "cmsis_os.h"
+#include "task.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define MAX_EVENTS 32
+#define MAX_SPI_DEVICES 8
+#define NUM_IRQS 82
+
+#define CYCLES_PER_TICK (HOST_CPU_HZ / configTICK_RATE_HZ) // Kernel tick (SysTick period).
+#define CYCLES_PER_MS (HOST_CPU_HZ / 1000U)               // HAL tick (TIM7 period).
+#define CYCLES_PER_US (HOST_CPU_HZ / 1000000U)            // TIM7 count.
+#define TIME_BASE_REFRESH_MS 1000U                        // timestamp_refresh() period.
+
+#define RESET_CLOCK_HZ 4000000U // MSI clock after reset, before SystemClock_Config().
+
+#define TDR_EMPTY 0x8000U // Not a byte, TDR holds it while no write is pending.
+#define RX_LINE_SIZE 4096 // Bytes waiting on a receive line.
+
+#define USART_FRAME_BITS 10U // 8N1.
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    USART_TypeDef *regs;
+    IRQn_Type irq_num;
+    bool open;
+    uint64_t bit_cycles;
+    host_usart_sink_t sink;
+    void *sink_arg;
+
+    /* Transmitter */
+    Host_Event tx_evt;   // Shift register empties.
+    bool tx_busy;        // Shift register holds a frame.
+    uint8_t tx_shift;    // Frame being sent.
+    bool tdr_full;       // TDR waits for the shift register.
+    uint8_t tdr;         // Waiting byte.
+
+    /* Receiver */
+    Host_Event rx_evt;   // Next frame received.
+    Host_Event rto_evt;  // Receiver timeout.
+    uint8_t rx_line[RX_LINE_SIZE];
+    size_t rx_head;
+    size_t rx_count;
+} Host_Usart;
+
+typedef struct
+{
+    GPIO_TypeDef *cs_port;
+    uint16_t cs_pin;
+    host_spi_read_t read;
+    void *arg;
+} Host_Spi_Device;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t now;       // Clock (cycles).
+static uint64_t stop_time; // End of run (cycles).
+static host_pace_t pace;
+static uint32_t kernel_ticks;
+
+static Host_Event *events[MAX_EVENTS];
+static uint32_t num_events;
+static uint32_t event_seq;
+
+static Host_Event time_base_evt; // timestamp_refresh() every second.
+
+static host_irq_handler_t irq_handlers[NUM_IRQS];
+static bool irq_enabled[NUM_IRQS];
+static bool irq_pending[NUM_IRQS];
+static uint32_t irq_priority[NUM_IRQS];
+static uint32_t primask;
+static uint32_t ipsr;
+static uint32_t critical_nesting;
+static bool dispatching; // irq_dispatch() runs, picks up newly pending interrupts itself.
+
+static Host_Usart usarts[2];
+
+static Host_Spi_Device spi_devices[MAX_SPI_DEVICES];
+static uint32_t num_spi_devices;
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) variables
+////////////////////////////////////////////////////////////////////////////////
+
+GPIO_TypeDef host_gpioa, host_gpiob, host_gpioc;
+SPI_TypeDef host_spi2;
+TIM_TypeDef host_tim3, host_tim7;
+USART_TypeDef host_usart2, host_uart4;
+RCC_TypeDef host_rcc;
+DWT_Type host_dwt;
+CoreDebug_Type host_core_debug;
+SCB_Type host_scb;
+
+uint32_t SystemCoreClock;
+__IO uint32_t uwTick;
+HAL_TickFreqTypeDef uwTickFreq = HAL_TICK_FREQ_DEFAULT;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function definitions
+////////////////////////////////////////////////////////////////////////////////
+
+static Host_Event *first_event(void)
+{
+    Host_Event *first = NULL;
+    for (uint32_t i = 0; i < num_events; i++)
+    {
+        Host_Event *e = events[i];
+        if (first == NULL || e->time < first->time || (e->time == first->time && e->seq < first->seq))
+        {
+            first = e;
+        }
+    }
+    return first;
+}
+
+static void irq_dispatch(void)
+{
+    if (primask != 0 || critical_nesting != 0 || ipsr != 0 || dispatching)
+    {
+        return;
+    }
+
+    dispatching = true;
+    for (;;)
+    {
+        int32_t next = -1;
+        for (int32_t i = 0; i < NUM_IRQS; i++)
+        {
+            if (irq_pending[i] && irq_enabled[i] && (next < 0 || irq_priority[i] < irq_priority[next]))
+            {
+                next = i;
+            }
+        }
+        if (next < 0)
+        {
+            break;
+        }
+
+        irq_pending[next] = false;
+        ipsr = (uint32_t)next + 16U;
+        if (irq_handlers[next] != NULL)
+        {
+            irq_handlers[next]();
+        }
+        ipsr = 0;
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            Host_Usart *u = &usarts[i];
+            if (u->open && u->irq_num == next)
+            { // Drivers read RDR in the handler whenever RXNE raised it.
+                if (u->regs->CR1 & USART_CR1_RXNEIE)
+                {
+                    CLEAR_BIT(u->regs->ISR, USART_ISR_RXNE);
+                }
+                host_usart_changed(u->regs);
+            }
+        }
+    }
+    dispatching = false;
+
+    host_rtos_yield_if_needed();
+}
+
+static void irq_raise(IRQn_Type irq_num)
+{
+    irq_pending[irq_num] = true;
+    irq_dispatch();
+}
+
+static Host_Usart *usart_model(USART_TypeDef *regs)
+{
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        if (usarts[i].open && usarts[i].regs == regs)
+        {
+            return &usarts[i];
+        }
+    }
+    return NULL;
+}
+
+static void usart_tx_start(Host_Usart *u, uint8_t byte)
+{
+    u->tx_shift = byte;
+    u->tx_busy = true;
+    CLEAR_BIT(u->regs->ISR, USART_ISR_TC);
+    SET_BIT(u->regs->ISR, USART_ISR_TXE);
+    host_event_schedule(&u->tx_evt, now + USART_FRAME_BITS * u->bit_cycles);
+}
+
+static void usart_update_irq(Host_Usart *u)
+{
+    uint32_t cr1 = u->regs->CR1;
+    uint32_t isr = u->regs->ISR;
+    if (((isr & USART_ISR_TXE) && (cr1 & USART_CR1_TXEIE)) ||
+        ((isr & USART_ISR_TC) && (cr1 & USART_CR1_TCIE)) ||
+        ((isr & (USART_ISR_RXNE | USART_ISR_ORE)) && (cr1 & USART_CR1_RXNEIE)) ||
+        ((isr & USART_ISR_RTOF) && (cr1 & USART_CR1_RTOIE)))
+    {
+        irq_raise(u->irq_num);
+    }
+}
+
+static void usart_tx_done(Host_Event *evt)
+{
+    Host_Usart *u = evt->arg;
+    if (u->sink != NULL)
+    {
+        u->sink(u->tx_shift, u->sink_arg);
+    }
+    if (u->tdr_full)
+    {
+        u->tdr_full = false;
+        usart_tx_start(u, u->tdr);
+    }
+    else
+    {
+        u->tx_busy = false;
+        SET_BIT(u->regs->ISR, USART_ISR_TC);
+    }
+    usart_update_irq(u);
+}
+
+static void usart_rx_done(Host_Event *evt)
+{
+    Host_Usart *u = evt->arg;
+    uint8_t byte = u->rx_line[u->rx_head];
+    u->rx_head = (u->rx_head + 1) % RX_LINE_SIZE;
+    u->rx_count--;
+
+    if ((u->regs->CR1 & (USART_CR1_UE | USART_CR1_RE)) == (USART_CR1_UE | USART_CR1_RE))
+    {
+        if (u->regs->ISR & USART_ISR_RXNE)
+        {
+            SET_BIT(u->regs->ISR, USART_ISR_ORE); // Previous byte not read, this one is lost.
+        }
+        else
+        {
+            u->regs->RDR = byte;
+            SET_BIT(u->regs->ISR, USART_ISR_RXNE);
+        }
+        if (u->regs->CR2 & USART_CR2_RTOEN)
+        {
+            host_event_schedule(&u->rto_evt, now + (u->regs->RTOR & USART_RTOR_RTO) * u->bit_cycles);
+        }
+    }
+    if (u->rx_count > 0)
+    {
+        host_event_schedule(&u->rx_evt, now + USART_FRAME_BITS * u->bit_cycles);
+    }
+    usart_update_irq(u);
+}
+
+static void usart_rx_timeout(Host_Event *evt)
+{
+    Host_Usart *u = evt->arg;
+    SET_BIT(u->regs->ISR, USART_ISR_RTOF);
+    usart_update_irq(u);
+}
+
+/* TIM7 update interrupt, taken after HAL_ResumeTick(). */
+static void time_base_irq(void)
+{
+    CLEAR_BIT(TIM7->SR, TIM_SR_UIF);
+    uwTick += uwTickFreq;
+}
+
+static void time_base_refresh(Host_Event *evt)
+{
+    timestamp_refresh();
+    host_event_schedule(evt, now + TIME_BASE_REFRESH_MS * (uint64_t)CYCLES_PER_MS);
+}
+
+/* Move the clock to time and run what is due then. */
+static void advance(uint64_t time)
+{
+    if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)
+    {
+        DWT->CYCCNT += (uint32_t)(time - now);
+    }
+    uint64_t periods = time / CYCLES_PER_MS - now / CYCLES_PER_MS;
+    now = time;
+    TIM7->CNT = (uint32_t)(now / CYCLES_PER_US % (TIM7->ARR + 1U));
+    if (periods > 0)
+    {
+        if (TIM7->DIER & TIM_DIER_UIE)
+        {
+            uwTick += (uint32_t)periods * uwTickFreq;
+        }
+        else
+        {
+            SET_BIT(TIM7->SR, TIM_SR_UIF);
+        }
+    }
+
+    Host_Event *evt;
+    while ((evt = first_event()) != NULL && evt->time <= now)
+    {
+        host_event_cancel(evt);
+        evt->cb(evt);
+    }
+
+    uint32_t ticks = (uint32_t)(now / CYCLES_PER_TICK);
+    host_rtos_tick(ticks - kernel_ticks);
+    kernel_ticks = ticks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+void host_hw_init(void)
+{
+    now = 0;
+    stop_time = UINT64_MAX;
+    pace = NULL;
+    kernel_ticks = 0;
+    num_events = 0;
+    uwTick = 0;
+    SystemCoreClock = RESET_CLOCK_HZ;
+
+    memset(&host_gpioa, 0, sizeof(host_gpioa));
+    memset(&host_gpiob, 0, sizeof(host_gpiob));
+    memset(&host_gpioc, 0, sizeof(host_gpioc));
+    memset(&host_spi2, 0, sizeof(host_spi2));
+    memset(&host_tim3, 0, sizeof(host_tim3));
+    memset(&host_tim7, 0, sizeof(host_tim7));
+    memset(&host_usart2, 0, sizeof(host_usart2));
+    memset(&host_uart4, 0, sizeof(host_uart4));
+    memset(&host_rcc, 0, sizeof(host_rcc));
+    memset(&host_dwt, 0, sizeof(host_dwt));
+    memset(&host_core_debug, 0, sizeof(host_core_debug));
+    memset(&host_scb, 0, sizeof(host_scb));
+    memset(usarts, 0, sizeof(usarts));
+    host_rcc.CSR = RCC_CSR_PINRSTF | RCC_CSR_BORRSTF; // Power-on reset.
+    host_usart2.TDR = host_uart4.TDR = TDR_EMPTY;
+
+    /* TIM7 as HAL_InitTick() leaves it: 1 MHz count, 1 ms update interrupt. */
+    host_tim7.PSC = HOST_CPU_HZ / 1000000U - 1U;
+    host_tim7.ARR = 1000U - 1U;
+    host_tim7.DIER = TIM_DIER_UIE;
+    host_tim7.CR1 = TIM_CR1_CEN;
+    irq_handlers[TIM7_IRQn] = time_base_irq;
+    irq_enabled[TIM7_IRQn] = true;
+
+    time_base_evt.cb = time_base_refresh;
+    host_event_schedule(&time_base_evt, TIME_BASE_REFRESH_MS * (uint64_t)CYCLES_PER_MS);
+}
+
+uint64_t host_hw_now(void)
+{
+    return now;
+}
+
+void host_hw_stop_at(uint64_t time)
+{
+    stop_time = time;
+}
+
+bool host_hw_idle(void)
+{
+    uint64_t next = UINT64_MAX;
+    Host_Event *evt = first_event();
+    if (evt != NULL)
+    {
+        next = evt->time;
+    }
+
+    uint32_t ticks;
+    if (host_rtos_next_timeout(&ticks))
+    {
+        uint64_t timeout = (uint64_t)(kernel_ticks + (uint64_t)ticks) * CYCLES_PER_TICK;
+        next = timeout < next ? timeout : next;
+    }
+
+    if (pace != NULL && next <= stop_time)
+    {
+        next = pace(next);
+    }
+    if (next == UINT64_MAX || next > stop_time)
+    {
+        return false;
+    }
+    advance(next > now ? next : now);
+    return true;
+}
+
+void host_hw_set_pace(host_pace_t pace_fn)
+{
+    pace = pace_fn;
+}
+
+void host_event_schedule(Host_Event *evt, uint64_t time)
+{
+    host_event_cancel(evt);
+    if (num_events == MAX_EVENTS)
+    {
+        fprintf(stderr, "host_hw: too many events\n");
+        abort();
+    }
+    evt->time = time;
+    evt->seq = ++event_seq;
+    evt->armed = true;
+    events[num_events++] = evt;
+}
+
+void host_event_cancel(Host_Event *evt)
+{
+    if (!evt->armed)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < num_events; i++)
+    {
+        if (events[i] == evt)
+        {
+            events[i] = events[--num_events];
+            break;
+        }
+    }
+    evt->armed = false;
+}
+
+void host_irq_attach(IRQn_Type irq_num, host_irq_handler_t handler)
+{
+    irq_handlers[irq_num] = handler;
+}
+
+bool host_irq_blocked(void)
+{
+    return primask != 0 || critical_nesting != 0 || ipsr != 0;
+}
+
+bool host_irq_pending(void)
+{
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+    {
+        return true;
+    }
+    for (uint32_t i = 0; i < NUM_IRQS; i++)
+    {
+        if (irq_pending[i] && irq_enabled[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void host_usart_open(USART_TypeDef *usart, IRQn_Type irq_num, uint32_t baud_rate,
+                     host_usart_sink_t sink, void *arg)
+{
+    Host_Usart *u = usart == USART2 ? &usarts[0] : &usarts[1];
+    memset(u, 0, sizeof(*u));
+    u->regs = usart;
+    u->irq_num = irq_num;
+    u->bit_cycles = HOST_CPU_HZ / baud_rate;
+    u->sink = sink;
+    u->sink_arg = arg;
+    u->tx_evt = (Host_Event){.cb = usart_tx_done, .arg = u};
+    u->rx_evt = (Host_Event){.cb = usart_rx_done, .arg = u};
+    u->rto_evt = (Host_Event){.cb = usart_rx_timeout, .arg = u};
+    u->open = true;
+
+    usart->BRR = HOST_CPU_HZ / baud_rate;
+    usart->CR1 = USART_CR1_UE | USART_CR1_RE | USART_CR1_TE;
+    usart->ISR = USART_ISR_TXE | USART_ISR_TC;
+    usart->TDR = TDR_EMPTY;
+}
+
+size_t host_usart_send(USART_TypeDef *usart, const uint8_t *data, size_t size)
+{
+    Host_Usart *u = usart_model(usart);
+    if (u == NULL)
+    {
+        return 0;
+    }
+
+    size_t n = 0;
+    for (; n < size && u->rx_count < RX_LINE_SIZE; n++)
+    {
+        u->rx_line[(u->rx_head + u->rx_count++) % RX_LINE_SIZE] = data[n];
+    }
+    if (n > 0 && !u->rx_evt.armed)
+    {
+        host_event_schedule(&u->rx_evt, now + USART_FRAME_BITS * u->bit_cycles);
+    }
+    return n;
+}
+
+void host_usart_changed(USART_TypeDef *USARTx)
+{
+    Host_Usart *u = usart_model(USARTx);
+    if (u == NULL)
+    {
+        return;
+    }
+
+    /* Flag clear register */
+    static const uint32_t icr_flags[][2] = {{USART_ICR_PECF, USART_ISR_PE},
+                                            {USART_ICR_FECF, USART_ISR_FE},
+                                            {USART_ICR_NECF, USART_ISR_NE},
+                                            {USART_ICR_ORECF, USART_ISR_ORE},
+                                            {USART_ICR_TCCF, USART_ISR_TC},
+                                            {USART_ICR_RTOCF, USART_ISR_RTOF}};
+    for (size_t i = 0; i < sizeof(icr_flags) / sizeof(icr_flags[0]); i++)
+    {
+        if (USARTx->ICR & icr_flags[i][0])
+        {
+            CLEAR_BIT(USARTx->ISR, icr_flags[i][1]);
+        }
+    }
+    USARTx->ICR = 0;
+
+    if (ipsr == (uint32_t)u->irq_num + 16U)
+    {
+        return; // Own handler runs, synchronized when it returns.
+    }
+
+    /* Transmit data register */
+    if (USARTx->TDR != TDR_EMPTY)
+    {
+        uint8_t byte = USARTx->TDR & 0xFFU;
+        USARTx->TDR = TDR_EMPTY;
+        if (!u->tx_busy)
+        {
+            usart_tx_start(u, byte);
+        }
+        else
+        {
+            u->tdr = byte;
+            u->tdr_full = true;
+            CLEAR_BIT(USARTx->ISR, USART_ISR_TXE);
+        }
+    }
+    usart_update_irq(u);
+}
+
+void host_spi_attach(GPIO_TypeDef *cs_port, uint16_t cs_pin, host_spi_read_t read, void *arg)
+{
+    if (num_spi_devices == MAX_SPI_DEVICES)
+    {
+        fprintf(stderr, "host_hw: too many SPI devices\n");
+        abort();
+    }
+    spi_devices[num_spi_devices++] = (Host_Spi_Device){.cs_port = cs_port, .cs_pin = cs_pin, .read = read, .arg = arg};
+}
+
+float host_pwm_duty(void)
+{
+    if (!(TIM3->CCER & TIM_CCER_CC1E) || TIM3->ARR == 0)
+    {
+        return 0.0f;
+    }
+    float duty = (float)TIM3->CCR1 / (float)(TIM3->ARR + 1U);
+    return duty > 1.0f ? 1.0f : duty;
+}
+
+/* Core */
+
+void __disable_irq(void)
+{
+    primask = 1;
+}
+
+void __enable_irq(void)
+{
+    primask = 0;
+    irq_dispatch();
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return primask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+    primask = priMask & 1U;
+    irq_dispatch();
+}
+
+uint32_t __get_IPSR(void)
+{
+    return ipsr;
+}
+
+void vPortEnterCritical(void)
+{
+    critical_nesting++;
+}
+
+void vPortExitCritical(void)
+{
+    if (critical_nesting > 0 && --critical_nesting == 0)
+    {
+        irq_dispatch();
+    }
+}
+
+uint32_t NVIC_GetPriorityGrouping(void)
+{
+    return 3U; // NVIC_PRIORITYGROUP_4, set by HAL_Init().
+}
+
+uint32_t NVIC_EncodePriority(uint32_t PriorityGroup, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    return PreemptPriority;
+}
+
+void __NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    irq_priority[IRQn] = priority;
+}
+
+void __NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    irq_enabled[IRQn] = true;
+    irq_dispatch();
+}
+
+void __NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    irq_enabled[IRQn] = false;
+}
+
+uint32_t __NVIC_GetPendingIRQ(IRQn_Type IRQn)
+{
+    return irq_pending[IRQn];
+}
+
+void __NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    irq_raise(IRQn);
+}
+
+void __NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    irq_pending[IRQn] = false;
+}
+
+/* HAL */
+
+uint32_t HAL_GetTick(void)
+{
+    return uwTick;
+}
+
+void HAL_SuspendTick(void)
+{
+    CLEAR_BIT(TIM7->DIER, TIM_DIER_UIE);
+}
+
+void HAL_ResumeTick(void)
+{
+    SET_BIT(TIM7->DIER, TIM_DIER_UIE);
+    if (TIM7->SR & TIM_SR_UIF)
+    {
+        irq_raise(TIM7_IRQn);
+    }
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return SystemCoreClock; // APB1 prescaler 1.
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET)
+    {
+        SET_BIT(GPIOx->ODR, GPIO_Pin);
+    }
+    else
+    {
+        CLEAR_BIT(GPIOx->ODR, GPIO_Pin);
+    }
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    uint32_t frame = 0xFFFFFFFFU; // MISO pulled up while no slave drives it.
+    for (uint32_t i = 0; i < num_spi_devices; i++)
+    {
+        Host_Spi_Device *dev = &spi_devices[i];
+        if (!(dev->cs_port->ODR & dev->cs_pin))
+        {
+            frame &= dev->read(dev->arg);
+        }
+    }
+    for (uint16_t i = 0; i < Size; i++)
+    {
+        pData[i] = i < 4 ? (uint8_t)(frame >> (24 - 8 * i)) : 0;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size)
+{
+    return HAL_ERROR; // DMA reads are not used by the reflow module.
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    SET_BIT(htim->Instance->CCER, TIM_CCER_CC1E << Channel);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    CLEAR_BIT(htim->Instance->CCER, TIM_CCER_CC1E << Channel);
+    return HAL_OK;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file host_hw.h
+ * @author Timothy Nguyen
+ * @brief Virtual clock and peripheral models of the virtual-time host build.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      One clock, counted in CPU cycles, drives everything: HAL_GetTick() (uwTick), the DWT
+ *      cycle counter behind timestamp.c, the kernel tick of host_rtos.c and the hardware events
+ *      below (UART bytes on the wire, model steps). The clock only moves in host_hw_idle(), when
+ *      every thread is blocked, and then jumps straight to the next deadline.
+ *
+ *      USART2 and UART4 are modelled at register level for uart.c and modbus.c: TXE, TC, RXNE,
+ *      ORE and RTOF follow the baud rate and raise the interrupt through a small NVIC.
+ */
+
+#ifndef _HOST_HW_H_
+#define _HOST_HW_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "stm32l4xx_hal.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define HOST_CPU_HZ 80000000U // SystemCoreClock after SystemClock_Config().
+
+#define HOST_MS_TO_CYCLES(ms) ((uint64_t)(ms) * (HOST_CPU_HZ / 1000U))
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Hardware event, runs its callback once the clock reaches its time.
+ */
+typedef struct Host_Event
+{
+    void (*cb)(struct Host_Event *evt); // Called at time, in interrupt-free context.
+    void *arg;                          // Callback argument.
+    uint64_t time;                      // Due time (cycles).
+    uint32_t seq;                       // Order of events due at the same time.
+    bool armed;                         // Scheduled?
+} Host_Event;
+
+/**
+ * @brief Receiver of bytes transmitted by a USART.
+ */
+typedef void (*host_usart_sink_t)(uint8_t byte, void *arg);
+
+/**
+ * @brief SPI slave read, returns the 32-bit frame clocked out while selected.
+ */
+typedef uint32_t (*host_spi_read_t)(void *arg);
+
+/**
+ * @brief Interrupt handler.
+ */
+typedef void (*host_irq_handler_t)(void);
+
+/**
+ * @brief Pacing of the clock, called by host_hw_idle() before it advances to next.
+ *
+ * @return Time to advance to, next or earlier to handle input from outside first.
+ */
+typedef uint64_t (*host_pace_t)(uint64_t next);
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Reset clock, registers and models to the power-on state.
+ */
+void host_hw_init(void);
+
+/**
+ * @brief Get virtual time.
+ *
+ * @return Cycles of the 80 MHz core clock since power-on.
+ */
+uint64_t host_hw_now(void);
+
+/**
+ * @brief Run until the given time, then make host_hw_idle() return false.
+ *
+ * @param time End time (cycles).
+ */
+void host_hw_stop_at(uint64_t time);
+
+/**
+ * @brief Advance the clock to the next hardware event or kernel timeout and run it.
+ *
+ * Called by the scheduler when no thread is ready.
+ *
+ * @return true if time advanced, false if the end time is reached.
+ */
+bool host_hw_idle(void);
+
+/**
+ * @brief Set the pacing of host_hw_idle(), NULL to jump straight to the next deadline.
+ */
+void host_hw_set_pace(host_pace_t pace);
+
+/**
+ * @brief Schedule an event.
+ *
+ * @param evt Event, its callback and argument set.
+ * @param time Due time (cycles), not earlier than now.
+ */
+void host_event_schedule(Host_Event *evt, uint64_t time);
+
+/**
+ * @brief Cancel a scheduled event.
+ */
+void host_event_cancel(Host_Event *evt);
+
+/**
+ * @brief Attach an interrupt handler to an interrupt number.
+ */
+void host_irq_attach(IRQn_Type irq_num, host_irq_handler_t handler);
+
+/**
+ * @brief Is an interrupt handler running or are interrupts masked?
+ */
+bool host_irq_blocked(void);
+
+/**
+ * @brief Is an enabled interrupt or SysTick pending? Ends WFI, even with interrupts masked.
+ */
+bool host_irq_pending(void);
+
+/**
+ * @brief Enable a USART, the way its MX_*_Init() function leaves it.
+ *
+ * @param usart Register block (USART2 or UART4).
+ * @param irq_num Interrupt number.
+ * @param baud_rate Baud rate, 8N1 frames.
+ * @param sink Receiver of transmitted bytes, NULL to drop them.
+ * @param arg Sink argument.
+ */
+void host_usart_open(USART_TypeDef *usart, IRQn_Type irq_num, uint32_t baud_rate,
+                     host_usart_sink_t sink, void *arg);
+
+/**
+ * @brief Queue bytes on the receive line, they arrive one frame time apart.
+ *
+ * @return Number of bytes queued, short if the line buffer is full.
+ */
+size_t host_usart_send(USART_TypeDef *usart, const uint8_t *data, size_t size);
+
+/**
+ * @brief Attach a SPI slave to a chip select line of SPI2.
+ */
+void host_spi_attach(GPIO_TypeDef *cs_port, uint16_t cs_pin, host_spi_read_t read, void *arg);
+
+/**
+ * @brief Get heater duty cycle, TIM3 channel 1 compare over period, 0 while the output is off.
+ */
+float host_pwm_duty(void);
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ * @file host_max31855k.c
+ * @author Timothy Nguyen
+ * @brief MAX31855K model of the host builds, read through HAL_SPI_Receive().
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Frames go out through host_spi_attach() of host_hw.c, which puts them on MISO while the
+ *      chip select is low, so faults pass through the driver's own decoding and fault checks.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "host_max31855k.h"
+#include "host_hw.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define HJ_LSB 0.25f   // Hot junction resolution (deg C).
+#define CJ_LSB 0.0625f // Cold junction resolution (deg C).
+
+// Signed ranges of the raw temperature fields.
+#define HJ_MIN -8192 // 14 bits.
+#define HJ_MAX 8191
+#define CJ_MIN -2048 // 12 bits.
+#define CJ_MAX 2047
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    host_max_temp_t hj; // Thermocouple temperature, NULL if not attached.
+    void *arg;          // Argument of hj.
+    float cj;           // Cold junction temperature.
+    Host_Max_mode mode; // Scripted fault.
+    float a;            // Fault parameters, see host_max_set_mode().
+    float b;
+    uint32_t frame; // Last frame clocked out.
+} Host_Max;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+static Host_Max devs[HOST_MAX_DEVICES];
+static uint64_t rng; // xorshift64* state.
+
+static const char *mode_names[NUM_HOST_MAX_MODES] = {HOST_MAX_MODE_NAMES_CSV};
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function definitions
+////////////////////////////////////////////////////////////////////////////////
+
+static float uniform(void)
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return ((rng * 2685821657736338717ULL) >> 40) / (float)(1U << 24); // [0, 1)
+}
+
+static uint32_t convert(void *arg)
+{
+    Host_Max *max = arg;
+    switch (max->mode)
+    {
+    case HOST_MAX_OPEN:
+        max->frame = host_max_encode(0.0f, max->cj, HOST_MAX_OC);
+        break;
+    case HOST_MAX_VCC:
+        max->frame = host_max_encode(0.0f, max->cj, HOST_MAX_SCV);
+        break;
+    case HOST_MAX_GND:
+        max->frame = host_max_encode(0.0f, max->cj, HOST_MAX_SCG);
+        break;
+    case HOST_MAX_ZEROS:
+        max->frame = 0;
+        break;
+    case HOST_MAX_STUCK:
+        break;
+    case HOST_MAX_TEMP:
+        max->frame = host_max_encode(max->a, max->b, 0);
+        break;
+    case HOST_MAX_NOISE:
+        max->frame = host_max_encode(max->hj(max->arg) + max->a * (2.0f * uniform() - 1.0f), max->cj, 0);
+        break;
+    default:
+        max->frame = host_max_encode(max->hj(max->arg), max->cj, 0);
+        break;
+    }
+    return max->frame;
+}
+
+static bool parse_float(const char *str, float *val)
+{
+    char *end;
+    *val = strtof(str, &end);
+    return end != str && *end == '\0' && isfinite(*val);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+void host_max_init(uint64_t seed)
+{
+    memset(devs, 0, sizeof(devs));
+    rng = seed != 0 ? seed : 1;
+}
+
+void host_max_attach(uint8_t dev, GPIO_TypeDef *cs_port, uint16_t cs_pin, host_max_temp_t hj, void *arg, float cj)
+{
+    if (dev >= HOST_MAX_DEVICES || devs[dev].hj != NULL)
+    {
+        fprintf(stderr, "host_max: device %u in use\n", dev);
+        exit(1);
+    }
+    devs[dev] = (Host_Max){.hj = hj, .arg = arg, .cj = cj};
+    host_spi_attach(cs_port, cs_pin, convert, &devs[dev]);
+}
+
+void host_max_set_mode(uint8_t dev, Host_Max_mode mode, float a, float b)
+{
+    Host_Max *max = &devs[dev];
+    max->mode = mode;
+    max->a = a;
+    max->b = b;
+}
+
+bool host_max_parse(const char *args, uint8_t *dev, Host_Max_mode *mode, float *a, float *b)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s", args);
+
+    const char *argv[4];
+    int argc = 0;
+    for (char *tok = strtok(buf, " \t"); tok != NULL; tok = strtok(NULL, " \t"))
+    {
+        if (argc == 4)
+        {
+            return false;
+        }
+        argv[argc++] = tok;
+    }
+    if (argc < 2 || argv[0][0] < '0' || argv[0][0] >= '0' + HOST_MAX_DEVICES || argv[0][1] != '\0')
+    {
+        return false;
+    }
+    *dev = argv[0][0] - '0';
+
+    *mode = NUM_HOST_MAX_MODES;
+    for (uint8_t i = 0; i < NUM_HOST_MAX_MODES; i++)
+    {
+        if (strcasecmp(argv[1], mode_names[i]) == 0)
+        {
+            *mode = i;
+        }
+    }
+
+    *a = 0.0f;
+    *b = 0.0f;
+    switch (*mode)
+    {
+    case HOST_MAX_TEMP:
+        return (argc == 3 || argc == 4) && parse_float(argv[2], a) && (argc == 3 || parse_float(argv[3], b));
+    case HOST_MAX_NOISE:
+        return argc == 3 && parse_float(argv[2], a) && *a >= 0.0f;
+    case NUM_HOST_MAX_MODES:
+        return false;
+    default:
+        return argc == 2;
+    }
+}
+
+const char *host_max_mode_name(Host_Max_mode mode)
+{
+    return mode < NUM_HOST_MAX_MODES ? mode_names[mode] : "?";
+}
+
+uint32_t host_max_encode(float hj, float cj, uint32_t faults)
+{
+    long hj_raw = lroundf(fminf(fmaxf(hj / HJ_LSB, HJ_MIN), HJ_MAX));
+    long cj_raw = lroundf(fminf(fmaxf(cj / CJ_LSB, CJ_MIN), CJ_MAX));
+    uint32_t frame = ((uint32_t)hj_raw & 0x3FFFU) << 18 | ((uint32_t)cj_raw & 0xFFFU) << 4;
+    faults &= HOST_MAX_SCV | HOST_MAX_SCG | HOST_MAX_OC;
+    return faults != 0 ? frame | HOST_MAX_FAULT | faults : frame;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file host_max31855k.h
+ * @author Timothy Nguyen
+ * @brief MAX31855K model of the host builds, read through HAL_SPI_Receive().
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Each device converts the temperature of its thermocouple into a MAX31855K frame: 14-bit
+ *      hot junction in D31-D18 and 12-bit cold junction in D15-D4, two's complement, saturated
+ *      and rounded to the nearest step. A scripted fault replaces the conversion:
+ *
+ *          open, vcc, gnd  Fault frame with D16 and D0, D2 or D1 set, cold junction kept.
+ *          zeros           MISO stuck low, every bit reads 0.
+ *          stuck           The frame clocked out when the fault was set, repeated.
+ *          temp            Fixed hot and cold junction temperatures.
+ *          noise           Uniform noise of up to +/-amplitude added to the hot junction.
+ */
+
+#ifndef _HOST_MAX31855K_H_
+#define _HOST_MAX31855K_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "stm32l4xx_hal.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define HOST_MAX_DEVICES 8 // Devices on the bus.
+
+// Fault bits.
+#define HOST_MAX_FAULT (1U << 16) // D16, set when any of D0-D2 is set.
+#define HOST_MAX_SCV (1U << 2)    // D2, short to VCC.
+#define HOST_MAX_SCG (1U << 1)    // D1, short to GND.
+#define HOST_MAX_OC (1U << 0)     // D0, open circuit.
+
+#define HOST_MAX_MODE_NAMES_CSV "off", "open", "vcc", "gnd", "zeros", "stuck", "temp", "noise"
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Scripted fault of a device.
+ */
+typedef enum
+{
+    HOST_MAX_OFF,   // Convert the thermocouple temperature.
+    HOST_MAX_OPEN,  // Open circuit fault.
+    HOST_MAX_VCC,   // Thermocouple shorted to VCC.
+    HOST_MAX_GND,   // Thermocouple shorted to GND.
+    HOST_MAX_ZEROS, // SPI reads only 0s.
+    HOST_MAX_STUCK, // Repeat the frame clocked out when the fault was set.
+    HOST_MAX_TEMP,  // Fixed hot and cold junction temperatures.
+    HOST_MAX_NOISE, // Uniform noise added to the hot junction temperature.
+
+    NUM_HOST_MAX_MODES
+} Host_Max_mode;
+
+/**
+ * @brief Hot junction temperature source (deg C).
+ */
+typedef float (*host_max_temp_t)(void *arg);
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Detach all devices and seed the noise generator.
+ */
+void host_max_init(uint64_t seed);
+
+/**
+ * @brief Attach a device to a chip select line of SPI2.
+ *
+ * @param dev Device index, less than HOST_MAX_DEVICES.
+ * @param cs_port Chip select port.
+ * @param cs_pin Chip select pin.
+ * @param hj Thermocouple temperature, read at each conversion.
+ * @param arg Argument of hj.
+ * @param cj Cold junction (die) temperature.
+ */
+void host_max_attach(uint8_t dev, GPIO_TypeDef *cs_port, uint16_t cs_pin, host_max_temp_t hj, void *arg, float cj);
+
+/**
+ * @brief Set the scripted fault of a device.
+ *
+ * @param dev Device index.
+ * @param mode Fault, HOST_MAX_OFF to convert the thermocouple temperature again.
+ * @param a Hot junction temperature of HOST_MAX_TEMP, amplitude of HOST_MAX_NOISE.
+ * @param b Cold junction temperature of HOST_MAX_TEMP.
+ */
+void host_max_set_mode(uint8_t dev, Host_Max_mode mode, float a, float b);
+
+/**
+ * @brief Parse "<dev> <mode> [<a> [<b>]]", the arguments of the host "sim" command.
+ *
+ * @param[in] args Arguments.
+ * @param[out] dev Device index.
+ * @param[out] mode Fault.
+ * @param[out] a First parameter, 0 if not given.
+ * @param[out] b Second parameter, 0 if not given.
+ *
+ * @return true if valid, false otherwise.
+ */
+bool host_max_parse(const char *args, uint8_t *dev, Host_Max_mode *mode, float *a, float *b);
+
+/**
+ * @brief Get the name of a fault.
+ */
+const char *host_max_mode_name(Host_Max_mode mode);
+
+/**
+ * @brief Encode a MAX31855K frame.
+ *
+ * @param hj Hot junction temperature, saturated to the 14-bit range.
+ * @param cj Cold junction temperature, saturated to the 12-bit range.
+ * @param faults D0-D2 fault bits, D16 is set if any of them is set.
+ *
+ * @return Frame, D31 first on the wire.
+ */
+uint32_t host_max_encode(float hj, float cj, uint32_t faults);
+
+#endif
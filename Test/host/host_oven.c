@@ -0,0 +1,149 @@
+/**
+ * @file host_oven.c
+ * @author Timothy Nguyen
+ * @brief Oven plant of the virtual-time host build.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      The model steps in fixed 100 ms increments with the duty cycle TIM3 outputs at each step,
+ *      so its trajectory does not depend on when the firmware reads the thermocouples.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "host_oven.h"
+#include "host_hw.h"
+#include "host_max31855k.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define STEP_MS 100U                         // Model step.
+#define STEP_S (STEP_MS / 1000.0f)           // Model step (s).
+#define MAX_DEAD_STEPS 1200U                 // Dead time up to 120 s.
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+static Host_Oven_cfg cfg;
+static float temp;    // Oven air (deg C).
+static float element; // Heater element (deg C).
+static float board;   // Test board (deg C).
+static float elapsed; // Model time (s).
+static uint64_t rng;  // xorshift64* state.
+
+static float dead_line[MAX_DEAD_STEPS]; // Element temperatures on their way to the air.
+static uint32_t dead_steps;
+static uint32_t dead_idx;
+
+static Host_Event step_evt;
+
+static uint8_t tc_ids[NUM_REFLOW_TCS]; // Temperature source arguments.
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function definitions
+////////////////////////////////////////////////////////////////////////////////
+
+static float uniform(void)
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return ((rng * 2685821657736338717ULL) >> 40) / (float)(1U << 24); // [0, 1)
+}
+
+static float gauss(float sigma)
+{
+    float u1 = 1.0f - uniform(); // (0, 1]
+    float u2 = uniform();
+    return sigma * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+/* Open oven thermocouple B once its time has come. */
+static void check_tc_open(void)
+{
+    if (cfg.tc_open >= 0.0f && elapsed >= cfg.tc_open)
+    {
+        host_max_set_mode(REFLOW_TC_OVEN_B, HOST_MAX_OPEN, 0.0f, 0.0f);
+        cfg.tc_open = -1.0f;
+    }
+}
+
+static void step(Host_Event *evt)
+{
+    float target = cfg.ambient + cfg.gain * host_pwm_duty();
+    if (cfg.element_tau > 0.0f)
+    {
+        element += (target - element) / cfg.element_tau * STEP_S;
+    }
+    else
+    {
+        element = target;
+    }
+
+    float heat = dead_line[dead_idx];
+    dead_line[dead_idx] = element;
+    dead_idx = (dead_idx + 1) % dead_steps;
+
+    temp += (heat - temp) / cfg.tau * STEP_S;
+    board += (temp - board) * (1.0f - expf(-STEP_S / cfg.board_tau));
+    elapsed += STEP_S;
+    check_tc_open();
+
+    host_event_schedule(evt, host_hw_now() + HOST_MS_TO_CYCLES(STEP_MS));
+}
+
+static float tc_temp(void *arg)
+{
+    uint8_t tc = *(uint8_t *)arg;
+    switch (tc)
+    {
+    case REFLOW_TC_ELEMENT:
+        return element + gauss(cfg.noise);
+    case REFLOW_TC_PROBE:
+        return board + gauss(cfg.noise);
+    case REFLOW_TC_OVEN_B:
+        return temp + cfg.tc_drift * elapsed / 60.0f + gauss(cfg.noise);
+    default:
+        return temp + gauss(cfg.noise);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+void host_oven_init(const Host_Oven_cfg *oven_cfg, const Reflow_cfg_t *reflow_cfg)
+{
+    cfg = *oven_cfg;
+    temp = element = board = cfg.ambient;
+    elapsed = 0.0f;
+    rng = cfg.seed != 0 ? cfg.seed : 1;
+
+    dead_steps = (uint32_t)(cfg.dead_time / STEP_S);
+    dead_steps = dead_steps < 1 ? 1 : dead_steps > MAX_DEAD_STEPS ? MAX_DEAD_STEPS : dead_steps;
+    for (uint32_t i = 0; i < dead_steps; i++)
+    {
+        dead_line[i] = cfg.ambient;
+    }
+    dead_idx = 0;
+
+    for (uint8_t tc = 0; tc < NUM_REFLOW_TCS; tc++)
+    {
+        tc_ids[tc] = tc;
+        host_max_attach(tc, reflow_cfg->max_cfg[tc].max_cs_port, reflow_cfg->max_cfg[tc].max_cs_pin,
+                        tc_temp, &tc_ids[tc], cfg.ambient);
+    }
+    check_tc_open();
+
+    step_evt.cb = step;
+    host_event_schedule(&step_evt, host_hw_now() + HOST_MS_TO_CYCLES(STEP_MS));
+}
+
+float host_oven_temp(void)
+{
+    return temp;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file host_oven.h
+ * @author Timothy Nguyen
+ * @brief Oven plant of the virtual-time host build, read through MAX31855K models.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      First-order-plus-dead-time oven driven by the TIM3 heater duty, stepped every 100 ms of
+ *      virtual time. The heater element lags the heater by element_tau, the oven air lags the
+ *      element by tau after dead_time, and the test board under the probe thermocouple lags the
+ *      air by board_tau. Redundant oven thermocouple B drifts by tc_drift and opens after tc_open.
+ *      Readings carry Gaussian noise from a seeded generator; host_max31855k.c converts them.
+ */
+
+#ifndef _HOST_OVEN_H_
+#define _HOST_OVEN_H_
+
+#include <stdint.h>
+
+#include "reflow.h"
+
+/**
+ * @brief Oven model parameters.
+ */
+typedef struct
+{
+    float ambient;     // Ambient temperature (deg C).
+    float gain;        // Steady-state rise above ambient at full power (deg C).
+    float tau;         // Oven time constant (s).
+    float dead_time;   // Heater to thermocouple dead time (s).
+    float element_tau; // Heater element time constant (s), 0 to follow the heater instantly.
+    float board_tau;   // Test board lag behind oven air (s).
+    float noise;       // Thermocouple noise (deg C, 1 sigma).
+    float tc_drift;    // Drift of oven thermocouple B (deg C/min).
+    float tc_open;     // Open oven thermocouple B after this many seconds, negative for never.
+    uint64_t seed;     // Noise generator seed.
+} Host_Oven_cfg;
+
+#define HOST_OVEN_CFG_DEFAULT                                                                   \
+    {                                                                                           \
+        .ambient = 25.0f, .gain = 300.0f, .tau = 180.0f, .dead_time = 8.0f, .element_tau = 0.0f, \
+        .board_tau = 40.0f, .noise = 0.1f, .tc_drift = 0.0f, .tc_open = -1.0f, .seed = 1         \
+    }
+
+/**
+ * @brief Start the oven at ambient temperature and attach a MAX31855K model to each chip select
+ *        of the reflow configuration, device index = thermocouple index.
+ *
+ * @param cfg Model parameters.
+ * @param reflow_cfg Reflow configuration passed to reflow_init().
+ */
+void host_oven_init(const Host_Oven_cfg *cfg, const Reflow_cfg_t *reflow_cfg);
+
+/**
+ * @brief Get oven air temperature without noise (deg C).
+ */
+float host_oven_temp(void);
+
+#endif
@@ -0,0 +1,305 @@
+/**
+ * @file host_pty.c
+ * @author Timothy Nguyen
+ * @brief Pseudo-terminal links of the virtual-time host build.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      The pace hook of host_hw_idle() holds the virtual clock back to the wall clock. While it
+ *      waits it moves transmitted bytes to the masters and reads input, which goes on the receive
+ *      line of the USART model at the virtual time it arrived.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_pty.h"
+#include "host_hw.h"
+
+// After the register blocks, termios.h defines CR1 to CR3 as macros.
+#include <termios.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define MAX_PTYS 4
+#define MAX_WAIT_S 0.01 // Longest wait, keeps output flowing while the firmware sleeps.
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+static Host_Pty *ptys[MAX_PTYS];
+static size_t num_ptys;
+static double cycles_per_s; // Virtual cycles per wall clock second.
+static struct timespec start;
+static double last_refill; // Wall clock time of the last bucket refill (s).
+static volatile sig_atomic_t stop_requested;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/* Wall clock time since host_pty_start() (s). */
+static double elapsed(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)(ts.tv_sec - start.tv_sec) + (ts.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+static void stop(int sig)
+{
+    stop_requested = 1;
+}
+
+static void refill(double wall_s)
+{
+    double dt = wall_s - last_refill;
+    last_refill = wall_s;
+    for (size_t i = 0; i < num_ptys; i++)
+    {
+        Host_Pty *pty = ptys[i];
+        pty->rx_budget = fmin(pty->burst, pty->rx_budget + dt * pty->bytes_per_s);
+        pty->tx_budget = fmin(pty->burst, pty->tx_budget + dt * pty->bytes_per_s);
+    }
+}
+
+static void flush(Host_Pty *pty)
+{
+    while (pty->tx_count > 0 && pty->tx_budget >= 1.0)
+    {
+        size_t size = HOST_PTY_TX_SIZE - pty->tx_head;
+        size = pty->tx_count < size ? pty->tx_count : size;
+        size = (size_t)pty->tx_budget < size ? (size_t)pty->tx_budget : size;
+        ssize_t sent = write(pty->master, &pty->tx[pty->tx_head], size);
+        if (sent <= 0)
+        {
+            return; // Host not reading, the master buffer is full.
+        }
+        pty->tx_head = (pty->tx_head + (size_t)sent) % HOST_PTY_TX_SIZE;
+        pty->tx_count -= (size_t)sent;
+        pty->tx_budget -= (double)sent;
+    }
+}
+
+/* Read host input within the budget, true if any arrived. */
+static bool receive(Host_Pty *pty)
+{
+    size_t size = HOST_PTY_RX_SIZE - pty->rx_count;
+    size = (size_t)pty->rx_budget < size ? (size_t)pty->rx_budget : size;
+    if (size == 0)
+    {
+        return false;
+    }
+    ssize_t got = read(pty->master, &pty->rx[pty->rx_count], size);
+    if (got <= 0)
+    {
+        return false; // Nothing waiting.
+    }
+    pty->rx_count += (size_t)got;
+    pty->rx_budget -= (double)got;
+    return true;
+}
+
+/* Queue input read by the previous call on the receive lines, true if any was queued. */
+static bool deliver(void)
+{
+    bool queued = false;
+    for (size_t i = 0; i < num_ptys; i++)
+    {
+        Host_Pty *pty = ptys[i];
+        size_t size = host_usart_send(pty->usart, pty->rx, pty->rx_count);
+        memmove(pty->rx, &pty->rx[size], pty->rx_count - size);
+        pty->rx_count -= size;
+        queued |= size > 0;
+    }
+    return queued;
+}
+
+static uint64_t pace(uint64_t next)
+{
+    if (deliver())
+    {
+        return host_hw_now(); // The receive events may come before next.
+    }
+
+    for (;;)
+    {
+        if (stop_requested)
+        {
+            host_hw_stop_at(host_hw_now());
+            return next;
+        }
+
+        double wall_s = elapsed();
+        refill(wall_s);
+        bool input = false;
+        for (size_t i = 0; i < num_ptys; i++)
+        {
+            flush(ptys[i]);
+            input |= receive(ptys[i]);
+        }
+
+        uint64_t wall = (uint64_t)(wall_s * cycles_per_s);
+        if (wall >= next)
+        {
+            return next; // Behind the wall clock, input waits for the next call.
+        }
+        if (input)
+        {
+            return wall > host_hw_now() ? wall : host_hw_now();
+        }
+
+        /* Sleep until next, input or the budget for waiting bytes, whichever comes first. */
+        double wait_s = fmin((double)(next - wall) / cycles_per_s, MAX_WAIT_S);
+        struct pollfd fds[MAX_PTYS];
+        for (size_t i = 0; i < num_ptys; i++)
+        {
+            Host_Pty *pty = ptys[i];
+            fds[i] = (struct pollfd){.fd = pty->master};
+            if (pty->rx_count < HOST_PTY_RX_SIZE)
+            {
+                if (pty->rx_budget >= 1.0)
+                {
+                    fds[i].events |= POLLIN;
+                }
+                else
+                {
+                    wait_s = fmin(wait_s, (1.0 - pty->rx_budget) / pty->bytes_per_s);
+                }
+            }
+            if (pty->tx_count > 0)
+            {
+                if (pty->tx_budget >= 1.0)
+                {
+                    fds[i].events |= POLLOUT;
+                }
+                else
+                {
+                    wait_s = fmin(wait_s, (1.0 - pty->tx_budget) / pty->bytes_per_s);
+                }
+            }
+        }
+        struct timespec timeout = {.tv_sec = 0, .tv_nsec = (long)(wait_s * 1e9)};
+        ppoll(fds, num_ptys, &timeout, NULL);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+bool host_pty_open(Host_Pty *pty, const char *link)
+{
+    memset(pty, 0, sizeof(*pty));
+    pty->slave = -1;
+    pty->master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (pty->master < 0 || grantpt(pty->master) != 0 || unlockpt(pty->master) != 0 ||
+        ptsname_r(pty->master, pty->path, sizeof(pty->path)) != 0)
+    {
+        perror("host_pty: posix_openpt");
+        host_pty_close(pty);
+        return false;
+    }
+
+    /* Raw mode on the slave, kept open so the settings and master survive host tools closing it. */
+    struct termios tio;
+    pty->slave = open(pty->path, O_RDWR | O_NOCTTY);
+    if (pty->slave < 0 || tcgetattr(pty->slave, &tio) != 0)
+    {
+        perror(pty->path);
+        host_pty_close(pty);
+        return false;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(pty->slave, TCSANOW, &tio);
+
+    if (link != NULL)
+    {
+        struct stat st;
+        if (lstat(link, &st) == 0 && S_ISLNK(st.st_mode))
+        {
+            unlink(link);
+        }
+        if (symlink(pty->path, link) != 0)
+        {
+            perror(link);
+            host_pty_close(pty);
+            return false;
+        }
+        snprintf(pty->link, sizeof(pty->link), "%s", link);
+    }
+    return true;
+}
+
+void host_pty_close(Host_Pty *pty)
+{
+    if (pty->link[0] != '\0')
+    {
+        unlink(pty->link);
+        pty->link[0] = '\0';
+    }
+    if (pty->slave >= 0)
+    {
+        close(pty->slave);
+        pty->slave = -1;
+    }
+    if (pty->master >= 0)
+    {
+        close(pty->master);
+        pty->master = -1;
+    }
+}
+
+void host_pty_attach(Host_Pty *pty, USART_TypeDef *usart, IRQn_Type irq_num, uint32_t baud_rate, double speed)
+{
+    pty->usart = usart;
+    pty->bytes_per_s = baud_rate / 10.0; // 8N1
+    pty->burst = fmax(16.0, pty->bytes_per_s / 100.0);
+    pty->rx_budget = pty->burst;
+    pty->tx_budget = pty->burst;
+    host_usart_open(usart, irq_num, (uint32_t)lround(baud_rate / speed), host_pty_sink, pty);
+}
+
+void host_pty_sink(uint8_t byte, void *arg)
+{
+    Host_Pty *pty = arg;
+    if (pty->tx_count == HOST_PTY_TX_SIZE)
+    {
+        pty->tx_dropped++;
+        return;
+    }
+    pty->tx[(pty->tx_head + pty->tx_count++) % HOST_PTY_TX_SIZE] = byte;
+}
+
+void host_pty_start(Host_Pty *const *links, size_t num_links, double speed)
+{
+    if (num_links > MAX_PTYS)
+    {
+        fprintf(stderr, "host_pty: too many links\n");
+        exit(1);
+    }
+    memcpy(ptys, links, num_links * sizeof(*links));
+    num_ptys = num_links;
+    cycles_per_s = speed * HOST_CPU_HZ;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    last_refill = 0.0;
+
+    struct sigaction sa = {.sa_handler = stop};
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    host_hw_set_pace(pace);
+}
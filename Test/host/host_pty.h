@@ -0,0 +1,116 @@
+/**
+ * @file host_pty.h
+ * @author Timothy Nguyen
+ * @brief Pseudo-terminal links of the virtual-time host build.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      A pty stands in for the wire of a USART model: the slave side behaves like the board's
+ *      ST-Link virtual COM port (console) or a RS-485 adapter (Modbus), so the host tools open
+ *      its path as they would /dev/ttyACM0. host_pty_start() paces the virtual clock against
+ *      the wall clock, --speed virtual seconds per second.
+ *
+ *      The USART model runs at the link baud rate divided by the speed, so the firmware sees the
+ *      link drain at the baud rate in real time and drops output when its transmit buffer fills,
+ *      as on hardware. On the pty side both directions are throttled by a token bucket of
+ *      baud / 10 bytes per second, with a burst of 10 ms (16 bytes at least).
+ */
+
+#ifndef _HOST_PTY_H_
+#define _HOST_PTY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "stm32l4xx_hal.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define HOST_PTY_PATH_SIZE 256
+#define HOST_PTY_RX_SIZE 256  // Bytes read from the host, waiting for the receive line.
+#define HOST_PTY_TX_SIZE 4096 // Bytes transmitted, waiting for the host.
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Pty link.
+ */
+typedef struct
+{
+    int master;                    // Host tool side, read and written here.
+    int slave;                     // Kept open so the master survives reconnects of host tools.
+    char path[HOST_PTY_PATH_SIZE]; // Slave device.
+    char link[HOST_PTY_PATH_SIZE]; // Symlink to path, empty if none.
+    USART_TypeDef *usart;          // Attached USART model.
+
+    /* Token buckets (bytes) */
+    double bytes_per_s;
+    double burst;
+    double rx_budget;
+    double tx_budget;
+
+    uint8_t rx[HOST_PTY_RX_SIZE];
+    size_t rx_count;
+    uint8_t tx[HOST_PTY_TX_SIZE];
+    size_t tx_head;
+    size_t tx_count;
+    uint32_t tx_dropped; // Bytes lost while the host did not read.
+} Host_Pty;
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Open a pty in raw mode.
+ *
+ * @param pty Link.
+ * @param link Symlink to create to the slave device, replacing an older symlink, NULL for none.
+ *
+ * @return true if successful, false otherwise (reported on stderr).
+ */
+bool host_pty_open(Host_Pty *pty, const char *link);
+
+/**
+ * @brief Close a pty and remove its symlink.
+ */
+void host_pty_close(Host_Pty *pty);
+
+/**
+ * @brief Connect a pty to a USART model.
+ *
+ * Opens the USART with host_usart_open() at baud_rate / speed, host_pty_sink() as its sink.
+ *
+ * @param pty Link.
+ * @param usart Register block (USART2 or UART4).
+ * @param irq_num Interrupt number.
+ * @param baud_rate Baud rate of the link.
+ * @param speed Virtual seconds per wall clock second.
+ */
+void host_pty_attach(Host_Pty *pty, USART_TypeDef *usart, IRQn_Type irq_num, uint32_t baud_rate, double speed);
+
+/**
+ * @brief USART sink, queues a transmitted byte for the host.
+ *
+ * @param byte Byte.
+ * @param arg Link.
+ */
+void host_pty_sink(uint8_t byte, void *arg);
+
+/**
+ * @brief Pace host_hw_idle() by the wall clock and serve the attached ptys.
+ *
+ * Call at virtual time 0. SIGINT and SIGTERM end the run at the current virtual time.
+ *
+ * @param ptys Attached links.
+ * @param num_ptys Number of links.
+ * @param speed Virtual seconds per wall clock second.
+ */
+void host_pty_start(Host_Pty *const *ptys, size_t num_ptys, double speed);
+
+#endif
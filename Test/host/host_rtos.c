@@ -0,0 +1,734 @@
+/**
+ * @file host_rtos.c
+ * @author Timothy Nguyen
+ * @brief CMSIS-RTOS2 and FreeRTOS calls of the firmware on a host scheduler in virtual time.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Each thread is a ucontext coroutine with its own host stack. The scheduler runs in the
+ *      context of osKernelStart(): it resumes the highest priority ready thread (first ready
+ *      first among equal priorities) until that thread blocks or is preempted, and asks the
+ *      hardware model to advance the clock when no thread is ready. Preemption happens where
+ *      FreeRTOS would switch: when a call wakes a higher priority thread, and when the kernel is
+ *      unlocked, interrupts are unmasked or an interrupt handler returns.
+ *
+ *      Software timers run in a timer service thread at configTIMER_TASK_PRIORITY. Priority
+ *      inheritance and thread stacks of the firmware attributes are not modelled.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include "host_rtos.h"
+#include "host_hw.h"
+#include "cmsis_os.h"
+#include "task.h"
+#include "timers.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define MAX_THREADS 16
+#define MAX_QUEUES 16
+#define MAX_SEMAPHORES 8
+#define MAX_MUTEXES 16
+#define MAX_TIMERS 16
+
+#define THREAD_STACK_SIZE (256U * 1024U) // Host stack of each thread, firmware sizes are for ARM.
+
+/* Abort on misuse the firmware kernel would assert on. */
+#define RTOS_CHECK(cond)                                                               \
+    do                                                                                 \
+    {                                                                                  \
+        if (!(cond))                                                                   \
+        {                                                                              \
+            fprintf(stderr, "host_rtos: %s:%d: %s failed\n", __FILE__, __LINE__, #cond); \
+            abort();                                                                   \
+        }                                                                              \
+    } while (0)
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum
+{
+    THREAD_READY,
+    THREAD_BLOCKED,
+    THREAD_TERMINATED
+} Thread_State;
+
+typedef struct
+{
+    ucontext_t ctx;
+    osThreadFunc_t func;
+    void *argument;
+    const char *name;
+    osPriority_t priority;
+    Thread_State state;
+    uint32_t seq;          // Ready or block order, first in first out among equal priorities.
+    const void *wait_obj;  // Object the thread is blocked on.
+    bool timed;            // Blocked with a timeout?
+    uint32_t wake_tick;    // Tick the timeout expires.
+    osStatus_t wait_result; // osOK when woken by the object, osErrorTimeout on timeout.
+    uint32_t stack_words;  // Firmware stack size, reported as high water mark.
+    void *stack;
+} Host_Thread;
+
+typedef struct
+{
+    uint8_t *buf;
+    uint32_t msg_size;
+    uint32_t msg_count;
+    uint32_t count;
+    uint32_t head;
+} Host_Queue;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_count;
+} Host_Semaphore;
+
+typedef struct
+{
+    Host_Thread *owner;
+    uint32_t depth;
+    bool recursive;
+} Host_Mutex;
+
+typedef struct
+{
+    TimerCallbackFunction_t cb;
+    uint32_t period;
+    uint32_t expiry;
+    bool reload;
+    bool active;
+} Host_Timer;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+static Host_Thread threads[MAX_THREADS];
+static uint32_t num_threads;
+
+static Host_Queue queues[MAX_QUEUES];
+static uint32_t num_queues;
+
+static Host_Semaphore semaphores[MAX_SEMAPHORES];
+static uint32_t num_semaphores;
+
+static Host_Mutex mutexes[MAX_MUTEXES];
+static uint32_t num_mutexes;
+
+static Host_Timer timers[MAX_TIMERS];
+static uint32_t num_timers;
+
+static ucontext_t sched_ctx;   // Scheduler context of osKernelStart().
+static Host_Thread *current;   // Running thread, NULL in scheduler and initialization code.
+static uint32_t seq;           // Source of thread order numbers.
+static bool need_resched;      // A thread was made ready while another runs.
+
+static osKernelState_t kernel_state = osKernelInactive;
+static bool kernel_locked;
+static uint32_t tick;
+
+static Host_Thread *timer_thread; // Timer service thread.
+static const char timer_wait;     // Timer service blocks on this while no timer is due.
+static const char delay_wait;     // osDelay() blocks on this.
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function definitions
+////////////////////////////////////////////////////////////////////////////////
+
+static void make_ready(Host_Thread *thread, osStatus_t result)
+{
+    thread->state = THREAD_READY;
+    thread->wait_obj = NULL;
+    thread->timed = false;
+    thread->wait_result = result;
+    thread->seq = ++seq;
+    if (current != NULL && thread->priority > current->priority)
+    {
+        need_resched = true;
+    }
+}
+
+/* Resume the scheduler until this thread is picked again. */
+static void switch_out(void)
+{
+    Host_Thread *self = current;
+    RTOS_CHECK(swapcontext(&self->ctx, &sched_ctx) == 0);
+}
+
+/* Block the running thread on an object, return why it was woken. */
+static osStatus_t block(const void *obj, uint32_t timeout)
+{
+    RTOS_CHECK(current != NULL && !host_irq_blocked());
+
+    Host_Thread *self = current;
+    self->state = THREAD_BLOCKED;
+    self->wait_obj = obj;
+    self->timed = timeout != osWaitForever;
+    self->wake_tick = tick + timeout;
+    self->seq = ++seq;
+    switch_out();
+    return self->wait_result;
+}
+
+/* Wake the highest priority thread blocked on an object, the longest waiting among equals. */
+static bool wake_one(const void *obj)
+{
+    Host_Thread *best = NULL;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        Host_Thread *t = &threads[i];
+        if (t->state == THREAD_BLOCKED && t->wait_obj == obj &&
+            (best == NULL || t->priority > best->priority ||
+             (t->priority == best->priority && (int32_t)(t->seq - best->seq) < 0)))
+        {
+            best = t;
+        }
+    }
+    if (best != NULL)
+    {
+        make_ready(best, osOK);
+    }
+    return best != NULL;
+}
+
+/* Remaining ticks of a timeout started at start_tick. */
+static uint32_t remaining(uint32_t timeout, uint32_t start_tick)
+{
+    if (timeout == osWaitForever)
+    {
+        return osWaitForever;
+    }
+    uint32_t elapsed = tick - start_tick;
+    return elapsed >= timeout ? 0 : timeout - elapsed;
+}
+
+static Host_Thread *pick(void)
+{
+    Host_Thread *best = NULL;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        Host_Thread *t = &threads[i];
+        if (t->state == THREAD_READY &&
+            (best == NULL || t->priority > best->priority ||
+             (t->priority == best->priority && (int32_t)(t->seq - best->seq) < 0)))
+        {
+            best = t;
+        }
+    }
+    return best;
+}
+
+static void thread_entry(void)
+{
+    current->func(current->argument);
+    osThreadTerminate(current);
+}
+
+/* Active timer due first, NULL if none. */
+static Host_Timer *next_timer(void)
+{
+    Host_Timer *next = NULL;
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        Host_Timer *t = &timers[i];
+        if (t->active && (next == NULL || (int32_t)(t->expiry - next->expiry) < 0))
+        {
+            next = t;
+        }
+    }
+    return next;
+}
+
+static void timer_service(void *argument)
+{
+    for (;;)
+    {
+        Host_Timer *t = next_timer();
+        if (t != NULL && (int32_t)(t->expiry - tick) <= 0)
+        {
+            if (t->reload)
+            {
+                t->expiry += t->period;
+            }
+            else
+            {
+                t->active = false;
+            }
+            t->cb((TimerHandle_t)t);
+            continue;
+        }
+        block(&timer_wait, t != NULL ? t->expiry - tick : osWaitForever);
+    }
+}
+
+static void timer_service_wake(void)
+{
+    if (timer_thread != NULL && timer_thread->state == THREAD_BLOCKED)
+    {
+        make_ready(timer_thread, osOK);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+void host_rtos_tick(uint32_t ticks)
+{
+    tick += ticks;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        Host_Thread *t = &threads[i];
+        if (t->state == THREAD_BLOCKED && t->timed && (int32_t)(tick - t->wake_tick) >= 0)
+        {
+            make_ready(t, osErrorTimeout);
+        }
+    }
+}
+
+bool host_rtos_next_timeout(uint32_t *ticks)
+{
+    bool found = false;
+    for (uint32_t i = 0; i < num_threads; i++)
+    {
+        Host_Thread *t = &threads[i];
+        if (t->state == THREAD_BLOCKED && t->timed)
+        {
+            uint32_t left = (int32_t)(t->wake_tick - tick) > 0 ? t->wake_tick - tick : 0;
+            if (!found || left < *ticks)
+            {
+                *ticks = left;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+void host_rtos_yield_if_needed(void)
+{
+    if (current == NULL || !need_resched || kernel_locked || host_irq_blocked())
+    {
+        return;
+    }
+    need_resched = false;
+
+    Host_Thread *next = pick();
+    if (next != NULL && next->priority > current->priority)
+    {
+        current->seq = ++seq; // Preempted thread queues behind its equals.
+        switch_out();
+    }
+}
+
+bool host_rtos_in_thread(void)
+{
+    return current != NULL;
+}
+
+/* Kernel */
+
+osStatus_t osKernelInitialize(void)
+{
+    kernel_state = osKernelReady;
+    return osOK;
+}
+
+osStatus_t osKernelStart(void)
+{
+    static const osThreadAttr_t timer_attr = {.name = "Tmr Svc",
+                                              .priority = (osPriority_t)configTIMER_TASK_PRIORITY};
+    timer_thread = osThreadNew(timer_service, NULL, &timer_attr);
+    kernel_state = osKernelRunning;
+
+    for (;;)
+    {
+        Host_Thread *next = pick();
+        if (next != NULL)
+        {
+            current = next;
+            need_resched = false;
+            RTOS_CHECK(swapcontext(&sched_ctx, &next->ctx) == 0);
+            current = NULL;
+        }
+        else if (!host_hw_idle())
+        {
+            break;
+        }
+    }
+    return osOK;
+}
+
+osKernelState_t osKernelGetState(void)
+{
+    return kernel_locked ? osKernelLocked : kernel_state;
+}
+
+int32_t osKernelLock(void)
+{
+    int32_t prev = kernel_locked;
+    kernel_locked = true;
+    return prev;
+}
+
+int32_t osKernelUnlock(void)
+{
+    int32_t prev = kernel_locked;
+    kernel_locked = false;
+    host_rtos_yield_if_needed();
+    return prev;
+}
+
+uint32_t osKernelGetTickCount(void)
+{
+    return tick;
+}
+
+/* Threads */
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    RTOS_CHECK(num_threads < MAX_THREADS);
+    Host_Thread *t = &threads[num_threads++];
+    memset(t, 0, sizeof(*t));
+
+    t->func = func;
+    t->argument = argument;
+    t->name = attr != NULL && attr->name != NULL ? attr->name : "";
+    t->priority = attr != NULL && attr->priority != osPriorityNone ? attr->priority : osPriorityNormal;
+    t->stack_words = attr != NULL ? attr->stack_size / sizeof(uint32_t) : 0;
+    t->stack = malloc(THREAD_STACK_SIZE);
+    RTOS_CHECK(t->stack != NULL);
+
+    RTOS_CHECK(getcontext(&t->ctx) == 0);
+    t->ctx.uc_stack.ss_sp = t->stack;
+    t->ctx.uc_stack.ss_size = THREAD_STACK_SIZE;
+    t->ctx.uc_link = &sched_ctx;
+    makecontext(&t->ctx, thread_entry, 0);
+
+    make_ready(t, osOK);
+    host_rtos_yield_if_needed();
+    return t;
+}
+
+osThreadId_t osThreadGetId(void)
+{
+    return current;
+}
+
+osStatus_t osThreadSetPriority(osThreadId_t thread_id, osPriority_t priority)
+{
+    Host_Thread *t = thread_id;
+    if (t == NULL || priority <= osPriorityNone || priority > osPriorityISR)
+    {
+        return osErrorParameter;
+    }
+    t->priority = priority;
+    need_resched = true;
+    host_rtos_yield_if_needed();
+    return osOK;
+}
+
+osStatus_t osThreadTerminate(osThreadId_t thread_id)
+{
+    Host_Thread *t = thread_id;
+    if (t == NULL || t->state == THREAD_TERMINATED)
+    {
+        return osErrorParameter;
+    }
+    t->state = THREAD_TERMINATED;
+    if (t == current)
+    {
+        switch_out(); // Never resumed.
+    }
+    return osOK;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    if (ticks != 0)
+    {
+        block(&delay_wait, ticks);
+    }
+    return osOK;
+}
+
+/* Timers */
+
+TimerHandle_t xTimerCreateStatic(const char *const pcTimerName,
+                                 const TickType_t xTimerPeriodInTicks,
+                                 const UBaseType_t uxAutoReload,
+                                 void *const pvTimerID,
+                                 TimerCallbackFunction_t pxCallbackFunction,
+                                 StaticTimer_t *pxTimerBuffer)
+{
+    RTOS_CHECK(num_timers < MAX_TIMERS);
+    Host_Timer *t = &timers[num_timers++];
+    *t = (Host_Timer){.cb = pxCallbackFunction,
+                      .period = xTimerPeriodInTicks,
+                      .reload = uxAutoReload != pdFALSE};
+    return t;
+}
+
+BaseType_t xTimerStop(TimerHandle_t xTimer, const TickType_t xTicksToWait)
+{
+    ((Host_Timer *)xTimer)->active = false;
+    return pdPASS;
+}
+
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks)
+{
+    Host_Timer *t = timer_id;
+    if (t == NULL || ticks == 0)
+    {
+        return osErrorParameter;
+    }
+    t->period = ticks;
+    t->expiry = tick + ticks;
+    t->active = true;
+    timer_service_wake();
+    host_rtos_yield_if_needed();
+    return osOK;
+}
+
+osStatus_t osTimerStop(osTimerId_t timer_id)
+{
+    Host_Timer *t = timer_id;
+    if (t == NULL)
+    {
+        return osErrorParameter;
+    }
+    if (!t->active)
+    {
+        return osErrorResource;
+    }
+    t->active = false;
+    return osOK;
+}
+
+/* Mutexes */
+
+osMutexId_t osMutexNew(const osMutexAttr_t *attr)
+{
+    RTOS_CHECK(num_mutexes < MAX_MUTEXES);
+    Host_Mutex *m = &mutexes[num_mutexes++];
+    *m = (Host_Mutex){.recursive = attr != NULL && (attr->attr_bits & osMutexRecursive)};
+    return m;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    Host_Mutex *m = mutex_id;
+    if (host_irq_blocked() && timeout != 0)
+    {
+        return osErrorISR;
+    }
+    if (current == NULL)
+    {
+        return osOK; // Before the scheduler starts there is nobody to exclude.
+    }
+
+    uint32_t start_tick = tick;
+    for (;;)
+    {
+        if (m->owner == NULL)
+        {
+            m->owner = current;
+            m->depth = 1;
+            return osOK;
+        }
+        if (m->owner == current && m->recursive)
+        {
+            m->depth++;
+            return osOK;
+        }
+        uint32_t left = remaining(timeout, start_tick);
+        if (left == 0)
+        {
+            return timeout == 0 ? osErrorResource : osErrorTimeout;
+        }
+        if (block(m, left) != osOK)
+        {
+            return osErrorTimeout;
+        }
+    }
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    Host_Mutex *m = mutex_id;
+    if (current == NULL)
+    {
+        return osOK;
+    }
+    if (m->owner != current)
+    {
+        return osErrorResource;
+    }
+    if (--m->depth == 0)
+    {
+        m->owner = NULL;
+        wake_one(m);
+        host_rtos_yield_if_needed();
+    }
+    return osOK;
+}
+
+/* Semaphores */
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr)
+{
+    RTOS_CHECK(num_semaphores < MAX_SEMAPHORES);
+    Host_Semaphore *s = &semaphores[num_semaphores++];
+    *s = (Host_Semaphore){.count = initial_count, .max_count = max_count};
+    return s;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    Host_Semaphore *s = semaphore_id;
+    uint32_t start_tick = tick;
+    for (;;)
+    {
+        if (s->count > 0)
+        {
+            s->count--;
+            return osOK;
+        }
+        uint32_t left = remaining(timeout, start_tick);
+        if (left == 0 || host_irq_blocked())
+        {
+            return timeout == 0 ? osErrorResource : osErrorTimeout;
+        }
+        if (block(s, left) != osOK)
+        {
+            return osErrorTimeout;
+        }
+    }
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    Host_Semaphore *s = semaphore_id;
+    if (s->count == s->max_count)
+    {
+        return osErrorResource;
+    }
+    s->count++;
+    wake_one(s);
+    host_rtos_yield_if_needed();
+    return osOK;
+}
+
+/* Message queues, receivers block on the queue and senders on its count. */
+
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr)
+{
+    RTOS_CHECK(num_queues < MAX_QUEUES);
+    Host_Queue *q = &queues[num_queues++];
+    *q = (Host_Queue){.buf = calloc(msg_count, msg_size), .msg_size = msg_size, .msg_count = msg_count};
+    RTOS_CHECK(q->buf != NULL);
+    return q;
+}
+
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout)
+{
+    Host_Queue *q = mq_id;
+    if (q == NULL || msg_ptr == NULL)
+    {
+        return osErrorParameter;
+    }
+
+    uint32_t start_tick = tick;
+    while (q->count == q->msg_count)
+    {
+        uint32_t left = remaining(timeout, start_tick);
+        if (left == 0 || host_irq_blocked())
+        {
+            return timeout == 0 ? osErrorResource : osErrorTimeout;
+        }
+        if (block(&q->count, left) != osOK)
+        {
+            return osErrorTimeout;
+        }
+    }
+
+    memcpy(&q->buf[((q->head + q->count) % q->msg_count) * q->msg_size], msg_ptr, q->msg_size);
+    q->count++;
+    wake_one(q);
+    host_rtos_yield_if_needed();
+    return osOK;
+}
+
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout)
+{
+    Host_Queue *q = mq_id;
+    if (q == NULL || msg_ptr == NULL)
+    {
+        return osErrorParameter;
+    }
+
+    uint32_t start_tick = tick;
+    while (q->count == 0)
+    {
+        uint32_t left = remaining(timeout, start_tick);
+        if (left == 0 || host_irq_blocked())
+        {
+            return timeout == 0 ? osErrorResource : osErrorTimeout;
+        }
+        if (block(q, left) != osOK)
+        {
+            return osErrorTimeout;
+        }
+    }
+
+    memcpy(msg_ptr, &q->buf[q->head * q->msg_size], q->msg_size);
+    q->head = (q->head + 1) % q->msg_count;
+    q->count--;
+    if (msg_prio != NULL)
+    {
+        *msg_prio = 0;
+    }
+    wake_one(&q->count);
+    host_rtos_yield_if_needed();
+    return osOK;
+}
+
+/* FreeRTOS task information */
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *const pxTaskStatusArray, const UBaseType_t uxArraySize, uint32_t *const pulTotalRunTime)
+{
+    UBaseType_t num = 0;
+    for (uint32_t i = 0; i < num_threads && num < uxArraySize; i++)
+    {
+        Host_Thread *t = &threads[i];
+        if (t->state == THREAD_TERMINATED)
+        {
+            continue;
+        }
+        pxTaskStatusArray[num++] = (TaskStatus_t){
+            .xHandle = t,
+            .pcTaskName = t->name,
+            .xTaskNumber = i + 1,
+            .eCurrentState = t == current ? eRunning : t->state == THREAD_READY ? eReady : eBlocked,
+            .uxCurrentPriority = t->priority,
+            .uxBasePriority = t->priority,
+            .usStackHighWaterMark = (uint16_t)t->stack_words, // Host stacks are not measured.
+        };
+    }
+    if (pulTotalRunTime != NULL)
+    {
+        *pulTotalRunTime = 0;
+    }
+    return num;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file host_rtos.h
+ * @author Timothy Nguyen
+ * @brief Host scheduler behind the CMSIS-RTOS2 and FreeRTOS calls of the virtual-time build.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Threads are ucontext coroutines run one at a time by a fixed priority, preemptive
+ *      scheduler, as FreeRTOS with configUSE_PREEMPTION. Code takes no virtual time: the clock
+ *      (host_hw.c) only moves while every thread is blocked, straight to the next deadline.
+ *      Kernel ticks are counted from that clock, so osDelay(), osTimer* and blocking timeouts
+ *      expire at the same virtual time as HAL_GetTick() passes them.
+ */
+
+#ifndef _HOST_RTOS_H_
+#define _HOST_RTOS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Advance kernel tick count and wake threads and timers whose timeout expired.
+ *
+ * @param ticks Kernel ticks elapsed since last call.
+ */
+void host_rtos_tick(uint32_t ticks);
+
+/**
+ * @brief Get ticks until the earliest thread timeout or timer expiry.
+ *
+ * @param[out] ticks Ticks from the current tick count.
+ *
+ * @return true if a timeout is pending, false if all threads wait forever.
+ */
+bool host_rtos_next_timeout(uint32_t *ticks);
+
+/**
+ * @brief Switch to a higher priority thread made ready by an interrupt or an unlock.
+ *
+ * Does nothing while the kernel is locked, interrupts are masked or an interrupt handler runs.
+ */
+void host_rtos_yield_if_needed(void);
+
+/**
+ * @brief Is a thread running (as opposed to the scheduler or initialization code)?
+ */
+bool host_rtos_in_thread(void);
+
+#endif
@@ -0,0 +1,697 @@
+/**
+ * @file host_sim.c
+ * @author Timothy Nguyen
+ * @brief Whole firmware on the host in virtual time, driven by a console script.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      main() and StartDefaultTask() follow Core/Src/main.c with the peripherals replaced by the
+ *      models of host_hw.c and an oven (host_oven.c) behind the thermocouple chip selects. The
+ *      power module is left out: idle time is skipped by the virtual clock instead.
+ *
+ *      A script line "<ms> <text>" sends text and a carriage return on the console UART at that
+ *      virtual time, paced by the baud rate; "\t", "\r", "\n", "\\" and "\xHH" are escapes and
+ *      lines starting with '#' are comments. "<ms> !sim <dev> <mode> [<args>]" is a host command
+ *      instead, it sets the scripted fault of thermocouple dev (see host_max31855k.h): e.g.
+ *      "!sim 0 open", "!sim 2 temp 250 30", "!sim 3 noise 2" or "!sim 0 off". Lines starting
+ *      with "--" hold options, which those given on the command line override. Console output
+ *      goes to stdout. The run ends one second after the last line, or at --until. Same script
+ *      and options, same output.
+ *
+ *      Without a script the UARTs go to ptys (host_pty.c) instead and the run follows the wall
+ *      clock, --speed virtual seconds per second, until interrupted: the console of oven n at
+ *      the printed path, or --link (numbered from 0 with --count above 1), and with --modbus the
+ *      Modbus RTU slave as well, so fleetd.py, modbus_master.py and replay.py run against the
+ *      firmware as they would against boards. Each oven is a process of its own, seed + n.
+ *
+ *      Usage: host_sim [options] script
+ *             host_sim [options] [--count N] [--link PATH] [--modbus [PATH]]
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "host_hw.h"
+#include "host_max31855k.h"
+#include "host_oven.h"
+#include "host_pty.h"
+#include "cmsis_os.h"
+#include "boot.h"
+#include "cmd.h"
+#include "console.h"
+#include "log.h"
+#include "modbus.h"
+#include "pid.h"
+#include "reflow.h"
+#include "stream.h"
+#include "timestamp.h"
+#include "uart.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+/* Configuration of Core/Src/main.c */
+#define CONSOLE_BAUD_RATE 115200
+#define MODBUS_BAUD_RATE 19200
+#define MODBUS_SLAVE_ADDR 1
+
+/* Pins of Core/Inc/main.h */
+#define LD2_Pin GPIO_PIN_5
+#define LD2_GPIO_Port GPIOA
+#define MAX_CS_Pin GPIO_PIN_4
+#define MAX_CS_GPIO_Port GPIOC
+#define MAX_ELEMENT_CS_Pin GPIO_PIN_5
+#define MAX_PROBE_CS_Pin GPIO_PIN_6
+#define MAX_OVEN_B_CS_Pin GPIO_PIN_8
+#define MAX_OVEN_C_CS_Pin GPIO_PIN_9
+
+#define TIM3_PERIOD (4095 - 1)
+
+#define MAX_SCRIPT_LINES 4096
+#define MAX_LINE_SIZE 256
+#define MAX_SCRIPT_ARGS 32
+#define END_DELAY_MS 1000   // Run time after the last script line.
+#define WATCHDOG_S 60       // Wall clock limit, catches ASSERT() loops.
+#define MAX_OVENS 16        // Pty mode --count.
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    uint32_t ms;
+    uint16_t len;
+    uint8_t data[MAX_LINE_SIZE];
+    bool sim;           // Host "sim" command instead of console text.
+    uint8_t dev;        // Its arguments.
+    Host_Max_mode mode;
+    float a;
+    float b;
+} Script_Line;
+
+typedef struct
+{
+    Host_Oven_cfg oven;
+    long until_ms;
+    uint32_t count;           // Ovens, pty mode.
+    const char *link;         // Console symlink, pty mode.
+    uint32_t baud_rate;       // Console.
+    double speed;             // Virtual seconds per wall clock second, pty mode.
+    bool modbus;              // Modbus pty, pty mode.
+    const char *modbus_link;  // Its symlink.
+    uint32_t modbus_baud_rate;
+} Sim_Options;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+static SPI_HandleTypeDef hspi2 = {.Instance = SPI2};
+static TIM_HandleTypeDef htim3 = {.Instance = TIM3};
+static osThreadId_t defaultTaskHandle;
+
+static const Reflow_cfg_t reflow_cfg =
+    {
+        .pwm_timer_handle = &htim3,
+        .pwm_channel = TIM_CHANNEL_1,
+        .max_cfg = {
+            [REFLOW_TC_OVEN] = {.hspi = &hspi2, .max_cs_port = MAX_CS_GPIO_Port, .max_cs_pin = MAX_CS_Pin},
+            [REFLOW_TC_ELEMENT] = {.hspi = &hspi2, .max_cs_port = GPIOC, .max_cs_pin = MAX_ELEMENT_CS_Pin},
+            [REFLOW_TC_PROBE] = {.hspi = &hspi2, .max_cs_port = GPIOC, .max_cs_pin = MAX_PROBE_CS_Pin},
+            [REFLOW_TC_OVEN_B] = {.hspi = &hspi2, .max_cs_port = GPIOC, .max_cs_pin = MAX_OVEN_B_CS_Pin},
+            [REFLOW_TC_OVEN_C] = {.hspi = &hspi2, .max_cs_port = GPIOC, .max_cs_pin = MAX_OVEN_C_CS_Pin}}};
+
+static const modbus_cfg_t modbus_cfg =
+    {
+        .uart_reg_base = UART4,
+        .irq_num = UART4_IRQn,
+        .baud_rate = MODBUS_BAUD_RATE,
+        .slave_addr = MODBUS_SLAVE_ADDR};
+
+static Script_Line script[MAX_SCRIPT_LINES];
+static uint32_t num_script_lines;
+static uint32_t next_script_line;
+static Host_Event script_evt;
+static char *script_args[1 + MAX_SCRIPT_ARGS]; // Program name and options of the script.
+static int num_script_args;
+
+static pid_t ovens[MAX_OVENS]; // Pty mode processes.
+static uint32_t num_ovens;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function declarations
+////////////////////////////////////////////////////////////////////////////////
+
+void USART2_IRQHandler(void);
+void UART4_IRQHandler(void);
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function definitions
+////////////////////////////////////////////////////////////////////////////////
+
+static void StartDefaultTask(void *argument)
+{
+    boot_mark(BOOT_PHASE_KERNEL);
+
+    modbus_init(&modbus_cfg);
+    reflow_init(&reflow_cfg);
+    reflow_start();
+
+    boot_defer("log", log_init);
+    boot_defer("stream", stream_init);
+    boot_defer("boot", boot_start);
+    boot_defer("pid", PID_Start);
+    boot_defer("cmd", cmd_init);
+    boot_defer("cmd start", cmd_start);
+    boot_defer("modbus start", modbus_start);
+    boot_defer("console", console_init);
+    boot_defer("console start", console_start);
+    boot_run_deferred();
+
+    osThreadTerminate(defaultTaskHandle);
+}
+
+static void console_sink(uint8_t byte, void *arg)
+{
+    putchar(byte);
+}
+
+static void script_send(Host_Event *evt)
+{
+    Script_Line *line = &script[next_script_line++];
+    if (line->sim)
+    {
+        host_max_set_mode(line->dev, line->mode, line->a, line->b);
+    }
+    else
+    {
+        host_usart_send(USART2, line->data, line->len);
+    }
+    if (next_script_line < num_script_lines)
+    {
+        host_event_schedule(evt, HOST_MS_TO_CYCLES(script[next_script_line].ms));
+    }
+}
+
+/* Decode escapes of text into line, followed by a carriage return. */
+static bool script_decode(Script_Line *line, const char *text)
+{
+    line->len = 0;
+    while (*text != '\0' && line->len < MAX_LINE_SIZE - 1)
+    {
+        char c = *text++;
+        if (c == '\\')
+        {
+            switch (*text++)
+            {
+            case 't':
+                c = '\t';
+                break;
+            case 'r':
+                c = '\r';
+                break;
+            case 'n':
+                c = '\n';
+                break;
+            case '\\':
+                c = '\\';
+                break;
+            case 'x':
+            {
+                char hex[3] = {text[0], text[0] != '\0' ? text[1] : '\0', '\0'};
+                char *end;
+                c = (char)strtoul(hex, &end, 16);
+                if (end != hex + 2)
+                {
+                    return false;
+                }
+                text += 2;
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        line->data[line->len++] = (uint8_t)c;
+    }
+    line->data[line->len++] = '\r';
+    return *text == '\0';
+}
+
+static bool script_load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    char buf[2 * MAX_LINE_SIZE];
+    uint32_t line_num = 0;
+    uint32_t prev_ms = 0;
+    while (fgets(buf, sizeof(buf), f) != NULL)
+    {
+        line_num++;
+        buf[strcspn(buf, "\r\n")] = '\0';
+        if (buf[0] == '#' || buf[strspn(buf, " \t")] == '\0')
+        {
+            continue;
+        }
+
+        if (buf[0] == '-')
+        { // Option line.
+            for (char *arg = strtok(buf, " \t"); arg != NULL; arg = strtok(NULL, " \t"))
+            {
+                if (num_script_args == MAX_SCRIPT_ARGS)
+                {
+                    fprintf(stderr, "%s:%u: too many options\n", path, line_num);
+                    fclose(f);
+                    return false;
+                }
+                script_args[1 + num_script_args++] = strdup(arg);
+            }
+            continue;
+        }
+
+        char *text;
+        unsigned long ms = strtoul(buf, &text, 10);
+        if (text == buf || (*text != ' ' && *text != '\0') || ms < prev_ms ||
+            num_script_lines == MAX_SCRIPT_LINES)
+        {
+            fprintf(stderr, "%s:%u: expected \"<ms> <text>\" in time order\n", path, line_num);
+            fclose(f);
+            return false;
+        }
+        text += *text == ' ';
+
+        Script_Line *line = &script[num_script_lines];
+        line->sim = strncmp(text, "!sim ", 5) == 0;
+        if (line->sim ? !host_max_parse(text + 5, &line->dev, &line->mode, &line->a, &line->b) ||
+                            line->dev >= NUM_REFLOW_TCS
+                      : !script_decode(line, text))
+        {
+            fprintf(stderr, "%s:%u: invalid %s\n", path, line_num, line->sim ? "sim command" : "escape");
+            fclose(f);
+            return false;
+        }
+        script[num_script_lines++].ms = (uint32_t)ms;
+        prev_ms = (uint32_t)ms;
+    }
+    fclose(f);
+    return true;
+}
+
+static void watchdog_expired(int sig)
+{
+    static const char msg[] = "host_sim: watchdog expired, firmware hung\n";
+    fflush(stdout);
+    write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    _exit(2);
+}
+
+/* Parse options, return the index of the first argument left or -1 on errors. */
+static int parse_options(int argc, char *argv[], Sim_Options *opts)
+{
+    static const struct option options[] = {
+        {"until", required_argument, NULL, 'u'},
+        {"seed", required_argument, NULL, 's'},
+        {"ambient", required_argument, NULL, 'a'},
+        {"gain", required_argument, NULL, 'g'},
+        {"tau", required_argument, NULL, 't'},
+        {"dead-time", required_argument, NULL, 'd'},
+        {"element-tau", required_argument, NULL, 'e'},
+        {"board-tau", required_argument, NULL, 'b'},
+        {"noise", required_argument, NULL, 'n'},
+        {"tc-drift", required_argument, NULL, 'D'},
+        {"tc-open", required_argument, NULL, 'O'},
+        {"count", required_argument, NULL, 'c'},
+        {"link", required_argument, NULL, 'l'},
+        {"baud", required_argument, NULL, 'B'},
+        {"speed", required_argument, NULL, 'S'},
+        {"modbus", optional_argument, NULL, 'm'},
+        {"modbus-baud", required_argument, NULL, 'M'},
+        {NULL, 0, NULL, 0}};
+
+    optind = 0; // Restart parsing.
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'u':
+            opts->until_ms = strtol(optarg, NULL, 10);
+            break;
+        case 's':
+            opts->oven.seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'a':
+            opts->oven.ambient = strtof(optarg, NULL);
+            break;
+        case 'g':
+            opts->oven.gain = strtof(optarg, NULL);
+            break;
+        case 't':
+            opts->oven.tau = strtof(optarg, NULL);
+            break;
+        case 'd':
+            opts->oven.dead_time = strtof(optarg, NULL);
+            break;
+        case 'e':
+            opts->oven.element_tau = strtof(optarg, NULL);
+            break;
+        case 'b':
+            opts->oven.board_tau = strtof(optarg, NULL);
+            break;
+        case 'n':
+            opts->oven.noise = strtof(optarg, NULL);
+            break;
+        case 'D':
+            opts->oven.tc_drift = strtof(optarg, NULL);
+            break;
+        case 'O':
+            opts->oven.tc_open = strtof(optarg, NULL);
+            break;
+        case 'c':
+            opts->count = strtoul(optarg, NULL, 10);
+            if (opts->count == 0 || opts->count > MAX_OVENS)
+            {
+                return -1;
+            }
+            break;
+        case 'l':
+            opts->link = optarg;
+            break;
+        case 'B':
+            opts->baud_rate = strtoul(optarg, NULL, 10);
+            if (opts->baud_rate == 0)
+            {
+                return -1;
+            }
+            break;
+        case 'S':
+            opts->speed = strtod(optarg, NULL);
+            if (!(opts->speed > 0.0))
+            {
+                return -1;
+            }
+            break;
+        case 'm':
+            /* "--modbus PATH" as well as "--modbus=PATH", a script can't follow --modbus. */
+            opts->modbus = true;
+            opts->modbus_link = optarg;
+            if (optarg == NULL && optind < argc && argv[optind][0] != '-')
+            {
+                opts->modbus_link = argv[optind++];
+            }
+            break;
+        case 'M':
+            opts->modbus_baud_rate = strtoul(optarg, NULL, 10);
+            if (opts->modbus_baud_rate == 0)
+            {
+                return -1;
+            }
+            break;
+        default:
+            return -1;
+        }
+    }
+    return optind;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: host_sim [options] script\n"
+            "       host_sim [options] [--count N] [--link PATH] [--modbus [PATH]]\n"
+            "  --until MS          End of run (default: 1 s after the last script line, none without)\n"
+            "  --seed N            Thermocouple noise seed (default 1)\n"
+            "  --ambient C         Ambient temperature (default 25)\n"
+            "  --gain C            Rise above ambient at full power (default 300)\n"
+            "  --tau S             Oven time constant (default 180)\n"
+            "  --dead-time S       Heater to thermocouple dead time (default 8)\n"
+            "  --element-tau S     Heater element time constant (default 0)\n"
+            "  --board-tau S       Test board lag behind oven air (default 40)\n"
+            "  --noise C           Thermocouple noise, 1 sigma (default 0.1)\n"
+            "  --tc-drift C        Drift of oven thermocouple B per minute (default 0)\n"
+            "  --tc-open S         Open oven thermocouple B after S seconds\n"
+            "  --baud N            Console baud rate (default 115200)\n"
+            "  --modbus-baud N     Modbus baud rate (default 19200)\n"
+            "Without a script:\n"
+            "  --count N           Ovens, one process each (default 1)\n"
+            "  --link PATH         Console symlink, numbered from 0 with --count above 1\n"
+            "  --speed X           Virtual seconds per wall clock second (default 1)\n"
+            "  --modbus [PATH]     Modbus RTU pty, with an optional symlink numbered like --link\n");
+}
+
+/* main() of Core/Src/main.c, with the UARTs on ptys if console is not NULL. */
+static void run_firmware(const Sim_Options *opts, uint32_t oven, Host_Pty *console, Host_Pty *modbus)
+{
+    host_hw_init();
+    timestamp_init();
+    boot_init();
+
+    SystemCoreClock = HOST_CPU_HZ; // SystemClock_Config()
+    timestamp_clock_update();
+    boot_mark(BOOT_PHASE_CLOCK);
+
+    HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_RESET); // MX_GPIO_Init()
+    HAL_GPIO_WritePin(MAX_CS_GPIO_Port, MAX_CS_Pin, GPIO_PIN_RESET);
+    if (console != NULL) // MX_USART2_UART_Init()
+    {
+        host_pty_attach(console, USART2, USART2_IRQn, opts->baud_rate, opts->speed);
+    }
+    else
+    {
+        host_usart_open(USART2, USART2_IRQn, opts->baud_rate, console_sink, NULL);
+    }
+    htim3.Instance->ARR = TIM3_PERIOD; // MX_TIM3_Init()
+    host_irq_attach(USART2_IRQn, USART2_IRQHandler);
+    host_irq_attach(UART4_IRQn, UART4_IRQHandler);
+
+    uart_config_t uart_cfg = {.uart_reg_base = USART2, .irq_num = USART2_IRQn};
+    uart_init(&uart_cfg);
+    uart_start();
+    if (modbus != NULL) // MX_UART4_Init()
+    {
+        host_pty_attach(modbus, UART4, UART4_IRQn, opts->modbus_baud_rate, opts->speed);
+    }
+    else
+    {
+        host_usart_open(UART4, UART4_IRQn, opts->modbus_baud_rate, NULL, NULL);
+    }
+    HAL_GPIO_WritePin(GPIOC, MAX_ELEMENT_CS_Pin | MAX_PROBE_CS_Pin | MAX_OVEN_B_CS_Pin | MAX_OVEN_C_CS_Pin,
+                      GPIO_PIN_SET); // MX_MAX_CS_Init()
+    HAL_GPIO_WritePin(LD2_GPIO_Port, LD2_Pin, GPIO_PIN_SET);
+    boot_mark(BOOT_PHASE_PERIPH);
+
+    Host_Oven_cfg oven_cfg = opts->oven;
+    oven_cfg.seed += oven;
+    host_max_init(oven_cfg.seed);
+    host_oven_init(&oven_cfg, &reflow_cfg);
+    if (console != NULL)
+    {
+        Host_Pty *const links[] = {console, modbus};
+        host_pty_start(links, modbus != NULL ? 2 : 1, opts->speed);
+    }
+    else if (num_script_lines > 0)
+    {
+        script_evt.cb = script_send;
+        host_event_schedule(&script_evt, HOST_MS_TO_CYCLES(script[0].ms));
+    }
+    if (opts->until_ms >= 0)
+    {
+        host_hw_stop_at(HOST_MS_TO_CYCLES(opts->until_ms));
+    }
+
+    osKernelInitialize();
+    static const osThreadAttr_t defaultTask_attributes = {.name = "defaultTask",
+                                                          .stack_size = 512 * 4,
+                                                          .priority = (osPriority_t)osPriorityNormal};
+    defaultTaskHandle = osThreadNew(StartDefaultTask, NULL, &defaultTask_attributes);
+    osKernelStart();
+}
+
+static void run_script(Sim_Options *opts)
+{
+    static char out_buf[1 << 16];
+    setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+    signal(SIGALRM, watchdog_expired);
+    alarm(WATCHDOG_S);
+
+    if (opts->until_ms < 0)
+    {
+        opts->until_ms = (num_script_lines > 0 ? script[num_script_lines - 1].ms : 0) + END_DELAY_MS;
+    }
+    run_firmware(opts, 0, NULL, NULL);
+    fflush(stdout);
+}
+
+static void stop_ovens(int sig)
+{
+    for (uint32_t n = 0; n < num_ovens; n++)
+    {
+        kill(ovens[n], SIGTERM);
+    }
+}
+
+/* Symlink of oven n, NULL for none. */
+static const char *pty_link(const Sim_Options *opts, const char *link, uint32_t n, char *buf, size_t size)
+{
+    if (link == NULL || opts->count == 1)
+    {
+        return link;
+    }
+    snprintf(buf, size, "%s%u", link, n);
+    return buf;
+}
+
+static void print_pty(const char *name, const Host_Pty *pty)
+{
+    fprintf(stdout, "%s: %s%s%s\n", name, pty->path, pty->link[0] != '\0' ? " -> " : "", pty->link);
+}
+
+static int run_ptys(const Sim_Options *opts)
+{
+    static Host_Pty consoles[MAX_OVENS];
+    static Host_Pty modbuses[MAX_OVENS];
+    char buf[HOST_PTY_PATH_SIZE];
+    char name[32];
+    uint32_t num_open = 0;
+    bool ok = true;
+    for (; ok && num_open < opts->count; num_open++)
+    {
+        uint32_t n = num_open;
+        ok = host_pty_open(&consoles[n], pty_link(opts, opts->link, n, buf, sizeof(buf)));
+        if (ok && opts->modbus)
+        {
+            ok = host_pty_open(&modbuses[n], pty_link(opts, opts->modbus_link, n, buf, sizeof(buf)));
+            if (!ok)
+            {
+                host_pty_close(&consoles[n]);
+            }
+        }
+        if (ok)
+        {
+            snprintf(name, sizeof(name), "oven%u", n);
+            print_pty(name, &consoles[n]);
+            if (opts->modbus)
+            {
+                snprintf(name, sizeof(name), "oven%u modbus", n);
+                print_pty(name, &modbuses[n]);
+            }
+        }
+    }
+    if (!ok)
+    {
+        num_open--;
+    }
+    fflush(stdout);
+
+    /* One process per oven, the models and firmware are singletons. */
+    struct sigaction sa = {.sa_handler = stop_ovens};
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    for (uint32_t n = 0; ok && n < num_open; n++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            Host_Pty *console = &consoles[n];
+            Host_Pty *modbus = opts->modbus ? &modbuses[n] : NULL;
+            run_firmware(opts, n, console, modbus);
+            for (uint32_t i = 0; i < 2; i++)
+            {
+                const Host_Pty *pty = i == 0 ? console : modbus;
+                if (pty != NULL && pty->tx_dropped > 0)
+                {
+                    fprintf(stdout, "%s: %u bytes dropped, host not reading\n", pty->path, pty->tx_dropped);
+                }
+            }
+            fflush(stdout);
+            _exit(0);
+        }
+        if (pid < 0)
+        {
+            perror("host_sim: fork");
+            stop_ovens(SIGTERM);
+            ok = false;
+            break;
+        }
+        ovens[num_ovens++] = pid;
+    }
+
+    int status = ok ? 0 : 1;
+    for (uint32_t n = 0; n < num_ovens; n++)
+    {
+        int wstatus = 0;
+        while (waitpid(ovens[n], &wstatus, 0) < 0 && errno == EINTR)
+        {
+        }
+        if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
+        {
+            status = 1;
+        }
+    }
+    for (uint32_t n = 0; n < num_open; n++)
+    {
+        host_pty_close(&consoles[n]);
+        if (opts->modbus)
+        {
+            host_pty_close(&modbuses[n]);
+        }
+    }
+    return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[])
+{
+    Sim_Options opts = {.oven = HOST_OVEN_CFG_DEFAULT,
+                        .until_ms = -1,
+                        .count = 1,
+                        .baud_rate = CONSOLE_BAUD_RATE,
+                        .speed = 1.0,
+                        .modbus_baud_rate = MODBUS_BAUD_RATE};
+    int first = parse_options(argc, argv, &opts);
+    if (first < 0 || argc - first > 1)
+    {
+        usage();
+        return 1;
+    }
+    if (argc - first == 0)
+    {
+        return run_ptys(&opts);
+    }
+
+    if (opts.count != 1 || opts.link != NULL || opts.modbus || !script_load(argv[first]))
+    {
+        usage();
+        return 1;
+    }
+
+    /* Options of the script first, the command line overrides them. */
+    script_args[0] = argv[0];
+    if (parse_options(num_script_args + 1, script_args, &opts) != num_script_args + 1 ||
+        parse_options(argc, argv, &opts) != argc - 1)
+    {
+        usage();
+        return 1;
+    }
+    run_script(&opts);
+    return 0;
+}
@@ -0,0 +1,333 @@
+/**
+ * @file host_stubs.c
+ * @author Timothy Nguyen
+ * @brief Host replacements of the RTOS, HAL, UART, Modbus, timestamp and boot functions used by
+ *        the console path and the reflow commands.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Active objects have no thread on the host: Active_post() runs the event handler in the
+ *      caller, so a command line is executed before console_process() returns. Events posted
+ *      by a handler are queued and run after it returns, keeping run-to-completion.
+ *
+ *      Timers never expire and the kernel is never locked, so the control loop does not run;
+ *      thermocouples read a steady 25 deg C. The virtual-time build (host_rtos.c) runs it.
+ */
+
+#include <stdio.h>
+
+#include "host_console.h"
+#include "active.h"
+#include "uart.h"
+#include "modbus.h"
+#include "timestamp.h"
+#include "boot.h"
+#include "cmsis_os.h"
+#include "timers.h"
+#include "stm32l4xx_hal.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define MAX_PENDING_EVENTS 8 // Events posted by a running event handler.
+
+#define TC_READING 0x01901900U // MAX31855K reading: 25 deg C hot and cold junction, no fault.
+
+////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////
+
+/* Event waiting for the running handler to return */
+typedef struct
+{
+    Active *ao;
+    Event const *evt;
+} Pending_Event;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t uart_bytes; // Bytes written to the UART.
+static bool uart_echo;      // Echo UART output to stdout?
+static uint64_t now_us;     // Simulated time (us).
+
+static bool dispatching;                                 // An event handler is running.
+static Pending_Event pending_evts[MAX_PENDING_EVENTS];   // Events posted while dispatching.
+static uint8_t num_pending_evts;                         // Number of queued events.
+
+static uint8_t timer_handles[4]; // Distinct non-NULL timer handles.
+static uint8_t num_timers;       // Timer handles handed out.
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t host_uart_bytes(void)
+{
+    return uart_bytes;
+}
+
+void host_uart_echo(bool enable)
+{
+    uart_echo = enable;
+}
+
+/* Active object framework */
+
+mod_err_t Active_ctor(Active *const ao, EventHandler evt_handler)
+{
+    ao->evt_handler = evt_handler;
+    return MOD_OK;
+}
+
+mod_err_t Active_start(Active *const ao,
+                       const osThreadAttr_t *const thread_attr,
+                       uint32_t msg_count,
+                       const osMessageQueueAttr_t *const queue_attr)
+{
+    /* The event loop thread starts with the initial transition. */
+    static const Event init_evt = {.sig = INIT_SIG};
+    return Active_post(ao, &init_evt);
+}
+
+mod_err_t Active_post(Active *const ao, Event const *const evt)
+{
+    if (dispatching)
+    {
+        if (num_pending_evts == MAX_PENDING_EVENTS)
+        {
+            return MOD_ERR_BUF_OVERRUN; // Event queue full.
+        }
+        pending_evts[num_pending_evts++] = (Pending_Event){.ao = ao, .evt = evt};
+        return MOD_OK;
+    }
+
+    dispatching = true;
+    ao->evt_handler(ao, evt);
+    for (uint8_t i = 0; i < num_pending_evts; i++)
+    {
+        pending_evts[i].ao->evt_handler(pending_evts[i].ao, pending_evts[i].evt);
+    }
+    num_pending_evts = 0;
+    dispatching = false;
+    return MOD_OK;
+}
+
+osTimerId_t Active_timer_new(const char *name, TimerCallbackFunction_t cb, StaticTimer_t *cb_mem)
+{
+    if (cb == NULL || cb_mem == NULL || num_timers == sizeof(timer_handles))
+    {
+        return NULL;
+    }
+    return &timer_handles[num_timers++];
+}
+
+void TimeEvent_ctor(TimeEvent *const time_evt, Signal sig, Active *ao)
+{
+    time_evt->base.sig = sig;
+    time_evt->ao = ao;
+    time_evt->timeout = 0U;
+    time_evt->reload = 0U;
+}
+
+void TimeEvent_arm(TimeEvent *const time_evt, uint32_t timeout, uint32_t reload)
+{
+    time_evt->timeout = timeout;
+    time_evt->reload = reload;
+}
+
+void TimeEvent_disarm(TimeEvent *const time_evt)
+{
+    time_evt->timeout = 0U;
+}
+
+void TimeEvent_use_virtual_clock(bool enable)
+{
+}
+
+void TimeEvent_advance(uint32_t ms)
+{
+}
+
+/* UART */
+
+mod_err_t uart_putc(char c)
+{
+    uart_bytes++;
+    if (uart_echo)
+    {
+        putchar(c);
+    }
+    return MOD_OK;
+}
+
+mod_err_t uart_write(const void *data, uint16_t len)
+{
+    const char *p = data;
+    for (uint16_t i = 0; i < len; i++)
+    {
+        uart_putc(p[i]);
+    }
+    return MOD_OK;
+}
+
+mod_err_t uart_start_rx(void)
+{
+    return MOD_OK;
+}
+
+bool uart_tx_lock(void)
+{
+    return false; // Single thread, nothing to serialize.
+}
+
+void uart_tx_unlock(bool locked)
+{
+}
+
+/* Modbus register shadow, no slave runs on the host. */
+
+void modbus_set_write_cb(modbus_write_cb_t cb)
+{
+}
+
+mod_err_t modbus_update_input_regs(uint16_t addr, uint16_t count, const uint16_t *values)
+{
+    return MOD_OK;
+}
+
+mod_err_t modbus_update_holding_regs(uint16_t addr, uint16_t count, const uint16_t *values)
+{
+    return MOD_OK;
+}
+
+/* Timestamps advance by 1 us per call so log lines stay distinct. */
+
+uint64_t timestamp_us(void)
+{
+    return ++now_us;
+}
+
+uint32_t timestamp_ms(void)
+{
+    return (uint32_t)(now_us / 1000U);
+}
+
+uint64_t timestamp_cycles(void)
+{
+    return now_us;
+}
+
+uint32_t timestamp_cycles_to_us(uint64_t cycles)
+{
+    return (uint32_t)cycles;
+}
+
+void boot_mark(boot_phase_t phase)
+{
+}
+
+/* HAL */
+
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)(now_us / 1000U);
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    for (uint16_t i = 0; i < Size; i++)
+    {
+        pData[i] = i < 4 ? (uint8_t)(TC_READING >> (24 - 8 * i)) : 0;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pTxData, uint8_t *pRxData, uint16_t Size)
+{
+    return HAL_ERROR; // DMA reads are not used by the reflow module.
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    return HAL_OK;
+}
+
+/* CMSIS-RTOS2 and FreeRTOS */
+
+osKernelState_t osKernelGetState(void)
+{
+    return osKernelInactive; // Mutexes are never taken.
+}
+
+int32_t osKernelLock(void)
+{
+    return 0;
+}
+
+int32_t osKernelUnlock(void)
+{
+    return 0;
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    return NULL;
+}
+
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks)
+{
+    return osOK;
+}
+
+osStatus_t osTimerStop(osTimerId_t timer_id)
+{
+    return osOK;
+}
+
+osMutexId_t osMutexNew(const osMutexAttr_t *attr)
+{
+    static uint8_t mutex;
+    return &mutex;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    return osOK;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    return osOK;
+}
+
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr)
+{
+    return NULL;
+}
+
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout)
+{
+    return osErrorResource;
+}
+
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout)
+{
+    return osErrorResource;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    return osErrorResource;
+}
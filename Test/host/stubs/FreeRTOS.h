@@ -0,0 +1,37 @@
+/**
+ * @file FreeRTOS.h
+ * @author Timothy Nguyen
+ * @brief Host stand-in for the FreeRTOS types used by firmware headers.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      The configuration is taken from Core/Inc/FreeRTOSConfig.h, so tick rate and timer task
+ *      priority match the firmware.
+ */
+
+#ifndef _HOST_FREERTOS_H_
+#define _HOST_FREERTOS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+/* Control blocks of statically allocated objects, only their memory is used on the host. */
+typedef struct
+{
+    void *dummy[4];
+} StaticTask_t, StaticQueue_t, StaticSemaphore_t, StaticTimer_t;
+
+#include "FreeRTOSConfig.h"
+
+#endif
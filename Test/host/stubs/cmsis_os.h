@@ -0,0 +1,134 @@
+/**
+ * @file cmsis_os.h
+ * @author Timothy Nguyen
+ * @brief Host stand-in for the CMSIS-RTOS2 API used by the firmware.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Only types and the calls made by the host-built modules are declared, with the
+ *      signatures of cmsis_os2.h. The fuzz and benchmark builds implement them in host_stubs.c,
+ *      the virtual-time build in host_rtos.c.
+ */
+
+#ifndef _HOST_CMSIS_OS_H_
+#define _HOST_CMSIS_OS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+
+typedef void *osThreadId_t;
+typedef void *osMessageQueueId_t;
+typedef void *osSemaphoreId_t;
+typedef void *osMutexId_t;
+typedef void *osTimerId_t;
+
+typedef enum
+{
+    osOK = 0,
+    osError = -1,
+    osErrorTimeout = -2,
+    osErrorResource = -3,
+    osErrorParameter = -4,
+    osErrorNoMemory = -5,
+    osErrorISR = -6,
+} osStatus_t;
+
+typedef enum
+{
+    osKernelInactive = 0,
+    osKernelReady = 1,
+    osKernelRunning = 2,
+    osKernelLocked = 3,
+    osKernelSuspended = 4,
+    osKernelError = -1,
+} osKernelState_t;
+
+typedef enum
+{
+    osPriorityNone = 0,
+    osPriorityIdle = 1,
+    osPriorityLow = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal = 24,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh = 40,
+    osPriorityRealtime = 48,
+    osPriorityISR = 56,
+    osPriorityError = -1,
+} osPriority_t;
+
+#define osWaitForever 0xFFFFFFFFU
+
+#define osMutexRecursive 0x00000001U
+#define osMutexPrioInherit 0x00000002U
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+    void *stack_mem;
+    uint32_t stack_size;
+    osPriority_t priority;
+    uint32_t tz_module;
+    uint32_t reserved;
+} osThreadAttr_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+    void *mq_mem;
+    uint32_t mq_size;
+} osMessageQueueAttr_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+} osMutexAttr_t, osSemaphoreAttr_t;
+
+typedef void (*osThreadFunc_t)(void *argument);
+
+/* Kernel */
+osStatus_t osKernelInitialize(void);
+osStatus_t osKernelStart(void);
+osKernelState_t osKernelGetState(void);
+int32_t osKernelLock(void);
+int32_t osKernelUnlock(void);
+uint32_t osKernelGetTickCount(void);
+
+/* Threads */
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr);
+osThreadId_t osThreadGetId(void);
+osStatus_t osThreadSetPriority(osThreadId_t thread_id, osPriority_t priority);
+osStatus_t osThreadTerminate(osThreadId_t thread_id);
+osStatus_t osDelay(uint32_t ticks);
+
+/* Timers */
+osStatus_t osTimerStart(osTimerId_t timer_id, uint32_t ticks);
+osStatus_t osTimerStop(osTimerId_t timer_id);
+
+/* Mutexes */
+osMutexId_t osMutexNew(const osMutexAttr_t *attr);
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+osStatus_t osMutexRelease(osMutexId_t mutex_id);
+
+/* Semaphores */
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t *attr);
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+
+/* Message queues */
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr);
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout);
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout);
+
+#endif
@@ -0,0 +1,354 @@
+/**
+ * @file stm32l476xx.h
+ * @author Timothy Nguyen
+ * @brief Host stand-in for the STM32L476 device header: interrupt numbers and register layouts.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Register blocks are plain structures in host memory. Peripherals are reached through the
+ *      handles and base addresses the host build passes to the firmware modules, or through the
+ *      instance macros below, which name the register blocks of the virtual-time build
+ *      (host_hw.c). Core functions (NVIC, PRIMASK, IPSR) are implemented there as well.
+ *
+ *      SysTick and LPTIM1, the timers of tickless idle (power.c), are reached through accessors
+ *      implemented by the program that models them (test_power.c), as is __WFI(). Each access
+ *      lets the model catch up with the previous write, e.g. the reload value of a shortened
+ *      SysTick period, which power.c overwrites right after enabling the counter.
+ */
+
+#ifndef _HOST_STM32L476XX_H_
+#define _HOST_STM32L476XX_H_
+
+#include <stdint.h>
+
+#define __I volatile const
+#define __O volatile
+#define __IO volatile
+
+/* Interrupt numbers used by the firmware */
+typedef enum
+{
+    SysTick_IRQn = -1,
+    USART1_IRQn = 37,
+    USART2_IRQn = 38,
+    USART3_IRQn = 39,
+    UART4_IRQn = 52,
+    UART5_IRQn = 53,
+    TIM7_IRQn = 55,
+    LPTIM1_IRQn = 65,
+} IRQn_Type;
+
+typedef struct
+{
+    __IO uint32_t MODER;
+    __IO uint32_t OTYPER;
+    __IO uint32_t OSPEEDR;
+    __IO uint32_t PUPDR;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t LCKR;
+    __IO uint32_t AFR[2];
+    __IO uint32_t BRR;
+    __IO uint32_t ASCR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SR;
+    __IO uint32_t DR;
+    __IO uint32_t CRCPR;
+    __IO uint32_t RXCRCR;
+    __IO uint32_t TXCRCR;
+} SPI_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SMCR;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t EGR;
+    __IO uint32_t CCMR1;
+    __IO uint32_t CCMR2;
+    __IO uint32_t CCER;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t RCR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+    __IO uint32_t BDTR;
+    __IO uint32_t DCR;
+    __IO uint32_t DMAR;
+    __IO uint32_t OR1;
+    __IO uint32_t CCMR3;
+    __IO uint32_t CCR5;
+    __IO uint32_t CCR6;
+    __IO uint32_t OR2;
+    __IO uint32_t OR3;
+} TIM_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t CR3;
+    __IO uint32_t BRR;
+    __IO uint16_t GTPR;
+    uint16_t RESERVED2;
+    __IO uint32_t RTOR;
+    __IO uint16_t RQR;
+    uint16_t RESERVED4;
+    __IO uint32_t ISR;
+    __IO uint32_t ICR;
+    __IO uint16_t RDR;
+    uint16_t RESERVED5;
+    __IO uint16_t TDR;
+    uint16_t RESERVED6;
+} USART_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CR;
+    __IO uint32_t ICSCR;
+    __IO uint32_t CFGR;
+    __IO uint32_t PLLCFGR;
+    __IO uint32_t PLLSAI1CFGR;
+    __IO uint32_t PLLSAI2CFGR;
+    __IO uint32_t CIER;
+    __IO uint32_t CIFR;
+    __IO uint32_t CICR;
+    uint32_t RESERVED0;
+    __IO uint32_t AHB1RSTR;
+    __IO uint32_t AHB2RSTR;
+    __IO uint32_t AHB3RSTR;
+    uint32_t RESERVED1;
+    __IO uint32_t APB1RSTR1;
+    __IO uint32_t APB1RSTR2;
+    __IO uint32_t APB2RSTR;
+    uint32_t RESERVED2;
+    __IO uint32_t AHB1ENR;
+    __IO uint32_t AHB2ENR;
+    __IO uint32_t AHB3ENR;
+    uint32_t RESERVED3;
+    __IO uint32_t APB1ENR1;
+    __IO uint32_t APB1ENR2;
+    __IO uint32_t APB2ENR;
+    uint32_t RESERVED4;
+    __IO uint32_t AHB1SMENR;
+    __IO uint32_t AHB2SMENR;
+    __IO uint32_t AHB3SMENR;
+    uint32_t RESERVED5;
+    __IO uint32_t APB1SMENR1;
+    __IO uint32_t APB1SMENR2;
+    __IO uint32_t APB2SMENR;
+    uint32_t RESERVED6;
+    __IO uint32_t CCIPR;
+    uint32_t RESERVED7;
+    __IO uint32_t BDCR;
+    __IO uint32_t CSR;
+} RCC_TypeDef;
+
+/* Cortex-M4 data watchpoint and trace unit, cycle counter only */
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    __IO uint32_t DHCSR;
+    __O uint32_t DCRSR;
+    __IO uint32_t DCRDR;
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+/* Cortex-M4 system timer */
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __I uint32_t CALIB;
+} SysTick_Type;
+
+/* Cortex-M4 system control block, up to the interrupt control and state register */
+typedef struct
+{
+    __I uint32_t CPUID;
+    __IO uint32_t ICSR;
+} SCB_Type;
+
+typedef struct
+{
+    __IO uint32_t ISR;
+    __IO uint32_t ICR;
+    __IO uint32_t IER;
+    __IO uint32_t CFGR;
+    __IO uint32_t CR;
+    __IO uint32_t CMP;
+    __IO uint32_t ARR;
+    __IO uint32_t CNT;
+    __IO uint32_t OR;
+} LPTIM_TypeDef;
+
+/* Peripherals of the virtual-time build */
+extern GPIO_TypeDef host_gpioa, host_gpiob, host_gpioc;
+extern SPI_TypeDef host_spi2;
+extern TIM_TypeDef host_tim3, host_tim7;
+extern USART_TypeDef host_usart2, host_uart4;
+extern RCC_TypeDef host_rcc;
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_core_debug;
+extern SCB_Type host_scb;
+
+SysTick_Type *host_systick(void);
+LPTIM_TypeDef *host_lptim1(void);
+
+#define GPIOA (&host_gpioa)
+#define GPIOB (&host_gpiob)
+#define GPIOC (&host_gpioc)
+#define SPI2 (&host_spi2)
+#define TIM3 (&host_tim3)
+#define TIM7 (&host_tim7)
+#define USART2 (&host_usart2)
+#define UART4 (&host_uart4)
+#define RCC (&host_rcc)
+#define DWT (&host_dwt)
+#define CoreDebug (&host_core_debug)
+#define SCB (&host_scb)
+#define SysTick (host_systick())
+#define LPTIM1 (host_lptim1())
+
+extern uint32_t SystemCoreClock;
+
+/* Core functions */
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+uint32_t __get_IPSR(void);
+void __WFI(void);
+
+/* Memory accesses complete in program order on the host. */
+static inline void __DSB(void)
+{
+}
+
+static inline void __ISB(void)
+{
+}
+
+uint32_t NVIC_GetPriorityGrouping(void);
+uint32_t NVIC_EncodePriority(uint32_t PriorityGroup, uint32_t PreemptPriority, uint32_t SubPriority);
+void __NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority);
+void __NVIC_EnableIRQ(IRQn_Type IRQn);
+void __NVIC_DisableIRQ(IRQn_Type IRQn);
+uint32_t __NVIC_GetPendingIRQ(IRQn_Type IRQn);
+void __NVIC_SetPendingIRQ(IRQn_Type IRQn);
+void __NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+
+#define NVIC_SetPriority __NVIC_SetPriority
+#define NVIC_EnableIRQ __NVIC_EnableIRQ
+#define NVIC_DisableIRQ __NVIC_DisableIRQ
+#define NVIC_GetPendingIRQ __NVIC_GetPendingIRQ
+#define NVIC_SetPendingIRQ __NVIC_SetPendingIRQ
+#define NVIC_ClearPendingIRQ __NVIC_ClearPendingIRQ
+
+/* RCC peripheral clock enable and independent clock configuration register bits */
+#define RCC_APB1ENR1_LPTIM1EN (1U << 31)
+#define RCC_CCIPR_LPTIM1SEL (3U << 18)
+
+/* RCC control/status register bits */
+#define RCC_CSR_RMVF (1U << 23)
+#define RCC_CSR_FWRSTF (1U << 24)
+#define RCC_CSR_OBLRSTF (1U << 25)
+#define RCC_CSR_PINRSTF (1U << 26)
+#define RCC_CSR_BORRSTF (1U << 27)
+#define RCC_CSR_SFTRSTF (1U << 28)
+#define RCC_CSR_IWDGRSTF (1U << 29)
+#define RCC_CSR_WWDGRSTF (1U << 30)
+#define RCC_CSR_LPWRRSTF (1U << 31)
+
+/* DWT and debug register bits */
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+#define DWT_CTRL_NOCYCCNT_Msk (1UL << 25)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+/* SysTick and SCB register bits */
+#define SysTick_CTRL_ENABLE_Msk (1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk (1UL << 1)
+#define SysTick_CTRL_COUNTFLAG_Msk (1UL << 16)
+#define SCB_ICSR_PENDSTCLR_Msk (1UL << 25)
+#define SCB_ICSR_PENDSTSET_Msk (1UL << 26)
+
+/* TIM control, interrupt enable and status register bits */
+#define TIM_CR1_CEN (1U << 0)
+#define TIM_DIER_UIE (1U << 0)
+#define TIM_SR_UIF (1U << 0)
+
+/* TIM capture/compare mode register bits */
+#define TIM_CCMR1_OC1PE (1U << 3)
+#define TIM_CCMR1_OC2PE (1U << 11)
+#define TIM_CCMR2_OC3PE (1U << 3)
+#define TIM_CCMR2_OC4PE (1U << 11)
+
+/* TIM capture/compare enable register bits */
+#define TIM_CCER_CC1E (1U << 0)
+
+/* LPTIM register bits */
+#define LPTIM_ISR_ARRM (1U << 1)
+#define LPTIM_ISR_ARROK (1U << 4)
+#define LPTIM_ICR_ARRMCF (1U << 1)
+#define LPTIM_ICR_ARROKCF (1U << 4)
+#define LPTIM_IER_ARRMIE (1U << 1)
+#define LPTIM_CFGR_PRESC (7U << 9)
+#define LPTIM_CR_ENABLE (1U << 0)
+#define LPTIM_CR_SNGSTRT (1U << 1)
+
+/* USART control register bits */
+#define USART_CR1_UE (1U << 0)
+#define USART_CR1_RE (1U << 2)
+#define USART_CR1_TE (1U << 3)
+#define USART_CR1_RXNEIE (1U << 5)
+#define USART_CR1_TCIE (1U << 6)
+#define USART_CR1_TXEIE (1U << 7)
+#define USART_CR1_RTOIE (1U << 26)
+#define USART_CR2_RTOEN (1U << 23)
+#define USART_CR3_EIE (1U << 0)
+#define USART_RTOR_RTO (0xFFFFFFU << 0)
+
+/* USART interrupt flag clear register bits */
+#define USART_ICR_PECF (1U << 0)
+#define USART_ICR_FECF (1U << 1)
+#define USART_ICR_NECF (1U << 2)
+#define USART_ICR_ORECF (1U << 3)
+#define USART_ICR_TCCF (1U << 6)
+#define USART_ICR_RTOCF (1U << 11)
+
+/* USART interrupt and status register bits */
+#define USART_ISR_PE_Msk (1U << 0)
+#define USART_ISR_PE USART_ISR_PE_Msk
+#define USART_ISR_FE_Msk (1U << 1)
+#define USART_ISR_FE USART_ISR_FE_Msk
+#define USART_ISR_NE_Msk (1U << 2)
+#define USART_ISR_NE USART_ISR_NE_Msk
+#define USART_ISR_ORE_Msk (1U << 3)
+#define USART_ISR_ORE USART_ISR_ORE_Msk
+#define USART_ISR_RXNE_Msk (1U << 5)
+#define USART_ISR_RXNE USART_ISR_RXNE_Msk
+#define USART_ISR_TC_Msk (1U << 6)
+#define USART_ISR_TC USART_ISR_TC_Msk
+#define USART_ISR_TXE_Msk (1U << 7)
+#define USART_ISR_TXE USART_ISR_TXE_Msk
+#define USART_ISR_RTOF_Msk (1U << 11)
+#define USART_ISR_RTOF USART_ISR_RTOF_Msk
+
+#endif
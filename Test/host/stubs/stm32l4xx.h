@@ -0,0 +1,21 @@
+/**
+ * @file stm32l4xx.h
+ * @author Timothy Nguyen
+ * @brief Host stand-in for the STM32L4 family header.
+ * @version 0.1
+ * @date 2021-08-20
+ */
+
+#ifndef _HOST_STM32L4XX_H_
+#define _HOST_STM32L4XX_H_
+
+#include "stm32l476xx.h"
+
+#define SET_BIT(REG, BIT) ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT) ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT) ((REG) & (BIT))
+#define WRITE_REG(REG, VAL) ((REG) = (VAL))
+#define READ_REG(REG) ((REG))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) WRITE_REG((REG), (((READ_REG(REG)) & (~(CLEARMASK))) | (SETMASK)))
+
+#endif
@@ -0,0 +1,21 @@
+/**
+ * @file stm32l4xx_ll_bus.h
+ * @author Timothy Nguyen
+ * @brief Host stand-in for the STM32L4 LL bus driver, the clock enables made by power.c.
+ * @version 0.1
+ * @date 2021-08-20
+ */
+
+#ifndef _HOST_STM32L4XX_LL_BUS_H_
+#define _HOST_STM32L4XX_LL_BUS_H_
+
+#include "stm32l4xx.h"
+
+#define LL_APB1_GRP1_PERIPH_LPTIM1 RCC_APB1ENR1_LPTIM1EN
+
+static inline void LL_APB1_GRP1_EnableClock(uint32_t Periphs)
+{
+    SET_BIT(RCC->APB1ENR1, Periphs);
+}
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file stm32l4xx_ll_usart.h
+ * @author Timothy Nguyen
+ * @brief Host stand-in for the STM32L4 LL USART driver, the calls made by uart.c and modbus.c.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      The functions change the same register bits as the LL driver. Calls that can raise or clear
+ *      an interrupt notify the USART model of the virtual-time build (host_hw.c), which cannot
+ *      observe plain register writes.
+ */
+
+#ifndef _HOST_STM32L4XX_LL_USART_H_
+#define _HOST_STM32L4XX_LL_USART_H_
+
+#include "stm32l4xx.h"
+
+#define LL_USART_ISR_PE USART_ISR_PE
+#define LL_USART_ISR_FE USART_ISR_FE
+#define LL_USART_ISR_NE USART_ISR_NE
+#define LL_USART_ISR_ORE USART_ISR_ORE
+#define LL_USART_ISR_RXNE USART_ISR_RXNE
+#define LL_USART_ISR_TC USART_ISR_TC
+#define LL_USART_ISR_TXE USART_ISR_TXE
+#define LL_USART_ISR_RTOF USART_ISR_RTOF
+
+/**
+ * @brief Re-evaluate the interrupt request of a USART after a control or flag change.
+ */
+void host_usart_changed(USART_TypeDef *USARTx);
+
+static inline uint32_t LL_USART_IsEnabled(USART_TypeDef *USARTx)
+{
+    return READ_BIT(USARTx->CR1, USART_CR1_UE) == USART_CR1_UE;
+}
+
+static inline void LL_USART_SetRxTimeout(USART_TypeDef *USARTx, uint32_t Timeout)
+{
+    MODIFY_REG(USARTx->RTOR, USART_RTOR_RTO, Timeout);
+}
+
+static inline void LL_USART_EnableRxTimeout(USART_TypeDef *USARTx)
+{
+    SET_BIT(USARTx->CR2, USART_CR2_RTOEN);
+}
+
+static inline void LL_USART_EnableIT_RXNE(USART_TypeDef *USARTx)
+{
+    SET_BIT(USARTx->CR1, USART_CR1_RXNEIE);
+    host_usart_changed(USARTx);
+}
+
+static inline void LL_USART_EnableIT_TXE(USART_TypeDef *USARTx)
+{
+    SET_BIT(USARTx->CR1, USART_CR1_TXEIE);
+    host_usart_changed(USARTx);
+}
+
+static inline void LL_USART_DisableIT_TXE(USART_TypeDef *USARTx)
+{
+    CLEAR_BIT(USARTx->CR1, USART_CR1_TXEIE);
+    host_usart_changed(USARTx);
+}
+
+static inline void LL_USART_EnableIT_RTO(USART_TypeDef *USARTx)
+{
+    SET_BIT(USARTx->CR1, USART_CR1_RTOIE);
+    host_usart_changed(USARTx);
+}
+
+static inline uint32_t LL_USART_IsEnabledIT_RXNE(USART_TypeDef *USARTx)
+{
+    return READ_BIT(USARTx->CR1, USART_CR1_RXNEIE) == USART_CR1_RXNEIE;
+}
+
+static inline uint32_t LL_USART_IsEnabledIT_TXE(USART_TypeDef *USARTx)
+{
+    return READ_BIT(USARTx->CR1, USART_CR1_TXEIE) == USART_CR1_TXEIE;
+}
+
+/* Flags are cleared by writing ICR; the model applies the write. */
+
+static inline void LL_USART_ClearFlag_PE(USART_TypeDef *USARTx)
+{
+    WRITE_REG(USARTx->ICR, USART_ICR_PECF);
+    host_usart_changed(USARTx);
+}
+
+static inline void LL_USART_ClearFlag_FE(USART_TypeDef *USARTx)
+{
+    WRITE_REG(USARTx->ICR, USART_ICR_FECF);
+    host_usart_changed(USARTx);
+}
+
+static inline void LL_USART_ClearFlag_NE(USART_TypeDef *USARTx)
+{
+    WRITE_REG(USARTx->ICR, USART_ICR_NECF);
+    host_usart_changed(USARTx);
+}
+
+static inline void LL_USART_ClearFlag_ORE(USART_TypeDef *USARTx)
+{
+    WRITE_REG(USARTx->ICR, USART_ICR_ORECF);
+    host_usart_changed(USARTx);
+}
+
+static inline void LL_USART_ClearFlag_RTO(USART_TypeDef *USARTx)
+{
+    WRITE_REG(USARTx->ICR, USART_ICR_RTOCF);
+    host_usart_changed(USARTx);
+}
+
+#endif
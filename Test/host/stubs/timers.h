@@ -0,0 +1,25 @@
+/**
+ * @file timers.h
+ * @author Timothy Nguyen
+ * @brief Host stand-in for FreeRTOS timers.h, the timer calls made by the host-built modules.
+ * @version 0.1
+ * @date 2021-08-20
+ */
+
+#ifndef _HOST_TIMERS_H_
+#define _HOST_TIMERS_H_
+
+#include "FreeRTOS.h"
+
+typedef void *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t xTimer);
+
+TimerHandle_t xTimerCreateStatic(const char *const pcTimerName,
+                                 const TickType_t xTimerPeriodInTicks,
+                                 const UBaseType_t uxAutoReload,
+                                 void *const pvTimerID,
+                                 TimerCallbackFunction_t pxCallbackFunction,
+                                 StaticTimer_t *pxTimerBuffer);
+BaseType_t xTimerStop(TimerHandle_t xTimer, const TickType_t xTicksToWait);
+
+#endif
@@ -0,0 +1,212 @@
+/**
+ * @file test_max31855k.c
+ * @author Timothy Nguyen
+ * @brief Host tests of the MAX31855K driver against the model of host_max31855k.c.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      Each scripted fault and a set of raw frames go through HAL_SPI_Receive() and the driver's
+ *      decoding and MAX31855K_error_check(); the decoded temperatures and error are checked. The
+ *      fail-safe stop of a reflow run on a faulty thermocouple is covered by scenarios/tc_faults.txt.
+ *
+ *      Usage: test_max31855k
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "host_hw.h"
+#include "host_max31855k.h"
+#include "MAX31855K.h"
+#include "cmd.h"
+#include "log.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define TC_DEV 0  // Device behind the MAX31855K model.
+#define RAW_DEV 1 // Device clocking out raw_frame.
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        num_checks++;                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            num_failed++;                                                            \
+            fprintf(stdout, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                            \
+    } while (0)
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+static SPI_HandleTypeDef hspi2 = {.Instance = SPI2};
+static const MAX31855K_cfg_t max_cfgs[] = {
+    [TC_DEV] = {.hspi = &hspi2, .max_cs_port = GPIOC, .max_cs_pin = GPIO_PIN_4},
+    [RAW_DEV] = {.hspi = &hspi2, .max_cs_port = GPIOC, .max_cs_pin = GPIO_PIN_5}};
+
+static float tc_temp;     // Thermocouple temperature of TC_DEV.
+static uint32_t raw_frame; // Frame of RAW_DEV.
+
+static uint32_t num_checks;
+static uint32_t num_failed;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function definitions
+////////////////////////////////////////////////////////////////////////////////
+
+static float tc_source(void *arg)
+{
+    return tc_temp;
+}
+
+static uint32_t raw_source(void *arg)
+{
+    return raw_frame;
+}
+
+/* Read TC_DEV in the given mode and check error and temperatures, NAN to skip one. */
+static void check_mode(Host_Max_mode mode, float a, float b, MAX31855K_err_t err, float hj, float cj)
+{
+    host_max_set_mode(TC_DEV, mode, a, b);
+    CHECK(MAX31855K_RxBlocking(TC_DEV) == err);
+    CHECK(strcmp(MAX31855K_Err_Str(TC_DEV), MAX31855K_Err_Name(err)) == 0);
+    CHECK(isnan(hj) || MAX31855K_Get_HJ(TC_DEV) == hj);
+    CHECK(isnan(cj) || MAX31855K_Get_CJ(TC_DEV) == cj);
+}
+
+/* Read RAW_DEV and check error and temperatures. */
+static void check_raw(uint32_t frame, MAX31855K_err_t err, float hj, float cj)
+{
+    raw_frame = frame;
+    CHECK(MAX31855K_RxBlocking(RAW_DEV) == err);
+    CHECK(MAX31855K_Get_HJ(RAW_DEV) == hj);
+    CHECK(MAX31855K_Get_CJ(RAW_DEV) == cj);
+}
+
+static void test_conversion(void)
+{
+    /* Rounded to 0.25 deg C. */
+    tc_temp = 25.3f;
+    check_mode(HOST_MAX_OFF, 0, 0, MAX_OK, 25.25f, 25.0f);
+
+    /* Negative temperatures are sign-extended from 14 and 12 bits. */
+    tc_temp = -12.6f;
+    check_mode(HOST_MAX_TEMP, -12.6f, -3.0625f, MAX_OK, -12.5f, -3.0625f);
+    check_mode(HOST_MAX_TEMP, -0.25f, -0.0625f, MAX_OK, -0.25f, -0.0625f);
+
+    /* Saturated to the ranges of the fields. */
+    check_mode(HOST_MAX_TEMP, 3000.0f, 200.0f, MAX_OK, 2047.75f, 127.9375f);
+    check_mode(HOST_MAX_TEMP, -3000.0f, -200.0f, MAX_OK, -2048.0f, -128.0f);
+    check_mode(HOST_MAX_TEMP, 250.25f, 30.0f, MAX_OK, 250.25f, 30.0f);
+}
+
+static void test_faults(void)
+{
+    tc_temp = 100.0f;
+
+    /* Fault frames keep the cold junction temperature. */
+    check_mode(HOST_MAX_OPEN, 0, 0, MAX_OPEN, 0.0f, 25.0f);
+    check_mode(HOST_MAX_VCC, 0, 0, MAX_SHORT_VCC, 0.0f, 25.0f);
+    check_mode(HOST_MAX_GND, 0, 0, MAX_SHORT_GND, 0.0f, 25.0f);
+    check_mode(HOST_MAX_ZEROS, 0, 0, MAX_ZEROS, 0.0f, 0.0f);
+
+    /* Stuck repeats the last frame while the thermocouple heats up. */
+    check_mode(HOST_MAX_OFF, 0, 0, MAX_OK, 100.0f, 25.0f);
+    tc_temp = 200.0f;
+    check_mode(HOST_MAX_STUCK, 0, 0, MAX_OK, 100.0f, 25.0f);
+    check_mode(HOST_MAX_STUCK, 0, 0, MAX_OK, 100.0f, 25.0f);
+    check_mode(HOST_MAX_OFF, 0, 0, MAX_OK, 200.0f, 25.0f);
+
+    /* Noise stays within its amplitude, on the 0.25 deg C grid. */
+    bool varied = false;
+    for (int i = 0; i < 100; i++)
+    {
+        check_mode(HOST_MAX_NOISE, 2.0f, 0, MAX_OK, NAN, 25.0f);
+        float hj = MAX31855K_Get_HJ(TC_DEV);
+        CHECK(hj >= 198.0f && hj <= 202.0f && hj == roundf(hj * 4.0f) / 4.0f);
+        varied |= hj != 200.0f;
+    }
+    CHECK(varied);
+    check_mode(HOST_MAX_OFF, 0, 0, MAX_OK, 200.0f, 25.0f);
+}
+
+static void test_raw_frames(void)
+{
+    /* Field boundaries and sign bits D31 and D15. */
+    check_raw(0x7FFC7FF0U, MAX_OK, 2047.75f, 127.9375f);
+    check_raw(0x80008000U, MAX_OK, -2048.0f, -128.0f);
+    check_raw(0xFFFCFFF0U, MAX_OK, -0.25f, -0.0625f);
+    check_raw(0x00040010U, MAX_OK, 0.25f, 0.0625f);
+
+    /* D0-D2 only count with D16 set. */
+    check_raw(0x06401907U, MAX_OK, 100.0f, 25.0f);
+    check_raw(0x00011901U, MAX_OPEN, 0.0f, 25.0f);
+    check_raw(0x00011902U, MAX_SHORT_GND, 0.0f, 25.0f);
+    check_raw(0x00011904U, MAX_SHORT_VCC, 0.0f, 25.0f);
+    check_raw(0x00011900U, MAX_FAULT, 0.0f, 25.0f);      // D16 without a source.
+    check_raw(0x00011903U, MAX_FAULT, 0.0f, 25.0f);      // Two sources.
+    check_raw(0xFFFFFFFFU, MAX_FAULT, -0.25f, -0.0625f); // MISO floating high.
+    check_raw(0x00000000U, MAX_ZEROS, 0.0f, 0.0f);
+
+    /* Encoder of the model. */
+    CHECK(host_max_encode(100.0f, 25.0f, 0) == 0x06401900U);
+    CHECK(host_max_encode(0.0f, 25.0f, HOST_MAX_OC) == 0x00011901U);
+    CHECK(host_max_encode(-0.25f, -0.0625f, 0) == 0xFFFCFFF0U);
+}
+
+static void test_dma(void)
+{
+    /* DMA transfers are not modelled, the start failure is reported. */
+    MAX31855K_RxDMA(TC_DEV);
+    CHECK(strcmp(MAX31855K_Err_Str(TC_DEV), "MAX_SPI_DMA_FAIL") == 0);
+    check_mode(HOST_MAX_OFF, 0, 0, MAX_OK, 200.0f, 25.0f);
+}
+
+static void test_parse(void)
+{
+    uint8_t dev;
+    Host_Max_mode mode;
+    float a, b;
+    CHECK(host_max_parse("3 open", &dev, &mode, &a, &b) && dev == 3 && mode == HOST_MAX_OPEN);
+    CHECK(host_max_parse("2 temp 250.25 30", &dev, &mode, &a, &b) && mode == HOST_MAX_TEMP && a == 250.25f && b == 30.0f);
+    CHECK(host_max_parse("0 noise 2", &dev, &mode, &a, &b) && mode == HOST_MAX_NOISE && a == 2.0f);
+    CHECK(host_max_parse("0 OFF", &dev, &mode, &a, &b) && mode == HOST_MAX_OFF);
+    CHECK(!host_max_parse("open", &dev, &mode, &a, &b));
+    CHECK(!host_max_parse("9 open", &dev, &mode, &a, &b));
+    CHECK(!host_max_parse("0 open 1", &dev, &mode, &a, &b));
+    CHECK(!host_max_parse("0 temp", &dev, &mode, &a, &b));
+    CHECK(!host_max_parse("0 noise -1", &dev, &mode, &a, &b));
+    CHECK(!host_max_parse("0 noise nan", &dev, &mode, &a, &b));
+    CHECK(!host_max_parse("0 melt", &dev, &mode, &a, &b));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+int main(void)
+{
+    host_hw_init();
+    host_max_init(1);
+    cmd_init();
+    log_init();
+
+    host_max_attach(TC_DEV, max_cfgs[TC_DEV].max_cs_port, max_cfgs[TC_DEV].max_cs_pin, tc_source, NULL, 25.0f);
+    host_spi_attach(max_cfgs[RAW_DEV].max_cs_port, max_cfgs[RAW_DEV].max_cs_pin, raw_source, NULL);
+    MAX31855K_Init(TC_DEV, &max_cfgs[TC_DEV]);
+    MAX31855K_Init(RAW_DEV, &max_cfgs[RAW_DEV]);
+
+    test_conversion();
+    test_faults();
+    test_raw_frames();
+    test_dma();
+    test_parse();
+
+    fprintf(stdout, "test_max31855k: %u of %u checks passed\n", num_checks - num_failed, num_checks);
+    return num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,567 @@
+/**
+ * @file test_power.c
+ * @author Timothy Nguyen
+ * @brief Host tests of tickless idle (power.c) on the virtual clock of host_hw.c.
+ * @version 0.1
+ * @date 2021-08-20
+ *
+ *      power.c is included, so its static sleep functions run against the SysTick and LPTIM1
+ *      models below and the TIM7 time base of host_hw.c. WFI jumps the clock to the first
+ *      interrupt that a timer or a scripted wake-up raises, with the DWT cycle counter stopped.
+ *      Every sleep is checked against the clock: kernel ticks stepped and pended, the SysTick
+ *      period after the sleep, uwTick, timestamps and the wake-up reason.
+ *
+ *      A sleep that LPTIM1 ends keeps the kernel tick on its grid. An interrupt that ends it
+ *      earlier delays the grid by the part of an LPTIM1 count it cut, less than 1.6 us.
+ *
+ *      Usage: test_power
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../Core/Src/power.c"
+#include "host_hw.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Common macros
+////////////////////////////////////////////////////////////////////////////////
+
+#define TICK_CYCLES (HOST_CPU_HZ / configTICK_RATE_HZ) // Kernel tick period.
+#define MS_CYCLES HOST_MS_TO_CYCLES(1)                  // HAL tick period.
+#define US_CYCLES (HOST_CPU_HZ / 1000000U)
+
+#define ARR_EMPTY 0x10000U // Not a 16-bit value, ARR holds it while no write is pending.
+
+#define RANDOM_SLEEPS 3000
+
+#define CHECK(cond)                                                                  \
+    do                                                                               \
+    {                                                                                \
+        num_checks++;                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            num_failed++;                                                            \
+            fprintf(stdout, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        }                                                                            \
+    } while (0)
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) variables
+////////////////////////////////////////////////////////////////////////////////
+
+/* SysTick */
+static SysTick_Type systick;
+static uint32_t systick_ctrl;  // CTRL as the model last saw it.
+static uint64_t systick_next;  // Time VAL reaches 0 (cycles), while enabled.
+static uint32_t systick_first; // Cycles to the first reload after the last enable.
+static Host_Event systick_evt;
+
+/* LPTIM1 */
+static LPTIM_TypeDef lptim;
+static uint32_t lptim_arr; // Last ARR written.
+static bool lptim_running; // One-shot count in progress.
+static uint64_t lptim_start_time;
+static Host_Event lptim_evt;
+
+/* Kernel and scripted wake-ups */
+static uint32_t kernel_ticks; // Ticks stepped and counted by SysTick interrupts.
+static uint32_t stepped;      // Argument of the last vTaskStepTick().
+static uint64_t grid_shift;   // Delay of the kernel tick grid by early wake-ups (cycles).
+static bool abort_sleep;      // eTaskConfirmSleepModeStatus() returns eAbortSleep.
+static bool cyccnt_runs;      // DWT counts through WFI, as with DBGMCU_CR DBG_SLEEP set.
+static IRQn_Type wake_irq;
+static Host_Event wake_evt; // Pends wake_irq.
+static Host_Event run_evt;  // Ends run().
+static uint64_t rng = 1;    // xorshift64* state.
+
+static uint32_t num_checks;
+static uint32_t num_failed;
+
+////////////////////////////////////////////////////////////////////////////////
+// Private (static) function definitions
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t random_below(uint32_t n)
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return (uint32_t)((rng * 2685821657736338717ULL) >> 32) % n;
+}
+
+/* SysTick_Handler(): the kernel counts a tick. */
+static void systick_handler(void)
+{
+    SCB->ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+    kernel_ticks++;
+}
+
+static void systick_reload(Host_Event *evt)
+{
+    systick_next += systick.LOAD + 1U;
+    host_event_schedule(evt, systick_next);
+    systick.CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+    systick_ctrl = systick.CTRL;
+    if (systick.CTRL & SysTick_CTRL_TICKINT_Msk)
+    {
+        SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+        if (!host_irq_blocked())
+        {
+            systick_handler();
+        }
+    }
+}
+
+/* Catch up with the writes since the previous access. VAL counts the cycles to the next reload. */
+static void systick_sync(void)
+{
+    uint64_t now = host_hw_now();
+    bool enabled = systick.CTRL & SysTick_CTRL_ENABLE_Msk;
+    if (enabled && !(systick_ctrl & SysTick_CTRL_ENABLE_Msk))
+    { // Counting resumes from VAL, a cleared VAL loads LOAD first.
+        systick_first = systick.VAL != 0U ? systick.VAL : systick.LOAD + 1U;
+        systick_next = now + systick_first;
+        host_event_schedule(&systick_evt, systick_next);
+    }
+    else if (!enabled)
+    {
+        host_event_cancel(&systick_evt);
+    }
+    if (enabled)
+    {
+        systick.VAL = (uint32_t)(systick_next - now);
+    }
+    systick_ctrl = systick.CTRL;
+}
+
+static void lptim_match(Host_Event *evt)
+{
+    lptim_running = false;
+    lptim.CNT = lptim_arr;
+    lptim.ISR |= LPTIM_ISR_ARRM;
+    if (lptim.IER & LPTIM_IER_ARRMIE)
+    {
+        NVIC_SetPendingIRQ(LPTIM1_IRQn);
+    }
+}
+
+/* Catch up with the writes since the previous access: ICR, ARR, CR. */
+static void lptim_sync(void)
+{
+    uint64_t now = host_hw_now();
+    lptim.ISR &= ~lptim.ICR;
+    lptim.ICR = 0U;
+
+    bool enabled = lptim.CR & LPTIM_CR_ENABLE;
+    if (lptim.ARR != ARR_EMPTY)
+    {
+        lptim_arr = lptim.ARR & LPTIM_MAX_COUNT;
+        lptim.ARR = ARR_EMPTY;
+        if (enabled)
+        {
+            lptim.ISR |= LPTIM_ISR_ARROK;
+        }
+    }
+
+    if (!enabled)
+    {
+        lptim_running = false;
+        lptim.CNT = 0U;
+        host_event_cancel(&lptim_evt);
+    }
+    else if (lptim.CR & LPTIM_CR_SNGSTRT)
+    {
+        lptim.CR &= ~LPTIM_CR_SNGSTRT;
+        lptim_running = true;
+        lptim_start_time = now;
+        host_event_schedule(&lptim_evt, now + (uint64_t)lptim_arr * LPTIM_PRESCALER);
+    }
+    if (lptim_running)
+    {
+        lptim.CNT = (uint32_t)((now - lptim_start_time) / LPTIM_PRESCALER);
+    }
+}
+
+static void wake(Host_Event *evt)
+{
+    NVIC_SetPendingIRQ(wake_irq);
+}
+
+static void run_done(Host_Event *evt)
+{
+}
+
+/* Stay awake for the given time, with SysTick interrupts taken as they come. */
+static void run(uint64_t cycles)
+{
+    host_event_schedule(&run_evt, host_hw_now() + cycles);
+    while (run_evt.armed && host_hw_idle())
+    {
+    }
+    systick_sync();
+}
+
+static uint32_t total_wakes(void)
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < NUM_POWER_WAKES; i++)
+    {
+        total += power.wakes[i];
+    }
+    return total;
+}
+
+/**
+ * Let the idle task sleep and check the clocks against the time asleep.
+ *
+ * @param expected_idle Ticks to the kernel deadline.
+ * @param irq Interrupt raised after wake_after cycles, unless LPTIM1 ends the sleep first.
+ * @param wake_after Cycles, 0 for no interrupt.
+ */
+static void check_sleep(TickType_t expected_idle, IRQn_Type irq, uint64_t wake_after)
+{
+    uint64_t start = host_hw_now();
+    uint64_t next = systick_next;
+    uint32_t ticks = kernel_ticks;
+    uint32_t hal_ticks = uwTick;
+    uint64_t us = timestamp_us();
+    uint64_t sleep_us = power.sleep_us;
+    uint32_t wakes[NUM_POWER_WAKES];
+    memcpy(wakes, power.wakes, sizeof(wakes));
+    if (wake_after > 0)
+    {
+        wake_irq = irq;
+        host_event_schedule(&wake_evt, start + wake_after);
+    }
+    stepped = UINT32_MAX;
+
+    vPortSuppressTicksAndSleep(expected_idle);
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+    {
+        systick_handler();
+    }
+    systick_sync();
+    lptim_sync();
+
+    uint64_t end = host_hw_now();
+    uint64_t slept = end - start;
+    bool woken = wake_after > 0 && !wake_evt.armed;
+    host_event_cancel(&wake_evt);
+
+    /* Reason, and the kernel deadline at the end of the sleep LPTIM1 measures. */
+    TickType_t ticks_expected = expected_idle < power.max_sleep_ticks ? expected_idle : power.max_sleep_ticks;
+    uint64_t deadline = next + (uint64_t)(ticks_expected - 1U) * TICK_CYCLES;
+    power_wake_t reason = expected_idle > power.max_sleep_ticks ? POWER_WAKE_LIMIT : POWER_WAKE_DEADLINE;
+    if (woken)
+    {
+        reason = irq == USART2_IRQn ? POWER_WAKE_CONSOLE : irq == UART4_IRQn ? POWER_WAKE_MODBUS
+                                                                             : POWER_WAKE_OTHER;
+        CHECK(slept == wake_after);
+        CHECK(end <= deadline + LPTIM_PRESCALER);
+    }
+    else
+    {
+        CHECK(end >= deadline && end < deadline + LPTIM_PRESCALER);
+    }
+    CHECK(power.wakes[reason] == wakes[reason] + 1U);
+    CHECK(total_wakes() == wakes[0] + wakes[1] + wakes[2] + wakes[3] + wakes[4] + wakes[5] + 1U);
+
+    /* Kernel tick: one per period that ended, the last one through a pended SysTick interrupt,
+     * and SysTick restarted for the rest of the period. */
+    uint64_t shift = (systick_next - next) % TICK_CYCLES;
+    uint32_t passed = (uint32_t)((systick_next - next) / TICK_CYCLES);
+    CHECK(kernel_ticks - ticks == passed);
+    CHECK(passed == 0U ? stepped == UINT32_MAX : stepped == passed - 1U);
+    CHECK(woken ? shift < LPTIM_PRESCALER : shift == 0U && passed == ticks_expected);
+    grid_shift += shift;
+    CHECK(systick_next > end && systick_next - end <= TICK_CYCLES);
+    CHECK(systick_first == systick_next - end);
+    CHECK(systick.LOAD == TICK_CYCLES - 1U && (systick.CTRL & SysTick_CTRL_ENABLE_Msk));
+    CHECK(!(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk));
+
+    /* HAL tick: TIM7 kept counting, the update interrupt was taken on resume. */
+    CHECK(uwTick - hal_ticks == (uint32_t)(end / MS_CYCLES - start / MS_CYCLES));
+    CHECK((TIM7->DIER & TIM_DIER_UIE) && !(TIM7->SR & TIM_SR_UIF));
+
+    /* Timestamps, corrected for the stopped cycle counter. */
+    int64_t us_err = (int64_t)(timestamp_us() - us) - (int64_t)(slept / US_CYCLES);
+    int64_t sleep_err = (int64_t)(power.sleep_us - sleep_us) - (int64_t)(slept / US_CYCLES);
+    CHECK(us_err >= -2 && us_err <= 1);
+    CHECK(sleep_err >= -2 && sleep_err <= 0);
+
+    /* LPTIM1 stopped. */
+    CHECK(!(lptim.CR & LPTIM_CR_ENABLE) && !lptim_running && !(lptim.ISR & LPTIM_ISR_ARRM));
+    CHECK(!NVIC_GetPendingIRQ(LPTIM1_IRQn));
+}
+
+/* Stay awake until the given number of cycles is left to the next kernel tick. */
+static void run_to_tick_left(uint32_t left)
+{
+    uint64_t now = host_hw_now();
+    run(systick_next - now >= left ? systick_next - now - left : systick_next + TICK_CYCLES - now - left);
+    CHECK(systick.VAL == left);
+}
+
+static void test_init(void)
+{
+    CHECK(power_init() == MOD_OK);
+    CHECK(power.lp_per_tick == 625U && power.core_per_lp == 128U && power.core_per_tick == TICK_CYCLES);
+    CHECK(power.max_sleep_ticks == 103U);
+    CHECK((RCC->APB1ENR1 & RCC_APB1ENR1_LPTIM1EN) && !(RCC->CCIPR & RCC_CCIPR_LPTIM1SEL));
+    CHECK(lptim.CFGR == LPTIM_CFGR_PRESC && lptim.IER == LPTIM_IER_ARRMIE);
+    CHECK(power_start() == MOD_OK && power.sleep_enabled);
+
+    /* Kernel tick as the port starts it. */
+    SysTick->LOAD = TICK_CYCLES - 1U;
+    SysTick->VAL = 0U;
+    SysTick->CTRL = SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+    systick_sync();
+    run(10U * TICK_CYCLES);
+    CHECK(kernel_ticks == 10U && systick_next == 11U * TICK_CYCLES);
+}
+
+static void test_deadline(void)
+{
+    /* 30000 cycles left in the tick, 5 ticks: 235 + 4 * 625 counts, 80 cycles past the deadline. */
+    run_to_tick_left(30000U);
+    uint64_t start = host_hw_now();
+    check_sleep(5U, 0, 0);
+    CHECK(host_hw_now() - start == 2735U * 128U);
+    CHECK(stepped == 4U && systick_first == TICK_CYCLES - 80U);
+
+    /* Tick boundary on, just before and just after an LPTIM1 count. */
+    static const uint32_t lefts[] = {1U, 2U, 127U, 128U, 129U, 40000U, TICK_CYCLES - 1U, TICK_CYCLES};
+    static const TickType_t idles[] = {1U, 2U, 3U, 50U, 102U, 103U};
+    for (size_t i = 0; i < ARRAY_SIZE(lefts); i++)
+    {
+        for (size_t j = 0; j < ARRAY_SIZE(idles); j++)
+        {
+            run_to_tick_left(lefts[i]);
+            check_sleep(idles[j], 0, 0);
+        }
+    }
+}
+
+static void test_limit(void)
+{
+    check_sleep(104U, 0, 0);
+    check_sleep(1000U, 0, 0);
+    check_sleep(portMAX_DELAY, 0, 0);
+    CHECK(power.wakes[POWER_WAKE_LIMIT] == 3U);
+}
+
+static void test_interrupts(void)
+{
+    /* Before the first tick boundary, on one, and after several. */
+    run_to_tick_left(50000U);
+    check_sleep(10U, USART2_IRQn, 1U);
+    run_to_tick_left(50000U);
+    check_sleep(10U, USART2_IRQn, 49999U);
+    run_to_tick_left(50000U);
+    check_sleep(10U, UART4_IRQn, 50000U);
+    run_to_tick_left(50000U);
+    check_sleep(10U, UART4_IRQn, 50001U);
+    run_to_tick_left(50000U);
+    check_sleep(10U, USART1_IRQn, 50000U + 3U * TICK_CYCLES + 1000U);
+    CHECK(stepped == 3U);
+
+    /* The HAL tick period ends during the sleep, not the kernel tick. */
+    run_to_tick_left(TICK_CYCLES);
+    check_sleep(20U, USART2_IRQn, MS_CYCLES / 2U);
+}
+
+static void test_random(void)
+{
+    static const IRQn_Type irqs[] = {USART2_IRQn, UART4_IRQn, USART1_IRQn};
+    for (uint32_t i = 0; i < RANDOM_SLEEPS; i++)
+    {
+        run(random_below(3U * TICK_CYCLES));
+        TickType_t idle = 1U + random_below(150U);
+        uint64_t wake_after = random_below(2U) ? 1U + random_below((idle + 1U) * TICK_CYCLES) : 0U;
+        check_sleep(idle, irqs[random_below(ARRAY_SIZE(irqs))], wake_after);
+    }
+
+    /* HAL tick exact, kernel tick counted on the grid the early wake-ups delayed. */
+    CHECK(uwTick == host_hw_now() / MS_CYCLES);
+    CHECK((systick_next - grid_shift) % TICK_CYCLES == 0U);
+    CHECK(kernel_ticks == (systick_next - grid_shift) / TICK_CYCLES - 1U);
+}
+
+static void test_cyccnt_runs(void)
+{
+    /* No timestamp correction when the cycle counter did not stop. */
+    cyccnt_runs = true;
+    run_to_tick_left(1000U);
+    check_sleep(7U, 0, 0);
+    run_to_tick_left(1000U);
+    check_sleep(7U, USART2_IRQn, 3U * TICK_CYCLES);
+    cyccnt_runs = false;
+}
+
+static void test_abort(void)
+{
+    uint32_t aborted = power.aborted;
+    uint32_t wakes = total_wakes();
+    uint64_t start = host_hw_now();
+
+    abort_sleep = true;
+    vPortSuppressTicksAndSleep(5U);
+    abort_sleep = false;
+
+    /* A tick interrupt pending, not taken yet. */
+    SCB->ICSR |= SCB_ICSR_PENDSTSET_Msk;
+    vPortSuppressTicksAndSleep(5U);
+    SCB->ICSR &= ~SCB_ICSR_PENDSTSET_Msk;
+
+    CHECK(power.aborted == aborted + 2U && total_wakes() == wakes && host_hw_now() == start);
+    CHECK(systick.CTRL & SysTick_CTRL_ENABLE_Msk);
+
+    power.sleep_enabled = false;
+    vPortSuppressTicksAndSleep(5U);
+    power.sleep_enabled = true;
+    CHECK(power.aborted == aborted + 2U && total_wakes() == wakes && host_hw_now() == start);
+}
+
+static void test_tick_mode(void)
+{
+    /* Plain WFI, the next SysTick interrupt ends the sleep. */
+    power.tickless = false;
+    for (uint32_t left = 1U; left <= TICK_CYCLES; left += 19999U)
+    {
+        run_to_tick_left(left);
+        uint64_t start = host_hw_now();
+        uint32_t ticks = kernel_ticks;
+        uint32_t tick_wakes = power.wakes[POWER_WAKE_TICK];
+        uint64_t sleep_us = power.sleep_us;
+        systick.CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk; // Cleared by the read in sleep_until_tick().
+
+        vPortSuppressTicksAndSleep(10U);
+        systick_handler();
+
+        CHECK(host_hw_now() - start == left && kernel_ticks == ticks + 1U);
+        CHECK(power.wakes[POWER_WAKE_TICK] == tick_wakes + 1U);
+        CHECK(power.sleep_us - sleep_us == left / US_CYCLES);
+    }
+    power.tickless = true;
+}
+
+static void test_window(void)
+{
+    /* Start of a second, then three console wake-ups. */
+    count_wake(POWER_WAKE_OTHER, 0U, 0U);
+    uint64_t window = power.window_start_us;
+    run((window + US_PER_SECOND - timestamp_us()) * US_CYCLES);
+    count_wake(POWER_WAKE_OTHER, 0U, 0U);
+    CHECK(power.window_start_us == window + US_PER_SECOND);
+    window = power.window_start_us;
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        count_wake(POWER_WAKE_CONSOLE, 0U, 0U);
+    }
+    CHECK(power.window_wakes[POWER_WAKE_CONSOLE] == 3U && power.window_wakes[POWER_WAKE_OTHER] == 1U);
+
+    /* Time asleep advances timestamps unless the cycle counter ran. */
+    uint64_t us = timestamp_us();
+    uint64_t sleep_us = power.sleep_us;
+    count_wake(POWER_WAKE_OTHER, 8000U, 0U);
+    CHECK(timestamp_us() == us + 100U && power.sleep_us == sleep_us + 100U);
+    count_wake(POWER_WAKE_OTHER, 8000U, 7000U);
+    CHECK(timestamp_us() == us + 100U && power.sleep_us == sleep_us + 200U);
+
+    /* The next second moves the counts to the last complete second. */
+    run((window + US_PER_SECOND + 10U - timestamp_us()) * US_CYCLES);
+    count_wake(POWER_WAKE_MODBUS, 0U, 0U);
+    CHECK(power.window_start_us == window + US_PER_SECOND);
+    CHECK(power.last_second_wakes[POWER_WAKE_CONSOLE] == 3U && power.last_second_wakes[POWER_WAKE_OTHER] == 3U);
+    CHECK(power.window_wakes[POWER_WAKE_MODBUS] == 1U && power.window_wakes[POWER_WAKE_CONSOLE] == 0U);
+
+    /* A gap of more than a second leaves nothing in the last second. */
+    run(2500U * MS_CYCLES);
+    count_wake(POWER_WAKE_OTHER, 0U, 0U);
+    CHECK(power.window_start_us == window + 3U * US_PER_SECOND);
+    for (uint8_t i = 0; i < NUM_POWER_WAKES; i++)
+    {
+        CHECK(power.last_second_wakes[i] == 0U);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public (global) functions
+////////////////////////////////////////////////////////////////////////////////
+
+SysTick_Type *host_systick(void)
+{
+    systick_sync();
+    return &systick;
+}
+
+LPTIM_TypeDef *host_lptim1(void)
+{
+    lptim_sync();
+    return &lptim;
+}
+
+/* The core clock, and with it the DWT cycle counter, stops until an interrupt is pending. */
+void __WFI(void)
+{
+    systick_sync();
+    lptim_sync();
+    uint32_t dwt_ctrl = DWT->CTRL;
+    if (!cyccnt_runs)
+    {
+        DWT->CTRL &= ~DWT_CTRL_CYCCNTENA_Msk;
+    }
+    while (!host_irq_pending())
+    {
+        if (!host_hw_idle())
+        {
+            fprintf(stdout, "test_power: WFI never returns\n");
+            exit(1);
+        }
+    }
+    DWT->CTRL = dwt_ctrl;
+}
+
+void vTaskStepTick(TickType_t xTicksToJump)
+{
+    stepped = xTicksToJump;
+    kernel_ticks += xTicksToJump;
+}
+
+eSleepModeStatus eTaskConfirmSleepModeStatus(void)
+{
+    return abort_sleep ? eAbortSleep : eStandardSleep;
+}
+
+int main(void)
+{
+    host_hw_init();
+    SystemCoreClock = HOST_CPU_HZ;
+    timestamp_init();
+    cmd_init();
+    log_init();
+
+    lptim.ARR = ARR_EMPTY;
+    systick_evt.cb = systick_reload;
+    lptim_evt.cb = lptim_match;
+    wake_evt.cb = wake;
+    run_evt.cb = run_done;
+    host_irq_attach(LPTIM1_IRQn, LPTIM1_IRQHandler);
+    NVIC_EnableIRQ(USART1_IRQn);
+    NVIC_EnableIRQ(USART2_IRQn);
+    NVIC_EnableIRQ(UART4_IRQn);
+
+    test_init();
+    test_deadline();
+    test_limit();
+    test_interrupts();
+    test_random();
+    test_cyccnt_runs();
+    test_abort();
+    test_tick_mode();
+    test_window();
+
+    fprintf(stdout, "test_power: %u of %u checks passed\n", num_checks - num_failed, num_checks);
+    return num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+"""Columnar run archive for recorded reflow runs.
+
+Each run is stored in its own file: a small header followed by one fixed-width column per
+quantity. Columns are contiguous and 64-byte aligned, so analysis tools can numpy.memmap them
+and scan hundreds of runs without parsing text. An append-only index (index.jsonl) lists every
+run in the archive together with its metadata.
+
+Run file layout (little-endian):
+    magic 'RFRN' | version (u16) | reserved (u16) | samples (u32) | meta length (u32) | meta (JSON)
+    padding to 64 bytes, then the columns in COLUMNS order, each padded to 64 bytes.
+
+Usage:
+    python archive.py import csv/*.csv --archive runs.arc --profile SAC305 --kp 225 --kd 500 --oven oven1
+    python archive.py list --archive runs.arc
+    python archive.py export <run id> --archive runs.arc -o run.csv
+"""
+
+import argparse
+import csv
+import datetime
+import json
+import os
+import struct
+import uuid
+
+import numpy as np
+
+MAGIC = b'RFRN'
+VERSION = 1
+ALIGN = 64
+FILE_HEADER = struct.Struct('<4sHHII')  # magic, version, reserved, samples, meta length
+
+STATE_NAMES = ['RESET', 'PREHEAT', 'SOAK', 'RAMPUP', 'PEAK', 'COOLDOWN', 'STREAM']
+
+# Column name, dtype, CSV header (plot_temp.py layout).
+COLUMNS = [
+    ('time', np.float32, 'Time (s)'),
+    ('state', np.uint8, 'State'),
+    ('setpoint', np.float32, 'Set point (°C)'),
+    ('temperature', np.float32, 'Measured (°C)'),
+    ('p', np.float32, 'P'),
+    ('i', np.float32, 'I'),
+    ('d', np.float32, 'D'),
+    ('pwm', np.float32, 'PWM/4095'),
+]
+
+INDEX_NAME = 'index.jsonl'
+
+
+def _align(n):
+    return (n + ALIGN - 1) // ALIGN * ALIGN
+
+
+def column_offsets(samples, meta_len):
+    """Return dict of column name -> byte offset for a run file."""
+    offset = _align(FILE_HEADER.size + meta_len)
+    offsets = {}
+    for name, dtype, _ in COLUMNS:
+        offsets[name] = offset
+        offset += _align(samples * np.dtype(dtype).itemsize)
+    return offsets
+
+
+class Run:
+    """Memory-mapped run. Columns are read-only numpy arrays."""
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, 'rb') as f:
+            magic, version, _, samples, meta_len = FILE_HEADER.unpack(f.read(FILE_HEADER.size))
+            if magic != MAGIC or version != VERSION:
+                raise ValueError('{}: not a run file'.format(path))
+            self.meta = json.loads(f.read(meta_len).decode('utf-8'))
+        self.samples = samples
+        offsets = column_offsets(samples, meta_len)
+        self.columns = {}
+        for name, dtype, _ in COLUMNS:
+            if samples:
+                self.columns[name] = np.memmap(path, dtype=dtype, mode='r', offset=offsets[name], shape=(samples,))
+            else:
+                self.columns[name] = np.empty(0, dtype=dtype)
+
+    def __getitem__(self, name):
+        return self.columns[name]
+
+    def to_csv(self, path):
+        """Write run in the plot_temp.py CSV layout."""
+        with open(path, 'w', newline='', encoding='utf-8') as f:
+            writer = csv.writer(f)
+            writer.writerow(['State', 'Time (s)', 'P', 'I', 'D', 'PWM/4095', 'Set point (°C)', 'Measured (°C)'])
+            for n in range(self.samples):
+                state = int(self['state'][n])
+                writer.writerow([STATE_NAMES[state] if state < len(STATE_NAMES) else state,
+                                 *(float(self[c][n]) for c in ('time', 'p', 'i', 'd', 'pwm', 'setpoint', 'temperature'))])
+
+
+class Archive:
+    """Directory of run files with a global index."""
+
+    def __init__(self, path):
+        self.path = path
+        os.makedirs(path, exist_ok=True)
+
+    def index(self):
+        """Return list of index entries (dicts), oldest first."""
+        index_path = os.path.join(self.path, INDEX_NAME)
+        if not os.path.exists(index_path):
+            return []
+        with open(index_path, encoding='utf-8') as f:
+            return [json.loads(line) for line in f if line.strip()]
+
+    def open(self, run_id):
+        return Run(os.path.join(self.path, run_id + '.rfr'))
+
+    def add(self, columns, meta):
+        """Store a run.
+
+        columns: dict of column name -> sequence, all of equal length (missing columns are NaN/0).
+        meta: JSON-serialisable dict, e.g. profile, gains, oven, firmware, start time.
+
+        Returns the run id.
+        """
+        samples = len(columns['temperature'])
+        run_id = meta.get('id') or uuid.uuid4().hex[:16]
+        meta = dict(meta, id=run_id, samples=samples)
+        meta_bytes = json.dumps(meta, sort_keys=True).encode('utf-8')
+        offsets = column_offsets(samples, len(meta_bytes))
+
+        path = os.path.join(self.path, run_id + '.rfr')
+        tmp_path = path + '.tmp'
+        with open(tmp_path, 'wb') as f:
+            f.write(FILE_HEADER.pack(MAGIC, VERSION, 0, samples, len(meta_bytes)))
+            f.write(meta_bytes)
+            for name, dtype, _ in COLUMNS:
+                fill = 0 if np.dtype(dtype).kind == 'u' else np.nan
+                data = np.asarray(columns.get(name, np.full(samples, fill)), dtype=dtype)
+                if len(data) != samples:
+                    raise ValueError('column {} has {} samples, expected {}'.format(name, len(data), samples))
+                f.seek(offsets[name])
+                f.write(data.tobytes())
+            f.truncate(_align(f.tell()))
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(tmp_path, path)
+
+        # Index entry is written last, so indexed runs are always complete.
+        with open(os.path.join(self.path, INDEX_NAME), 'a', encoding='utf-8') as f:
+            f.write(json.dumps(meta, sort_keys=True) + '\n')
+            f.flush()
+            os.fsync(f.fileno())
+        return run_id
+
+    def import_csv(self, csv_path, meta):
+        """Store a run recorded by plot_temp.py, ingest.py or stream_host.py."""
+        with open(csv_path, newline='', encoding='utf-8') as f:
+            reader = csv.reader(f)
+            header = next(reader)
+            rows = [row for row in reader if row]
+
+        if header[0] == 'State':
+            # State, Time, P, I, D, PWM, Set point, Measured
+            cols = {'time': 1, 'p': 2, 'i': 3, 'd': 4, 'pwm': 5, 'setpoint': 6, 'temperature': 7}
+            scale = 1.0
+        elif header[0] == 'seq':
+            # seq, state, tick (ms), setpoint, temperature, output
+            cols = {'time': 2, 'setpoint': 3, 'temperature': 4, 'pwm': 5}
+            scale = 1e-3
+        else:
+            raise ValueError('{}: unknown recording format'.format(csv_path))
+        state_col = 0 if header[0] == 'State' else 1
+
+        columns = {name: np.array([float(row[col]) for row in rows], dtype=np.float32) for name, col in cols.items()}
+        columns['time'] = (columns['time'] - (columns['time'][0] if rows else 0)) * scale
+        columns['state'] = np.array([STATE_NAMES.index(row[state_col]) if row[state_col] in STATE_NAMES else 0xFF
+                                     for row in rows], dtype=np.uint8)
+
+        meta = dict(meta, source=os.path.basename(csv_path))
+        meta.setdefault('start', datetime.datetime.fromtimestamp(os.path.getmtime(csv_path)).isoformat(timespec='seconds'))
+        return self.add(columns, meta)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    imp = sub.add_parser('import', help='Import CSV recordings.')
+    imp.add_argument('csv', nargs='+')
+    imp.add_argument('--profile')
+    imp.add_argument('--kp', type=float)
+    imp.add_argument('--ki', type=float)
+    imp.add_argument('--kd', type=float)
+    imp.add_argument('--tau', type=float)
+    imp.add_argument('--oven')
+    imp.add_argument('--firmware')
+
+    sub.add_parser('list', help='List archived runs.')
+
+    exp = sub.add_parser('export', help='Export run as CSV.')
+    exp.add_argument('run_id')
+    exp.add_argument('-o', '--out', help='Output CSV path (default: <run id>.csv).')
+
+    for p in (imp, sub.choices['list'], exp):
+        p.add_argument('--archive', default='runs.arc', help='Archive directory.')
+    args = parser.parse_args()
+
+    archive = Archive(args.archive)
+    if args.cmd == 'import':
+        gains = {k: getattr(args, k) for k in ('kp', 'ki', 'kd', 'tau') if getattr(args, k) is not None}
+        meta = {k: v for k, v in (('profile', args.profile), ('oven', args.oven), ('firmware', args.firmware)) if v}
+        if gains:
+            meta['gains'] = gains
+        for path in args.csv:
+            print(archive.import_csv(path, meta), path)
+    elif args.cmd == 'list':
+        for entry in archive.index():
+            print('{id}  {start}  {samples:6d}  {profile}  {oven}  {firmware}  {source}'.format(
+                **{'profile': '-', 'oven': '-', 'firmware': '-', 'start': '-', 'source': '-', **entry}))
+    else:
+        archive.open(args.run_id).to_csv(args.out or args.run_id + '.csv')
+
+
+if __name__ == '__main__':
+    main()
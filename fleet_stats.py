@@ -0,0 +1,173 @@
+"""Compute reflow compliance metrics over a run archive and flag drift across the fleet.
+
+Per run: time above liquidus (TAL), peak temperature, maximum heating and cooling rates,
+overshoot over the peak setpoint, heater energy and time to peak. Runs are processed on all
+cores. Results are aggregated by oven, profile and firmware version, and each oven's runs are
+checked against individuals control limits (mean +/- 3 sigma of its first --baseline runs), which
+catches slow drift such as ageing heating elements.
+
+Usage:
+    python fleet_stats.py --archive runs.arc
+    python fleet_stats.py --archive runs.arc --element-watts 1500 --runs-out metrics.csv
+    python fleet_stats.py --archive fleet.arc/oven1 --archive fleet.arc/oven2
+"""
+
+import argparse
+import csv
+import multiprocessing
+import os
+from collections import defaultdict
+
+import numpy as np
+
+from archive import Archive
+
+# Liquidus temperatures (deg C) of the compiled-in profiles (Core/Inc/reflow_profiles.def).
+LIQUIDUS = {
+    'default': 183,
+    'SAC305': 217,
+    'SAC0307': 217,
+    'Sn96.5Ag3.5': 221,
+    'Sn63Pb37': 183,
+    'Sn62Pb36Ag2': 179,
+    'Sn42Bi58': 138,
+    'Sn42Bi57Ag1': 139,
+}
+
+# Window for ramp rate estimation (s), smooths out thermocouple quantisation.
+RAMP_WINDOW = 5.0
+
+# Full-scale PWM output.
+PWM_MAX = 4095.0
+
+METRICS = ['tal', 'peak', 'time_to_peak', 'max_heating_rate', 'max_cooling_rate', 'overshoot', 'energy']
+
+# Metrics whose drift is tracked per oven.
+DRIFT_METRICS = ['time_to_peak', 'energy', 'max_heating_rate']
+
+
+def run_metrics(job):
+    """Compute metrics of one archived run."""
+    archive_path, entry, liquidus_override, element_watts = job
+    run = Archive(archive_path).open(entry['id'])
+    t = np.asarray(run['time'], dtype=np.float64)
+    temp = np.asarray(run['temperature'], dtype=np.float64)
+    sp = np.asarray(run['setpoint'], dtype=np.float64)
+    pwm = np.asarray(run['pwm'], dtype=np.float64)
+
+    result = {'id': entry['id'], 'start': entry.get('start', ''), 'oven': entry.get('oven', '-'),
+              'profile': entry.get('profile', '-'), 'firmware': entry.get('firmware', '-'), 'samples': len(t)}
+    if len(t) < 2:
+        return dict(result, **{m: float('nan') for m in METRICS})
+
+    dt = np.diff(t, append=t[-1] + np.median(np.diff(t)))
+    liquidus = liquidus_override or LIQUIDUS.get(result['profile'], LIQUIDUS['default'])
+
+    # Ramp rate over a sliding window of RAMP_WINDOW seconds.
+    step = max(1, int(round(RAMP_WINDOW / np.median(dt))))
+    rates = (temp[step:] - temp[:-step]) / (t[step:] - t[:-step]) if len(t) > step else np.zeros(1)
+
+    peak_index = int(np.argmax(temp))
+    duty = np.clip(pwm / PWM_MAX, 0, 1)
+    energy = float(np.sum(duty * dt))  # Full-power seconds.
+    if element_watts:
+        energy *= element_watts / 3600  # Wh.
+
+    result.update({
+        'tal': float(np.sum(dt[temp >= liquidus])),
+        'peak': float(temp[peak_index]),
+        'time_to_peak': float(t[peak_index] - t[0]),
+        'max_heating_rate': float(np.max(rates)),
+        'max_cooling_rate': float(-np.min(rates)),
+        'overshoot': float(temp[peak_index] - np.max(sp)),
+        'energy': energy,
+    })
+    return result
+
+
+def aggregate(results, key):
+    """Return {group: {metric: (mean, std)}} grouped by the given fields."""
+    groups = defaultdict(list)
+    for r in results:
+        groups[tuple(r[k] for k in key)].append(r)
+    summary = {}
+    for group, rows in sorted(groups.items()):
+        summary[group] = {'runs': len(rows)}
+        for m in METRICS:
+            values = np.array([r[m] for r in rows], dtype=np.float64)
+            summary[group][m] = (np.nanmean(values), np.nanstd(values))
+    return summary
+
+
+def control_limits(values):
+    """Individuals chart limits from the average moving range."""
+    mean = np.mean(values)
+    sigma = np.mean(np.abs(np.diff(values))) / 1.128 if len(values) > 1 else 0.0
+    return mean - 3 * sigma, mean + 3 * sigma, mean
+
+
+def drift(results, baseline, run_length=8):
+    """Flag runs outside each oven's control limits, or long runs on one side of the baseline mean."""
+    flags = []
+    by_oven = defaultdict(list)
+    for r in results:
+        by_oven[r['oven']].append(r)
+    for oven, rows in sorted(by_oven.items()):
+        rows.sort(key=lambda r: r['start'])
+        if len(rows) <= baseline:
+            continue
+        for m in DRIFT_METRICS:
+            values = np.array([r[m] for r in rows], dtype=np.float64)
+            lo, hi, mean = control_limits(values[:baseline])
+            side = 0
+            streak = 0
+            for r, v in zip(rows[baseline:], values[baseline:]):
+                if hi > lo and (v < lo or v > hi):  # Constant baselines give no usable limits.
+                    flags.append((oven, m, r['id'], r['start'], v, 'outside control limits [{:.2f}, {:.2f}]'.format(lo, hi)))
+                s = 1 if v > mean else (-1 if v < mean else 0)
+                streak = streak + 1 if s == side and s != 0 else abs(s)
+                side = s
+                if streak == run_length:
+                    flags.append((oven, m, r['id'], r['start'], v,
+                                  '{} runs {} baseline mean {:.2f}'.format(run_length, 'above' if s > 0 else 'below', mean)))
+    return flags
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--archive', action='append', help='Archive directory (repeatable, default: runs.arc).')
+    parser.add_argument('--liquidus', type=float, help='Override liquidus temperature for TAL (deg C).')
+    parser.add_argument('--element-watts', type=float, help='Heater power, reports energy in Wh instead of full-power seconds.')
+    parser.add_argument('--baseline', type=int, default=20, help='Runs per oven used to set control limits.')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count(), help='Worker processes.')
+    parser.add_argument('--runs-out', help='Write per-run metrics to this CSV file.')
+    args = parser.parse_args()
+
+    jobs = [(path, entry, args.liquidus, args.element_watts)
+            for path in args.archive or ['runs.arc'] for entry in Archive(path).index()]
+    with multiprocessing.Pool(args.jobs) as pool:
+        results = pool.map(run_metrics, jobs, chunksize=max(1, len(jobs) // (4 * args.jobs)))
+
+    if args.runs_out:
+        with open(args.runs_out, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=['id', 'start', 'oven', 'profile', 'firmware', 'samples'] + METRICS)
+            writer.writeheader()
+            writer.writerows(results)
+
+    energy_unit = 'Wh' if args.element_watts else 'full-power s'
+    print('{} runs. TAL, time to peak in s; rates in deg C/s; energy in {}.'.format(len(results), energy_unit))
+    print('{:12s} {:12s} {:10s} {:>5s} '.format('oven', 'profile', 'firmware', 'runs') +
+          ' '.join('{:>18s}'.format(m) for m in METRICS))
+    for (oven, profile, firmware), s in aggregate(results, ('oven', 'profile', 'firmware')).items():
+        print('{:12s} {:12s} {:10s} {:5d} '.format(str(oven), str(profile), str(firmware), s['runs']) +
+              ' '.join('{:>9.2f} ±{:<7.2f}'.format(*s[m]) for m in METRICS))
+
+    flags = drift(results, args.baseline)
+    if flags:
+        print('\nDrift:')
+        for oven, metric, run_id, start, value, reason in flags:
+            print('{} run {} ({}): {} = {:.2f}, {}'.format(oven, run_id, start or '-', metric, value, reason))
+
+
+if __name__ == '__main__':
+    main()
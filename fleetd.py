@@ -0,0 +1,345 @@
+"""Manage a fleet of reflow oven controllers from one host process.
+
+All serial links and control clients are served by a single selectors event loop (epoll on
+Linux). Every device gets its own telemetry decoder, run recorder and run archive
+(<archive>/<device>), so runs of different ovens never mix. Console output of each device is
+kept in a short backlog and forwarded to the control clients attached to it. Devices that
+disappear (unplugged board, closed pty) are reopened every --reconnect seconds.
+
+Control socket: a Unix stream socket accepting one command per line.
+    devices                     list devices with link state, controller state and run file
+    attach <device|*>           forward console output of a device to this client
+    detach <device|*>           stop forwarding console output
+    watch <device|*>            forward control samples of a device to this client
+    unwatch <device|*>          stop forwarding control samples
+    send <device|*> <command>   send a console command, e.g. "send oven1 reflow start"
+    backlog <device>            replay the recent console output of a device
+    quit                        close the connection
+Replies start with "ok" or "error"; forwarded output is prefixed with the device name.
+
+Any pty that behaves like a controller (e.g. Test/host/host_sim without a script) can be given as a
+port.
+
+Usage:
+    python fleetd.py --device oven1=/dev/ttyACM0 --device oven2=/dev/ttyACM1 --archive fleet.arc
+    socat - UNIX-CONNECT:/tmp/fleetd.sock
+"""
+
+import argparse
+import collections
+import os
+import selectors
+import signal
+import socket
+import sys
+import time
+
+import serial
+
+from ingest import INIT_MSG, RUN_END_MSGS, RunWriter, TelemetryDecoder, parse_telemetry
+
+# Console lines kept per device for the backlog command.
+BACKLOG_LINES = 200
+
+# Unsent output above which a control client is dropped (bytes).
+CLIENT_MAX_PENDING = 1 << 20
+
+
+class Device:
+    """One controller: serial link, decoder, run recorder and subscribers."""
+
+    def __init__(self, name, port, args, on_close):
+        self.name = name
+        self.port = port
+        self.baud = args.baud
+        self.init = not args.no_init
+        self.serial = None
+        self.decoder = None
+        self.writer = RunWriter(os.path.join(args.out_dir, name), name, args.fsync_samples, args.fsync_interval,
+                                on_close)
+        os.makedirs(self.writer.out_dir, exist_ok=True)
+        self.backlog = collections.deque(maxlen=BACKLOG_LINES)
+        self.attached = set()
+        self.watchers = set()
+        self.last = None
+        self.next_open = 0.0
+        self.open_error = None
+
+    def open(self):
+        """Open the serial link, returns False if the port is unavailable."""
+        try:
+            self.serial = serial.Serial(port=self.port, baudrate=self.baud, timeout=0)
+        except (OSError, serial.SerialException) as e:
+            if str(e) != self.open_error:
+                print('{}: cannot open {}: {}'.format(self.name, self.port, e))
+            self.open_error = str(e)
+            return False
+        self.open_error = None
+        self.decoder = TelemetryDecoder()
+        if self.init:
+            self.serial.write(INIT_MSG)
+        print('{}: connected to {}'.format(self.name, self.port))
+        return True
+
+    def close(self):
+        self.writer.close()
+        if self.serial is not None:
+            self.serial.close()
+            self.serial = None
+
+    def status(self):
+        link = 'up' if self.serial is not None else 'down'
+        if self.last is None:
+            return '{} {} {} - - -'.format(self.name, self.port, link)
+        return '{} {} {} {} {:.2f} {}'.format(self.name, self.port, link, self.last['state'],
+                                            self.last['temperature'], self.writer.path if self.writer.file else '-')
+
+
+class Client:
+    """Control socket connection with buffered, non-blocking output."""
+
+    def __init__(self, sock):
+        self.sock = sock
+        self.inbuf = bytearray()
+        self.outbuf = bytearray()
+        self.closing = False
+
+    def write(self, text):
+        self.outbuf += text.encode('utf-8', 'replace')
+
+
+class Fleet:
+    """Event loop multiplexing devices and control clients."""
+
+    def __init__(self, args):
+        self.args = args
+        self.sel = selectors.DefaultSelector()
+        self.clients = {}
+
+        on_close = None
+        if args.archive:
+            from archive import Archive
+
+            def on_close(name, path):
+                Archive(os.path.join(args.archive, name)).import_csv(path, {'oven': name})
+
+        self.devices = {}
+        for spec in args.device:
+            name, _, port = spec.rpartition('=')
+            name = name or os.path.basename(port)
+            self.devices[name] = Device(name, port, args, on_close)
+
+        if os.path.exists(args.socket):
+            os.unlink(args.socket)
+        self.listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.listener.bind(args.socket)
+        self.listener.listen()
+        self.listener.setblocking(False)
+        self.sel.register(self.listener, selectors.EVENT_READ, None)
+
+    # Devices.
+
+    def connect(self, dev):
+        if dev.open():
+            self.sel.register(dev.serial.fileno(), selectors.EVENT_READ, dev)
+        else:
+            dev.next_open = time.monotonic() + self.args.reconnect
+
+    def disconnect(self, dev, reason):
+        print('{}: link lost: {}'.format(dev.name, reason))
+        self.sel.unregister(dev.serial.fileno())
+        dev.close()
+        dev.next_open = time.monotonic() + self.args.reconnect
+        self.publish(dev.attached, '{} link down\n'.format(dev.name))
+
+    def read_device(self, dev):
+        try:
+            data = dev.serial.read(dev.serial.in_waiting or 1)
+        except (OSError, serial.SerialException) as e:
+            self.disconnect(dev, e)
+            return
+        for kind, item in dev.decoder.feed(data):
+            sample = item if kind == 'sample' else parse_telemetry(item)
+            if sample is not None:
+                dev.last = sample
+                dev.writer.add(sample)
+                if dev.watchers:
+                    self.publish(dev.watchers, '{} sample {state} {seq} {ms} {setpoint:.2f} {temperature:.2f} '
+                                               '{output:.1f}\n'.format(dev.name, **sample))
+                continue
+            line = item.rstrip('\r')
+            if not line:
+                continue
+            dev.backlog.append(line)
+            self.publish(dev.attached, '{} {}\n'.format(dev.name, line))
+            if any(msg in line for msg in RUN_END_MSGS):
+                dev.writer.close()
+
+    def send(self, dev, command):
+        if dev.serial is None:
+            return False
+        try:
+            dev.serial.write(' {}\n'.format(command).encode())
+        except (OSError, serial.SerialException) as e:
+            self.disconnect(dev, e)
+            return False
+        return True
+
+    # Control clients.
+
+    def accept(self):
+        sock, _ = self.listener.accept()
+        sock.setblocking(False)
+        client = Client(sock)
+        self.clients[sock] = client
+        self.sel.register(sock, selectors.EVENT_READ, client)
+
+    def drop(self, client):
+        for dev in self.devices.values():
+            dev.attached.discard(client)
+            dev.watchers.discard(client)
+        self.sel.unregister(client.sock)
+        del self.clients[client.sock]
+        client.sock.close()
+
+    def publish(self, clients, text):
+        for client in list(clients):
+            client.write(text)
+            self.flush(client)
+
+    def flush(self, client):
+        """Send buffered output without blocking, waiting for EVENT_WRITE if the socket is full."""
+        if client.outbuf:
+            try:
+                sent = client.sock.send(client.outbuf)
+                del client.outbuf[:sent]
+            except BlockingIOError:
+                pass
+            except OSError:
+                self.drop(client)
+                return
+        if len(client.outbuf) > CLIENT_MAX_PENDING:
+            self.drop(client)  # Client stopped reading.
+            return
+        if client.closing and not client.outbuf:
+            self.drop(client)
+            return
+        events = selectors.EVENT_READ | (selectors.EVENT_WRITE if client.outbuf else 0)
+        if self.sel.get_key(client.sock).events != events:
+            self.sel.modify(client.sock, events, client)
+
+    def read_client(self, client):
+        try:
+            data = client.sock.recv(4096)
+        except (BlockingIOError, InterruptedError):
+            return
+        except OSError:
+            data = b''
+        if not data:
+            self.drop(client)
+            return
+        client.inbuf += data
+        while b'\n' in client.inbuf and client.sock in self.clients:
+            line, _, rest = client.inbuf.partition(b'\n')
+            client.inbuf = bytearray(rest)
+            client.write(self.command(client, line.decode('utf-8', 'replace').strip()))
+            self.flush(client)
+
+    def select_devices(self, name):
+        if name == '*':
+            return list(self.devices.values())
+        return [self.devices[name]] if name in self.devices else []
+
+    def command(self, client, line):
+        """Execute one control command and return the reply."""
+        words = line.split(maxsplit=2)
+        if not words:
+            return ''
+        cmd = words[0]
+        if cmd == 'devices':
+            return ''.join(dev.status() + '\n' for dev in self.devices.values()) + 'ok\n'
+        if cmd == 'quit':
+            client.closing = True
+            return 'ok\n'
+        if len(words) < 2:
+            return 'error missing device\n'
+        devs = self.select_devices(words[1])
+        if not devs:
+            return 'error unknown device {}\n'.format(words[1])
+        if cmd in ('attach', 'detach', 'watch', 'unwatch'):
+            for dev in devs:
+                subscribers = dev.attached if cmd in ('attach', 'detach') else dev.watchers
+                if cmd in ('attach', 'watch'):
+                    subscribers.add(client)
+                else:
+                    subscribers.discard(client)
+            return 'ok\n'
+        if cmd == 'backlog':
+            return ''.join('{} {}\n'.format(dev.name, line) for dev in devs for line in dev.backlog) + 'ok\n'
+        if cmd == 'send':
+            if len(words) < 3:
+                return 'error missing command\n'
+            down = [dev.name for dev in devs if not self.send(dev, words[2])]
+            return 'error link down {}\n'.format(' '.join(down)) if down else 'ok\n'
+        return 'error unknown command {}\n'.format(cmd)
+
+    # Event loop.
+
+    def run(self):
+        for dev in self.devices.values():
+            self.connect(dev)
+        while True:
+            for key, events in self.sel.select(timeout=0.5):
+                if key.data is None:
+                    self.accept()
+                elif isinstance(key.data, Device):
+                    self.read_device(key.data)
+                elif key.fileobj in self.clients:
+                    if events & selectors.EVENT_READ:
+                        self.read_client(key.data)
+                    if events & selectors.EVENT_WRITE and key.fileobj in self.clients:
+                        self.flush(key.data)
+            now = time.monotonic()
+            for dev in self.devices.values():
+                if dev.serial is None and now >= dev.next_open:
+                    self.connect(dev)
+                # Bound data loss on idle devices too.
+                if now - dev.writer.last_sync >= self.args.fsync_interval:
+                    dev.writer.sync()
+
+    def close(self):
+        for client in list(self.clients.values()):
+            self.drop(client)
+        for dev in self.devices.values():
+            dev.close()
+        self.sel.close()
+        self.listener.close()
+        os.unlink(self.args.socket)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--device', action='append', required=True,
+                        help='Controller as name=port, or just the port (repeatable).')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--socket', default='/tmp/fleetd.sock', help='Path of the control socket.')
+    parser.add_argument('--out-dir', default='runs', help='Directory for per-run CSV files, one subdirectory per device.')
+    parser.add_argument('--archive', help='Store finished runs in per-device run archives below this directory.')
+    parser.add_argument('--fsync-samples', type=int, default=20, help='Samples per fsync batch.')
+    parser.add_argument('--fsync-interval', type=float, default=2.0, help='Maximum time between fsyncs (s).')
+    parser.add_argument('--reconnect', type=float, default=2.0, help='Delay before reopening a lost port (s).')
+    parser.add_argument('--no-init', action='store_true', help='Do not change log levels on the controllers.')
+    args = parser.parse_args()
+
+    fleet = Fleet(args)
+    signal.signal(signal.SIGTERM, lambda signum, frame: sys.exit(0))
+    try:
+        fleet.run()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        fleet.close()
+
+
+if __name__ == '__main__':
+    main()
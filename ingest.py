@@ -0,0 +1,352 @@
+"""Record telemetry from one or more reflow oven controllers.
+
+Every serial port is read without blocking. Both the text telemetry logged by the REFLOW module
+and binary sample frames (see Core/Inc/stream.h) are decoded. Each reflow run is appended to its
+own CSV file in the plot_temp.py layout, flushed to disk in batches, so a crash loses at most one
+batch. The most recent samples of all devices are also published in a shared-memory ring, which
+live viewers attach to with RingReader.
+
+Usage:
+    python ingest.py --port COM3
+    python ingest.py --port /dev/ttyACM0 --port /dev/ttyACM1 --out-dir runs --ring reflow_ring
+"""
+
+import argparse
+import csv
+import json
+import math
+import os
+import re
+import selectors
+import struct
+import time
+from multiprocessing import shared_memory
+
+import serial
+
+from stream_host import SAMPLE_FMT, SAMPLE_FRAME, STATE_NAMES, SYNC, crc8
+
+# Enable REFLOW telemetry only.
+INIT_MSG = b'\n log set * OFF\n log set REFLOW INFO\n'
+
+# REFLOW telemetry line: I (<s>.<us>) REFLOW: <state> <sp> <pv> <P> <I> <D> <PWM> [<seq> <tick> [<exec us>]]
+# Older firmware logs milliseconds after the decimal point.
+TELEMETRY_RE = re.compile(r'I \((\d+\.\d+)\) REFLOW: ([A-Z]+)((?: -?[\d.]+| nan| inf){6})(?: (\d+) (\d+)(?: (\d+))?)?')
+
+# Structured log line ("log format kv"): t=<s>.<us> lvl=<letter> tag=<tag> <key>=<value> ...
+KV_RE = re.compile(r't=(\d+\.\d+) lvl=(\w) tag=(\S+) (.*)')
+
+# Record ("log format kv", structured info message): <key>=<value> ... without time, level and tag.
+KV_RECORD_RE = re.compile(r'(?:^|\r)(\w+=\S*(?: \w+=\S*)*)\s*$')
+
+# Lines ending a run.
+RUN_END_MSGS = ('Reflow process completed!', 'Reflow process stopped')
+
+CSV_HEADER = ['State', 'Time (s)', 'P', 'I', 'D', 'PWM/4095', 'Set point (°C)', 'Measured (°C)', 'Seq', 'Tick (ms)',
+              'Exec (us)']
+
+SAMPLE_FRAME_SIZE = len(SYNC) + SAMPLE_FMT.size + 1
+
+# Shared-memory ring layout: header followed by fixed-size slots.
+RING_HEADER = struct.Struct('<QII')          # write count, slot count, slot size
+RING_SLOT = struct.Struct('<HBxIdffffff')    # device, state, device time (ms), host time, sp, pv, P, I, D, PWM
+
+
+class TelemetryDecoder:
+    """Split a byte stream into text lines and binary sample frames."""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data):
+        """Add received bytes and yield ('line', str) or ('sample', dict) items."""
+        self.buf += data
+        while self.buf:
+            sync = self.buf.find(SYNC)
+            newline = self.buf.find(b'\n')
+            if sync >= 0 and (newline < 0 or sync < newline):
+                if len(self.buf) - sync < SAMPLE_FRAME_SIZE:
+                    return  # Wait for rest of frame.
+                payload = bytes(self.buf[sync + 2:sync + 2 + SAMPLE_FMT.size])
+                if payload[0] == SAMPLE_FRAME and crc8(payload) == self.buf[sync + SAMPLE_FRAME_SIZE - 1]:
+                    if sync > 0:
+                        yield 'line', self.buf[:sync].decode('utf-8', 'replace')
+                    _, _, state, seq, tick, sp, pv, out = SAMPLE_FMT.unpack(payload)
+                    yield 'sample', {'state': STATE_NAMES[state] if state < len(STATE_NAMES) else str(state),
+                                     'seq': seq, 'ms': tick, 'setpoint': sp, 'temperature': pv,
+                                     'p': math.nan, 'i': math.nan, 'd': math.nan, 'output': out, 'exec_us': None}
+                    del self.buf[:sync + SAMPLE_FRAME_SIZE]
+                    continue
+                # Sync bytes inside text, treat as text.
+                if newline < 0:
+                    del self.buf[:sync + 1]
+                    continue
+            if newline < 0:
+                if len(self.buf) > 4096:
+                    del self.buf[:-SAMPLE_FRAME_SIZE]  # Runaway garbage.
+                return
+            line = self.buf[:newline].decode('utf-8', 'replace')
+            del self.buf[:newline + 1]
+            yield 'line', line
+
+
+def parse_log_fields(line):
+    """Return fields of a structured (kv or json) log line, None for text lines.
+
+    Log time, level and tag are returned as 't' (s), 'lvl' and 'tag'. Records (structured info
+    messages) have none of them.
+    """
+    start = line.find('{"')
+    if start >= 0:
+        try:
+            fields = json.loads(line[start:])
+        except ValueError:
+            return None
+        return fields if isinstance(fields, dict) else None
+    match = KV_RE.search(line)
+    if match is None:
+        match = KV_RECORD_RE.search(line)
+        if match is None:
+            return None
+        return dict(f.split('=', 1) for f in match.group(1).split())
+    fields = {'t': float(match.group(1)), 'lvl': match.group(2), 'tag': match.group(3)}
+    if match.group(4).startswith('msg="'):
+        fields['msg'] = match.group(4)[5:].rstrip('"')
+    else:
+        fields.update(f.split('=', 1) for f in match.group(4).split() if '=' in f)
+    return fields
+
+
+def parse_telemetry(line):
+    """Return sample dict for a REFLOW telemetry line in any log format, None otherwise."""
+    fields = parse_log_fields(line)
+    if fields is not None:
+        if fields.get('tag', 'REFLOW') != 'REFLOW' or 's' not in fields or 'sp' not in fields:
+            return None
+        try:
+            return {'state': fields['s'], 'seq': int(fields['n']), 'ms': int(fields['k']),
+                    'setpoint': float(fields['sp']), 'temperature': float(fields['pv']), 'p': float(fields['p']),
+                    'i': float(fields['i']), 'd': float(fields['d']), 'output': float(fields['o']),
+                    'exec_us': int(fields['x']) if 'x' in fields else None}
+        except (KeyError, ValueError):
+            return None
+
+    match = TELEMETRY_RE.search(line)
+    if match is None:
+        return None
+    sp, pv, p, i, d, out = (float(v) for v in match.group(3).split())
+    if match.group(4) is not None:
+        # Sequence number and tick of the control sample.
+        seq, ms = int(match.group(4)), int(match.group(5))
+    else:
+        # Older firmware: fall back to the log timestamp.
+        seq, ms = None, int(round(float(match.group(1)) * 1000))
+    exec_us = int(match.group(6)) if match.group(6) is not None else None
+    return {'state': match.group(2), 'seq': seq, 'ms': ms, 'setpoint': sp, 'temperature': pv, 'p': p, 'i': i, 'd': d,
+            'output': out, 'exec_us': exec_us}
+
+
+class RunWriter:
+    """Append samples of one device to per-run CSV files with batched fsync."""
+
+    def __init__(self, out_dir, device, fsync_samples, fsync_interval, on_close=None):
+        self.out_dir = out_dir
+        self.on_close = on_close
+        self.path = None
+        self.device = device
+        self.fsync_samples = fsync_samples
+        self.fsync_interval = fsync_interval
+        self.file = None
+        self.writer = None
+        self.start_ms = 0
+        self.last_seq = None
+        self.lost = 0
+        self.pending = 0
+        self.last_sync = time.monotonic()
+
+    def add(self, sample):
+        """Append sample, opening a new run when the controller leaves RESET."""
+        seq = sample['seq']
+        if seq is not None and self.last_seq is not None and seq != (self.last_seq + 1) & 0xFFFFFFFF:
+            missed = (seq - self.last_seq - 1) & 0xFFFFFFFF
+            if missed >= 0x80000000:
+                # Sequence went backwards: the device rebooted or repeated a sample, nothing was lost.
+                print('{}: sequence restarted at sample {}'.format(self.device, seq))
+            else:
+                self.lost += missed
+                print('{}: lost {} samples before sample {}'.format(self.device, missed, seq))
+        self.last_seq = seq
+
+        if sample['state'] == 'RESET':
+            self.close()
+            return
+        if self.file is None:
+            self.open(sample)
+        self.writer.writerow([sample['state'], ((sample['ms'] - self.start_ms) & 0xFFFFFFFF) / 1000, sample['p'],
+                              sample['i'], sample['d'], sample['output'], sample['setpoint'], sample['temperature'],
+                              sample['seq'], sample['ms'], '' if sample.get('exec_us') is None else sample['exec_us']])
+        self.pending += 1
+        if self.pending >= self.fsync_samples or time.monotonic() - self.last_sync >= self.fsync_interval:
+            self.sync()
+
+    def open(self, sample):
+        name = '{}_{}.csv'.format(re.sub(r'\W', '_', self.device), time.strftime('%Y%m%d-%H%M%S'))
+        path = os.path.join(self.out_dir, name)
+        self.path = path
+        self.file = open(path, 'w', newline='', encoding='utf-8')
+        self.writer = csv.writer(self.file)
+        self.writer.writerow(CSV_HEADER)
+        self.start_ms = sample['ms']
+        print('{}: recording run to {}'.format(self.device, path))
+
+    def sync(self):
+        """Flush pending samples to disk."""
+        if self.file is not None and self.pending:
+            self.file.flush()
+            os.fsync(self.file.fileno())
+        self.pending = 0
+        self.last_sync = time.monotonic()
+
+    def close(self):
+        if self.file is not None:
+            self.sync()
+            self.file.close()
+            print('{}: run finished, {} samples lost'.format(self.device, self.lost))
+            self.lost = 0
+            if self.on_close:
+                self.on_close(self.device, self.path)
+        self.file = None
+        self.writer = None
+
+
+class Ring:
+    """Shared-memory ring of the most recent samples, written by a single ingest process."""
+
+    def __init__(self, name, slots):
+        self.slots = slots
+        self.shm = shared_memory.SharedMemory(name=name, create=True, size=RING_HEADER.size + slots * RING_SLOT.size)
+        self.count = 0
+        RING_HEADER.pack_into(self.shm.buf, 0, 0, slots, RING_SLOT.size)
+
+    def append(self, device, sample):
+        state = STATE_NAMES.index(sample['state']) if sample['state'] in STATE_NAMES else 0xFF
+        offset = RING_HEADER.size + (self.count % self.slots) * RING_SLOT.size
+        RING_SLOT.pack_into(self.shm.buf, offset, device, state, sample['ms'] & 0xFFFFFFFF, time.time(),
+                            sample['setpoint'], sample['temperature'], sample['p'], sample['i'], sample['d'],
+                            sample['output'])
+        # Publish slot after it is written.
+        self.count += 1
+        RING_HEADER.pack_into(self.shm.buf, 0, self.count, self.slots, RING_SLOT.size)
+
+    def close(self):
+        self.shm.close()
+        self.shm.unlink()
+
+
+class RingReader:
+    """Read samples published by ingest.py from another process."""
+
+    def __init__(self, name):
+        self.shm = shared_memory.SharedMemory(name=name)
+        _, self.slots, _ = RING_HEADER.unpack_from(self.shm.buf, 0)
+        self.next = 0
+
+    def read(self):
+        """Return list of samples published since the previous call (oldest first)."""
+        count = RING_HEADER.unpack_from(self.shm.buf, 0)[0]
+        start = max(self.next, count - self.slots)
+        samples = []
+        for n in range(start, count):
+            offset = RING_HEADER.size + (n % self.slots) * RING_SLOT.size
+            device, state, ms, host_time, sp, pv, p, i, d, out = RING_SLOT.unpack_from(self.shm.buf, offset)
+            samples.append({'device': device, 'state': STATE_NAMES[state] if state < len(STATE_NAMES) else None,
+                            'ms': ms, 'host_time': host_time, 'setpoint': sp, 'temperature': pv,
+                            'p': p, 'i': i, 'd': d, 'output': out})
+        # Slots overwritten while reading are dropped.
+        overrun = RING_HEADER.unpack_from(self.shm.buf, 0)[0] - self.slots
+        samples = samples[max(0, overrun - start):]
+        self.next = count
+        return samples
+
+    def close(self):
+        self.shm.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--port', action='append', required=True, help='Controller serial port (repeatable).')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--out-dir', default='runs', help='Directory for per-run CSV files.')
+    parser.add_argument('--fsync-samples', type=int, default=20, help='Samples per fsync batch.')
+    parser.add_argument('--fsync-interval', type=float, default=2.0, help='Maximum time between fsyncs (s).')
+    parser.add_argument('--archive', help='Also store finished runs in this run archive (see archive.py).')
+    parser.add_argument('--oven', action='append', help='Oven name per --port, stored in the archive.')
+    parser.add_argument('--ring', help='Name of shared-memory ring for live viewers.')
+    parser.add_argument('--ring-slots', type=int, default=4096)
+    parser.add_argument('--no-init', action='store_true', help='Do not change log levels on the controllers.')
+    parser.add_argument('--log-format', choices=('text', 'kv', 'json'),
+                        help='Switch the controllers to this log format.')
+    args = parser.parse_args()
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    ring = Ring(args.ring, args.ring_slots) if args.ring else None
+
+    on_close = None
+    if args.archive:
+        from archive import Archive
+        archive = Archive(args.archive)
+        ovens = dict(zip(args.port, args.oven or []))
+
+        def on_close(device, path):
+            archive.import_csv(path, {'oven': ovens.get(device, device)})
+
+    devices = []
+    for index, port in enumerate(args.port):
+        ser = serial.Serial(port=port, baudrate=args.baud, timeout=0)
+        if not args.no_init:
+            ser.write(INIT_MSG)
+        if args.log_format:
+            ser.write(' log format {}\n'.format(args.log_format).encode())
+        devices.append({'index': index, 'serial': ser, 'decoder': TelemetryDecoder(),
+                        'writer': RunWriter(args.out_dir, port, args.fsync_samples, args.fsync_interval, on_close)})
+        print('Connected to', ser.name)
+
+    # Serial ports are only selectable on POSIX; poll elsewhere.
+    sel = selectors.DefaultSelector() if os.name == 'posix' else None
+    if sel:
+        for dev in devices:
+            sel.register(dev['serial'].fileno(), selectors.EVENT_READ, dev)
+
+    try:
+        while True:
+            if sel:
+                ready = [key.data for key, _ in sel.select(timeout=0.5)]
+            else:
+                time.sleep(0.01)
+                ready = devices
+            for dev in ready:
+                data = dev['serial'].read(dev['serial'].in_waiting or 1)
+                for kind, item in dev['decoder'].feed(data):
+                    sample = item if kind == 'sample' else parse_telemetry(item)
+                    if sample is not None:
+                        dev['writer'].add(sample)
+                        if ring:
+                            ring.append(dev['index'], sample)
+                    elif any(msg in item for msg in RUN_END_MSGS):
+                        dev['writer'].close()
+            # Bound data loss on idle devices too.
+            for dev in devices:
+                if time.monotonic() - dev['writer'].last_sync >= args.fsync_interval:
+                    dev['writer'].sync()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for dev in devices:
+            dev['writer'].close()
+            dev['serial'].close()
+        if ring:
+            ring.close()
+
+
+if __name__ == '__main__':
+    main()
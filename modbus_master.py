@@ -0,0 +1,218 @@
+"""Modbus RTU master for the reflow oven controller's Modbus slave (UART4).
+
+Reads the telemetry input registers and the parameter holding registers, writes parameters and
+starts or stops runs the way a PLC or SCADA system would. The register map is documented in
+Core/Inc/reflow.h. Without a board, run it against the pty of Test/host/host_sim --modbus.
+
+Usage:
+    python modbus_master.py --port /dev/ttyUSB0 status
+    python modbus_master.py --port /dev/ttyUSB0 poll --interval 1
+    python modbus_master.py --port /dev/ttyUSB0 set Kp 225 Ki 0.5
+    python modbus_master.py --port /dev/ttyUSB0 profile 1
+    python modbus_master.py --port /dev/ttyUSB0 start
+    python modbus_master.py --port /dev/ttyUSB0 read-input 0 11
+    python modbus_master.py --port /dev/ttyUSB0 write 2 22500 50
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import serial
+
+from stream_host import STATE_NAMES
+
+# Function codes.
+READ_HOLDING_REGS = 0x03
+READ_INPUT_REGS = 0x04
+WRITE_SINGLE_REG = 0x06
+WRITE_MULTIPLE_REGS = 0x10
+
+EXCEPTIONS = {1: 'illegal function', 2: 'illegal data address', 3: 'illegal data value', 4: 'device failure',
+              6: 'device busy'}
+
+# Register map (Core/Inc/reflow.h).
+INPUT_REGS = ['state', 'setpoint', 'temperature', 'output', 'alarms', 'tc_error', 'profile', 'sample_seq_h',
+              'sample_seq_l', 'tick_h', 'tick_l', 'tc_confidence']
+HOLDING_REGS = ['command', 'profile', 'Kp', 'Ki', 'Kd', 'Tau', 'B', 'C', 'Tt']
+HOLDING_SCALE = {'Kp': 100, 'Ki': 100, 'Kd': 100, 'Tau': 100, 'B': 100, 'C': 100, 'Tt': 100}
+CMD_START, CMD_STOP = 1, 2
+ALARM_NAMES = {0x1: 'TC_FAULT', 0x2: 'ABORTED', 0x4: 'TC_VOTE'}
+CONFIDENCE_NAMES = ['HIGH', 'DEGRADED', 'LOW', 'NONE']
+
+
+class ModbusError(Exception):
+    pass
+
+
+def crc16(data):
+    """Modbus CRC-16 (reflected polynomial 0xA001, initial value 0xFFFF)."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def frame(pdu):
+    """Append CRC (low byte first) to address and PDU."""
+    return pdu + struct.pack('<H', crc16(pdu))
+
+
+def decode_inputs(regs):
+    """Convert input registers to engineering units."""
+    s16 = lambda v: v - 0x10000 if v & 0x8000 else v
+    return {
+        'state': STATE_NAMES[regs[0]] if regs[0] < len(STATE_NAMES) else str(regs[0]),
+        'setpoint': s16(regs[1]) / 10,
+        'temperature': s16(regs[2]) / 10,
+        'output': regs[3],
+        'alarms': '|'.join(name for bit, name in ALARM_NAMES.items() if regs[4] & bit) or '-',
+        'tc_error': regs[5],
+        'profile': regs[6],
+        'sample_seq': regs[7] << 16 | regs[8],
+        'tick': regs[9] << 16 | regs[10],
+        'tc_confidence': CONFIDENCE_NAMES[regs[11]] if regs[11] < len(CONFIDENCE_NAMES) else str(regs[11]),
+    }
+
+
+class Master:
+    """Request/response transactions with one slave."""
+
+    def __init__(self, port, baud, slave, timeout):
+        self.serial = serial.Serial(port=port, baudrate=baud, timeout=timeout)
+        self.slave = slave
+        self.timeout = timeout
+        # Inter-frame gap: 3.5 characters of 11 bits, 1.75 ms above 19200 baud.
+        self.t35 = 38.5 / baud if baud <= 19200 else 0.00175
+
+    def close(self):
+        self.serial.close()
+
+    def transact(self, pdu, length):
+        """Send a request and return the PDU of a response of the expected length."""
+        time.sleep(self.t35)
+        self.serial.reset_input_buffer()
+        self.serial.write(frame(bytes([self.slave]) + pdu))
+        if self.slave == 0:
+            return None  # Broadcasts are not answered.
+
+        resp = self.serial.read(5)  # Shortest response: exception.
+        if len(resp) < 5:
+            raise ModbusError('timeout')
+        if resp[1] == pdu[0] | 0x80:
+            if crc16(resp[:3]) != struct.unpack('<H', resp[3:5])[0]:
+                raise ModbusError('CRC error')
+            raise ModbusError('exception {}: {}'.format(resp[2], EXCEPTIONS.get(resp[2], 'unknown')))
+        resp += self.serial.read(length + 3 - len(resp))
+        if len(resp) != length + 3:
+            raise ModbusError('short response ({} bytes)'.format(len(resp)))
+        if crc16(resp[:-2]) != struct.unpack('<H', resp[-2:])[0]:
+            raise ModbusError('CRC error')
+        if resp[0] != self.slave or resp[1] != pdu[0]:
+            raise ModbusError('unexpected response {}'.format(resp.hex()))
+        return resp[1:-2]
+
+    def read(self, fc, addr, count):
+        pdu = self.transact(struct.pack('>BHH', fc, addr, count), 2 + count * 2)
+        return list(struct.unpack('>{}H'.format(count), pdu[2:]))
+
+    def read_input(self, addr, count):
+        return self.read(READ_INPUT_REGS, addr, count)
+
+    def read_holding(self, addr, count):
+        return self.read(READ_HOLDING_REGS, addr, count)
+
+    def write(self, addr, values):
+        if len(values) == 1:
+            self.transact(struct.pack('>BHH', WRITE_SINGLE_REG, addr, values[0]), 5)
+        else:
+            pdu = struct.pack('>BHHB{}H'.format(len(values)), WRITE_MULTIPLE_REGS, addr, len(values),
+                              len(values) * 2, *values)
+            self.transact(pdu, 5)
+
+    def status(self):
+        return decode_inputs(self.read_input(0, len(INPUT_REGS)))
+
+    def params(self):
+        regs = self.read_holding(0, len(HOLDING_REGS))
+        return {name: regs[i] / HOLDING_SCALE.get(name, 1) for i, name in enumerate(HOLDING_REGS) if i > 0}
+
+
+def print_status(status):
+    print('{state:<8} sp {setpoint:6.1f}  pv {temperature:6.1f}  out {output:4d}  alarms {alarms}  '
+          'tc_err {tc_error}  conf {tc_confidence}  profile {profile}  seq {sample_seq}  tick {tick}'.format(**status))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--port', required=True, help='Serial port of the RS-485 adapter or simulated oven.')
+    parser.add_argument('--baud', type=int, default=19200)
+    parser.add_argument('--slave', type=int, default=1, help='Slave address (0 broadcasts writes).')
+    parser.add_argument('--timeout', type=float, default=0.5, help='Response timeout (s).')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    sub.add_parser('status', help='Read telemetry and parameters.')
+    p = sub.add_parser('poll', help='Read telemetry periodically.')
+    p.add_argument('--interval', type=float, default=1.0)
+    p.add_argument('--count', type=int, help='Number of polls (default: until interrupted).')
+    sub.add_parser('start', help='Start reflow process.')
+    sub.add_parser('stop', help='Stop reflow process.')
+    p = sub.add_parser('profile', help='Select reflow profile by index.')
+    p.add_argument('index', type=int)
+    p = sub.add_parser('set', help='Set PID parameters, e.g. "set Kp 225 Ki 0.5".')
+    p.add_argument('pairs', nargs='+')
+    for name in ('read-input', 'read-holding'):
+        p = sub.add_parser(name, help='Read raw registers.')
+        p.add_argument('addr', type=int)
+        p.add_argument('count', type=int)
+    p = sub.add_parser('write', help='Write raw holding registers.')
+    p.add_argument('addr', type=int)
+    p.add_argument('values', type=int, nargs='+')
+    args = parser.parse_args()
+
+    master = Master(args.port, args.baud, args.slave, args.timeout)
+    try:
+        if args.cmd == 'status':
+            print_status(master.status())
+            print('  '.join('{} {:g}'.format(k, v) for k, v in master.params().items()))
+        elif args.cmd == 'poll':
+            n = 0
+            while args.count is None or n < args.count:
+                try:
+                    print_status(master.status())
+                except ModbusError as e:
+                    print('error: {}'.format(e))
+                n += 1
+                time.sleep(args.interval)
+        elif args.cmd in ('start', 'stop'):
+            master.write(HOLDING_REGS.index('command'), [CMD_START if args.cmd == 'start' else CMD_STOP])
+        elif args.cmd == 'profile':
+            master.write(HOLDING_REGS.index('profile'), [args.index])
+        elif args.cmd == 'set':
+            if len(args.pairs) % 2:
+                parser.error('set takes <param> <value> pairs')
+            names = {name.lower(): name for name in HOLDING_SCALE}
+            for param, value in zip(args.pairs[::2], args.pairs[1::2]):
+                name = names.get(param.lower())
+                if name is None:
+                    parser.error('unknown parameter {}'.format(param))
+                master.write(HOLDING_REGS.index(name), [int(round(float(value) * HOLDING_SCALE[name]))])
+        elif args.cmd == 'read-input':
+            print(' '.join(str(v) for v in master.read_input(args.addr, args.count)))
+        elif args.cmd == 'read-holding':
+            print(' '.join(str(v) for v in master.read_holding(args.addr, args.count)))
+        elif args.cmd == 'write':
+            master.write(args.addr, args.values)
+    except ModbusError as e:
+        print('error: {}'.format(e))
+        sys.exit(1)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        master.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -1,10 +1,20 @@
+import argparse
+import bisect
 import os
 import serial
 import matplotlib.pyplot as plt
 from matplotlib.animation import FuncAnimation
 import matplotlib.ticker as ticker
 import csv
-import time
+from ingest import RingReader, parse_telemetry
+
+# Command-line options. By default the plotter owns the serial port and starts the reflow process;
+# with --ring it only views samples published by ingest.py, which keeps recording the runs.
+parser = argparse.ArgumentParser(description='Plot reflow oven controller telemetry in real time.')
+parser.add_argument('--port', default='COM3', help='Serial port of the controller.')
+parser.add_argument('--ring', help='Read samples from the shared-memory ring of ingest.py instead of a serial port.')
+parser.add_argument('--device', type=int, default=0, help='Index of the --port of ingest.py to view (ring mode).')
+args = parser.parse_args()
 
 # Sampling time in ms.
 Tsample = 500
@@ -14,7 +24,7 @@ start_msg = b'log set * OFF\n log set REFLOW INFO\n reflow stop\n reflow start\n
 stop_msg = b'reflow stop\n'
 
 # Expected response message from microcontroller.
-start_response = '\x1b[0m\x1b[KStarting reflow process\r\n'
+start_response = 'Starting reflow process\r\n'
 
 # Path for CSV file.
 csv_path = "./csv/temp_ctrl.csv"
@@ -22,21 +32,82 @@ csv_path = "./csv/temp_ctrl.csv"
 # Path for temperature plot.
 plot_path = "./imgs/temp_ctrl.png"
 
-# Open serial port.
-ser = serial.Serial(port='COM3', baudrate=115200)
+# Gap in device time (ms) after which ring samples belong to a new run.
+RUN_GAP_MS = 5000
+
+# Decimation factor between pyramid levels, and number of levels (largest bucket is 4**8 samples).
+DECIMATION = 4
+DECIMATION_LEVELS = 8
+
+
+class DecimatedSeries:
+    """Samples of one quantity with a min/max pyramid, so a window is drawn with a bounded number of points.
+
+    Bucket b of level L covers samples [b * 4**L, (b + 1) * 4**L) and holds their minimum and maximum.
+    Appending updates one bucket per level; drawing picks the coarsest level that still gives about one
+    bucket per pixel, so the redraw cost does not grow with the length of the run.
+    """
+
+    def __init__(self, times):
+        self.times = times  # Shared, ascending time list (appended by the caller first).
+        self.values = []
+        self.mins = [[] for _ in range(DECIMATION_LEVELS)]
+        self.maxs = [[] for _ in range(DECIMATION_LEVELS)]
+
+    def append(self, value):
+        n = len(self.values)
+        self.values.append(value)
+        for level in range(DECIMATION_LEVELS):
+            b = n // DECIMATION ** (level + 1)
+            if b == len(self.mins[level]):
+                self.mins[level].append(value)
+                self.maxs[level].append(value)
+            else:
+                self.mins[level][b] = min(self.mins[level][b], value)
+                self.maxs[level][b] = max(self.maxs[level][b], value)
+
+    def view(self, t0, t1, max_points):
+        """Return x and y lists of the samples between t0 and t1, decimated to about max_points."""
+        i0 = max(0, bisect.bisect_left(self.times, t0) - 1)
+        i1 = min(len(self.values), bisect.bisect_right(self.times, t1) + 1)
+        if i1 - i0 <= max_points:
+            return self.times[i0:i1], self.values[i0:i1]
+        level = 0
+        while level < DECIMATION_LEVELS - 1 and (i1 - i0) / DECIMATION ** (level + 1) > max_points / 2:
+            level += 1
+        size = DECIMATION ** (level + 1)
+        xs, ys = [], []
+        for b in range(i0 // size, (i1 - 1) // size + 1):
+            # Draw each bucket as a vertical segment from its minimum to its maximum.
+            x = self.times[b * size]
+            xs += [x, x]
+            ys += [self.mins[level][b], self.maxs[level][b]]
+        return xs, ys
+
 
 # Data storage.
 state_lst = []         # State   
-sp_lst = []            # Setpoint temperature.
-pv_lst = []            # Measured temperature.
-proportional_lst = []  # Proportional term.
-integral_lst = []      # Integral term.
-derivative_lst = []    # Derivative term.
-pwm_lst = []           # PWM duty cycle.
-time_lst = []          # Time samples.
+time_lst = []          # Time samples (device time).
+seq_lst = []           # Sample sequence numbers.
+tick_lst = []          # Device ticks (ms).
+sp_lst = DecimatedSeries(time_lst)            # Setpoint temperature.
+pv_lst = DecimatedSeries(time_lst)            # Measured temperature.
+proportional_lst = DecimatedSeries(time_lst)  # Proportional term.
+integral_lst = DecimatedSeries(time_lst)      # Integral term.
+derivative_lst = DecimatedSeries(time_lst)    # Derivative term.
+pwm_lst = DecimatedSeries(time_lst)           # PWM duty cycle.
 
-# Check which port is being used.
-print("Connected to", ser.name)
+if args.ring:
+    # Attach to ingest.py's shared-memory ring.
+    ring = RingReader(args.ring)
+    ser = None
+    print("Viewing device", args.device, "of ring", args.ring)
+else:
+    # Open serial port.
+    ser = serial.Serial(port=args.port, baudrate=115200)
+
+    # Check which port is being used.
+    print("Connected to", ser.name)
 
 # Define Figure and Axes.
 fig, (ax1, ax2) = plt.subplots(nrows=1, ncols=2, figsize=(12, 6))
@@ -91,7 +162,8 @@ def init():
     plt.subplots_adjust(bottom=0.15)
     
     # Flush input serial buffer.
-    ser.reset_input_buffer()
+    if ser:
+        ser.reset_input_buffer()
 
     # Return iterable of objects to be re-drawn for blitting algorithm.
     return sp_line, pv_line, proportional_line, integral_line, derivative_line, pwm_line
@@ -100,22 +172,64 @@ def init():
 ax1.grid()
 ax2.grid()
 
-# Get a time reference (s) for animation.
-timeref = time.time()
+# Number of samples lost in transit.
+lost_samples = 0
 
-# Function called each frame.
-def update(frame):
+# Time of the latest sample drawn (s).
+last_time = 0
+
+# Store one sample.
+def store(state, sp, pv, proportional, integral, derivative, pwm, seq, tick):
+    global lost_samples
+
+    # Detect samples lost between the controller and the plot.
+    if seq is not None and seq_lst and seq_lst[-1] is not None and seq != seq_lst[-1] + 1:
+        lost_samples += seq - seq_lst[-1] - 1
+        print('Lost {} samples before sample {}.'.format(seq - seq_lst[-1] - 1, seq))
+
+    # Store data with appropriate conversions.
+    state_lst.append(state)
+    seq_lst.append(seq)
+    tick_lst.append(tick)
+    # Time axis from device ticks, unaffected by serial and USB buffering.
+    time_lst.append(((tick - tick_lst[0]) & 0xFFFFFFFF) / 1000)
+    sp_lst.append(float(sp))
+    pv_lst.append(float(pv))
+    proportional_lst.append(float(proportional))
+    integral_lst.append(float(integral))
+    derivative_lst.append(float(derivative))
+    pwm_lst.append(float(pwm)) 
+
+# Clear stored samples when the viewed controller starts another run.
+def clear():
+    global sp_lst, pv_lst, proportional_lst, integral_lst, derivative_lst, pwm_lst
+    for lst in (state_lst, time_lst, seq_lst, tick_lst):
+        lst.clear()
+    sp_lst, pv_lst, proportional_lst, integral_lst, derivative_lst, pwm_lst = (DecimatedSeries(time_lst) for _ in range(6))
+
+# Read all samples published to the ring since the previous frame.
+def read_ring():
+    for sample in ring.read():
+        if sample['device'] != args.device:
+            continue
+        if sample['state'] in (None, 'RESET'):
+            continue
+        # A run ended if the controller left cool-down or stopped sampling for a while.
+        if state_lst and ((state_lst[-1] == 'COOLDOWN' and sample['state'] != 'COOLDOWN') or
+                          (sample['ms'] - tick_lst[-1]) & 0xFFFFFFFF > RUN_GAP_MS):
+            clear()
+        store(sample['state'], sample['setpoint'], sample['temperature'], sample['p'], sample['i'],
+              sample['d'], sample['output'], None, sample['ms'])
+
+# Read one sample from the serial port.
+def read_serial():
     # Read and parse line from serial buffer.
     num_attempts = 0
     while True:
         line = ser.readline().decode('UTF-8')
-        words = line.split()
-        try:
-            state = words[3]
-            # NOTE: Numbers still in string format.
-            sp, pv, proportional, integral, derivative, pwm = words[4:] 
-            # print(state, sp, pv, proportional, integral, derivative, pwm)
-        except:
+        # Text, kv and json log formats are all understood.
+        sample = parse_telemetry(line)
+        if sample is None:
             print('Failed to parse values, trying again...')
             num_attempts = num_attempts + 1
             if num_attempts == 3:
@@ -124,55 +238,71 @@ def update(frame):
                 ani.pause()
             continue
         break
+    store(sample['state'], sample['setpoint'], sample['temperature'], sample['p'], sample['i'], sample['d'],
+          sample['output'], sample['seq'], sample['ms'])
 
-    # Store data with appropriate conversions.
-    state_lst.append(state)
-    sp_lst.append(float(sp))
-    pv_lst.append(float(pv))
-    proportional_lst.append(float(proportional))
-    integral_lst.append(float(integral))
-    derivative_lst.append(float(derivative))
-    pwm_lst.append(float(pwm)) 
-    time_lst.append(time.time()-timeref)
+# Function called each frame.
+def update(frame):
+    global last_time
+
+    if ser:
+        read_serial()
+    else:
+        read_ring()
+    if not time_lst:
+        return sp_line, pv_line, proportional_line, integral_line, derivative_line, pwm_line
+
+    # Extend the time axis as the run goes on, unless the user panned away from the latest sample.
+    for ax in (ax1, ax2):
+        x0, x1 = ax.get_xlim()
+        if x0 <= last_time <= x1 < time_lst[-1]:
+            ax.set_xlim(x0, time_lst[-1] * 1.25)
+    last_time = time_lst[-1]
 
-    # Update Line2D objects.
-    sp_line.set_data(time_lst, sp_lst)
-    pv_line.set_data(time_lst, pv_lst)
-    proportional_line.set_data(time_lst, proportional_lst)
-    integral_line.set_data(time_lst, integral_lst)
-    derivative_line.set_data(time_lst, derivative_lst)
-    pwm_line.set_data(time_lst, pwm_lst)
+    # Update Line2D objects with the visible window only, about one min/max pair per pixel.
+    for ax, lines in ((ax1, ((proportional_line, proportional_lst), (integral_line, integral_lst),
+                             (derivative_line, derivative_lst), (pwm_line, pwm_lst))),
+                      (ax2, ((sp_line, sp_lst), (pv_line, pv_lst)))):
+        x0, x1 = ax.get_xlim()
+        max_points = max(100, int(ax.bbox.width))
+        for line, series in lines:
+            line.set_data(*series.view(x0, x1, max_points))
 
     # Update time and state text.
-    time_txt.set_text("Time: {:.2f} s".format(time_lst[frame]))
-    state_txt.set_text("State: {}".format(state_lst[frame]))
+    time_txt.set_text("Time: {:.2f} s".format(time_lst[-1]))
+    state_txt.set_text("State: {}".format(state_lst[-1]))
 
     return sp_line, pv_line, proportional_line, integral_line, derivative_line, pwm_line
 
 # Post reflow start command and wait for response.
-ser.write(start_msg)
-num_start_attempts = 0
-while True:
-    line = ser.readline().decode('UTF-8')
-    print(line)
-    if line == start_response:
-        print('Start message received.')
-        break
-    num_start_attempts = num_start_attempts + 1
-    if num_start_attempts == 20:
-        print('Did not receive response from microcontroller.')
-        ser.write(stop_msg)
-        exit()
+if ser:
+    ser.write(start_msg)
+    num_start_attempts = 0
+    while True:
+        line = ser.readline().decode('UTF-8')
+        print(line)
+        if line.endswith(start_response):
+            print('Start message received.')
+            break
+        num_start_attempts = num_start_attempts + 1
+        if num_start_attempts == 20:
+            print('Did not receive response from microcontroller.')
+            ser.write(stop_msg)
+            exit()
 
 # Start animation.
 ani = FuncAnimation(fig, update, init_func=init, blit=False, interval=Tsample-20)
 plt.show()
 
-# Close serial connection once window is closed.
-print("Number of bytes remaining in rx buffer:", ser.in_waiting)
-print("Closing serial connection.")
-ser.write(stop_msg) # For safety measures, turn reflow controller off regardless of status.
-ser.close()
+if ser:
+    # Close serial connection once window is closed.
+    print("Number of bytes remaining in rx buffer:", ser.in_waiting)
+    print("Number of samples lost:", lost_samples)
+    print("Closing serial connection.")
+    ser.write(stop_msg) # For safety measures, turn reflow controller off regardless of status.
+    ser.close()
+else:
+    ring.close()
 
 # Save plot.
 version_num = 1
@@ -186,6 +316,11 @@ else:
     plot_path = filename + '_' + str(version_num) + ext
     fig.savefig(plot_path)
 
+# Runs viewed from the ring are recorded by ingest.py.
+if not ser:
+    print("Plot saved at", plot_path)
+    exit()
+
 # Save CSV file.
 if os.path.isfile(csv_path) == True:
     csv_path = './csv/temp_ctrl_{}.csv'.format(version_num)
@@ -193,13 +328,15 @@ if os.path.isfile(csv_path) == True:
 with open(csv_path, 'w', newline='') as f:
     writer = csv.writer(f)
     writer.writerow(["State", "Time (s)", "P", "I", "D", "PWM/4095", "Set point (°C)",
-                    "Measured (°C)", "Sample Period (s)"])
-    for s_num in range(len(pv_lst)):
+                    "Measured (°C)", "Seq", "Tick (ms)", "Sample Period (s)"])
+    for s_num in range(len(time_lst)):
         if s_num == 0:
-            writer.writerow([state_lst[s_num], time_lst[s_num], proportional_lst[s_num], integral_lst[s_num],
-                        derivative_lst[s_num], pwm_lst[s_num], sp_lst[s_num], pv_lst[s_num], Tsample/1000])
+            writer.writerow([state_lst[s_num], time_lst[s_num], proportional_lst.values[s_num], integral_lst.values[s_num],
+                        derivative_lst.values[s_num], pwm_lst.values[s_num], sp_lst.values[s_num], pv_lst.values[s_num],
+                        seq_lst[s_num], tick_lst[s_num], Tsample/1000])
         else:
-             writer.writerow([state_lst[s_num], time_lst[s_num], proportional_lst[s_num], integral_lst[s_num],
-                        derivative_lst[s_num], pwm_lst[s_num], sp_lst[s_num], pv_lst[s_num]])
+             writer.writerow([state_lst[s_num], time_lst[s_num], proportional_lst.values[s_num], integral_lst.values[s_num],
+                        derivative_lst.values[s_num], pwm_lst.values[s_num], sp_lst.values[s_num], pv_lst.values[s_num],
+                        seq_lst[s_num], tick_lst[s_num]])
 
 print("Plot and csv file saved at", plot_path, 'and', csv_path, 'respectively.')
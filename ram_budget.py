@@ -0,0 +1,150 @@
+"""Print the RAM budget of each firmware module from the linker map file.
+
+Every input section placed in RAM or RAM2 (.data, .bss, COMMON, .noinit) is charged to the
+object file it comes from. Core/Src modules are listed by name; HAL drivers, FreeRTOS and the
+C library are grouped. Statically allocated thread stacks, queues and timers live in the .bss
+of the module that owns them, so the table is the module's complete RAM footprint. The FreeRTOS
+heap (heap_4) and the main stack/newlib heap reserve are listed on their own lines.
+
+Runs after every link of the Debug build (see makefile.targets).
+
+Usage:
+    python ram_budget.py Debug/reflow_oven_controller.map
+    python ram_budget.py Debug/reflow_oven_controller.map --sort name
+"""
+
+import argparse
+import collections
+import os
+import re
+import sys
+
+# Output sections in RAM and the column they are reported in.
+SECTIONS = {'.data': 'data', '.bss': 'bss', '.noinit': 'noinit'}
+
+MEMORY_RE = re.compile(r'^(\w+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+OUTPUT_RE = re.compile(r'^(\.[\w.]+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+INPUT_RE = re.compile(r'^ (\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$')
+
+
+def module_name(obj):
+    """Map an object file path to a module name."""
+    obj = obj.replace('\\', '/')
+    if '(' in obj or obj.endswith('.a'):
+        return 'libc'
+    if 'MemMang' in obj:
+        return 'freertos heap'
+    if 'FreeRTOS' in obj:
+        return 'freertos'
+    if obj.startswith('Drivers/'):
+        return 'hal'
+    stem = os.path.splitext(os.path.basename(obj))[0]
+    if stem.startswith('stm32l4xx_') or stem.startswith('system_stm32'):
+        return 'hal'
+    if stem in ('crti', 'crtn', 'crtbegin', 'crtend', 'crt0'):
+        return 'libc'
+    return stem
+
+
+def parse_map(path):
+    """Return ({module: {column: bytes}}, reserve bytes, {region: (origin, length)}, region usage)."""
+    modules = collections.defaultdict(collections.Counter)
+    regions = {}
+    usage = collections.Counter()
+    reserve = 0
+    in_memory = False
+    section = None
+    pending = None  # Input section name on its own line.
+    pending_output = None
+
+    with open(path, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if line.startswith('Memory Configuration'):
+                in_memory = True
+                continue
+            if line.startswith('Linker script and memory map'):
+                in_memory = False
+                continue
+            if in_memory:
+                m = MEMORY_RE.match(line)
+                if m and m.group(1) != 'Name':
+                    regions[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+                continue
+
+            if re.match(r'^\.[\w.]+$', line):
+                pending_output = line  # Long section name, address and size follow on the next line.
+                continue
+            if pending_output is not None:
+                line = pending_output + line
+                pending_output = None
+            m = OUTPUT_RE.match(line)
+            if m:
+                name, addr, size = m.group(1), int(m.group(2), 16), int(m.group(3), 16)
+                section = name if name in SECTIONS else None
+                if name == '._user_heap_stack':
+                    reserve = size
+                for region, (origin, length) in regions.items():
+                    if region != '*default*' and origin <= addr < origin + length and addr and size:
+                        if name in SECTIONS or name == '._user_heap_stack':
+                            usage[region] += size
+                pending = None
+                continue
+            if line and not line.startswith(' '):
+                section = None  # Any other output section.
+                continue
+            if section is None:
+                continue
+
+            if pending is not None:
+                line = ' ' + pending + line
+                pending = None
+            m = INPUT_RE.match(line)
+            if m is None:
+                stripped = line.strip()
+                if stripped.startswith('.') and ' ' not in stripped:
+                    pending = stripped
+                continue
+            size = int(m.group(3), 16)
+            if size == 0 or int(m.group(2), 16) == 0:
+                continue  # Discarded or empty input section.
+            obj = m.group(4).strip()
+            if m.group(1) == '*fill*' or obj.startswith('0x'):
+                continue
+            modules[module_name(obj)][SECTIONS[section]] += size
+
+    return modules, reserve, regions, usage
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('map', help='Linker map file.')
+    parser.add_argument('--sort', choices=('size', 'name'), default='size')
+    args = parser.parse_args()
+
+    try:
+        modules, reserve, regions, usage = parse_map(args.map)
+    except OSError as e:
+        print('ram_budget: {}'.format(e))
+        sys.exit(1)
+
+    rows = sorted(modules.items(), key=lambda kv: kv[0] if args.sort == 'name' else -sum(kv[1].values()))
+    print('RAM budget ({})'.format(os.path.basename(args.map)))
+    print('{:<16} {:>8} {:>8} {:>8} {:>8}'.format('Module', '.data', '.bss', '.noinit', 'Total'))
+    total = collections.Counter()
+    for name, cols in rows:
+        print('{:<16} {:>8} {:>8} {:>8} {:>8}'.format(name, cols['data'], cols['bss'], cols['noinit'],
+                                                       sum(cols.values())))
+        total.update(cols)
+    print('{:<16} {:>8} {:>8} {:>8} {:>8}'.format('stack/heap', '', reserve, '', reserve))
+    print('{:<16} {:>8} {:>8} {:>8} {:>8}'.format('Total', total['data'], total['bss'] + reserve, total['noinit'],
+                                                   sum(total.values()) + reserve))
+    for region in ('RAM', 'RAM2'):
+        if region in regions:
+            length = regions[region][1]
+            print('{}: {} of {} bytes used ({:.1f} %)'.format(region, usage[region], length,
+                                                              100.0 * usage[region] / length))
+
+
+if __name__ == '__main__':
+    main()
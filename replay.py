@@ -0,0 +1,267 @@
+"""Replay recorded reflow runs through the controller firmware and compare the results.
+
+Each recorded temperature is sent to the controller in a replay frame (see Core/Inc/stream.h).
+The controller treats it as the thermocouple reading, runs one iteration of the reflow state
+machine and PID controller with the relay off, and answers with its control sample. Frames are
+sent in lockstep with the answers, so a run replays at serial speed rather than in real time.
+
+The replayed setpoints, outputs and state transitions are compared against the recording.
+Runs are distributed over every controller given with --port, one worker process per board.
+Without --port, each of --jobs workers (default: one per CPU core) replays on its own instance
+of the host build (Test/host/host_sim on a pty), so a firmware build is checked against
+thousands of archived runs before it reaches an oven.
+
+Usage:
+    python replay.py --port COM3 csv/temp_ctrl.csv csv/temp_ctrl_1.csv
+    python replay.py --port /dev/ttyACM0 --port /dev/ttyACM1 --report report.csv runs/*.csv
+    python replay.py --archive runs.arc --report report.csv
+
+Accepted recordings are CSV files written by plot_temp.py or stream_host.py and run files of
+archive.py; --archive replays every run of an archive. The profile and gains stored with an
+archived run are used unless given on the command line.
+"""
+
+import argparse
+import csv
+import multiprocessing
+import os
+import subprocess
+import sys
+import time
+
+import serial
+
+from archive import STATE_NAMES, Archive, Run
+from stream_host import SampleDecoder, pack_replay
+
+HOST_SIM = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'Test', 'host', 'host_sim')
+
+
+def load_archived_run(path):
+    """Load an archive.py run file, see load_run()."""
+    rec = Run(path)
+    states = [STATE_NAMES[s] if s < len(STATE_NAMES) else str(s) for s in rec['state'].tolist()]
+    run = [{'state': state, 'setpoint': setpoint, 'temperature': temperature, 'output': output}
+           for state, setpoint, temperature, output in zip(states, rec['setpoint'].tolist(),
+                                                           rec['temperature'].tolist(), rec['pwm'].tolist())]
+    return run, rec.meta
+
+
+def load_run(path):
+    """Load recorded samples as a list of dicts with state, setpoint, temperature and output.
+
+    Returns the samples and the run's metadata (empty for CSV files).
+    """
+    if path.endswith('.rfr'):
+        return load_archived_run(path)
+    with open(path, newline='', encoding='utf-8') as f:
+        reader = csv.reader(f)
+        header = next(reader)
+        if header[0] == 'State':
+            # plot_temp.py: State, Time, P, I, D, PWM, Set point, Measured
+            cols = {'state': 0, 'output': 5, 'setpoint': 6, 'temperature': 7}
+        elif header[0] == 'seq':
+            # stream_host.py: seq, state, tick, setpoint, temperature, output
+            cols = {'state': 1, 'setpoint': 3, 'temperature': 4, 'output': 5}
+        else:
+            raise ValueError('{}: unknown recording format'.format(path))
+
+        run = []
+        for row in reader:
+            if not row:
+                continue
+            run.append({'state': row[cols['state']],
+                        'setpoint': float(row[cols['setpoint']]),
+                        'temperature': float(row[cols['temperature']]),
+                        'output': float(row[cols['output']])})
+    return run, {}
+
+
+def replay_run(ser, run, timeout):
+    """Replay recorded temperatures in lockstep and return the controller's samples."""
+    decoder = SampleDecoder()
+    samples = []
+    for seq, rec in enumerate(run):
+        ser.write(pack_replay(seq, rec['temperature']))
+        deadline = time.monotonic() + timeout
+        answer = None
+        while answer is None and time.monotonic() < deadline:
+            for sample in decoder.feed(ser.read(ser.in_waiting or 1)):
+                if sample['seq'] == seq & 0xFFFF:
+                    answer = sample
+        if answer is None:
+            raise TimeoutError('no answer to replay frame {}'.format(seq))
+        samples.append(answer)
+        # Run finished or stopped on the controller; remaining frames would only be answered.
+        if answer['state'] == 'RESET' and seq > 0 and samples[-2]['state'] != 'RESET':
+            break
+
+    ser.write(pack_replay(len(run), 0.0, stop=True))
+    return samples
+
+
+def transitions(states):
+    """Return list of (state, index) pairs for every state change."""
+    changes = []
+    for i, state in enumerate(states):
+        if not changes or changes[-1][0] != state:
+            changes.append((state, i))
+    return changes
+
+
+def compare(run, samples, tol_output, tol_samples):
+    """Compare replayed samples with the recording and return a result dict."""
+    # The recording starts with the first control iteration, the replay may begin with RESET answers.
+    start = next((i for i, s in enumerate(samples) if s['state'] != 'RESET'), len(samples))
+    replayed = samples[start:]
+    n = min(len(run), len(replayed))
+
+    rec_tr = transitions([r['state'] for r in run])
+    rep_tr = transitions([s['state'] for s in replayed if s['state'] != 'RESET'])
+
+    # Setpoints jump at transitions, so outputs are only compared outside the allowed transition shift.
+    near = {i + d for _, i in rec_tr[1:] + rep_tr[1:] for d in range(-tol_samples, tol_samples + 1)}
+    steady = [i for i in range(n) if i not in near]
+    max_output = max((abs(run[i]['output'] - replayed[i]['output']) for i in steady), default=0.0)
+    max_setpoint = max((abs(run[i]['setpoint'] - replayed[i]['setpoint']) for i in steady), default=0.0)
+    same_states = [s for s, _ in rec_tr] == [s for s, _ in rep_tr]
+    max_shift = max((abs(a[1] - b[1]) for a, b in zip(rec_tr, rep_tr)), default=0)
+
+    passed = same_states and max_shift <= tol_samples and max_output <= tol_output
+    return {'samples': n,
+            'max_output_diff': max_output,
+            'max_setpoint_diff': max_setpoint,
+            'transitions': ' '.join('{}@{}'.format(s, i) for s, i in rep_tr),
+            'max_transition_shift': max_shift if same_states else 'mismatch',
+            'passed': passed}
+
+
+def setup_commands(args, meta):
+    """Console commands that prepare the controller for a replayed run with the given metadata."""
+    cmds = ['log set * OFF', 'reflow stop']
+    profile = args.profile or meta.get('profile')
+    if profile:
+        cmds.append('reflow profile use {}'.format(profile))
+    stored = meta.get('gains', {})
+    gains = [(name, getattr(args, name.lower()) if getattr(args, name.lower()) is not None else stored.get(name.lower()))
+             for name in ('Kp', 'Ki', 'Kd', 'Tau')]
+    gains = [(name, value) for name, value in gains if value is not None]
+    if gains:
+        cmds.append('reflow set ' + ' '.join('{} {}'.format(name, value) for name, value in gains))
+    cmds.append('reflow replay')
+    return ''.join(' {}\n'.format(cmd) for cmd in cmds).encode()
+
+
+def start_host_sim(args):
+    """Start the host build on a pty and return the process and the pty path."""
+    sim = subprocess.Popen([args.host_sim, '--baud', str(args.baud), '--speed', str(args.speed)],
+                           stdout=subprocess.PIPE, stdin=subprocess.DEVNULL, text=True)
+    line = sim.stdout.readline()  # "oven0: /dev/pts/N"
+    if not line.startswith('oven0: '):
+        sim.kill()
+        sim.wait()
+        raise OSError('{}: no pty'.format(args.host_sim))
+    return sim, line.split()[1]
+
+
+def worker(port, args, jobs, results):
+    """Replay runs from the job queue on one controller, or on the host build if port is None."""
+    sim = None
+    ser = None
+    error = None
+    try:
+        if port is None:
+            sim, port = start_host_sim(args)
+            time.sleep(0.5)  # Let the firmware boot.
+        ser = serial.Serial(port=port, baudrate=args.baud, timeout=0)
+    except OSError as e:
+        error = str(e)  # Reported with every run taken, so main() still gets all results.
+    try:
+        while True:
+            path = jobs.get()
+            if path is None:
+                break
+            try:
+                if error:
+                    raise OSError(error)
+                run, meta = load_run(path)
+                ser.write(setup_commands(args, meta))
+                time.sleep(0.3)
+                ser.reset_input_buffer()
+                samples = replay_run(ser, run, args.timeout)
+                time.sleep(0.1)  # Let controller leave replay mode.
+                result = compare(run, samples, args.tol_output, args.tol_samples)
+            except (OSError, ValueError, TimeoutError) as e:
+                result = {'passed': False, 'error': str(e)}
+            result.update({'run': path, 'port': port})
+            results.put(result)
+    finally:
+        if ser is not None:
+            ser.close()
+        if sim is not None:
+            sim.terminate()
+            sim.communicate()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('runs', nargs='*', help='Recorded runs (CSV or archive.py .rfr files).')
+    parser.add_argument('--archive', action='append', default=[], help='Replay every run of an archive (repeatable).')
+    parser.add_argument('--port', action='append', help='Controller serial port (repeatable, default: host build).')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count(), help='Host build instances without --port.')
+    parser.add_argument('--host-sim', default=HOST_SIM, help='Host build (default: Test/host/host_sim).')
+    parser.add_argument('--speed', type=float, default=1.0, help='Virtual seconds per second of the host build.')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--profile', help='Reflow profile used by the recorded runs.')
+    parser.add_argument('--kp', type=float)
+    parser.add_argument('--ki', type=float)
+    parser.add_argument('--kd', type=float)
+    parser.add_argument('--tau', type=float)
+    parser.add_argument('--tol-output', type=float, default=1.0, help='Allowed output difference (PWM counts).')
+    parser.add_argument('--tol-samples', type=int, default=2, help='Allowed transition shift (samples).')
+    parser.add_argument('--timeout', type=float, default=1.0, help='Answer timeout per frame (s).')
+    parser.add_argument('--report', help='Write per-run results to this CSV file.')
+    args = parser.parse_args()
+
+    runs = args.runs + [os.path.join(path, entry['id'] + '.rfr')
+                        for path in args.archive for entry in Archive(path).index()]
+    if not runs:
+        parser.error('no runs to replay')
+    ports = args.port or [None] * max(1, min(args.jobs, len(runs)))
+
+    jobs = multiprocessing.Queue()
+    results = multiprocessing.Queue()
+    for path in runs:
+        jobs.put(path)
+    for _ in ports:
+        jobs.put(None)
+
+    workers = [multiprocessing.Process(target=worker, args=(port, args, jobs, results)) for port in ports]
+    for w in workers:
+        w.start()
+
+    fields = ['run', 'port', 'passed', 'samples', 'max_output_diff', 'max_setpoint_diff',
+              'max_transition_shift', 'transitions', 'error']
+    report = []
+    for _ in runs:
+        result = results.get()
+        report.append(result)
+        print('{} {} {}'.format('PASS' if result['passed'] else 'FAIL', result['run'],
+                                result.get('error') or 'output diff {:.2f}, transition shift {}'.format(
+                                    result['max_output_diff'], result['max_transition_shift'])))
+    for w in workers:
+        w.join()
+
+    if args.report:
+        with open(args.report, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=fields)
+            writer.writeheader()
+            writer.writerows(report)
+
+    failed = sum(not r['passed'] for r in report)
+    print('{} of {} runs passed.'.format(len(report) - failed, len(report)))
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,209 @@
+"""Stream setpoints to the reflow oven controller from a host PC.
+
+The controller tracks each setpoint with its PID loop and answers every frame
+with its latest control sample. If frames stop arriving for longer than the
+device watchdog (STREAM_WATCHDOG_MS), the controller turns the relay off.
+
+Frame layout is documented in Core/Inc/stream.h. The frame helpers are shared with replay.py.
+
+Usage:
+    python stream_host.py --port COM3 --setpoints profile.csv
+    python stream_host.py --port /dev/ttyACM0 --setpoint 150 --duration 60
+
+Setpoint CSV files have the columns: time (s), setpoint (deg C)[, feedforward (PWM counts)].
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+import serial
+
+SYNC = b'\xa5\x5a'
+
+SETPOINT_FRAME = 0x01
+REPLAY_FRAME = 0x02
+SAMPLE_FRAME = 0x81
+
+FLAG_FEEDFORWARD = 0x01
+FLAG_STOP = 0x02
+FLAG_FAULT = 0x04
+
+# Little-endian payloads following the sync bytes (excluding CRC).
+SETPOINT_FMT = struct.Struct('<BHBff')      # type, seq, flags, setpoint, feedforward
+REPLAY_FMT = struct.Struct('<BHBff')        # type, seq, flags, temperature, reserved
+SAMPLE_FMT = struct.Struct('<BHBIIfff')     # type, seq, state, sample seq, tick, setpoint, temperature, output
+
+STATE_NAMES = ['RESET', 'PREHEAT', 'SOAK', 'RAMPUP', 'PEAK', 'COOLDOWN', 'STREAM']
+
+
+def crc8(data):
+    """CRC-8 with polynomial 0x07 and initial value 0x00."""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def pack_setpoint(seq, setpoint, feedforward=None, stop=False):
+    """Build a setpoint frame."""
+    flags = 0
+    if feedforward is not None:
+        flags |= FLAG_FEEDFORWARD
+    if stop:
+        flags |= FLAG_STOP
+    payload = SETPOINT_FMT.pack(SETPOINT_FRAME, seq & 0xFFFF, flags, setpoint, feedforward or 0.0)
+    return SYNC + payload + bytes([crc8(payload)])
+
+
+def pack_replay(seq, temperature, fault=False, stop=False):
+    """Build a replay frame carrying one recorded temperature sample."""
+    flags = 0
+    if fault:
+        flags |= FLAG_FAULT
+    if stop:
+        flags |= FLAG_STOP
+    payload = REPLAY_FMT.pack(REPLAY_FRAME, seq & 0xFFFF, flags, temperature, 0.0)
+    return SYNC + payload + bytes([crc8(payload)])
+
+
+class SampleDecoder:
+    """Incrementally decode sample frames from a byte stream.
+
+    Bytes outside of frames (e.g. log messages) are skipped.
+    """
+
+    FRAME_SIZE = len(SYNC) + SAMPLE_FMT.size + 1
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.crc_errors = 0
+
+    def feed(self, data):
+        """Add received bytes and return list of decoded samples as dicts."""
+        self.buf += data
+        samples = []
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                # Keep a trailing partial sync byte.
+                del self.buf[:max(0, len(self.buf) - 1)]
+                break
+            if len(self.buf) - start < self.FRAME_SIZE:
+                del self.buf[:start]
+                break
+            payload = bytes(self.buf[start + 2:start + 2 + SAMPLE_FMT.size])
+            crc = self.buf[start + self.FRAME_SIZE - 1]
+            if payload[0] != SAMPLE_FRAME or crc8(payload) != crc:
+                if payload[0] == SAMPLE_FRAME:
+                    self.crc_errors += 1
+                del self.buf[:start + 1]
+                continue
+            _, seq, state, sample_seq, tick, sp, temp, out = SAMPLE_FMT.unpack(payload)
+            samples.append({'seq': seq, 'state': STATE_NAMES[state] if state < len(STATE_NAMES) else state,
+                            'sample_seq': sample_seq, 'tick': tick, 'setpoint': sp, 'temperature': temp,
+                            'output': out})
+            del self.buf[:start + self.FRAME_SIZE]
+        return samples
+
+
+def load_setpoints(path):
+    """Load (time, setpoint, feedforward) rows from a CSV file."""
+    rows = []
+    with open(path, newline='') as f:
+        for row in csv.reader(f):
+            try:
+                values = [float(v) for v in row]
+            except ValueError:
+                continue  # Header.
+            rows.append((values[0], values[1], values[2] if len(values) > 2 else None))
+    return rows
+
+
+def setpoint_at(rows, t):
+    """Return (setpoint, feedforward) of the last row at or before time t."""
+    current = rows[0]
+    for row in rows:
+        if row[0] > t:
+            break
+        current = row
+    return current[1], current[2]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--port', required=True, help='Serial port of the controller.')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--rate', type=float, default=10.0, help='Frame rate in Hz (max 10).')
+    parser.add_argument('--setpoints', help='CSV file of time, setpoint[, feedforward].')
+    parser.add_argument('--setpoint', type=float, help='Constant setpoint (deg C).')
+    parser.add_argument('--feedforward', type=float, help='Constant feedforward (PWM counts).')
+    parser.add_argument('--duration', type=float, help='Streaming duration (s).')
+    parser.add_argument('--out', help='Write received samples to this CSV file.')
+    args = parser.parse_args()
+
+    if args.setpoints:
+        rows = load_setpoints(args.setpoints)
+        duration = args.duration or rows[-1][0]
+    elif args.setpoint is not None:
+        rows = [(0.0, args.setpoint, args.feedforward)]
+        duration = args.duration or float('inf')
+    else:
+        parser.error('either --setpoints or --setpoint is required')
+
+    period = 1.0 / min(args.rate, 10.0)
+    ser = serial.Serial(port=args.port, baudrate=args.baud, timeout=0)
+    print('Connected to', ser.name)
+
+    # Silence log output so it does not compete with frames, then enter streaming mode.
+    ser.write(b'log set * OFF\n reflow stop\n reflow stream\n')
+    time.sleep(0.5)
+    ser.reset_input_buffer()
+
+    decoder = SampleDecoder()
+    writer = None
+    out_file = None
+    if args.out:
+        out_file = open(args.out, 'w', newline='')
+        writer = csv.writer(out_file)
+        writer.writerow(['seq', 'state', 'tick (ms)', 'setpoint', 'temperature', 'output', 'sample seq'])
+
+    seq = 0
+    start = time.monotonic()
+    next_frame = start
+    try:
+        while True:
+            now = time.monotonic()
+            t = now - start
+            if t > duration:
+                break
+            if now >= next_frame:
+                sp, ff = setpoint_at(rows, t)
+                ser.write(pack_setpoint(seq, sp, ff))
+                seq += 1
+                next_frame += period
+            for sample in decoder.feed(ser.read(ser.in_waiting or 1)):
+                print('{seq:5d} {state:8s} {tick:10d} sp={setpoint:7.2f} temp={temperature:7.2f} out={output:7.1f}'
+                      .format(**sample))
+                if writer:
+                    writer.writerow([sample[k] for k in ('seq', 'state', 'tick', 'setpoint', 'temperature', 'output',
+                                                         'sample_seq')])
+            time.sleep(min(0.005, max(0.0, next_frame - time.monotonic())))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        ser.write(pack_setpoint(seq, 0.0, stop=True))
+        ser.write(b'\n reflow stop\n')
+        ser.close()
+        if out_file:
+            out_file.close()
+        if decoder.crc_errors:
+            print('CRC errors:', decoder.crc_errors, file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()